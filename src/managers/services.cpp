@@ -47,6 +47,8 @@ OtaUpdater& Services::getOtaUpdater() { return ota_updater_; }
 
 Scheduler& Services::getScheduler() { return scheduler_; }
 
+WorkerPool& Services::getWorkerPool() { return worker_pool_; }
+
 ServiceGetters Services::getGetters() {
   ServiceGetters getters(std::bind(&Services::getNetwork, this),
                          std::bind(&Services::getWebSocket, this),
@@ -56,6 +58,8 @@ ServiceGetters Services::getGetters() {
 
 Scheduler Services::scheduler_{};
 
+WorkerPool Services::worker_pool_{scheduler_};
+
 peripheral::PeripheralFactory Services::peripheral_factory_{};
 
 peripheral::PeripheralController Services::peripheral_controller_{
@@ -7,6 +7,7 @@
 #include "managers/service_getters.h"
 #include "managers/network.h"
 #include "managers/web_socket.h"
+#include "managers/worker_pool.h"
 #ifdef ESP32
 #include "managers/ota_updater.h"
 #endif
@@ -52,6 +53,8 @@ class Services {
 
   static Scheduler& getScheduler();
 
+  static WorkerPool& getWorkerPool();
+
   /**
    * Get callbacks to get the pointers to dynamic services (network and server)
    * 
@@ -68,6 +71,8 @@ class Services {
   std::shared_ptr<Storage> storage_;
   /// Executes the active tasks
   static Scheduler scheduler_;
+  /// Runs blocking driver calls of peripherals outside of the scheduler
+  static WorkerPool worker_pool_;
   /// Creates peripherals with the registered peripheral factory callbacks
   static peripheral::PeripheralFactory peripheral_factory_;
   /// Handles server requests to create / delete peripherals
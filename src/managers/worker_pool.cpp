@@ -0,0 +1,212 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace inamata {
+
+constexpr uint8_t WorkerPool::worker_count;
+constexpr size_t WorkerPool::max_queue_length;
+
+WorkerPool::WorkerPool(Scheduler& scheduler)
+    : Task(std::chrono::milliseconds(1).count(), TASK_FOREVER, &scheduler,
+           false) {}
+
+WorkerPool::~WorkerPool() {
+#ifdef ESP32
+  // Let the workers finish their current job and exit by themselves
+  stop_workers_ = true;
+  for (uint8_t i = 0; i < started_workers_; i++) {
+    xSemaphoreGive(jobs_available_);
+  }
+  for (uint8_t i = 0; i < started_workers_; i++) {
+    xSemaphoreTake(workers_stopped_, portMAX_DELAY);
+  }
+  if (workers_stopped_) {
+    vSemaphoreDelete(workers_stopped_);
+  }
+  if (jobs_available_) {
+    vSemaphoreDelete(jobs_available_);
+  }
+  if (mutex_) {
+    vSemaphoreDelete(mutex_);
+  }
+#endif
+}
+
+bool WorkerPool::submit(const void* owner, std::function<void()> work,
+                        std::function<void()> done) {
+#ifdef ESP32
+  if (!start()) {
+    return false;
+  }
+
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  const bool has_space = pending_.size() < max_queue_length;
+  if (has_space) {
+    pending_.push_back(
+        Job{.owner = owner, .work = std::move(work), .done = std::move(done)});
+  }
+  xSemaphoreGive(mutex_);
+  if (!has_space) {
+    return false;
+  }
+  xSemaphoreGive(jobs_available_);
+#else
+  // Without FreeRTOS the work blocks the loop, but the done callback is still
+  // run by the scheduler, so that peripherals behave the same on both
+  work();
+  completed_.push_back(
+      Job{.owner = owner, .work = nullptr, .done = std::move(done)});
+#endif
+
+  active_jobs_++;
+  enableIfNot();
+  return true;
+}
+
+void WorkerPool::cancel(const void* owner) {
+  const auto is_owner = [owner](const Job& job) { return job.owner == owner; };
+  size_t cancelled_jobs = 0;
+
+#ifdef ESP32
+  if (!mutex_) {
+    return;
+  }
+
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  auto pending_end = std::remove_if(pending_.begin(), pending_.end(), is_owner);
+  cancelled_jobs += std::distance(pending_end, pending_.end());
+  pending_.erase(pending_end, pending_.end());
+  auto completed_end =
+      std::remove_if(completed_.begin(), completed_.end(), is_owner);
+  cancelled_jobs += std::distance(completed_end, completed_.end());
+  completed_.erase(completed_end, completed_.end());
+  for (Worker& worker : workers_) {
+    if (worker.running_owner == owner && !worker.is_cancelled) {
+      worker.is_cancelled = true;
+      cancelled_jobs++;
+    }
+  }
+  xSemaphoreGive(mutex_);
+
+  // The work may access the owner, so wait until it returned
+  while (true) {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    const bool is_running =
+        std::any_of(workers_.begin(), workers_.end(),
+                    [owner](const Worker& worker) {
+                      return worker.running_owner == owner;
+                    });
+    xSemaphoreGive(mutex_);
+    if (!is_running) {
+      break;
+    }
+    vTaskDelay(1);
+  }
+#else
+  auto completed_end =
+      std::remove_if(completed_.begin(), completed_.end(), is_owner);
+  cancelled_jobs += std::distance(completed_end, completed_.end());
+  completed_.erase(completed_end, completed_.end());
+#endif
+
+  active_jobs_ -= cancelled_jobs;
+}
+
+bool WorkerPool::Callback() {
+  // Take the completed jobs first, as done callbacks may submit new ones
+  std::deque<Job> completed;
+#ifdef ESP32
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+#endif
+  completed.swap(completed_);
+#ifdef ESP32
+  xSemaphoreGive(mutex_);
+#endif
+
+  active_jobs_ -= completed.size();
+  for (const Job& job : completed) {
+    if (job.done) {
+      job.done();
+    }
+  }
+
+  // Sleep until the next job is submitted
+  if (active_jobs_ == 0) {
+    disable();
+  }
+  return !completed.empty();
+}
+
+#ifdef ESP32
+bool WorkerPool::start() {
+  if (started_workers_ == worker_count) {
+    return true;
+  }
+
+  if (!mutex_) {
+    mutex_ = xSemaphoreCreateMutex();
+    jobs_available_ = xSemaphoreCreateCounting(max_queue_length, 0);
+    workers_stopped_ = xSemaphoreCreateCounting(worker_count, 0);
+  }
+  if (!mutex_ || !jobs_available_ || !workers_stopped_) {
+    return false;
+  }
+
+  // Retried on the next submit if the memory for a worker is missing
+  for (; started_workers_ < worker_count; started_workers_++) {
+    Worker& worker = workers_[started_workers_];
+    worker.pool = this;
+    if (xTaskCreate(runWorker, "worker_pool", 4096, &worker, 1,
+                    &worker.handle) != pdPASS) {
+      break;
+    }
+  }
+  return started_workers_ > 0;
+}
+
+void WorkerPool::runWorker(void* arg) {
+  Worker& worker = *static_cast<Worker*>(arg);
+  WorkerPool& pool = *worker.pool;
+
+  while (true) {
+    xSemaphoreTake(pool.jobs_available_, portMAX_DELAY);
+    if (pool.stop_workers_) {
+      break;
+    }
+
+    // The job may have been cancelled in the meantime
+    xSemaphoreTake(pool.mutex_, portMAX_DELAY);
+    if (pool.pending_.empty()) {
+      xSemaphoreGive(pool.mutex_);
+      continue;
+    }
+    Job job = std::move(pool.pending_.front());
+    pool.pending_.pop_front();
+    worker.running_owner = job.owner;
+    worker.is_cancelled = false;
+    xSemaphoreGive(pool.mutex_);
+
+    job.work();
+    job.work = nullptr;
+
+    xSemaphoreTake(pool.mutex_, portMAX_DELAY);
+    if (!worker.is_cancelled) {
+      pool.completed_.push_back(std::move(job));
+    } else {
+      job.done = nullptr;
+    }
+    worker.running_owner = nullptr;
+    xSemaphoreGive(pool.mutex_);
+  }
+
+  xSemaphoreGive(pool.workers_stopped_);
+  vTaskDelete(nullptr);
+}
+#endif
+
+const __FlashStringHelper* WorkerPool::submit_error_ =
+    FPSTR("Blocking operation busy or worker queue full");
+
+}  // namespace inamata
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "managers/types.h"
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+namespace inamata {
+
+/**
+ * Runs blocking driver calls outside of the scheduler's loop
+ *
+ * Peripherals whose vendor drivers block (e.g. waiting for the bus) submit
+ * those calls as jobs. On the ESP32 they are executed by a small pool of
+ * FreeRTOS worker tasks, which are started with the first job. Completed jobs
+ * are handed back through a completion queue and their done callbacks are run
+ * by the scheduler, so that peripherals never have to synchronize with the
+ * workers themselves. On the ESP8266 the jobs are run inline instead.
+ */
+class WorkerPool : public Task {
+ public:
+  /**
+   * Registers the completion handler with the scheduler
+   *
+   * \param scheduler The scheduler to run the done callbacks from
+   */
+  WorkerPool(Scheduler& scheduler);
+  virtual ~WorkerPool();
+
+  /**
+   * Queues a job to run on a worker
+   *
+   * \param owner The peripheral that submits the job. Used to cancel it
+   * \param work The blocking calls to run on a worker
+   * \param done Run by the scheduler once the work returned
+   * \return False if the queue is full or the workers could not be started
+   */
+  bool submit(const void* owner, std::function<void()> work,
+              std::function<void()> done);
+
+  /**
+   * Drops all jobs of a peripheral and waits for its running ones
+   *
+   * Has to be called before a peripheral that submitted jobs is destroyed, so
+   * that no work or done callback accesses it afterwards. The done callbacks
+   * of the dropped jobs are not run.
+   *
+   * \param owner The peripheral that submitted the jobs
+   */
+  void cancel(const void* owner);
+
+  /**
+   * Runs the done callbacks of all completed jobs
+   *
+   * \return True if a job was completed
+   */
+  bool Callback() final;
+
+  /// Number of worker tasks. Jobs wait for a free worker beyond this
+  static constexpr uint8_t worker_count = 2;
+  /// Maximum number of jobs waiting for a worker
+  static constexpr size_t max_queue_length = 16;
+
+  static const __FlashStringHelper* submit_error_;
+
+ private:
+  struct Job {
+    const void* owner;
+    std::function<void()> work;
+    std::function<void()> done;
+  };
+
+#ifdef ESP32
+  /// State of a single worker task
+  struct Worker {
+    WorkerPool* pool;
+    TaskHandle_t handle;
+    /// Owner of the job being run. Guarded by the mutex
+    const void* running_owner;
+    /// Whether the running job was cancelled. Guarded by the mutex
+    bool is_cancelled;
+  };
+
+  /**
+   * Creates the synchronization primitives and starts the workers
+   *
+   * \return True if the workers are running
+   */
+  bool start();
+  static void runWorker(void* arg);
+
+  /// Guards the job queues and the workers' running jobs
+  SemaphoreHandle_t mutex_ = nullptr;
+  /// Counts the pending jobs, which the workers wait on
+  SemaphoreHandle_t jobs_available_ = nullptr;
+  /// Given by each worker once it exited
+  SemaphoreHandle_t workers_stopped_ = nullptr;
+  std::array<Worker, worker_count> workers_{};
+  uint8_t started_workers_ = 0;
+  volatile bool stop_workers_ = false;
+#endif
+
+  std::deque<Job> pending_;
+  std::deque<Job> completed_;
+  /// Submitted jobs whose done callbacks have not been run or dropped yet.
+  /// Only used by the scheduler
+  size_t active_jobs_ = 0;
+};
+
+/**
+ * A blocking operation of a peripheral that runs on the worker pool
+ *
+ * Tracks a single job at a time. The peripheral keeps returning a short wait
+ * to its task while the job is busy, similar to a measurement in progress,
+ * and then returns the job's result. Declare it as the last member of the
+ * peripheral, so that it is destroyed first and cancels the peripheral's
+ * jobs while the driver is still intact.
+ *
+ * \tparam Result The capability's result with a wait time and error
+ */
+template <class Result>
+class BlockingOperation {
+ public:
+  /**
+   * Creates an idle operation
+   *
+   * \param pool The pool to run the jobs on
+   * \param owner The peripheral whose jobs are cancelled on destruction
+   */
+  BlockingOperation(WorkerPool& pool, const void* owner)
+      : pool_(pool), owner_(owner) {}
+  ~BlockingOperation() { pool_.cancel(owner_); }
+
+  /**
+   * Runs a job whose result is returned by takeResult()
+   *
+   * \param work The blocking calls returning the capability's result
+   * \return False if a job is busy or the pool's queue is full
+   */
+  bool run(std::function<Result()> work) {
+    std::shared_ptr<Result> result = std::make_shared<Result>();
+    return submit([work, result]() { *result = work(); },
+                  [this, result]() {
+                    result_ = std::move(*result);
+                    has_result_ = true;
+                  });
+  }
+
+  /**
+   * Runs the work unless busy and returns its result once completed
+   *
+   * Intended for the handle functions of capabilities, which are called again
+   * after the returned wait until no wait is returned.
+   *
+   * \param who The peripheral's type to report errors with
+   * \param work The blocking calls returning the capability's result
+   * \return The job's result or the time to wait for it
+   */
+  Result poll(const String& who, std::function<Result()> work) {
+    if (is_busy_) {
+      return Result{.wait = poll_wait};
+    }
+    if (has_result_) {
+      return takeResult();
+    }
+    if (!run(std::move(work))) {
+      return Result{.wait = {},
+                    .error = ErrorResult(who, WorkerPool::submit_error_)};
+    }
+    return Result{.wait = poll_wait};
+  }
+
+  /**
+   * Runs a job without a result, e.g. to start a measurement
+   *
+   * \param work The blocking calls
+   * \return False if a job is busy or the pool's queue is full
+   */
+  bool post(std::function<void()> work) {
+    return submit(std::move(work), []() {});
+  }
+
+  /**
+   * Checks if a job was submitted and has not completed yet
+   *
+   * \return True while the job is queued or running
+   */
+  bool isBusy() const { return is_busy_; }
+
+  /**
+   * Checks if a job submitted by run() completed
+   *
+   * \return True if takeResult() returns the job's result
+   */
+  bool hasResult() const { return has_result_; }
+
+  /**
+   * Gets the result of the last job submitted by run()
+   *
+   * \return The job's result
+   */
+  Result takeResult() {
+    has_result_ = false;
+    return std::move(result_);
+  }
+
+  /// Time to wait before checking a busy job again
+  static constexpr std::chrono::milliseconds poll_wait{10};
+
+ private:
+  bool submit(std::function<void()> work, std::function<void()> done) {
+    if (is_busy_) {
+      return false;
+    }
+    is_busy_ = true;
+    has_result_ = false;
+    const bool is_submitted =
+        pool_.submit(owner_, std::move(work), [this, done]() {
+          is_busy_ = false;
+          done();
+        });
+    if (!is_submitted) {
+      is_busy_ = false;
+    }
+    return is_submitted;
+  }
+
+  WorkerPool& pool_;
+  const void* owner_;
+  bool is_busy_ = false;
+  bool has_result_ = false;
+  Result result_;
+};
+
+template <class Result>
+constexpr std::chrono::milliseconds BlockingOperation<Result>::poll_wait;
+
+}  // namespace inamata
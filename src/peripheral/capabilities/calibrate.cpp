@@ -4,17 +4,6 @@ namespace inamata {
 namespace peripheral {
 namespace capabilities {
 
-bool Calibrate::registerType(const String& type) {
-  return getSupportedTypes().insert(type).second;
-}
-
-bool Calibrate::isSupported(const String& type) {
-  const std::set<String>& types = getSupportedTypes();
-  return std::binary_search(types.begin(), types.end(), type);
-}
-
-const std::set<String>& Calibrate::getTypes() { return getSupportedTypes(); }
-
 String Calibrate::invalidTypeError(const utils::UUID& uuid,
                                    std::shared_ptr<Peripheral> peripheral) {
   String error(F("Calibrate capability not supported: "));
@@ -24,11 +13,6 @@ String Calibrate::invalidTypeError(const utils::UUID& uuid,
   return error;
 }
 
-std::set<String>& Calibrate::getSupportedTypes() {
-  static std::set<String> supported_types;
-  return supported_types;
-}
-
 }  // namespace capabilities
 }  // namespace peripheral
 }  // namespace inamata
@@ -4,7 +4,6 @@
 
 #include <chrono>
 #include <memory>
-#include <set>
 
 #include "peripheral/peripheral.h"
 #include "utils/uuid.h"
@@ -50,11 +49,6 @@ class Calibrate {
    */
   virtual Result handleCalibration() = 0;
 
-  // Type checking
-  static bool registerType(const String& type);
-  static bool isSupported(const String& type);
-  static const std::set<String>& getTypes();
-
   /**
    * Error when a peripheral can't be casted to the specific capability.
    *
@@ -64,9 +58,6 @@ class Calibrate {
    */
   static String invalidTypeError(const utils::UUID& uuid,
                                  std::shared_ptr<Peripheral> peripheral);
-
- private:
-  static std::set<String>& getSupportedTypes();
 };
 
 }  // namespace capabilities
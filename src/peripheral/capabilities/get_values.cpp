@@ -4,17 +4,6 @@ namespace inamata {
 namespace peripheral {
 namespace capabilities {
 
-bool GetValues::registerType(const String& type) {
-  return getSupportedTypes().insert(type).second;
-}
-
-bool GetValues::isSupported(const String& type) {
-  const std::set<String>& types = getSupportedTypes();
-  return std::binary_search(types.begin(), types.end(), type);
-}
-
-const std::set<String>& GetValues::getTypes() { return getSupportedTypes(); }
-
 String GetValues::invalidTypeError(const utils::UUID& uuid,
                                    std::shared_ptr<Peripheral> peripheral) {
   String error(F("GetValues capability not supported: "));
@@ -26,11 +15,6 @@ String GetValues::invalidTypeError(const utils::UUID& uuid,
 
 const __FlashStringHelper* GetValues::get_values_error_ = FPSTR("GetValues error");
 
-std::set<String>& GetValues::getSupportedTypes() {
-  static std::set<String> supported_types;
-  return supported_types;
-}
-
 }  // namespace capabilities
 }  // namespace peripheral
 }  // namespace inamata
\ No newline at end of file
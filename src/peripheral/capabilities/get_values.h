@@ -3,7 +3,6 @@
 #include <Arduino.h>
 
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "peripheral/peripheral.h"
@@ -28,11 +27,6 @@ class GetValues {
    */
   virtual Result getValues() = 0;
 
-  // Type checking
-  static bool registerType(const String& type);
-  static bool isSupported(const String& type);
-  static const std::set<String>& getTypes();
-
   /**
    * Error when a peripheral can't be casted to the specific capability.
    *
@@ -45,9 +39,6 @@ class GetValues {
 
  protected:
   static const __FlashStringHelper* get_values_error_;
-
- private:
-  static std::set<String>& getSupportedTypes();
 };
 
 }  // namespace capabilities
@@ -4,17 +4,6 @@ namespace inamata {
 namespace peripheral {
 namespace capabilities {
 
-bool LedStrip::registerType(const String& type) {
-  return getSupportedTypes().insert(type).second;
-}
-
-bool LedStrip::isSupported(const String& type) {
-  const std::set<String>& types = getSupportedTypes();
-  return std::binary_search(types.begin(), types.end(), type);
-}
-
-const std::set<String>& LedStrip::getTypes() { return getSupportedTypes(); }
-
 String LedStrip::invalidTypeError(const utils::UUID& uuid,
                                   std::shared_ptr<Peripheral> peripheral) {
   String error(F("LedStrip capability not supported: "));
@@ -24,11 +13,6 @@ String LedStrip::invalidTypeError(const utils::UUID& uuid,
   return error;
 }
 
-std::set<String>& LedStrip::getSupportedTypes() {
-  static std::set<String> supported_types;
-  return supported_types;
-}
-
 }  // namespace capabilities
 }  // namespace peripheral
 }  // namespace inamata
@@ -3,7 +3,6 @@
 #include <Arduino.h>
 
 #include <memory>
-#include <set>
 
 #include "peripheral/peripheral.h"
 #include "utils/color.h"
@@ -32,16 +31,34 @@ class LedStrip {
    */
   virtual void turnOff() = 0;
 
-  // Type checking
-  static bool registerType(const String& type);
-  static bool isSupported(const String& type);
-  static const std::set<String>& getTypes();
+  /**
+   * Gets the number of individually addressable pixels
+   *
+   * \return The number of pixels in the LED strip
+   */
+  virtual size_t getPixelCount() const = 0;
+
+  /**
+   * Sets the color of a single pixel in the frame buffer
+   *
+   * The pixel only changes once the frame is shown. Out of range indices are
+   * ignored.
+   *
+   * \param index Index of the pixel, starting at zero
+   * \param color Color of the pixel
+   */
+  virtual void setPixel(size_t index, utils::Color color) = 0;
+
+  /**
+   * Starts sending the frame buffer to the LED strip without waiting for it
+   *
+   * \return False if the previous frame is still being sent and the frame was
+   *         skipped
+   */
+  virtual bool show() = 0;
 
   static String invalidTypeError(const utils::UUID& uuid,
                                  std::shared_ptr<Peripheral> peripheral);
-
- private:
-  static std::set<String>& getSupportedTypes();
 };
 
 }  // namespace capabilities
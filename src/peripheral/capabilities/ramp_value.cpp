@@ -0,0 +1,56 @@
+#include "ramp_value.h"
+
+#include <cmath>
+
+namespace inamata {
+namespace peripheral {
+namespace capabilities {
+
+bool RampValue::toCurve(JsonVariantConst name, Curve& curve) {
+  if (name.isNull() || name == F("linear")) {
+    curve = Curve::kLinear;
+  } else if (name == F("ease_in")) {
+    curve = Curve::kEaseIn;
+  } else if (name == F("ease_out")) {
+    curve = Curve::kEaseOut;
+  } else if (name == F("ease_in_out")) {
+    curve = Curve::kEaseInOut;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+float RampValue::applyCurve(Curve curve, float progress) {
+  progress = std::fmax(0, std::fmin(1, progress));
+  switch (curve) {
+    case Curve::kEaseIn:
+      return progress * progress;
+    case Curve::kEaseOut:
+      return 1 - (1 - progress) * (1 - progress);
+    case Curve::kEaseInOut:
+      return progress * progress * (3 - 2 * progress);
+    case Curve::kLinear:
+    default:
+      return progress;
+  }
+}
+
+String RampValue::invalidTypeError(const utils::UUID& uuid,
+                                   std::shared_ptr<Peripheral> peripheral) {
+  String error(F("RampValue capability not supported: "));
+  error += uuid.toString();
+  error += F(" is a ");
+  error += peripheral->getType();
+  return error;
+}
+
+const __FlashStringHelper* RampValue::ramp_ms_key_ = FPSTR("ramp_ms");
+const __FlashStringHelper* RampValue::curve_key_ = FPSTR("curve");
+const __FlashStringHelper* RampValue::ramp_error_ = FPSTR(
+    "Invalid ramp: ramp_ms (uint) and curve (linear, ease_in, ease_out, "
+    "ease_in_out)");
+
+}  // namespace capabilities
+}  // namespace peripheral
+}  // namespace inamata
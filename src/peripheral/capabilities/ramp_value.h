@@ -0,0 +1,78 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <memory>
+
+#include "peripheral/peripheral.h"
+#include "utils/uuid.h"
+#include "utils/value_unit.h"
+
+namespace inamata {
+namespace peripheral {
+namespace capabilities {
+
+/**
+ * A capability that allows a value to be ramped to a target over time
+ *
+ * The peripheral runs the ramp itself, e.g. with a hardware fade engine, so
+ * that a smooth ramp only requires a single command.
+ */
+class RampValue {
+ public:
+  /// The shape of the ramp from the start to the target value
+  enum class Curve { kLinear, kEaseIn, kEaseOut, kEaseInOut };
+
+  struct Ramp {
+    utils::ValueUnit target;
+    std::chrono::milliseconds duration;
+    Curve curve;
+  };
+
+  /**
+   * Starts ramping from the current to the target value without blocking
+   *
+   * A running ramp is replaced. A later setValue() ends the ramp.
+   *
+   * \param ramp The target value, the duration and the curve of the ramp
+   * \return Whether the ramp was started
+   */
+  virtual ErrorResult rampValue(const Ramp& ramp) = 0;
+
+  /**
+   * Parses the name of a curve (linear, ease_in, ease_out, ease_in_out)
+   *
+   * \param name The name of the curve. Null defaults to linear
+   * \param curve Receives the parsed curve
+   * \return True if the name is a valid curve
+   */
+  static bool toCurve(JsonVariantConst name, Curve& curve);
+
+  /**
+   * Maps the linear progress of a ramp to the progress of a curve
+   *
+   * \param curve The curve of the ramp
+   * \param progress The elapsed fraction of the ramp duration from 0 to 1
+   * \return The fraction of the value change from 0 to 1
+   */
+  static float applyCurve(Curve curve, float progress);
+
+  /**
+   * Error when a peripheral can't be casted to the specific capability.
+   *
+   * \param uuid The UUID of the peripheral to be casted
+   * \param peripheral The peripheral to be casted (to get its type)
+   * \return The error message
+   */
+  static String invalidTypeError(const utils::UUID& uuid,
+                                 std::shared_ptr<Peripheral> peripheral);
+
+  static const __FlashStringHelper* ramp_ms_key_;
+  static const __FlashStringHelper* curve_key_;
+  static const __FlashStringHelper* ramp_error_;
+};
+
+}  // namespace capabilities
+}  // namespace peripheral
+}  // namespace inamata
@@ -4,17 +4,6 @@ namespace inamata {
 namespace peripheral {
 namespace capabilities {
 
-bool SetValue::registerType(const String& type) {
-  return getSupportedTypes().insert(type).second;
-}
-
-bool SetValue::isSupported(const String& type) {
-  const std::set<String>& types = getSupportedTypes();
-  return std::binary_search(types.begin(), types.end(), type);
-}
-
-const std::set<String>& SetValue::getTypes() { return getSupportedTypes(); }
-
 String SetValue::invalidTypeError(const utils::UUID& uuid,
                                   std::shared_ptr<Peripheral> peripheral) {
   String error(F("SetValue capability not supported: "));
@@ -24,11 +13,6 @@ String SetValue::invalidTypeError(const utils::UUID& uuid,
   return error;
 }
 
-std::set<String>& SetValue::getSupportedTypes() {
-  static std::set<String> supported_types;
-  return supported_types;
-}
-
 }  // namespace capabilities
 }  // namespace peripheral
 }  // namespace inamata
\ No newline at end of file
@@ -3,7 +3,6 @@
 #include <Arduino.h>
 
 #include <memory>
-#include <set>
 
 #include "peripheral/peripheral.h"
 #include "utils/uuid.h"
@@ -25,16 +24,8 @@ class SetValue {
    */
   virtual void setValue(utils::ValueUnit value_unit) = 0;
 
-  // Type checking
-  static bool registerType(const String& type);
-  static bool isSupported(const String& type);
-  static const std::set<String>& getTypes();
-
   static String invalidTypeError(const utils::UUID& uuid,
                                  std::shared_ptr<Peripheral> peripheral);
-
- private:
-  static std::set<String>& getSupportedTypes();
 };
 
 }  // namespace capabilities
@@ -4,7 +4,6 @@
 
 #include <chrono>
 #include <memory>
-#include <set>
 
 #include "peripheral/peripheral.h"
 #include "utils/uuid.h"
@@ -46,16 +45,8 @@ class StartMeasurement {
    */
   virtual Result handleMeasurement() = 0;
 
-  // Type checking
-  static bool registerType(const String& type);
-  static bool isSupported(const String& type);
-  static const std::set<String>& getTypes();
-
   static String invalidTypeError(const utils::UUID& uuid,
                                  std::shared_ptr<Peripheral> peripheral);
-
- private:
-  static std::set<String>& getSupportedTypes();
 };
 
 }  // namespace capabilities
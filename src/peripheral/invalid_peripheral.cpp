@@ -21,8 +21,5 @@ std::shared_ptr<Peripheral> InvalidPeripheral::factory(const ServiceGetters& ser
   return std::make_shared<InvalidPeripheral>();
 }
 
-bool InvalidPeripheral::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
 }  // namespace peripheral
 }  // namespace inamata
@@ -16,12 +16,8 @@ class InvalidPeripheral : public Peripheral {
 
   const String& getType() const final;
   static const String& type();
-
- private:
   static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
                                              const JsonObjectConst&);
-
-  static bool registered_;
 };
 
 }  // namespace peripheral
@@ -3,6 +3,24 @@
 namespace inamata {
 namespace peripheral {
 
+capabilities::GetValues* Peripheral::asGetValues() { return nullptr; }
+
+capabilities::SetValue* Peripheral::asSetValue() { return nullptr; }
+
+capabilities::StartMeasurement* Peripheral::asStartMeasurement() {
+  return nullptr;
+}
+
+capabilities::Calibrate* Peripheral::asCalibrate() { return nullptr; }
+
+capabilities::LedStrip* Peripheral::asLedStrip() { return nullptr; }
+
+capabilities::RampValue* Peripheral::asRampValue() { return nullptr; }
+
+ErrorResult Peripheral::update(const JsonObjectConst& parameters) {
+  return ErrorResult(getType(), F("Updates not supported"));
+}
+
 bool Peripheral::isValid() const { return valid_; }
 
 ErrorResult Peripheral::getError() const {
@@ -12,6 +12,15 @@ namespace peripheral {
 
 class TaskFactory;
 
+namespace capabilities {
+class Calibrate;
+class GetValues;
+class LedStrip;
+class RampValue;
+class SetValue;
+class StartMeasurement;
+}  // namespace capabilities
+
 class Peripheral {
  public:
   Peripheral() = default;
@@ -27,6 +36,32 @@ class Peripheral {
    */
   virtual const String& getType() const = 0;
 
+  /**
+   * Typed accessors to the capability interfaces of the peripheral
+   *
+   * Overwritten by each peripheral for the capabilities it supports. Allows
+   * the capabilities to be queried without RTTI.
+   *
+   * \return The capability interface or a nullptr if it is not supported
+   */
+  virtual capabilities::GetValues* asGetValues();
+  virtual capabilities::SetValue* asSetValue();
+  virtual capabilities::StartMeasurement* asStartMeasurement();
+  virtual capabilities::Calibrate* asCalibrate();
+  virtual capabilities::LedStrip* asLedStrip();
+  virtual capabilities::RampValue* asRampValue();
+
+  /**
+   * Changes the configuration of the peripheral while it keeps running
+   *
+   * Overwritten by peripherals that can be reconfigured without being
+   * recreated, which keeps their state and the tasks using them.
+   *
+   * \param parameters The parameters to change
+   * \return Contains the cause of the error, if the update failed
+   */
+  virtual ErrorResult update(const JsonObjectConst& parameters);
+
   /**
    * Checks if the peripheral is valid (often used after construction)
    *
@@ -1,5 +1,7 @@
 #include "peripheral_controller.h"
 
+#include <algorithm>
+
 namespace inamata {
 namespace peripheral {
 
@@ -45,6 +47,18 @@ void PeripheralController::handleCallback(const JsonObjectConst& message) {
     }
   }
 
+  // Reconfigure a running peripheral for each command and store the result
+  JsonArrayConst update_commands =
+      peripheral_commands[update_command_key_].as<JsonArrayConst>();
+  if (update_commands) {
+    JsonArray update_results =
+        peripheral_results.createNestedArray(update_command_key_);
+    for (JsonVariantConst update_command : update_commands) {
+      ErrorResult error = update(update_command);
+      addResultEntry(update_command[uuid_key_], error, update_results);
+    }
+  }
+
   // Remove a peripheral for each command and store the result
   JsonArrayConst remove_commands =
       peripheral_commands[remove_command_key_].as<JsonArrayConst>();
@@ -57,6 +71,42 @@ void PeripheralController::handleCallback(const JsonObjectConst& message) {
     }
   }
 
+  // Directly set values without creating a task. Done before reads so that a
+  // read in the same command observes the written value
+  JsonArrayConst write_commands =
+      peripheral_commands[write_command_key_].as<JsonArrayConst>();
+  if (write_commands) {
+    JsonArray write_results =
+        peripheral_results.createNestedArray(write_command_key_);
+    for (JsonVariantConst write_command : write_commands) {
+      ErrorResult error = write(write_command);
+      addResultEntry(write_command[uuid_key_], error, write_results);
+    }
+  }
+
+  // Directly read values and add them to the result entries
+  JsonArrayConst read_commands =
+      peripheral_commands[read_command_key_].as<JsonArrayConst>();
+  if (read_commands) {
+    JsonArray read_results =
+        peripheral_results.createNestedArray(read_command_key_);
+    for (JsonVariantConst read_command : read_commands) {
+      capabilities::GetValues::Result values = read(read_command);
+      JsonObject result =
+          addResultEntry(read_command[uuid_key_], values.error, read_results);
+      if (!values.error.isError()) {
+        JsonArray data_points =
+            result.createNestedArray(utils::ValueUnit::data_points_key);
+        for (const auto& value_unit : values.values) {
+          JsonObject data_point = data_points.createNestedObject();
+          data_point[utils::ValueUnit::value_key] = value_unit.value;
+          data_point[utils::ValueUnit::data_point_type_key] =
+              value_unit.data_point_type.toString();
+        }
+      }
+    }
+  }
+
   // Send the command results
   std::shared_ptr<WebSocket> web_socket = services_.getWebSocket();
   if (web_socket) {
@@ -70,8 +120,8 @@ void PeripheralController::handleCallback(const JsonObjectConst& message) {
 std::vector<utils::UUID> PeripheralController::getPeripheralIDs() {
   std::vector<utils::UUID> uuids;
   uuids.reserve(peripherals_.size());
-  for (const auto& peripheral : peripherals_) {
-    uuids.push_back(peripheral.first);
+  for (const auto& entry : peripherals_) {
+    uuids.push_back(entry.uuid);
   }
   return uuids;
 }
@@ -83,9 +133,9 @@ ErrorResult PeripheralController::add(const JsonObjectConst& doc) {
   }
 
   // If the peripheral is present, try to replace it
-  auto iterator = peripherals_.find(uuid);
-  if (iterator != peripherals_.end()) {
-    if (iterator->second.use_count() > 1) {
+  auto iterator = lowerBound(uuid);
+  if (iterator != peripherals_.end() && iterator->uuid == uuid) {
+    if (iterator->peripheral.use_count() > 1) {
       return ErrorResult(type(), String(F("Peripheral still in use")));
     }
     peripherals_.erase(iterator);
@@ -102,20 +152,46 @@ ErrorResult PeripheralController::add(const JsonObjectConst& doc) {
     return ErrorResult(type(), F("Error calling peripheral factory"));
   }
 
-  peripherals_.emplace(uuid, peripheral);
+  // Resolve the capabilities once, so that tasks do not have to query them on
+  // each creation
+  peripherals_.insert(
+      lowerBound(uuid),
+      PeripheralEntry{
+          .uuid = uuid,
+          .peripheral = peripheral,
+          .get_values = peripheral->asGetValues(),
+          .set_value = peripheral->asSetValue(),
+          .start_measurement = peripheral->asStartMeasurement(),
+          .calibrate = peripheral->asCalibrate(),
+          .led_strip = peripheral->asLedStrip(),
+          .ramp_value = peripheral->asRampValue(),
+      });
 
   return ErrorResult();
 }
 
+ErrorResult PeripheralController::update(const JsonObjectConst& doc) {
+  utils::UUID uuid(doc[uuid_key_]);
+  if (!uuid.isValid()) {
+    return ErrorResult(type(), uuid_key_error_);
+  }
+
+  const PeripheralEntry* entry = findPeripheral(uuid);
+  if (!entry) {
+    return ErrorResult(type(), peripheral_not_found_error_);
+  }
+  return entry->peripheral->update(doc);
+}
+
 ErrorResult PeripheralController::remove(const JsonObjectConst& doc) {
   utils::UUID uuid(doc[uuid_key_]);
   if (!uuid.isValid()) {
     return ErrorResult(type(), uuid_key_error_);
   }
 
-  auto iterator = peripherals_.find(uuid);
-  if (iterator != peripherals_.end()) {
-    if (iterator->second.use_count() > 1) {
+  auto iterator = lowerBound(uuid);
+  if (iterator != peripherals_.end() && iterator->uuid == uuid) {
+    if (iterator->peripheral.use_count() > 1) {
       return ErrorResult(type(), String(F("Peripheral still in use")));
     }
     peripherals_.erase(iterator);
@@ -124,19 +200,123 @@ ErrorResult PeripheralController::remove(const JsonObjectConst& doc) {
   return ErrorResult();
 }
 
+ErrorResult PeripheralController::write(const JsonObjectConst& doc) {
+  utils::UUID uuid(doc[uuid_key_]);
+  if (!uuid.isValid()) {
+    return ErrorResult(type(), uuid_key_error_);
+  }
+
+  const PeripheralEntry* entry = findPeripheral(uuid);
+  if (!entry) {
+    return ErrorResult(type(), peripheral_not_found_error_);
+  }
+  if (!entry->set_value) {
+    return ErrorResult(type(), capabilities::SetValue::invalidTypeError(
+                                   uuid, entry->peripheral));
+  }
+
+  JsonVariantConst value = doc[utils::ValueUnit::value_key];
+  if (!value.is<float>()) {
+    return ErrorResult(type(), utils::ValueUnit::value_key_error);
+  }
+  utils::UUID data_point_type(doc[utils::ValueUnit::data_point_type_key]);
+  if (!data_point_type.isValid()) {
+    return ErrorResult(type(), utils::ValueUnit::data_point_type_key_error);
+  }
+
+  utils::ValueUnit value_unit{.value = value,
+                              .data_point_type = data_point_type};
+
+  // Optionally ramp to the value instead of jumping to it
+  JsonVariantConst ramp_ms = doc[capabilities::RampValue::ramp_ms_key_];
+  if (!ramp_ms.isNull()) {
+    if (!entry->ramp_value) {
+      return ErrorResult(type(), capabilities::RampValue::invalidTypeError(
+                                     uuid, entry->peripheral));
+    }
+    capabilities::RampValue::Curve curve;
+    if (!ramp_ms.is<uint32_t>() ||
+        !capabilities::RampValue::toCurve(
+            doc[capabilities::RampValue::curve_key_], curve)) {
+      return ErrorResult(type(), capabilities::RampValue::ramp_error_);
+    }
+    return entry->ramp_value->rampValue(capabilities::RampValue::Ramp{
+        .target = value_unit,
+        .duration = std::chrono::milliseconds(ramp_ms.as<uint32_t>()),
+        .curve = curve});
+  }
+
+  entry->set_value->setValue(value_unit);
+  return ErrorResult();
+}
+
+capabilities::GetValues::Result PeripheralController::read(
+    const JsonObjectConst& doc) {
+  utils::UUID uuid(doc[uuid_key_]);
+  if (!uuid.isValid()) {
+    return {.values = {}, .error = ErrorResult(type(), uuid_key_error_)};
+  }
+
+  const PeripheralEntry* entry = findPeripheral(uuid);
+  if (!entry) {
+    return {.values = {},
+            .error = ErrorResult(type(), peripheral_not_found_error_)};
+  }
+  if (!entry->get_values) {
+    return {.values = {},
+            .error = ErrorResult(type(),
+                                 capabilities::GetValues::invalidTypeError(
+                                     uuid, entry->peripheral))};
+  }
+  // Measurements spanning multiple loop iterations require a ReadSensor task
+  if (entry->start_measurement) {
+    return {.values = {}, .error = ErrorResult(type(), requires_task_error_)};
+  }
+
+  return entry->get_values->getValues();
+}
+
 std::shared_ptr<peripheral::Peripheral> PeripheralController::getPeripheral(
     const utils::UUID& uuid) {
-  auto peripheral = peripherals_.find(uuid);
-  if (peripheral != peripherals_.end()) {
-    return peripheral->second;
+  const PeripheralEntry* entry = findPeripheral(uuid);
+  if (entry) {
+    return entry->peripheral;
   } else {
     return std::shared_ptr<peripheral::Peripheral>();
   }
 }
 
-void PeripheralController::addResultEntry(const JsonVariantConst& uuid,
-                                          const ErrorResult& error,
-                                          const JsonArray& results) {
+const PeripheralEntry* PeripheralController::findPeripheral(
+    const utils::UUID& uuid) const {
+  auto iterator = lowerBound(uuid);
+  if (iterator != peripherals_.end() && iterator->uuid == uuid) {
+    return &*iterator;
+  } else {
+    return nullptr;
+  }
+}
+
+std::vector<PeripheralEntry>::iterator PeripheralController::lowerBound(
+    const utils::UUID& uuid) {
+  return std::lower_bound(
+      peripherals_.begin(), peripherals_.end(), uuid,
+      [](const PeripheralEntry& entry, const utils::UUID& uuid) {
+        return entry.uuid < uuid;
+      });
+}
+
+std::vector<PeripheralEntry>::const_iterator PeripheralController::lowerBound(
+    const utils::UUID& uuid) const {
+  return std::lower_bound(
+      peripherals_.begin(), peripherals_.end(), uuid,
+      [](const PeripheralEntry& entry, const utils::UUID& uuid) {
+        return entry.uuid < uuid;
+      });
+}
+
+JsonObject PeripheralController::addResultEntry(const JsonVariantConst& uuid,
+                                                const ErrorResult& error,
+                                                const JsonArray& results) {
   JsonObject result = results.createNestedObject();
 
   // Save whether the peripheral could be created or the reason for failing
@@ -148,6 +328,7 @@ void PeripheralController::addResultEntry(const JsonVariantConst& uuid,
     result[uuid_key_] = uuid;
     result["status"] = "success";
   }
+  return result;
 }
 
 const __FlashStringHelper* PeripheralController::peripheral_command_key_ =
@@ -161,6 +342,14 @@ const __FlashStringHelper* PeripheralController::update_command_key_ =
     FPSTR("update");
 const __FlashStringHelper* PeripheralController::remove_command_key_ =
     FPSTR("remove");
+const __FlashStringHelper* PeripheralController::write_command_key_ =
+    FPSTR("write");
+const __FlashStringHelper* PeripheralController::read_command_key_ =
+    FPSTR("read");
+const __FlashStringHelper* PeripheralController::peripheral_not_found_error_ =
+    FPSTR("Could not find peripheral");
+const __FlashStringHelper* PeripheralController::requires_task_error_ =
+    FPSTR("Requires measurement cycle. Use a ReadSensor task");
 
 }  // namespace peripheral
 }  // namespace inamata
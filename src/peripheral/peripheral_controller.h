@@ -3,11 +3,17 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
-#include <map>
 #include <memory>
+#include <vector>
 
 #include "managers/io_types.h"
 #include "managers/service_getters.h"
+#include "peripheral/capabilities/calibrate.h"
+#include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/led_strip.h"
+#include "peripheral/capabilities/ramp_value.h"
+#include "peripheral/capabilities/set_value.h"
+#include "peripheral/capabilities/start_measurement.h"
 #include "peripheral/peripheral.h"
 #include "peripheral/peripheral_factory.h"
 #include "utils/uuid.h"
@@ -15,6 +21,39 @@
 namespace inamata {
 namespace peripheral {
 
+/**
+ * A registered peripheral with its capability interfaces
+ *
+ * The capability pointers are resolved once when the peripheral is added and
+ * are null if the peripheral does not support the capability. They are only
+ * valid as long as the peripheral is kept alive. Use share() to hold on to
+ * them.
+ */
+struct PeripheralEntry {
+  utils::UUID uuid;
+  std::shared_ptr<Peripheral> peripheral;
+  capabilities::GetValues* get_values;
+  capabilities::SetValue* set_value;
+  capabilities::StartMeasurement* start_measurement;
+  capabilities::Calibrate* calibrate;
+  capabilities::LedStrip* led_strip;
+  capabilities::RampValue* ramp_value;
+
+  /**
+   * Shares ownership of the peripheral through one of its capabilities
+   *
+   * \param capability One of the entry's capability pointers
+   * \return A shared pointer to the capability, or a nullptr if unsupported
+   */
+  template <class T>
+  std::shared_ptr<T> share(T* capability) const {
+    if (!capability) {
+      return std::shared_ptr<T>();
+    }
+    return std::shared_ptr<T>(peripheral, capability);
+  }
+};
+
 class PeripheralController {
  public:
   PeripheralController(PeripheralFactory& peripheral_factory);
@@ -40,6 +79,17 @@ class PeripheralController {
    */
   std::shared_ptr<Peripheral> getPeripheral(const utils::UUID& name);
 
+  /**
+   * Returns the registry entry of a peripheral with its capabilities
+   *
+   * The pointer is invalidated when peripherals are added or removed, so it
+   * should not be stored.
+   *
+   * \param uuid ID of the peripheral to be found
+   * \return A pointer to the entry, or a nullptr if it does not exist
+   */
+  const PeripheralEntry* findPeripheral(const utils::UUID& uuid) const;
+
  private:
   /**
    * Create a new peripheral according to the JSON doc
@@ -49,6 +99,16 @@ class PeripheralController {
    */
   ErrorResult add(const JsonObjectConst& doc);
 
+  /**
+   * Change the configuration of a peripheral without recreating it
+   *
+   * \see Peripheral::update()
+   *
+   * \param doc The JSON doc with the UUID and the parameters to change
+   * \return Contains the source and cause of the error, if one occured
+   */
+  ErrorResult update(const JsonObjectConst& doc);
+
   /**
    * Remove a peripheral by its UUID
    *
@@ -57,14 +117,47 @@ class PeripheralController {
    */
   ErrorResult remove(const JsonObjectConst& doc);
 
-  static void addResultEntry(const JsonVariantConst& uuid,
-                             const ErrorResult& error,
-                             const JsonArray& results);
+  /**
+   * Set the value of a SetValue peripheral directly in the command handler
+   *
+   * Avoids creating, scheduling and deleting a SetValue task for one-shot
+   * actuation. With a ramp duration, peripherals with the RampValue
+   * capability ramp to the value on their own.
+   *
+   * \param doc The JSON doc with the UUID, value and data point type
+   * \return Contains the source and cause of the error, if one occured
+   */
+  ErrorResult write(const JsonObjectConst& doc);
+
+  /**
+   * Read the values of a GetValues peripheral directly in the command handler
+   *
+   * Peripherals requiring a StartMeasurement cycle cannot be read directly
+   * and still have to use a ReadSensor task.
+   *
+   * \param doc The JSON doc containing the UUID of the peripheral to read
+   * \return The read values or the source and cause of the error
+   */
+  capabilities::GetValues::Result read(const JsonObjectConst& doc);
+
+  /**
+   * Finds the position of a peripheral in the sorted registry
+   *
+   * \param uuid ID of the peripheral
+   * \return The entry with the UUID or the position where it would be inserted
+   */
+  std::vector<PeripheralEntry>::iterator lowerBound(const utils::UUID& uuid);
+  std::vector<PeripheralEntry>::const_iterator lowerBound(
+      const utils::UUID& uuid) const;
+
+  static JsonObject addResultEntry(const JsonVariantConst& uuid,
+                                   const ErrorResult& error,
+                                   const JsonArray& results);
 
   /// The server to which to reply to
   ServiceGetters services_;
-  /// Map of UUIDs to their respective peripherals
-  std::map<utils::UUID, std::shared_ptr<Peripheral>> peripherals_;
+  /// Peripherals and their capabilities, sorted by their UUIDs
+  std::vector<PeripheralEntry> peripherals_;
   /// Factory to construct peripherals according to the JSON parameters
   PeripheralFactory& peripheral_factory_;
 
@@ -74,6 +167,10 @@ class PeripheralController {
   static const __FlashStringHelper* add_command_key_;
   static const __FlashStringHelper* update_command_key_;
   static const __FlashStringHelper* remove_command_key_;
+  static const __FlashStringHelper* write_command_key_;
+  static const __FlashStringHelper* read_command_key_;
+  static const __FlashStringHelper* peripheral_not_found_error_;
+  static const __FlashStringHelper* requires_task_error_;
 };
 
 }  // namespace peripheral
@@ -1,17 +1,110 @@
 #include "peripheral_factory.h"
 
 #include "peripheral/invalid_peripheral.h"
+#include "peripheral/peripherals/analog_in/analog_in.h"
+#include "peripheral/peripherals/cse6677/cse6677.h"
+#include "peripheral/peripherals/cse7766/cse7766.h"
+#include "peripheral/peripherals/digital_in/digital_in.h"
+#include "peripheral/peripherals/digital_out/digital_out.h"
+#include "peripheral/peripherals/uart/uart_adapter.h"
+#include "utils/sorted_table.h"
+#ifndef ARDUINO_ESP32S3_DEV
+#include "peripheral/peripherals/analog_out/analog_out.h"
+#endif
+#ifndef MINIMAL_BUILD
+#include "peripheral/peripherals/as_ec_meter/as_ec_meter.h"
+#include "peripheral/peripherals/as_ph_meter/as_ph_meter.h"
+#include "peripheral/peripherals/as_rtd_meter/as_rtd_meter.h"
+#include "peripheral/peripherals/bme280/bme280.h"
+#include "peripheral/peripherals/dallas_temperature/dallas_temperature.h"
+#include "peripheral/peripherals/ezo_group/ezo_group.h"
+#include "peripheral/peripherals/modbus/modbus_device.h"
+#include "peripheral/peripherals/modbus/modbus_master.h"
+#include "peripheral/peripherals/neo_pixel/neo_pixel.h"
+#endif
+#ifdef ESP32
+#include "peripheral/peripherals/bh1750/bh1750_sensor.h"
+#include "peripheral/peripherals/capacitive_sensor/capacitive_sensor.h"
+#include "peripheral/peripherals/i2c/i2c_adapter.h"
+#include "peripheral/peripherals/i2c/i2c_mux.h"
+#include "peripheral/peripherals/max44009/max44009_sensor.h"
+#include "peripheral/peripherals/pulse_counter/pulse_counter.h"
+#include "peripheral/peripherals/pwm/pwm.h"
+#include "peripheral/peripherals/spi/spi_adapter.h"
+#include "peripheral/peripherals/spectral_analyzer/spectral_analyzer.h"
+#endif
 
 namespace inamata {
 namespace peripheral {
 
-bool PeripheralFactory::registerFactory(const String& name, Callback factory) {
-  if (getFactories().count(name) == 0) {
-    getFactories().emplace(name, factory);
-    return true;
-  }
-  return false;
-}
+namespace {
+
+using namespace peripherals;
+
+/**
+ * All peripheral factories, sorted by their type name
+ *
+ * Kept in a constant table instead of being registered by static
+ * initializers, so that no heap allocations are made on boot and lookups
+ * don't construct Strings. New peripherals have to be added here, in the
+ * guards of the builds they are compiled in. The order is checked at compile
+ * time.
+ */
+constexpr PeripheralFactory::Entry factories[] = {
+    {"AnalogIn", analog_in::AnalogIn::factory},
+#ifndef ARDUINO_ESP32S3_DEV
+    {"AnalogOut", analog_out::AnalogOut::factory},
+#endif
+#ifndef MINIMAL_BUILD
+    {"AsEcMeterI2C", as_ec_meter::AsEcMeterI2C::factory},
+    {"AsPhMeterI2C", as_ph_meter::AsPhMeterI2C::factory},
+    {"AsRtdMeterI2C", as_rtd_meter::AsRtdMeterI2C::factory},
+#endif
+#ifdef ESP32
+    {"BH1750", bh1750::Bh1750Sensor::factory},
+#endif
+#ifndef MINIMAL_BUILD
+    {"BME280", bme280::BME280::factory},
+#endif
+    {"CSE6677", cse6677::CSE6677::factory},
+    {"CSE7766", cse7766::CSE7766::factory},
+#ifdef ESP32
+    {"CapacitiveSensor", capacative_sensor::CapacitiveSensor::factory},
+#endif
+#ifndef MINIMAL_BUILD
+    {"DallasTemperature", dallas_temperature::DallasTemperature::factory},
+#endif
+    {"DigitalIn", digital_in::DigitalIn::factory},
+    {"DigitalOut", digital_out::DigitalOut::factory},
+#ifndef MINIMAL_BUILD
+    {"EzoGroup", ezo_group::EzoGroup::factory},
+#endif
+#ifdef ESP32
+    {"I2CAdapter", util::I2CAdapter::factory},
+    {"I2CMux", i2c::I2CMux::factory},
+#endif
+    {"InvalidPeripheral", InvalidPeripheral::factory},
+#ifdef ESP32
+    {"MAX44009", max44009::Max44009Sensor::factory},
+#endif
+#ifndef MINIMAL_BUILD
+    {"ModbusDevice", modbus::ModbusDevice::factory},
+    {"ModbusMaster", modbus::ModbusMaster::factory},
+    {"NeoPixel", neo_pixel::NeoPixel::factory},
+#endif
+#ifdef ESP32
+    {"PWM", pwm::Pwm::factory},
+    {"PulseCounter", pulse_counter::PulseCounter::factory},
+    {"SPIAdapter", spi::SPIAdapter::factory},
+    {"SpectralAnalyzer", spectral_analyzer::SpectralAnalyzer::factory},
+#endif
+    {"UARTAdapter", uart::UARTAdapter::factory},
+};
+
+static_assert(utils::isSortedByName(factories),
+              "Peripheral factories have to be sorted by name");
+
+}  // namespace
 
 std::shared_ptr<Peripheral> PeripheralFactory::createPeripheral(
     const ServiceGetters& services, const JsonObjectConst& parameter) {
@@ -20,9 +113,9 @@ std::shared_ptr<Peripheral> PeripheralFactory::createPeripheral(
     return std::make_shared<InvalidPeripheral>(type_key_error_);
   }
 
-  auto factory = getFactories().find(type);
-  if (factory != getFactories().end()) {
-    return factory->second(services, parameter);
+  const Entry* entry = utils::findByName(factories, type.as<const char*>());
+  if (entry) {
+    return entry->factory(services, parameter);
   } else {
     return std::make_shared<InvalidPeripheral>(
         unknownTypeError(type.as<const char*>()));
@@ -31,18 +124,13 @@ std::shared_ptr<Peripheral> PeripheralFactory::createPeripheral(
 
 std::vector<String> PeripheralFactory::getFactoryNames() {
   std::vector<String> names;
-  for (const auto& factory : getFactories()) {
-    names.push_back(factory.first);
+  names.reserve(sizeof(factories) / sizeof(factories[0]));
+  for (const Entry& entry : factories) {
+    names.push_back(entry.name);
   }
   return names;
 }
 
-std::map<const String, PeripheralFactory::Callback>&
-PeripheralFactory::getFactories() {
-  static std::map<const String, Callback> factories;
-  return factories;
-}
-
 String PeripheralFactory::unknownTypeError(const String& type) {
   String error(F("Unknown peripheral type: "));
   error += type;
@@ -3,7 +3,6 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
-#include <map>
 #include <memory>
 #include <vector>
 
@@ -18,18 +17,21 @@ class PeripheralFactory {
   using Callback = std::shared_ptr<Peripheral> (*)(
       const ServiceGetters& services, const JsonObjectConst& parameter);
 
+  /// Entry in the constant table of peripheral factories
+  struct Entry {
+    const char* name;
+    Callback factory;
+  };
+
   PeripheralFactory() = default;
   virtual ~PeripheralFactory() = default;
 
-  static bool registerFactory(const String& name, Callback factory);
-
   std::shared_ptr<Peripheral> createPeripheral(
       const ServiceGetters& services, const JsonObjectConst& parameter);
 
   std::vector<String> getFactoryNames();
 
  private:
-  static std::map<const String, Callback>& getFactories();
 
   static String unknownTypeError(const String& type);
 
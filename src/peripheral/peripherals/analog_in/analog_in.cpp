@@ -1,5 +1,12 @@
 #include "analog_in.h"
 
+#ifdef ESP32
+#include <esp_adc_cal.h>
+#endif
+
+#include <algorithm>
+#include <array>
+
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -31,6 +38,22 @@ AnalogIn::AnalogIn(const JsonObjectConst& parameters) {
     return;
   }
 
+  // Average several readings, each the median of an odd number of samples
+  const int oversampling = parameters[oversampling_key_] | 1;
+  const int median_of = parameters[median_of_key_] | 1;
+  if (oversampling < 1 || oversampling > max_oversampling_ || median_of < 1 ||
+      median_of > max_median_of_ || median_of % 2 == 0) {
+    setInvalid(sampling_error_);
+    return;
+  }
+  oversampling_ = oversampling;
+  median_of_ = median_of;
+#ifdef ESP32
+  if (calibration_mv_.empty()) {
+    buildCalibration();
+  }
+#endif
+
   // Use both or either voltage and unit as analog readings
   voltage_data_point_type_ =
       utils::UUID(parameters[voltage_data_point_type_key_]);
@@ -51,6 +74,8 @@ const String& AnalogIn::type() {
   return name;
 }
 
+capabilities::GetValues* AnalogIn::asGetValues() { return this; }
+
 void AnalogIn::parseConvertToUnit(const JsonObjectConst& parameters) {
   // Do a linear conversion from the voltage to a different unit
   JsonVariantConst min_v = parameters[min_v_key_];
@@ -95,8 +120,8 @@ void AnalogIn::parseConvertToUnit(const JsonObjectConst& parameters) {
 
 capabilities::GetValues::Result AnalogIn::getValues() {
   std::vector<utils::ValueUnit> values;
-  const uint16_t value = analogRead(pin_);
-  const float voltage = value * 3.3 / 4096.0;
+  const float value = readOversampled();
+  const float voltage = toVoltage(value);
 
   if (voltage_data_point_type_.isValid()) {
     values.push_back({utils::ValueUnit{
@@ -124,17 +149,63 @@ capabilities::GetValues::Result AnalogIn::getValues() {
   return {.values = values, .error = ErrorResult()};
 }
 
+uint16_t AnalogIn::readRaw() const { return analogRead(pin_); }
+
+float AnalogIn::toVoltage(float raw) const {
+#ifdef ESP32
+  // Linearly interpolate between the calibration points
+  const float position =
+      std::max(0.0f, std::min(raw, 4095.0f)) / calibration_step_;
+  const size_t index = position;
+  const float lower = calibration_mv_[index];
+  const float upper = calibration_mv_[index + 1];
+  return (lower + (position - index) * (upper - lower)) / 1000.0f;
+#else
+  return raw * 3.3 / 4096.0;
+#endif
+}
+
+float AnalogIn::readOversampled() const {
+  std::array<uint16_t, max_median_of_> window;
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < oversampling_; i++) {
+    for (uint8_t j = 0; j < median_of_; j++) {
+      window[j] = readRaw();
+    }
+    auto median = window.begin() + median_of_ / 2;
+    std::nth_element(window.begin(), median, window.begin() + median_of_);
+    sum += *median;
+  }
+  return static_cast<float>(sum) / oversampling_;
+}
+
+#ifdef ESP32
+void AnalogIn::buildCalibration() {
+  // The Arduino core reads with 12 bits and 11 dB attenuation by default.
+  // Uses the two point values or the reference voltage from the eFuses
+  esp_adc_cal_characteristics_t characteristics;
+  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                           default_vref_mv_, &characteristics);
+
+  // One point past the last raw value for the interpolation
+  const size_t points = 4096 / calibration_step_ + 1;
+  calibration_mv_.resize(points);
+  for (size_t i = 0; i < points; i++) {
+    const uint32_t raw = std::min<uint32_t>(i * calibration_step_, 4095);
+    calibration_mv_[i] = esp_adc_cal_raw_to_voltage(raw, &characteristics);
+  }
+}
+
+std::vector<uint16_t> AnalogIn::calibration_mv_;
+constexpr uint16_t AnalogIn::calibration_step_;
+#endif
+
+
 std::shared_ptr<Peripheral> AnalogIn::factory(
     const ServiceGetters& services, const JsonObjectConst& parameters) {
   return std::make_shared<AnalogIn>(parameters);
 }
 
-bool AnalogIn::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool AnalogIn::capability_get_values_ =
-    capabilities::GetValues::registerType(type());
-
 #ifdef ESP32
 const std::array<uint8_t, 8> AnalogIn::valid_pins_ = {
     32, 33, 34, 35, 36, 37, 38, 39,
@@ -166,6 +237,11 @@ const __FlashStringHelper* AnalogIn::max_v_key_ = FPSTR("max_v");
 const __FlashStringHelper* AnalogIn::min_unit_key_ = FPSTR("min_unit");
 const __FlashStringHelper* AnalogIn::max_unit_key_ = FPSTR("max_unit");
 const __FlashStringHelper* AnalogIn::limit_unit_key_ = FPSTR("limit_unit");
+const __FlashStringHelper* AnalogIn::oversampling_key_ =
+    FPSTR("oversampling");
+const __FlashStringHelper* AnalogIn::median_of_key_ = FPSTR("median_of");
+const __FlashStringHelper* AnalogIn::sampling_error_ =
+    FPSTR("Invalid oversampling (1 - 64) or median_of (odd, 1 - 9)");
 
 }  // namespace analog_in
 }  // namespace peripherals
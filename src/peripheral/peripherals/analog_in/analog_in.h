@@ -3,6 +3,7 @@
 #include <ArduinoJson.h>
 
 #include <memory>
+#include <vector>
 
 #include "managers/service_getters.h"
 #include "peripheral/capabilities/get_values.h"
@@ -24,22 +25,68 @@ class AnalogIn : public Peripheral, public capabilities::GetValues {
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameter);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
 
   /**
    * Get the GPIO state
    *
+   * Averages the configured number of readings, each being the median of a
+   * few raw samples to reject outliers.
+   *
    * \return The value 1 represents the high state, 0 its low state
    */
   capabilities::GetValues::Result getValues() final;
 
- private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameter);
-  static bool registered_;
-  static bool capability_get_values_;
+  /**
+   * Reads the raw ADC value without any conversion
+   *
+   * Lightweight enough to be called from a timer callback to capture sample
+   * blocks at a fixed rate.
+   *
+   * \return The raw ADC reading
+   */
+  uint16_t readRaw() const;
 
+  /**
+   * Converts a raw ADC reading to a voltage
+   *
+   * On the ESP32 the chip's calibration lookup table is used to correct for
+   * the nonlinear ADC and the per-chip reference voltage.
+   *
+   * \param raw The value returned by readRaw() or an average of it
+   * \return The voltage in volts
+   */
+  float toVoltage(float raw) const;
+
+ private:
   void parseConvertToUnit(const JsonObjectConst& parameters);
 
+  /**
+   * Reads the oversampled raw ADC value with outliers removed
+   *
+   * \return The mean of the median filtered readings
+   */
+  float readOversampled() const;
+
+#ifdef ESP32
+  /**
+   * Builds the lookup table from the eFuse ADC characterization
+   *
+   * Only done once for all instances, as all pins use the same attenuation.
+   */
+  static void buildCalibration();
+
+  /// Voltage in mV at every calibration_step_ raw value
+  static std::vector<uint16_t> calibration_mv_;
+  static constexpr uint16_t calibration_step_ = 16;
+  /// Reference voltage used if none was burned into the eFuses
+  static constexpr uint32_t default_vref_mv_ = 1100;
+#endif
+
   /// The pin to be used as a GPIO output
   unsigned int pin_;
 #ifdef ESP32
@@ -73,6 +120,16 @@ class AnalogIn : public Peripheral, public capabilities::GetValues {
   static const __FlashStringHelper* min_unit_key_;
   static const __FlashStringHelper* max_unit_key_;
   static const __FlashStringHelper* limit_unit_key_;
+
+  /// Number of median filtered readings to average
+  uint8_t oversampling_ = 1;
+  /// Number of raw samples to take the median of per reading
+  uint8_t median_of_ = 1;
+  static constexpr uint8_t max_oversampling_ = 64;
+  static constexpr uint8_t max_median_of_ = 9;
+  static const __FlashStringHelper* oversampling_key_;
+  static const __FlashStringHelper* median_of_key_;
+  static const __FlashStringHelper* sampling_error_;
 };
 
 }  // namespace analog_in
@@ -41,6 +41,16 @@ AnalogOut::AnalogOut(const ServiceGetters& services,
     setInvalid(data_point_type_key_error_);
     return;
   }
+
+  // Optionally start with a waveform instead of a static level
+  JsonVariantConst waveform = parameters[waveform_key_];
+  if (!waveform.isNull()) {
+    ErrorResult error = startWaveform(waveform);
+    if (error.isError()) {
+      setInvalid(error.detail_);
+      return;
+    }
+  }
 }
 
 const String& AnalogOut::getType() const { return type(); }
@@ -50,6 +60,8 @@ const String& AnalogOut::type() {
   return name;
 }
 
+capabilities::SetValue* AnalogOut::asSetValue() { return this; }
+
 void AnalogOut::setValue(utils::ValueUnit value_unit) {
   float max_value;
   if (voltage_data_point_type_.isValid()) {
@@ -74,23 +86,94 @@ void AnalogOut::setValue(utils::ValueUnit value_unit) {
       std::fmax(0, std::fmin(value_unit.value, max_value));
   const float dac_value = clamped_value * 255.0 / max_value;
 #ifdef ESP32
-  dacWrite(pin_, dac_value);
+  // A static level ends the waveform
+  if (waveform_) {
+    waveform_->stop();
+  }
+  DacWaveform::writeLevel(pin_, dac_value);
 #else
   analogWrite(pin_, dac_value);
 #endif
 }
 
+ErrorResult AnalogOut::update(const JsonObjectConst& parameters) {
+  JsonVariantConst waveform = parameters[waveform_key_];
+  if (waveform.isNull()) {
+    return ErrorResult(type(), waveform_error_);
+  }
+  return startWaveform(waveform);
+}
+
+ErrorResult AnalogOut::startWaveform(JsonVariantConst waveform) {
+#ifdef ESP32
+  const float frequency = waveform[frequency_key_] | 0.0f;
+  const float amplitude = waveform[amplitude_key_] | 1.0f;
+  const float offset = waveform[offset_key_] | 0.5f;
+  if (!(frequency > 0) || amplitude < 0 || amplitude > 1 || offset < 0 ||
+      offset > 1) {
+    return ErrorResult(type(), waveform_error_);
+  }
+
+  if (!waveform_) {
+    waveform_.reset(new DacWaveform(pin_));
+  }
+
+  using namespace utils::waveform;
+  std::vector<uint8_t> table;
+  JsonVariantConst shape_name = waveform[shape_key_];
+  if (shape_name == table_key_) {
+    JsonArrayConst values = waveform[table_key_].as<JsonArrayConst>();
+    if (values.size() < 2 || values.size() > max_table_size_) {
+      return ErrorResult(type(), waveform_error_);
+    }
+    std::vector<float> samples;
+    samples.reserve(values.size());
+    for (JsonVariantConst value : values) {
+      if (!value.is<float>()) {
+        return ErrorResult(type(), waveform_error_);
+      }
+      samples.push_back(value);
+    }
+    table = scale(samples, amplitude, offset);
+  } else {
+    Shape shape;
+    if (shape_name == F("sine")) {
+      shape = Shape::kSine;
+    } else if (shape_name == F("triangle")) {
+      shape = Shape::kTriangle;
+    } else if (shape_name == F("square")) {
+      shape = Shape::kSquare;
+    } else if (shape_name == F("sawtooth")) {
+      shape = Shape::kSawtooth;
+    } else {
+      return ErrorResult(type(), waveform_error_);
+    }
+
+    // The cosine generator needs no DMA buffers. Fall back to a table if it
+    // is used by the other DAC pin
+    if (shape == Shape::kSine &&
+        DacWaveform::fitsCosineGenerator(frequency, amplitude) &&
+        waveform_->startCosine(frequency, amplitude, offset)) {
+      return ErrorResult();
+    }
+    table = generate(shape, tableLength(frequency, DacWaveform::i2s_limits),
+                     amplitude, offset);
+  }
+
+  if (!waveform_->startTable(std::move(table), frequency)) {
+    return ErrorResult(type(), waveform_start_error_);
+  }
+  return ErrorResult();
+#else
+  return ErrorResult(type(), waveform_unsupported_error_);
+#endif
+}
+
 std::shared_ptr<Peripheral> AnalogOut::factory(
     const ServiceGetters& services, const JsonObjectConst& parameters) {
   return std::make_shared<AnalogOut>(services, parameters);
 }
 
-bool AnalogOut::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool AnalogOut::capability_set_value_ =
-    capabilities::SetValue::registerType(type());
-
 const __FlashStringHelper* AnalogOut::pin_key_ = FPSTR("pin");
 const __FlashStringHelper* AnalogOut::pin_key_error_ =
     FPSTR("Missing property: pin (unsigned int)");
@@ -104,6 +187,21 @@ const __FlashStringHelper* AnalogOut::percent_data_point_type_key_ =
 const __FlashStringHelper* AnalogOut::data_point_type_key_error_ =
     FPSTR("Missing property: data_point_type (UUID)");
 
+constexpr size_t AnalogOut::max_table_size_;
+const __FlashStringHelper* AnalogOut::waveform_key_ = FPSTR("waveform");
+const __FlashStringHelper* AnalogOut::shape_key_ = FPSTR("shape");
+const __FlashStringHelper* AnalogOut::frequency_key_ = FPSTR("frequency");
+const __FlashStringHelper* AnalogOut::amplitude_key_ = FPSTR("amplitude");
+const __FlashStringHelper* AnalogOut::offset_key_ = FPSTR("offset");
+const __FlashStringHelper* AnalogOut::table_key_ = FPSTR("table");
+const __FlashStringHelper* AnalogOut::waveform_error_ = FPSTR(
+    "Invalid waveform: shape (sine, triangle, square, sawtooth, table), "
+    "frequency (Hz), amplitude and offset (0-1), table (2-1024 of -1 to 1)");
+const __FlashStringHelper* AnalogOut::waveform_start_error_ =
+    FPSTR("Waveform frequency out of range or I2S0 in use");
+const __FlashStringHelper* AnalogOut::waveform_unsupported_error_ =
+    FPSTR("Waveforms are only supported on the ESP32");
+
 }  // namespace analog_out
 }  // namespace peripherals
 }  // namespace peripheral
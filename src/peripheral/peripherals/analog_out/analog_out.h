@@ -2,9 +2,14 @@
 
 #include <ArduinoJson.h>
 
+#include <memory>
+
 #include "managers/service_getters.h"
 #include "peripheral/capabilities/set_value.h"
 #include "peripheral/peripheral.h"
+#ifdef ESP32
+#include "peripheral/peripherals/analog_out/dac_waveform.h"
+#endif
 
 namespace inamata {
 namespace peripheral {
@@ -12,7 +17,10 @@ namespace peripherals {
 namespace analog_out {
 
 /**
- * Peripheral to control a GPIO output
+ * Peripheral to control a DAC output
+ *
+ * Outputs either a static level or, on the ESP32, a periodic waveform that is
+ * generated without CPU load per sample.
  */
 class AnalogOut : public Peripheral, public capabilities::SetValue {
  public:
@@ -22,6 +30,11 @@ class AnalogOut : public Peripheral, public capabilities::SetValue {
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameter);
+
+  // Capabilities supported by the peripheral
+  capabilities::SetValue* asSetValue() final;
 
   /**
    * Turns the GPIO on or off
@@ -30,11 +43,22 @@ class AnalogOut : public Peripheral, public capabilities::SetValue {
    */
   void setValue(utils::ValueUnit value_unit) final;
 
+  /**
+   * Starts or replaces the waveform
+   *
+   * \param parameters Contains the waveform object
+   * \return Contains the cause of the error, if the waveform failed
+   */
+  ErrorResult update(const JsonObjectConst& parameters) final;
+
  private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameter);
-  static bool registered_;
-  static bool capability_set_value_;
+  /**
+   * Starts a waveform according to its parameters
+   *
+   * \param waveform The shape, frequency, amplitude, offset and table
+   * \return Contains the cause of the error, if the waveform failed
+   */
+  ErrorResult startWaveform(JsonVariantConst waveform);
 
   /// Interface to send data to the server
   std::shared_ptr<WebSocket> web_socket_;
@@ -53,6 +77,21 @@ class AnalogOut : public Peripheral, public capabilities::SetValue {
   static const __FlashStringHelper* percent_data_point_type_key_;
   /// Error if neither percent nor voltage data point types are set
   static const __FlashStringHelper* data_point_type_key_error_;
+
+#ifdef ESP32
+  std::unique_ptr<DacWaveform> waveform_;
+#endif
+  /// Largest arbitrary table of a waveform
+  static constexpr size_t max_table_size_ = 1024;
+  static const __FlashStringHelper* waveform_key_;
+  static const __FlashStringHelper* shape_key_;
+  static const __FlashStringHelper* frequency_key_;
+  static const __FlashStringHelper* amplitude_key_;
+  static const __FlashStringHelper* offset_key_;
+  static const __FlashStringHelper* table_key_;
+  static const __FlashStringHelper* waveform_error_;
+  static const __FlashStringHelper* waveform_start_error_;
+  static const __FlashStringHelper* waveform_unsupported_error_;
 };
 
 }  // namespace analog_out
@@ -0,0 +1,206 @@
+#if defined(ESP32) && !defined(ARDUINO_ESP32S3_DEV)
+#include "dac_waveform.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace analog_out {
+
+bool DacWaveform::cosine_taken_ = false;
+dac_channel_t DacWaveform::cosine_channel_ = DAC_CHANNEL_1;
+bool DacWaveform::i2s_taken_ = false;
+int16_t DacWaveform::static_levels_[2] = {-1, -1};
+
+constexpr uint32_t DacWaveform::min_cosine_frequency_;
+constexpr uint32_t DacWaveform::max_cosine_frequency_;
+
+const utils::waveform::Limits DacWaveform::i2s_limits = {
+    .min_sample_rate = 5000,
+    .max_sample_rate = 1000000,
+    .max_buffer_frames = 1024,
+    .min_buffer_frames = 64,
+    .max_ring_frames = 8192,
+};
+
+DacWaveform::DacWaveform(int pin)
+    : channel_(pin == 25 ? DAC_CHANNEL_1 : DAC_CHANNEL_2) {
+  loader_stopped_ = xSemaphoreCreateBinary();
+}
+
+DacWaveform::~DacWaveform() {
+  stop();
+  if (loader_stopped_) {
+    vSemaphoreDelete(loader_stopped_);
+  }
+}
+
+bool DacWaveform::fitsCosineGenerator(float frequency, float amplitude) {
+  // The generator attenuates the full range by 1, 2, 4 or 8
+  bool fits_scale = false;
+  for (float scale = 1; scale >= 0.125f; scale /= 2) {
+    fits_scale |= fabsf(amplitude - scale) < 0.001f;
+  }
+  return fits_scale && frequency >= min_cosine_frequency_ &&
+         frequency <= max_cosine_frequency_;
+}
+
+bool DacWaveform::startCosine(float frequency, float amplitude,
+                              float offset) {
+  stop();
+  if (cosine_taken_ || !fitsCosineGenerator(frequency, amplitude)) {
+    return false;
+  }
+
+  dac_cw_config_t config = {};
+  config.en_ch = channel_;
+  config.scale = amplitude > 0.75f   ? DAC_CW_SCALE_1
+                 : amplitude > 0.35f ? DAC_CW_SCALE_2
+                 : amplitude > 0.18f ? DAC_CW_SCALE_4
+                                     : DAC_CW_SCALE_8;
+  config.phase = DAC_CW_PHASE_0;
+  config.freq = lroundf(frequency);
+  // The offset shifts the center of the wave from mid range
+  const long center_shift = lroundf((offset - 0.5f) * 255);
+  config.offset = std::max(-128L, std::min(127L, center_shift));
+  if (dac_cw_generator_config(&config) != ESP_OK ||
+      dac_cw_generator_enable() != ESP_OK) {
+    return false;
+  }
+  dac_output_enable(channel_);
+
+  cosine_taken_ = true;
+  cosine_channel_ = channel_;
+  static_levels_[channel_] = -1;
+  source_ = Source::kCosine;
+  return true;
+}
+
+bool DacWaveform::startTable(std::vector<uint8_t> table, float frequency) {
+  stop();
+  if (i2s_taken_ || !loader_stopped_ ||
+      !utils::waveform::layout(frequency, table.size(), i2s_limits,
+                               layout_)) {
+    return false;
+  }
+
+  i2s_config_t config = {};
+  config.mode = static_cast<i2s_mode_t>(I2S_MODE_MASTER | I2S_MODE_TX |
+                                        I2S_MODE_DAC_BUILT_IN);
+  config.sample_rate = layout_.sample_rate;
+  config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+  config.communication_format = I2S_COMM_FORMAT_STAND_MSB;
+  config.dma_buf_count = layout_.buffer_count;
+  config.dma_buf_len = layout_.buffer_frames;
+  config.use_apll = false;
+  // Without clearing, the DMA keeps repeating the buffers once nothing new
+  // is written
+  config.tx_desc_auto_clear = false;
+  if (i2s_driver_install(I2S_NUM_0, &config, 0, nullptr) != ESP_OK) {
+    return false;
+  }
+  i2s_taken_ = true;
+  source_ = Source::kI2S;
+  static_levels_[channel_] = -1;
+  // GPIO 25 is driven by the right and GPIO 26 by the left channel
+  i2s_set_pin(I2S_NUM_0, nullptr);
+  i2s_set_dac_mode(channel_ == DAC_CHANNEL_1 ? I2S_DAC_CHANNEL_RIGHT_EN
+                                             : I2S_DAC_CHANNEL_LEFT_EN);
+
+  table_ = std::move(table);
+  stop_loader_ = false;
+  if (xTaskCreate(runLoader, "dac_waveform", 2048, this, 1, &loader_) !=
+      pdPASS) {
+    loader_ = nullptr;
+    stop();
+    return false;
+  }
+  return true;
+}
+
+void DacWaveform::stop() {
+  if (source_ == Source::kCosine) {
+    dac_cw_generator_disable();
+    dac_output_disable(channel_);
+    cosine_taken_ = false;
+  } else if (source_ == Source::kI2S) {
+    if (loader_) {
+      stop_loader_ = true;
+      xSemaphoreTake(loader_stopped_, portMAX_DELAY);
+      loader_ = nullptr;
+    }
+    // Only disable this pin. The other one may drive a static level
+    dac_output_disable(channel_);
+    i2s_driver_uninstall(I2S_NUM_0);
+    i2s_taken_ = false;
+    restoreOtherChannel();
+  }
+  source_ = Source::kNone;
+}
+
+bool DacWaveform::isRunning() const { return source_ != Source::kNone; }
+
+void DacWaveform::writeLevel(int pin, uint8_t value) {
+  // Enables the pad again, if it was disabled by a waveform
+  dacWrite(pin, value);
+  static_levels_[pin == 25 ? DAC_CHANNEL_1 : DAC_CHANNEL_2] = value;
+}
+
+void DacWaveform::restoreOtherChannel() {
+  // Uninstalling the I2S driver disables both DAC pads
+  const dac_channel_t other =
+      channel_ == DAC_CHANNEL_1 ? DAC_CHANNEL_2 : DAC_CHANNEL_1;
+  if (static_levels_[other] >= 0) {
+    dacWrite(toPin(other), static_levels_[other]);
+  } else if (cosine_taken_ && cosine_channel_ == other) {
+    dac_output_enable(other);
+  }
+}
+
+int DacWaveform::toPin(dac_channel_t channel) {
+  return channel == DAC_CHANNEL_1 ? 25 : 26;
+}
+
+void DacWaveform::runLoader(void* arg) {
+  DacWaveform* output = static_cast<DacWaveform*>(arg);
+  const utils::waveform::Layout& layout = output->layout_;
+  const std::vector<uint8_t>& table = output->table_;
+
+  // The write blocks until the DMA finished the next buffer, so the buffers
+  // are written in the order they are played. Each one is written once
+  std::vector<uint16_t> frames(layout.buffer_frames * 2);
+  size_t frame = 0;
+  for (size_t buffer = 0;
+       buffer < layout.buffer_count && !output->stop_loader_; buffer++) {
+    for (size_t i = 0; i < layout.buffer_frames; i++, frame++) {
+      // The DAC converts the upper byte of the 16-bit samples
+      const uint16_t sample = table[frame / layout.repeat % table.size()] << 8;
+      frames[2 * i] = sample;
+      frames[2 * i + 1] = sample;
+    }
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(frames.data());
+    const size_t size = frames.size() * sizeof(uint16_t);
+    size_t offset = 0;
+    while (offset < size && !output->stop_loader_) {
+      size_t written = 0;
+      i2s_write(I2S_NUM_0, data + offset, size - offset, &written,
+                pdMS_TO_TICKS(100));
+      offset += written;
+    }
+  }
+
+  xSemaphoreGive(output->loader_stopped_);
+  vTaskDelete(nullptr);
+}
+
+}  // namespace analog_out
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+#if defined(ESP32) && !defined(ARDUINO_ESP32S3_DEV)
+
+#include <Arduino.h>
+#include <driver/dac.h>
+#include <driver/i2s.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <vector>
+
+#include "utils/waveform.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace analog_out {
+
+/**
+ * Outputs a periodic waveform on a DAC pin without CPU load per sample
+ *
+ * Sine waves use the DAC's cosine generator when its frequency range and
+ * amplitude steps allow it. All other waveforms are played by the I2S0 DMA
+ * in built-in DAC mode. The DMA buffers are filled once with whole periods
+ * and then repeated by the DMA on its own.
+ *
+ * Only one waveform per source can run at a time, as both DAC pins share the
+ * cosine generator and I2S0.
+ */
+class DacWaveform {
+ public:
+  /**
+   * Prepares a waveform output on a DAC pin
+   *
+   * \param pin GPIO 25 or 26
+   */
+  explicit DacWaveform(int pin);
+  virtual ~DacWaveform();
+
+  /**
+   * Checks if a sine wave can be produced by the cosine generator
+   *
+   * \param frequency The frequency in Hz
+   * \param amplitude The peak to peak amplitude as a fraction of the range
+   * \return True if supported, otherwise the table has to be played
+   */
+  static bool fitsCosineGenerator(float frequency, float amplitude);
+
+  /**
+   * Starts a sine wave with the cosine generator
+   *
+   * \param frequency The frequency in Hz
+   * \param amplitude The peak to peak amplitude as a fraction of the range
+   * \param offset The center as a fraction of the range
+   * \return False if the generator is in use or failed
+   */
+  bool startCosine(float frequency, float amplitude, float offset);
+
+  /**
+   * Starts playing one period of DAC codes in a loop with the I2S DMA
+   *
+   * Loading the DMA buffers takes one repetition of the buffers. The pin
+   * outputs the center level until then.
+   *
+   * \param table The DAC codes of one period
+   * \param frequency The frequency in Hz
+   * \return False if I2S0 is in use, the frequency can't be played or the
+   *         driver failed
+   */
+  bool startTable(std::vector<uint8_t> table, float frequency);
+
+  /**
+   * Stops the waveform, leaving the pin free for static levels
+   *
+   * Waits for the DMA buffers to be loaded, if still in progress.
+   */
+  void stop();
+
+  /**
+   * Checks if a waveform is being output
+   *
+   * \return True while running
+   */
+  bool isRunning() const;
+
+  /**
+   * Outputs a static level on a DAC pin
+   *
+   * The level is remembered, so that it can be restored when a waveform on
+   * the other pin releases I2S0, which disables both DAC pads.
+   *
+   * \param pin GPIO 25 or 26
+   * \param value The DAC code
+   */
+  static void writeLevel(int pin, uint8_t value);
+
+  /// Limits of the I2S DMA in built-in DAC mode
+  static const utils::waveform::Limits i2s_limits;
+
+ private:
+  enum class Source { kNone, kCosine, kI2S };
+
+  /**
+   * Writes the table to each DMA buffer once and then ends
+   *
+   * \param arg The waveform output
+   */
+  static void runLoader(void* arg);
+
+  /**
+   * Restores the output of the other DAC pin after I2S0 was released
+   */
+  void restoreOtherChannel();
+
+  /**
+   * Gets the pin of a DAC channel
+   *
+   * \param channel The DAC channel
+   * \return GPIO 25 or 26
+   */
+  static int toPin(dac_channel_t channel);
+
+  static bool cosine_taken_;
+  static dac_channel_t cosine_channel_;
+  static bool i2s_taken_;
+  /// Static level of each DAC channel, or -1 while it outputs a waveform or
+  /// was never set
+  static int16_t static_levels_[2];
+
+  dac_channel_t channel_;
+  Source source_ = Source::kNone;
+
+  std::vector<uint8_t> table_;
+  utils::waveform::Layout layout_;
+  TaskHandle_t loader_ = nullptr;
+  SemaphoreHandle_t loader_stopped_ = nullptr;
+  volatile bool stop_loader_ = false;
+
+  /// Lowest and highest frequency of the cosine generator in Hz
+  static constexpr uint32_t min_cosine_frequency_ = 130;
+  static constexpr uint32_t max_cosine_frequency_ = 55000;
+};
+
+}  // namespace analog_out
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef MINIMAL_BUILD
 #include "as_ec_meter.h"
 
+#include "managers/services.h"
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -9,7 +10,10 @@ namespace peripherals {
 namespace as_ec_meter {
 
 AsEcMeterI2C::AsEcMeterI2C(const JsonObjectConst& parameters)
-    : I2CAbstractPeripheral(parameters), Ezo_board(0) {
+    : I2CAbstractPeripheral(parameters),
+      Ezo_board(0),
+      measurement_(Services::getWorkerPool(), this),
+      calibration_(Services::getWorkerPool(), this) {
   // If the base class constructor failed, abort the constructor
   if (!isValid()) {
     return;
@@ -46,7 +50,9 @@ AsEcMeterI2C::AsEcMeterI2C(const JsonObjectConst& parameters)
     return;
   }
 
-  // Set the correct I2C interface for the Ezo_board driver class
+  // Set the correct I2C interface for the Ezo_board driver class. Hold the
+  // bus while the driver accesses it directly
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
   wire = getWire();
 
   // Configure probe type (range from K0.010 to K10.000)
@@ -63,6 +69,14 @@ const String& AsEcMeterI2C::type() {
   return name;
 }
 
+capabilities::GetValues* AsEcMeterI2C::asGetValues() { return this; }
+
+capabilities::Calibrate* AsEcMeterI2C::asCalibrate() { return this; }
+
+capabilities::StartMeasurement* AsEcMeterI2C::asStartMeasurement() {
+  return this;
+}
+
 capabilities::Calibrate::Result AsEcMeterI2C::startCalibration(
     const JsonObjectConst& parameters) {
   // Get the calibration command to be performed
@@ -77,6 +91,7 @@ capabilities::Calibrate::Result AsEcMeterI2C::startCalibration(
   // then returns the expected time to complete the calibration process.
   // https://atlas-scientific.com/files/EC_EZO_Datasheet.pdf
   const String command = calibrate_command.as<String>();
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
   capabilities::Calibrate::Result result;
   if (command == calibrate_clear_command_) {
     result = startClearCalibration(parameters);
@@ -102,11 +117,36 @@ capabilities::Calibrate::Result AsEcMeterI2C::startCalibration(
 }
 
 capabilities::Calibrate::Result AsEcMeterI2C::handleCalibration() {
+  // Wait for the calibration step running on a worker and then start timing
+  // the next one
+  if (calibration_.isBusy()) {
+    return {.wait = calibration_.poll_wait};
+  }
+  if (calibration_.hasResult()) {
+    capabilities::Calibrate::Result result = calibration_.takeResult();
+    if (!result.error.isError()) {
+      calibration_duration_ = result.wait;
+      calibration_start_ = std::chrono::steady_clock::now();
+    }
+    return result;
+  }
+
   auto elapsed_time = std::chrono::steady_clock::now() - calibration_start_;
   // Check waited long enough. Return the time remaining if not
   if (elapsed_time < calibration_duration_) {
     return {.wait = calibration_duration_ - elapsed_time};
   }
+
+  if (!calibration_.run([this]() { return continueCalibration(); })) {
+    return {.wait = {},
+            .error = ErrorResult(type(), WorkerPool::submit_error_)};
+  }
+  return {.wait = calibration_.poll_wait};
+}
+
+capabilities::Calibrate::Result AsEcMeterI2C::continueCalibration() {
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
+
   // Check transitions
   capabilities::Calibrate::Result result;
   if (calibration_state_ == CalibrationState::kDryStabilize) {
@@ -130,16 +170,12 @@ capabilities::Calibrate::Result AsEcMeterI2C::handleCalibration() {
   } else if (calibration_state_ == CalibrationState::kClear) {
     // Finish clearing of calibration data
     calibration_state_ = CalibrationState::kNone;
-    calibration_duration_ = std::chrono::milliseconds(0);
+    result.wait = std::chrono::milliseconds(0);
 
   } else {
     return {.wait = {},
             .error = ErrorResult(type(), invalid_transition_error_)};
   }
-  if (!result.error.isError()) {
-    calibration_duration_ = result.wait;
-    calibration_start_ = std::chrono::steady_clock::now();
-  }
   return result;
 }
 
@@ -155,23 +191,39 @@ capabilities::StartMeasurement::Result AsEcMeterI2C::startMeasurement(
     return {.wait = {}, .error = ErrorResult(type(), temperature_c_key_error_)};
   }
 
-  // Start reading type depending on whether temperature compoensation is set
-  if (std::isnan(temperature_c_)) {
-    send_read_cmd();
-  } else {
-    send_read_with_temp_comp(temperature_c_);
-  }
-
   // Invalidate the last reading
   last_reading_ = NAN;
 
+  // The driver blocks on the bus, so send the command from a worker. Start
+  // reading type depending on whether temperature compoensation is set
+  const bool is_posted = measurement_.post([this]() {
+    i2c::I2CBus::Lock lock = lockBus(i2c_address);
+    if (std::isnan(temperature_c_)) {
+      send_read_cmd();
+    } else {
+      send_read_with_temp_comp(temperature_c_);
+    }
+  });
+  if (!is_posted) {
+    return {.wait = {},
+            .error = ErrorResult(type(), WorkerPool::submit_error_)};
+  }
+
   return {.wait = reading_duration_};
 }
 
 capabilities::StartMeasurement::Result AsEcMeterI2C::handleMeasurement() {
+  return measurement_.poll(type(), [this]() { return receiveMeasurement(); });
+}
+
+capabilities::StartMeasurement::Result AsEcMeterI2C::receiveMeasurement() {
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
+
   // Receive reading values, check if errors occured, check if measurement has
   // stabilized. Repeat if not stable.
   Ezo_board::errors error = receive_read_cmd();
+  // An unconnected device reads as all ones, which is reported as no data
+  lock.setSuccess(error != Ezo_board::errors::NO_DATA);
   if (error == Ezo_board::errors::SUCCESS) {
     last_reading_ = reading;
     if (isReadingStable()) {
@@ -432,18 +484,6 @@ std::shared_ptr<Peripheral> AsEcMeterI2C::factory(
   return std::make_shared<AsEcMeterI2C>(parameters);
 }
 
-bool AsEcMeterI2C::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool AsEcMeterI2C::capability_get_values_ =
-    capabilities::GetValues::registerType(type());
-
-bool AsEcMeterI2C::capability_calibrate_ =
-    capabilities::Calibrate::registerType(type());
-
-bool AsEcMeterI2C::capability_start_measurement_ =
-    capabilities::StartMeasurement::registerType(type());
-
 const __FlashStringHelper* AsEcMeterI2C::probe_type_key_ = FPSTR("probe_type");
 
 const __FlashStringHelper* AsEcMeterI2C::probe_type_key_error_ =
@@ -4,6 +4,7 @@
 #include <Ezo_i2c.h>
 
 #include "managers/service_getters.h"
+#include "managers/worker_pool.h"
 #include "peripheral/capabilities/calibrate.h"
 #include "peripheral/capabilities/get_values.h"
 #include "peripheral/capabilities/start_measurement.h"
@@ -29,6 +30,13 @@ class AsEcMeterI2C : public peripherals::i2c::I2CAbstractPeripheral,
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::Calibrate* asCalibrate() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
 
   /**
    * Perform a calibration step on the peripheral
@@ -79,6 +87,25 @@ class AsEcMeterI2C : public peripherals::i2c::I2CAbstractPeripheral,
   capabilities::GetValues::Result getValues() final;
 
  private:
+  /**
+   * Receives the reading and requests the next one if not stable yet
+   *
+   * Blocks while waiting for the bus, so it is run on a worker.
+   *
+   * \return The time wait, if an error occured or if the measurement completed
+   */
+  capabilities::StartMeasurement::Result receiveMeasurement();
+
+  /**
+   * Runs the bus accesses of the current calibration step
+   *
+   * Blocks while waiting for the bus, so it is run on a worker. The timing of
+   * the steps is updated by handleCalibration() once it completed.
+   *
+   * \return The time to wait, if an error occured or if complete
+   */
+  capabilities::Calibrate::Result continueCalibration();
+
   /**
    * Clear the calibration settings on the Ezo_board
    *
@@ -211,13 +238,6 @@ class AsEcMeterI2C : public peripherals::i2c::I2CAbstractPeripheral,
    */
   bool isReadingStable() const;
 
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameters);
-  static bool registered_;
-  static bool capability_get_values_;
-  static bool capability_calibrate_;
-  static bool capability_start_measurement_;
-
   utils::UUID data_point_type_{nullptr};
 
   static const __FlashStringHelper* probe_type_key_;
@@ -299,6 +319,12 @@ class AsEcMeterI2C : public peripherals::i2c::I2CAbstractPeripheral,
   static const __FlashStringHelper* invalid_transition_error_;
   static const __FlashStringHelper* receive_error_;
   static const __FlashStringHelper* not_calibrated_error_;
+
+  /// Run the driver's bus accesses of measurements and calibration steps on
+  /// a worker. Declared last, so that their jobs are cancelled before the
+  /// driver is destroyed
+  BlockingOperation<capabilities::StartMeasurement::Result> measurement_;
+  BlockingOperation<capabilities::Calibrate::Result> calibration_;
 };
 
 }  // namespace as_ec_meter
@@ -1,6 +1,7 @@
 #ifndef MINIMAL_BUILD
 #include "as_ph_meter.h"
 
+#include "managers/services.h"
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -9,7 +10,9 @@ namespace peripherals {
 namespace as_ph_meter {
 
 AsPhMeterI2C::AsPhMeterI2C(const JsonVariantConst& parameters)
-    : I2CAbstractPeripheral(parameters), Ezo_board(0) {
+    : I2CAbstractPeripheral(parameters),
+      Ezo_board(0),
+      measurement_(Services::getWorkerPool(), this) {
   // If the base class constructor failed, abort the constructor
   if (!isValid()) {
     return;
@@ -36,7 +39,9 @@ AsPhMeterI2C::AsPhMeterI2C(const JsonVariantConst& parameters)
     return;
   }
 
-  // Set the correct I2C interface for the Ezo_board driver class
+  // Set the correct I2C interface for the Ezo_board driver class. Hold the
+  // bus while the driver accesses it directly
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
   wire = getWire();
 
   // Set to sleep mode
@@ -50,6 +55,12 @@ const String& AsPhMeterI2C::type() {
   return name;
 }
 
+capabilities::GetValues* AsPhMeterI2C::asGetValues() { return this; }
+
+capabilities::StartMeasurement* AsPhMeterI2C::asStartMeasurement() {
+  return this;
+}
+
 capabilities::StartMeasurement::Result AsPhMeterI2C::startMeasurement(
     const JsonVariantConst& parameters) {
   // Check if temperature compensation is enabled
@@ -62,23 +73,39 @@ capabilities::StartMeasurement::Result AsPhMeterI2C::startMeasurement(
     return {.wait = {}, .error = ErrorResult(type(), temperature_c_key_error_)};
   }
 
-  // Start reading type depending on whether temperature compoensation is set
-  if (std::isnan(temperature_c_)) {
-    send_read_cmd();
-  } else {
-    send_read_with_temp_comp(temperature_c_);
-  }
-
   // Invalidate the last reading
   last_reading_ = NAN;
 
+  // The driver blocks on the bus, so send the command from a worker. Start
+  // reading type depending on whether temperature compoensation is set
+  const bool is_posted = measurement_.post([this]() {
+    i2c::I2CBus::Lock lock = lockBus(i2c_address);
+    if (std::isnan(temperature_c_)) {
+      send_read_cmd();
+    } else {
+      send_read_with_temp_comp(temperature_c_);
+    }
+  });
+  if (!is_posted) {
+    return {.wait = {},
+            .error = ErrorResult(type(), WorkerPool::submit_error_)};
+  }
+
   return {.wait = reading_duration_};
 }
 
 capabilities::StartMeasurement::Result AsPhMeterI2C::handleMeasurement() {
+  return measurement_.poll(type(), [this]() { return receiveMeasurement(); });
+}
+
+capabilities::StartMeasurement::Result AsPhMeterI2C::receiveMeasurement() {
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
+
   // Receive reading values, check if errors occured, check if measurement has
   // stabilized. Repeat if not stable.
   Ezo_board::errors error = receive_read_cmd();
+  // An unconnected device reads as all ones, which is reported as no data
+  lock.setSuccess(error != Ezo_board::errors::NO_DATA);
   if (error == Ezo_board::errors::SUCCESS) {
     last_reading_ = reading;
     if (isReadingStable()) {
@@ -134,15 +161,6 @@ std::shared_ptr<Peripheral> AsPhMeterI2C::factory(
   return std::make_shared<AsPhMeterI2C>(parameters);
 }
 
-bool AsPhMeterI2C::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool AsPhMeterI2C::capability_get_values_ =
-    capabilities::GetValues::registerType(type());
-
-bool AsPhMeterI2C::capability_start_measurement_ =
-    capabilities::StartMeasurement::registerType(type());
-
 const __FlashStringHelper* AsPhMeterI2C::temperature_c_key_ =
     FPSTR("temperature_c");
 
@@ -1,6 +1,7 @@
 #ifndef MINIMAL_BUILD
 #include "as_rtd_meter.h"
 
+#include "managers/services.h"
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -9,7 +10,9 @@ namespace peripherals {
 namespace as_rtd_meter {
 
 AsRtdMeterI2C::AsRtdMeterI2C(const JsonVariantConst& parameters)
-    : I2CAbstractPeripheral(parameters), Ezo_board(0) {
+    : I2CAbstractPeripheral(parameters),
+      Ezo_board(0),
+      measurement_(Services::getWorkerPool(), this) {
   // If the base class constructor failed, abort the constructor
   if (!isValid()) {
     return;
@@ -36,7 +39,9 @@ AsRtdMeterI2C::AsRtdMeterI2C(const JsonVariantConst& parameters)
     return;
   }
 
-  // Set the correct I2C interface for the Ezo_board driver class
+  // Set the correct I2C interface for the Ezo_board driver class. Hold the
+  // bus while the driver accesses it directly
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
   wire = getWire();
 
   // Set to sleep mode
@@ -50,21 +55,42 @@ const String& AsRtdMeterI2C::type() {
   return name;
 }
 
+capabilities::GetValues* AsRtdMeterI2C::asGetValues() { return this; }
+
+capabilities::StartMeasurement* AsRtdMeterI2C::asStartMeasurement() {
+  return this;
+}
+
 capabilities::StartMeasurement::Result AsRtdMeterI2C::startMeasurement(
     const JsonVariantConst& parameters) {
-  // Request a reading
-  send_read_cmd();
-
   // Invalidate the last reading
   last_reading_ = NAN;
 
+  // The driver blocks on the bus, so request a reading from a worker
+  const bool is_posted = measurement_.post([this]() {
+    i2c::I2CBus::Lock lock = lockBus(i2c_address);
+    send_read_cmd();
+  });
+  if (!is_posted) {
+    return {.wait = {},
+            .error = ErrorResult(type(), WorkerPool::submit_error_)};
+  }
+
   return {.wait = reading_duration_};
 }
 
 capabilities::StartMeasurement::Result AsRtdMeterI2C::handleMeasurement() {
+  return measurement_.poll(type(), [this]() { return receiveMeasurement(); });
+}
+
+capabilities::StartMeasurement::Result AsRtdMeterI2C::receiveMeasurement() {
+  i2c::I2CBus::Lock lock = lockBus(i2c_address);
+
   // Receive reading values, check if errors occured, check if measurement has
   // stabilized. Repeat if not stable.
   Ezo_board::errors error = receive_read_cmd();
+  // An unconnected device reads as all ones, which is reported as no data
+  lock.setSuccess(error != Ezo_board::errors::NO_DATA);
   if (error == Ezo_board::errors::SUCCESS) {
     // On success, store the reading an end the measurement process
     last_reading_ = reading;
@@ -100,15 +126,6 @@ std::shared_ptr<Peripheral> AsRtdMeterI2C::factory(
   return std::make_shared<AsRtdMeterI2C>(parameters);
 }
 
-bool AsRtdMeterI2C::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool AsRtdMeterI2C::capability_get_values_ =
-    capabilities::GetValues::registerType(type());
-
-bool AsRtdMeterI2C::capability_start_measurement_ =
-    capabilities::StartMeasurement::registerType(type());
-
 const __FlashStringHelper* AsRtdMeterI2C::sleep_code_ = FPSTR("Sleep");
 
 }  // namespace as_rtd_meter
@@ -3,6 +3,7 @@
 #include <ArduinoJson.h>
 #include <Ezo_i2c.h>
 
+#include "managers/worker_pool.h"
 #include "peripheral/capabilities/get_values.h"
 #include "peripheral/capabilities/start_measurement.h"
 #include "peripheral/peripherals/i2c/i2c_abstract_peripheral.h"
@@ -23,6 +24,12 @@ class AsRtdMeterI2C : public peripherals::i2c::I2CAbstractPeripheral,
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
 
   /**
    * Start an temperature measurement
@@ -54,11 +61,14 @@ class AsRtdMeterI2C : public peripherals::i2c::I2CAbstractPeripheral,
   capabilities::GetValues::Result getValues() final;
 
  private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameters);
-  static bool registered_;
-  static bool capability_get_values_;
-  static bool capability_start_measurement_;
+  /**
+   * Receives the reading and requests the next one if not stable yet
+   *
+   * Blocks while waiting for the bus, so it is run on a worker.
+   *
+   * \return The time wait, if an error occured or if the measurement completed
+   */
+  capabilities::StartMeasurement::Result receiveMeasurement();
 
   utils::UUID data_point_type_{nullptr};
 
@@ -67,6 +77,10 @@ class AsRtdMeterI2C : public peripherals::i2c::I2CAbstractPeripheral,
   float last_reading_ = NAN;
 
   static const __FlashStringHelper* sleep_code_;
+
+  /// Runs the driver's bus accesses of measurements on a worker. Declared
+  /// last, so that its jobs are cancelled before the driver is destroyed
+  BlockingOperation<capabilities::StartMeasurement::Result> measurement_;
 };
 
 }  // namespace as_rtd_meter
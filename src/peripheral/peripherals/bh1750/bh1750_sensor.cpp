@@ -1,14 +1,112 @@
+#ifdef ESP32
 #include "bh1750_sensor.h"
 
+#include <algorithm>
+
+#include "peripheral/peripheral_factory.h"
+
 namespace inamata {
 namespace peripheral {
 namespace peripherals {
 namespace bh1750 {
 
+namespace {
+constexpr uint8_t power_on_command = 0x01;
+constexpr uint8_t continuous_high_res_command = 0x10;
+constexpr uint8_t measurement_time_high_command = 0x40;
+constexpr uint8_t measurement_time_low_command = 0x60;
+}  // namespace
+
 Bh1750Sensor::Bh1750Sensor(const JsonObjectConst& parameter)
-    : light_sensor::I2CLightSensor(parameter) {}
+    : light_sensor::I2CLightSensor(parameter) {
+  // If the base class constructor failed, abort the constructor
+  if (!isValid()) {
+    return;
+  }
+
+  const uint8_t power_on = power_on_command;
+  queueWrite(&power_on, 1);
+  setMeasurementTime(measurement_time_);
+}
+
+const String& Bh1750Sensor::getType() const { return type(); }
+
+const String& Bh1750Sensor::type() {
+  static const String name{"BH1750"};
+  return name;
+}
+
+std::chrono::milliseconds Bh1750Sensor::getIntegrationTime() const {
+  // 180 ms at the default MTreg of 69 (datasheet maximum)
+  return std::chrono::milliseconds(
+      (180 * measurement_time_ + default_measurement_time_ - 1) /
+      default_measurement_time_);
+}
+
+bool Bh1750Sensor::readLux() {
+  i2c::I2CTransaction transaction;
+  transaction.address = i2c_address_;
+  transaction.read_length = 2;
+  transaction.callback = [this](const i2c::I2CTransaction& transaction) {
+    if (transaction.error) {
+      handleError(transaction_error_);
+      return;
+    }
+    const uint16_t raw = transaction.data[0] << 8 | transaction.data[1];
+    // 1.2 counts per lx at the default MTreg
+    handleLux(raw / 1.2f * default_measurement_time_ / measurement_time_);
+    adjustRange(raw);
+  };
+  return queueTransaction(std::move(transaction));
+}
+
+void Bh1750Sensor::adjustRange(uint16_t raw) {
+  if (raw >= min_raw_ && raw <= max_raw_) {
+    return;
+  }
+
+  // Scale the sensitivity so that the reading lands near the target
+  const uint32_t scaled =
+      measurement_time_ * target_raw_ / std::max<uint32_t>(raw, 1);
+  const uint8_t measurement_time = std::max<uint32_t>(
+      min_measurement_time_,
+      std::min<uint32_t>(scaled, max_measurement_time_));
+  if (measurement_time != measurement_time_) {
+    setMeasurementTime(measurement_time);
+  }
+}
+
+void Bh1750Sensor::setMeasurementTime(uint8_t measurement_time) {
+  // The MTreg is written in two parts. Restart the conversion afterwards, so
+  // that no conversion mixes the old and new sensitivity
+  const uint8_t commands[] = {
+      static_cast<uint8_t>(measurement_time_high_command |
+                           measurement_time >> 5),
+      static_cast<uint8_t>(measurement_time_low_command |
+                           (measurement_time & 0x1F)),
+      continuous_high_res_command,
+  };
+  for (const uint8_t command : commands) {
+    queueWrite(&command, 1);
+  }
+  measurement_time_ = measurement_time;
+}
+
+std::shared_ptr<Peripheral> Bh1750Sensor::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<Bh1750Sensor>(parameters);
+}
+
+constexpr uint8_t Bh1750Sensor::default_measurement_time_;
+constexpr uint8_t Bh1750Sensor::min_measurement_time_;
+constexpr uint8_t Bh1750Sensor::max_measurement_time_;
+constexpr uint16_t Bh1750Sensor::min_raw_;
+constexpr uint16_t Bh1750Sensor::max_raw_;
+constexpr uint32_t Bh1750Sensor::target_raw_;
 
 }  // namespace bh1750
 }  // namespace peripherals
 }  // namespace peripheral
 }  // namespace inamata
+
+#endif
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <memory>
+
+#include "managers/service_getters.h"
 #include "peripheral/peripherals/light_sensor/i2c_light_sensor.h"
 
 namespace inamata {
@@ -7,12 +13,57 @@ namespace peripheral {
 namespace peripherals {
 namespace bh1750 {
 
+/**
+ * Peripheral for the ROHM BH1750 ambient light sensor
+ *
+ * Measures continuously in the high resolution mode. After each reading the
+ * measurement time register (MTreg) is adjusted to keep the result in the
+ * sensor's range, which spans from 0.23 lx resolution in the dark to 120,000 lx
+ * in direct sunlight.
+ */
 class Bh1750Sensor : public light_sensor::I2CLightSensor {
+ public:
   Bh1750Sensor(const JsonObjectConst& parameter);
   virtual ~Bh1750Sensor() = default;
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+ private:
+  std::chrono::milliseconds getIntegrationTime() const final;
+  bool readLux() final;
+
+  /**
+   * Adjusts the sensitivity to the last reading
+   *
+   * \param raw The last reading
+   */
+  void adjustRange(uint16_t raw);
+
+  /**
+   * Sets the measurement time and restarts the continuous conversion
+   *
+   * \param measurement_time The new MTreg value
+   */
+  void setMeasurementTime(uint8_t measurement_time);
+
+  /// The current MTreg value, which scales the sensitivity and integration
+  uint8_t measurement_time_ = default_measurement_time_;
+
+  static constexpr uint8_t default_measurement_time_ = 69;
+  static constexpr uint8_t min_measurement_time_ = 31;
+  static constexpr uint8_t max_measurement_time_ = 254;
+  /// Readings outside of these limits adjust the range
+  static constexpr uint16_t min_raw_ = 1000;
+  static constexpr uint16_t max_raw_ = 50000;
+  /// The reading to aim for when adjusting the range
+  static constexpr uint32_t target_raw_ = 20000;
 };
 
-}
+}  // namespace bh1750
 }  // namespace peripherals
 }  // namespace peripheral
 }  // namespace inamata
@@ -1,6 +1,8 @@
 #ifndef MINIMAL_BUILD
 #include "bme280.h"
 
+#include <algorithm>
+
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -45,7 +47,9 @@ BME280::BME280(const JsonObjectConst& parameters)
     return;
   }
 
-  // Initialize the driver with the correct Wire (I2C) interface
+  // Initialize the driver with the correct Wire (I2C) interface. Hold the bus
+  // while the driver accesses it directly
+  i2c::I2CBus::Lock lock = lockBus(i2c_address_);
   driver_.setI2CAddress(i2c_address_);
   bool setup_success = driver_.beginI2C(*getWire());
   if (!setup_success) {
@@ -71,6 +75,9 @@ BME280::BME280(const JsonObjectConst& parameters)
     setInvalid(invalid_chip_type_error_);
     return;
   }
+
+  // Sleep between forced-mode measurements
+  driver_.setMode(MODE_SLEEP);
 }
 
 const String& BME280::getType() const { return type(); }
@@ -80,38 +87,180 @@ const String& BME280::type() {
   return name;
 }
 
+capabilities::GetValues* BME280::asGetValues() { return this; }
+
+capabilities::StartMeasurement* BME280::asStartMeasurement() { return this; }
+
+capabilities::StartMeasurement::Result BME280::startMeasurement(
+    const JsonVariantConst& parameters) {
+  // Set oversampling x1 for all readings and trigger a single conversion.
+  // The humidity control only takes effect after writing the measurement
+  // control. Writes are sent as register and value pairs
+  i2c::I2CTransaction transaction;
+  transaction.address = i2c_address_;
+  uint8_t& length = transaction.write_length;
+  if (chip_type_ == ChipType::BME280) {
+    transaction.data[length++] = BME280_CTRL_HUMIDITY_REG;
+    transaction.data[length++] = 0b001;
+  }
+  transaction.data[length++] = BME280_CTRL_MEAS_REG;
+  transaction.data[length++] = 0b001 << 5 | 0b001 << 2 | 0b01;
+  transaction.callback = [this](const i2c::I2CTransaction& transaction) {
+    handleTransaction(transaction);
+  };
+
+  temperature_c_ = NAN;
+  pressure_pa_ = NAN;
+  humidity_rh_ = NAN;
+  if (!queueTransaction(std::move(transaction))) {
+    measurement_state_ = MeasurementState::kIdle;
+    return {.wait = {}, .error = ErrorResult(type(), queue_error_)};
+  }
+  measurement_state_ = MeasurementState::kTriggering;
+  return {.wait = getConversionTime()};
+}
+
+capabilities::StartMeasurement::Result BME280::handleMeasurement() {
+  if (measurement_state_ == MeasurementState::kTriggering ||
+      measurement_state_ == MeasurementState::kReading) {
+    return {.wait = transaction_wait_};
+  } else if (measurement_state_ == MeasurementState::kConverting) {
+    // The conversion only started once the trigger reached the sensor
+    const std::chrono::nanoseconds converted =
+        std::chrono::steady_clock::now() - converting_since_;
+    if (converted < getConversionTime()) {
+      return {.wait = getConversionTime() - converted};
+    }
+
+    // Read all data registers in one burst
+    i2c::I2CTransaction transaction;
+    transaction.address = i2c_address_;
+    transaction.data[0] = BME280_PRESSURE_MSB_REG;
+    transaction.write_length = 1;
+    transaction.read_length = chip_type_ == ChipType::BME280 ? 8 : 6;
+    transaction.callback = [this](const i2c::I2CTransaction& transaction) {
+      handleTransaction(transaction);
+    };
+    if (!queueTransaction(std::move(transaction))) {
+      measurement_state_ = MeasurementState::kIdle;
+      return {.wait = {}, .error = ErrorResult(type(), queue_error_)};
+    }
+    measurement_state_ = MeasurementState::kReading;
+    return {.wait = transaction_wait_};
+  } else if (measurement_state_ == MeasurementState::kDone) {
+    return {.wait = {}};
+  } else if (measurement_state_ == MeasurementState::kFailed) {
+    measurement_state_ = MeasurementState::kIdle;
+    return {.wait = {}, .error = ErrorResult(type(), transaction_error_)};
+  } else {
+    return {.wait = {}, .error = ErrorResult(type(), not_started_error_)};
+  }
+}
+
 capabilities::GetValues::Result BME280::getValues() {
-  if (!isDeviceConnected(i2c_address_)) {
-    return {.values = {},
-            .error = ErrorResult(type(), missingI2CDeviceError(i2c_address_))};
+  // Use the values of the last measurement and invalidate them after
+  // returning them
+  if (measurement_state_ != MeasurementState::kDone) {
+    return {.values = {}, .error = ErrorResult(type(), get_values_error_)};
   }
+  measurement_state_ = MeasurementState::kIdle;
 
   capabilities::GetValues::Result result;
-
   result.values.push_back(
-      utils::ValueUnit{.value = driver_.readTempC(),
+      utils::ValueUnit{.value = temperature_c_,
                        .data_point_type = temperature_data_point_type_});
-  result.values.push_back(
-      utils::ValueUnit{.value = driver_.readFloatPressure(),
-                       .data_point_type = pressure_data_point_type_});
+  result.values.push_back(utils::ValueUnit{
+      .value = pressure_pa_, .data_point_type = pressure_data_point_type_});
   if (chip_type_ == ChipType::BME280) {
-    result.values.push_back(
-        utils::ValueUnit{.value = driver_.readFloatHumidity(),
-                         .data_point_type = humidity_data_point_type_});
+    result.values.push_back(utils::ValueUnit{
+        .value = humidity_rh_, .data_point_type = humidity_data_point_type_});
   }
   return result;
 }
 
+void BME280::handleTransaction(const i2c::I2CTransaction& transaction) {
+  if (transaction.error) {
+    measurement_state_ = MeasurementState::kFailed;
+  } else if (measurement_state_ == MeasurementState::kTriggering) {
+    converting_since_ = std::chrono::steady_clock::now();
+    measurement_state_ = MeasurementState::kConverting;
+  } else if (measurement_state_ == MeasurementState::kReading) {
+    memcpy(raw_data_, transaction.data, transaction.read_length);
+    compensate();
+    measurement_state_ = MeasurementState::kDone;
+  }
+}
+
+std::chrono::microseconds BME280::getConversionTime() const {
+  // Maximum conversion time for x1 oversampling (datasheet 9.1)
+  std::chrono::microseconds conversion_time(1250 + 2300 + 2875);
+  if (chip_type_ == ChipType::BME280) {
+    conversion_time += std::chrono::microseconds(2875);
+  }
+  return conversion_time;
+}
+
+void BME280::compensate() {
+  const SensorCalibration& cal = driver_.calibration;
+  const int32_t adc_p = int32_t(raw_data_[0]) << 12 |
+                        int32_t(raw_data_[1]) << 4 | raw_data_[2] >> 4;
+  const int32_t adc_t = int32_t(raw_data_[3]) << 12 |
+                        int32_t(raw_data_[4]) << 4 | raw_data_[5] >> 4;
+
+  // Temperature in 0.01 °C. The fine temperature is used by the others
+  int32_t var1 = (((adc_t >> 3) - (int32_t(cal.dig_T1) << 1)) *
+                  int32_t(cal.dig_T2)) >>
+                 11;
+  int32_t var2 = (((((adc_t >> 4) - int32_t(cal.dig_T1)) *
+                    ((adc_t >> 4) - int32_t(cal.dig_T1))) >>
+                   12) *
+                  int32_t(cal.dig_T3)) >>
+                 14;
+  const int32_t t_fine = var1 + var2;
+  temperature_c_ = ((t_fine * 5 + 128) >> 8) / 100.0f;
+
+  // Pressure in Pa as Q24.8
+  int64_t p_var1 = int64_t(t_fine) - 128000;
+  int64_t p_var2 = p_var1 * p_var1 * int64_t(cal.dig_P6);
+  p_var2 += (p_var1 * int64_t(cal.dig_P5)) << 17;
+  p_var2 += int64_t(cal.dig_P4) << 35;
+  p_var1 = ((p_var1 * p_var1 * int64_t(cal.dig_P3)) >> 8) +
+           ((p_var1 * int64_t(cal.dig_P2)) << 12);
+  p_var1 = ((int64_t(1) << 47) + p_var1) * int64_t(cal.dig_P1) >> 33;
+  if (p_var1 != 0) {
+    int64_t pressure = 1048576 - adc_p;
+    pressure = (((pressure << 31) - p_var2) * 3125) / p_var1;
+    p_var1 = (int64_t(cal.dig_P9) * (pressure >> 13) * (pressure >> 13)) >> 25;
+    p_var2 = (int64_t(cal.dig_P8) * pressure) >> 19;
+    pressure = ((pressure + p_var1 + p_var2) >> 8) + (int64_t(cal.dig_P7) << 4);
+    pressure_pa_ = pressure / 256.0f;
+  }
+
+  // Relative humidity in % as Q22.10
+  if (chip_type_ == ChipType::BME280) {
+    const int32_t adc_h = int32_t(raw_data_[6]) << 8 | raw_data_[7];
+    int32_t h = t_fine - 76800;
+    h = (((adc_h << 14) - (int32_t(cal.dig_H4) << 20) -
+          (int32_t(cal.dig_H5) * h) + 16384) >>
+         15) *
+        (((((((h * int32_t(cal.dig_H6)) >> 10) *
+             (((h * int32_t(cal.dig_H3)) >> 11) + 32768)) >>
+            10) +
+           2097152) *
+              int32_t(cal.dig_H2) +
+          8192) >>
+         14);
+    h -= (((h >> 15) * (h >> 15)) >> 7) * int32_t(cal.dig_H1) >> 4;
+    h = std::min(std::max(h, int32_t(0)), int32_t(419430400));
+    humidity_rh_ = (h >> 12) / 1024.0f;
+  }
+}
+
 std::shared_ptr<Peripheral> BME280::factory(const ServiceGetters& services,
                                             const JsonObjectConst& parameters) {
   return std::make_shared<BME280>(parameters);
 }
 
-bool BME280::registered_ = PeripheralFactory::registerFactory(type(), factory);
-
-bool BME280::capability_get_values_ =
-    capabilities::GetValues::registerType(type());
-
 const __FlashStringHelper* BME280::temperature_data_point_type_key_ =
     FPSTR("temperature_data_point_type");
 const __FlashStringHelper* BME280::temperature_data_point_type_key_error_ =
@@ -130,6 +279,13 @@ const __FlashStringHelper* BME280::humidity_data_point_type_key_error_ =
 const __FlashStringHelper* BME280::invalid_chip_type_error_ =
     FPSTR("Failed BME/P280 setup");
 
+const std::chrono::milliseconds BME280::transaction_wait_{1};
+
+const __FlashStringHelper* BME280::queue_error_ = FPSTR("I2C queue full");
+const __FlashStringHelper* BME280::transaction_error_ =
+    FPSTR("I2C transaction failed");
+const __FlashStringHelper* BME280::not_started_error_ = FPSTR("Not started");
+
 }  // namespace bme280
 }  // namespace peripherals
 }  // namespace peripheral
@@ -5,6 +5,7 @@
 
 #include "managers/service_getters.h"
 #include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/start_measurement.h"
 #include "peripheral/peripheral.h"
 #include "peripheral/peripherals/i2c/i2c_abstract_peripheral.h"
 
@@ -13,8 +14,17 @@ namespace peripheral {
 namespace peripherals {
 namespace bme280 {
 
+/**
+ * Peripheral interface for the Bosch BME280 and BMP280 air sensors
+ *
+ * The sensor sleeps between measurements. Each measurement triggers a single
+ * forced-mode conversion and reads all data registers in one burst, which are
+ * then compensated in software. Both use queued bus transactions so the loop
+ * is not blocked during the conversion.
+ */
 class BME280 : public peripherals::i2c::I2CAbstractPeripheral,
-               public capabilities::GetValues {
+               public capabilities::GetValues,
+               public capabilities::StartMeasurement {
  public:
   BME280(const JsonObjectConst& parameters);
   virtual ~BME280() = default;
@@ -22,19 +32,71 @@ class BME280 : public peripherals::i2c::I2CAbstractPeripheral,
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
+
+  /**
+   * Triggers a forced-mode conversion
+   *
+   * \param parameters Unused
+   * \return The datasheet's maximum conversion time
+   */
+  capabilities::StartMeasurement::Result startMeasurement(
+      const JsonVariantConst& parameters) final;
 
   /**
-   * Reads all available data points from the BME/P280
+   * Reads the data registers once the conversion completed
+   *
+   * The conversion time is counted from the completion of the trigger, as a
+   * busy bus may delay it.
+   *
+   * \return The time to wait, if an error occured or if the measurement
+   *     completed
+   */
+  capabilities::StartMeasurement::Result handleMeasurement() final;
+
+  /**
+   * Returns the compensated values of the last measurement
+   *
+   * Invalidates the values after returning them. Repeat startMeasurement for
+   * new values.
    *
    * \return A vector with all read data points and their type
    */
   capabilities::GetValues::Result getValues() final;
 
  private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameters);
-  static bool registered_;
-  static bool capability_get_values_;
+  /// Progress of a measurement through its queued transactions
+  enum class MeasurementState {
+    kIdle,
+    kTriggering,
+    kConverting,
+    kReading,
+    kDone,
+    kFailed,
+  };
+
+  /**
+   * Compensates the raw readings of the last burst read
+   *
+   * Uses the integer compensation formulas from the BME280 datasheet with the
+   * calibration data loaded by the driver.
+   */
+  void compensate();
+
+  /**
+   * Gives the datasheet's maximum conversion time for x1 oversampling
+   *
+   * \return The time from the trigger until the data registers are updated
+   */
+  std::chrono::microseconds getConversionTime() const;
+
+  /// Callback of the trigger and burst read transactions
+  void handleTransaction(const i2c::I2CTransaction& transaction);
 
   utils::UUID temperature_data_point_type_{nullptr};
   static const __FlashStringHelper* temperature_data_point_type_key_;
@@ -58,6 +120,22 @@ class BME280 : public peripherals::i2c::I2CAbstractPeripheral,
   /// The detected chip type
   ChipType chip_type_ = ChipType::Unknown;
 
+  MeasurementState measurement_state_ = MeasurementState::kIdle;
+  /// When the trigger of the current conversion completed
+  std::chrono::steady_clock::time_point converting_since_;
+  /// Raw data registers 0xF7 - 0xFE from the last burst read
+  uint8_t raw_data_[8];
+  float temperature_c_ = NAN;
+  float pressure_pa_ = NAN;
+  float humidity_rh_ = NAN;
+
+  /// Time between polls for a queued transaction to complete
+  static const std::chrono::milliseconds transaction_wait_;
+
+  static const __FlashStringHelper* queue_error_;
+  static const __FlashStringHelper* transaction_error_;
+  static const __FlashStringHelper* not_started_error_;
+
   /// The error if the chip type does not match the expected values
   static const __FlashStringHelper* invalid_chip_type_error_;
 };
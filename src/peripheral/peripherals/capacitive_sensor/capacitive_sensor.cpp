@@ -32,6 +32,8 @@ const String& CapacitiveSensor::type() {
   return name;
 }
 
+capabilities::GetValues* CapacitiveSensor::asGetValues() { return this; }
+
 capabilities::GetValues::Result CapacitiveSensor::getValues() {
   return {.values = {utils::ValueUnit{
               .value = static_cast<float>(touchRead(sense_pin_)),
@@ -47,12 +49,6 @@ std::shared_ptr<Peripheral> CapacitiveSensor::factory(
   return std::make_shared<CapacitiveSensor>(parameters);
 }
 
-bool CapacitiveSensor::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool CapacitiveSensor::capability_get_value_ =
-    capabilities::GetValues::registerType(type());
-
 }  // namespace capacative_sensor
 }  // namespace peripherals
 }  // namespace peripheral
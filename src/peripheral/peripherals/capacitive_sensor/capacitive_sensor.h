@@ -24,6 +24,11 @@ class CapacitiveSensor : public Peripheral, public capabilities::GetValues {
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
 
   /**
    * Read touch pad (values close to 0 mean touch detected)
@@ -33,11 +38,6 @@ class CapacitiveSensor : public Peripheral, public capabilities::GetValues {
   capabilities::GetValues::Result getValues() final;
 
  private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameters);
-  static bool registered_;
-  static bool capability_get_value_;
-
   unsigned int sense_pin_;
   utils::UUID data_point_type_;
 
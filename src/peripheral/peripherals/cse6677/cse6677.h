@@ -1,5 +1,11 @@
+#pragma once
+
+#include <memory>
+
 #include "peripheral/capabilities/get_values.h"
 #include "peripheral/capabilities/start_measurement.h"
+#include "peripheral/peripherals/cse7766/cse7766.h"
+#include "peripheral/peripherals/uart/frame_reader.h"
 #include "peripheral/peripherals/uart/uart_abstract_peripheral.h"
 
 namespace inamata {
@@ -7,13 +13,18 @@ namespace peripheral {
 namespace peripherals {
 namespace cse6677 {
 
+using cse7766::Protocol;
 
 /**
  * Driver for CSE6677, an electrical energy measurement chip 
  * 
- * UART baud rate is 4800 bps with an 8E1 encoding but 8N1 also works. Reads a
- * data frame via the startMeasurement interface and values from the buffered
- * data frame can be read via the getValues interface.
+ * UART baud rate is 4800 bps with an 8E1 encoding but 8N1 also works. The
+ * chip sends a data frame about every 50 ms, which is decoded in the
+ * background. The startMeasurement interface waits for a new frame and values
+ * from the latest frame can be read via the getValues interface.
+ *
+ * If an energy data point type is set, the active energy of every frame is
+ * accumulated and persisted across resets and power loss.
  */
 class CSE6677 : public uart::UARTAbstractPeripheral,
                 public capabilities::GetValues,
@@ -25,58 +36,44 @@ class CSE6677 : public uart::UARTAbstractPeripheral,
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
 
   /**
-   * Reset state and start reading data frame from CSE6677
+   * Start waiting for a new data frame from the CSE6677
    * 
    * @param parameters No parameters expected
-   * @return Error, wait or ready depending on read frame
+   * @return The time to wait for the next frame
    */
   capabilities::StartMeasurement::Result startMeasurement(
       const JsonVariantConst& parameters) final;
 
   /**
-   * Reads data frame CSE6677 and handle reset or timeout
-   * 
-   * - Attempt to read full and valid data frame from CSE6677 via UART/serial
-   * - Reset state after having read the values and start new timeout
-   * - Return timeout error if values not ready or read due to timeout
-   * - Return wait on no data or too many invalid bytes
+   * Checks if a new data frame was decoded since starting the measurement
    *
-   * \return A vector with all read data points and their type
+   * \return Ready on a new frame, wait if none yet or a timeout error
    */
   capabilities::StartMeasurement::Result handleMeasurement() final;
 
   /**
-   * Read values measured by CSE6677 from sent data frame
+   * Read values measured by CSE6677 from the latest data frame
    * 
-   * @return Measured volts, amps and watts or error
+   * @return Measured volts, amps, watts and optionally Wh or error
    */
   capabilities::GetValues::Result getValues() final;
 
  private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameters);
-
-  /**
-   * Read data frame until valid frame or fault occurs
-   * 
-   * @return Blank on success, wait if fault occurs
-   */
-  capabilities::StartMeasurement::Result readFrame();
-
-  /**
-   * Reset frame buffer, error counter and timeout
-   */
-  void resetState();
-
   /**
    * Parse a 24-bit MSB/big-endian uint
    *
    * @param first_byte Pointer to first byte of 24-bit uint
    * @return Parsed uint stored in a native 32-bit uint
    */
-  static uint32_t parse24bit(uint8_t* first_byte);
+  static uint32_t parse24bit(const uint8_t* first_byte);
 
   /**
    * Parse a 16-bit MSB/big-endian uint
@@ -84,26 +81,22 @@ class CSE6677 : public uart::UARTAbstractPeripheral,
    * @param first_byte Pointer to first byte of 16-bit uint
    * @return Parsed uint stored in a native 32-bit uint
    */
-  static uint32_t parse16bit(uint8_t* first_byte);
-
-  static bool registered_;
-  static bool capability_get_values_;
-  static bool capability_start_measurement_;
-
-  /// Buffer for a data frame (frame is 24 bytes)
-  uint8_t in_data_[24];
-  /// Index of the data frame buffer
-  uint8_t in_data_i_;
-  /// Number of invalid bytes read
-  uint32_t invalid_byte_count_;
-  /// Whether values from frame buffer were read
-  bool got_values_ = false;
-  /// When reading the frame buffer started (for timeout)
+  static uint32_t parse16bit(const uint8_t* first_byte);
+
+  /// Accumulates the energy of every frame if an energy type is set
+  std::unique_ptr<cse7766::EnergyAccumulator> energy_accumulator_;
+  /// Decodes the frames received via UART in the background
+  std::unique_ptr<uart::FrameReader<Protocol>> frame_reader_;
+  /// Frame count when the measurement was started
+  uint32_t start_frame_count_ = 0;
+  /// When waiting for a new frame started (for timeout)
   std::chrono::steady_clock::time_point measurement_start_;
-  /// Max duration to fill frame buffer
+  /// Max duration to wait for a new frame
   static constexpr std::chrono::seconds measurement_timeout_{10};
-  /// Time to wait after too many read errors or no data available
-  static constexpr std::chrono::milliseconds no_data_wait_{500};
+  /// Time between reads of the UART buffer
+  static constexpr std::chrono::milliseconds read_interval_{50};
+  /// Time to wait for a new frame
+  static constexpr std::chrono::milliseconds frame_wait_{100};
 
   /// Bitmask if power was measured 
   static constexpr uint8_t adj_power_mask = 1 << 4;
@@ -126,8 +119,6 @@ class CSE6677 : public uart::UARTAbstractPeripheral,
   static constexpr uint8_t power_cycles_offset = 17;
   /// Byte offset (position) in frame for 'adj' flags
   static constexpr uint8_t adj_offset = 20;
-  /// Byte offset (position) in frame for frame checksum
-  static constexpr uint8_t checksum_offset = 23;
 
   /// Bitmask for header 1 byte if errors occured
   static constexpr uint8_t header_error_mask = 0xF0;
@@ -152,6 +143,13 @@ class CSE6677 : public uart::UARTAbstractPeripheral,
   utils::UUID power_data_point_type_{nullptr};
   /// Key in parameters dict for the ID of power data point type
   static const __FlashStringHelper* power_data_point_type_key_;
+
+  /// ID of energy data point type. Optional
+  utils::UUID energy_data_point_type_{nullptr};
+  /// Key in parameters dict for the ID of energy data point type
+  static const __FlashStringHelper* energy_data_point_type_key_;
+  /// Key in parameters dict for the ID of the peripheral
+  static const __FlashStringHelper* uuid_key_;
 };
 
 }  // namespace cse6677
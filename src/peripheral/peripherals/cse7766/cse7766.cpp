@@ -1,5 +1,6 @@
 #include "cse7766.h"
 
+#include "managers/services.h"
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -7,6 +8,21 @@ namespace peripheral {
 namespace peripherals {
 namespace cse7766 {
 
+constexpr size_t Protocol::frame_size;
+
+bool Protocol::isHeader(uint8_t first, uint8_t second) {
+  return (first == 0x55 || first >= 0xF0 || first == 0xAA) && second == 0x5A;
+}
+
+bool Protocol::isValid(const uint8_t* frame) {
+  // Sum all bytes (with overflow) excluding header and checksum bytes
+  uint8_t checksum = 0;
+  for (uint8_t i = 2; i < frame_size - 1; i++) {
+    checksum += frame[i];
+  }
+  return checksum == frame[frame_size - 1];
+}
+
 CSE7766::CSE7766(const JsonObjectConst& parameters)
     : UARTAbstractPeripheral(parameters) {
   // If the base class constructor failed, abort the constructor
@@ -39,6 +55,40 @@ CSE7766::CSE7766(const JsonObjectConst& parameters)
                                               ErrorStore::KeyType::kUUID));
     return;
   }
+
+  // Optionally get the data point type for the accumulated energy
+  JsonVariantConst energy_data_point_type =
+      parameters[energy_data_point_type_key_];
+  if (!energy_data_point_type.isNull()) {
+    energy_data_point_type_ = utils::UUID(energy_data_point_type);
+    if (!energy_data_point_type_.isValid()) {
+      setInvalid(ErrorStore::genMissingProperty(energy_data_point_type_key_,
+                                                ErrorStore::KeyType::kUUID));
+      return;
+    }
+    utils::UUID id(parameters[uuid_key_]);
+    if (!id.isValid()) {
+      setInvalid(ErrorStore::genMissingProperty(uuid_key_,
+                                                ErrorStore::KeyType::kUUID));
+      return;
+    }
+    energy_accumulator_.reset(new cse7766::EnergyAccumulator(id));
+    if (!energy_accumulator_->isValid()) {
+      setInvalid(cse7766::EnergyAccumulator::rtc_slot_error_);
+      return;
+    }
+  }
+
+  // Decode frames in the background so that the latest one is always ready
+  frame_reader_.reset(new uart::FrameReader<Protocol>(
+      *uart_adapter_, Services::getScheduler(), read_interval_));
+  if (energy_accumulator_) {
+    cse7766::EnergyAccumulator* energy_accumulator = energy_accumulator_.get();
+    frame_reader_->getDecoder().setFrameCallback(
+        [energy_accumulator](const uint8_t* frame) {
+          energy_accumulator->update(frame);
+        });
+  }
 }
 
 const String& CSE7766::getType() const { return type(); }
@@ -48,36 +98,47 @@ const String& CSE7766::type() {
   return name;
 }
 
+capabilities::GetValues* CSE7766::asGetValues() { return this; }
+
+capabilities::StartMeasurement* CSE7766::asStartMeasurement() { return this; }
+
 capabilities::StartMeasurement::Result CSE7766::startMeasurement(
     const JsonVariantConst& parameters) {
-  resetState();
-  return readFrame();
+  start_frame_count_ = frame_reader_->getDecoder().getFrameCount();
+  measurement_start_ = std::chrono::steady_clock::now();
+  return {.wait = frame_wait_};
 }
 
 capabilities::StartMeasurement::Result CSE7766::handleMeasurement() {
-  if (got_values_) {
-    resetState();
+  if (frame_reader_->getDecoder().getFrameCount() != start_frame_count_) {
+    return capabilities::StartMeasurement::Result();
   }
   if (std::chrono::steady_clock::now() - measurement_start_ >
       measurement_timeout_) {
     return capabilities::StartMeasurement::Result{
         .error = ErrorResult(type(), F("Timeout"))};
   }
-  return readFrame();
+  return {.wait = frame_wait_};
 }
 
 capabilities::GetValues::Result CSE7766::getValues() {
-  if (in_data_[0] == 0xAA) {
+  const uart::FrameDecoder<Protocol>& decoder = frame_reader_->getDecoder();
+  if (!decoder.hasFrame()) {
+    return capabilities::GetValues::Result{
+        .error = ErrorResult(type(), F("No frame received"))};
+  }
+  const uint8_t* in_data = decoder.getFrame();
+  if (in_data[0] == 0xAA) {
     return capabilities::GetValues::Result{
         .error = ErrorResult(type(), F("Not calibrated"))};
   }
 
   capabilities::GetValues::Result result;
-  const uint8_t adj = in_data_[adj_offset];
+  const uint8_t adj = in_data[adj_offset];
 
   if (adj & adj_voltage_mask) {
-    const double voltage_coef = parse24bit(in_data_ + voltage_coef_offset);
-    const double voltage_cycle = parse24bit(in_data_ + voltage_cycle_offset);
+    const double voltage_coef = parse24bit(in_data + voltage_coef_offset);
+    const double voltage_cycle = parse24bit(in_data + voltage_cycle_offset);
     const float voltage = voltage_coef / voltage_cycle;
     result.values.push_back(utils::ValueUnit{
         .value = voltage, .data_point_type = voltage_data_point_type_});
@@ -87,10 +148,10 @@ capabilities::GetValues::Result CSE7766::getValues() {
   if (adj & adj_power_mask) {
     // Ensure abnormal header and power out-of-range bit are not set.
     // Otherwise set power as off
-    if ((in_data_[0] & power_oor_value) != power_oor_value) {
+    if ((in_data[0] & power_oor_value) != power_oor_value) {
       is_power_valid = true;
-      const double power_coef = parse24bit(in_data_ + power_coef_offset);
-      const double power_cycle = parse24bit(in_data_ + power_cycles_offset);
+      const double power_coef = parse24bit(in_data + power_coef_offset);
+      const double power_cycle = parse24bit(in_data + power_cycles_offset);
       power = power_coef / power_cycle;
     }
   }
@@ -98,8 +159,8 @@ capabilities::GetValues::Result CSE7766::getValues() {
   float current = 0.0;
   if (adj & adj_current_mask) {
     if (is_power_valid) {
-      const double current_coef = parse24bit(in_data_ + current_coef_offset);
-      const double current_cycle = parse24bit(in_data_ + current_cycle_offset);
+      const double current_coef = parse24bit(in_data + current_coef_offset);
+      const double current_cycle = parse24bit(in_data + current_cycle_offset);
       current = current_coef / current_cycle;
     }
   }
@@ -110,90 +171,21 @@ capabilities::GetValues::Result CSE7766::getValues() {
     result.values.push_back(utils::ValueUnit{
         .value = current, .data_point_type = current_data_point_type_});
   }
-
-  // Mark frame as being read and allow frame to be cleared for next poll
-  got_values_ = true;
-
-  return result;
-}
-
-capabilities::StartMeasurement::Result CSE7766::readFrame() {
-  while (true) {
-    // Check if a valid frame has been read (once frame is full).
-    if (in_data_i_ >= sizeof(in_data_)) {
-      // Sum all bytes (with overflow) excluding header and checksum bytes
-      uint8_t checksum = 0;
-      for (uint8_t i = 2; i < checksum_offset; i++) {
-        checksum += in_data_[i];
-      }
-      // On invalid checksum, read new frame
-      if (checksum != in_data_[checksum_offset]) {
-        in_data_i_ = 0;
-        invalid_byte_count_ += sizeof(in_data_);
-        continue;
-      } else {
-        // Frame read successfully, can now get values from frame
-        return capabilities::StartMeasurement::Result();
-      }
-    }
-
-    // Read bytes while available (not -1), wait if no valid data available
-    int byte_read = uart_adapter_->getSerial()->read();
-    if (byte_read == -1) {
-      return capabilities::StartMeasurement::Result{.wait = no_data_wait_};
-    }
-    // If more than two frame lengths of invalid bytes were read, then
-    // clear input buffer (at most 512 bytes) and wait for new attempt
-    if (invalid_byte_count_ &&
-        invalid_byte_count_ % (sizeof(in_data_) * 2) == 0) {
-      HardwareSerial* serial = uart_adapter_->getSerial();
-      uint8_t buffer[64];
-      for (int i = 0; i < 8; i++) {
-        // Will block for 1s due to HardwareSerial timeout
-        size_t byte_count = serial->readBytes(buffer, sizeof(buffer));
-        if (byte_count != sizeof(buffer)) {
-          break;
-        }
-      }
-      invalid_byte_count_++;
-      return capabilities::StartMeasurement::Result{.wait = no_data_wait_};
-    }
-
-    // If first byte is invalid, read next byte and check it
-    if (in_data_i_ == 0 && byte_read != 0x55 && byte_read < 0xF0 &&
-        byte_read != 0xAA) {
-      invalid_byte_count_++;
-      continue;
-    }
-    // If the second byte is invalid, restart reading frame
-    if (in_data_i_ == 1 && byte_read != 0x5A) {
-      in_data_i_ = 0;
-      invalid_byte_count_ += 2;
-      continue;
-    }
-    // Save byte at index and increment index
-    in_data_[in_data_i_] = byte_read;
-    in_data_i_++;
+  if (energy_accumulator_) {
+    result.values.push_back(utils::ValueUnit{
+        .value = static_cast<float>(energy_accumulator_->getEnergyWh()),
+        .data_point_type = energy_data_point_type_});
   }
-}
 
-void CSE7766::resetState() {
-  // Set after reading frame and getting values
-  got_values_ = false;
-  // Clear frame data and errors
-  memset(in_data_, 0, sizeof(in_data_));
-  in_data_i_ = 0;
-  invalid_byte_count_ = 0;
-  // Start time of reading a new frame
-  measurement_start_ = std::chrono::steady_clock::now();
+  return result;
 }
 
-uint32_t CSE7766::parse24bit(uint8_t* first_byte) {
+uint32_t CSE7766::parse24bit(const uint8_t* first_byte) {
   return uint32_t(*first_byte) << 16 | uint32_t(*(first_byte + 1)) << 8 |
          uint32_t(*(first_byte + 2));
 }
 
-uint32_t CSE7766::parse16bit(uint8_t* first_byte) {
+uint32_t CSE7766::parse16bit(const uint8_t* first_byte) {
   return uint32_t(*first_byte) << 8 | uint32_t(*(first_byte + 1));
 }
 
@@ -202,13 +194,9 @@ std::shared_ptr<Peripheral> CSE7766::factory(
   return std::make_shared<CSE7766>(parameters);
 }
 
-bool CSE7766::registered_ = PeripheralFactory::registerFactory(type(), factory);
-
-bool CSE7766::capability_get_values_ =
-    capabilities::GetValues::registerType(type());
-
-bool CSE7766::capability_start_measurement_ =
-    capabilities::StartMeasurement::registerType(type());
+constexpr std::chrono::seconds CSE7766::measurement_timeout_;
+constexpr std::chrono::milliseconds CSE7766::read_interval_;
+constexpr std::chrono::milliseconds CSE7766::frame_wait_;
 
 const __FlashStringHelper* CSE7766::voltage_data_point_type_key_ =
     FPSTR("voltage_data_point_type");
@@ -216,6 +204,9 @@ const __FlashStringHelper* CSE7766::current_data_point_type_key_ =
     FPSTR("current_data_point_type");
 const __FlashStringHelper* CSE7766::power_data_point_type_key_ =
     FPSTR("power_data_point_type");
+const __FlashStringHelper* CSE7766::energy_data_point_type_key_ =
+    FPSTR("energy_data_point_type");
+const __FlashStringHelper* CSE7766::uuid_key_ = FPSTR("uuid");
 
 }  // namespace cse7766
 }  // namespace peripherals
@@ -0,0 +1,243 @@
+#include "energy_accumulator.h"
+
+#include <LittleFS.h>
+
+#include <algorithm>
+
+#ifdef ESP32
+#include <esp_attr.h>
+#endif
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace cse7766 {
+
+namespace {
+/// Size of an RTC slot, a multiple of the 4-byte RTC memory blocks
+constexpr size_t rtc_slot_size = 24;
+#ifdef ESP32
+/// Not initialized on boot so that they survive resets
+RTC_NOINIT_ATTR uint8_t rtc_records[4][rtc_slot_size];
+#else
+/// First RTC user memory block of the checkpoints. The ESP8266 core reserves
+/// blocks 0 - 31 for the bootloader's OTA command
+constexpr uint32_t rtc_block_offset = 32;
+#endif
+
+/// Whether mounting the file system was attempted and succeeded
+bool is_fs_mounted = false;
+bool is_fs_mount_attempted = false;
+
+bool mountFs() {
+  if (!is_fs_mount_attempted) {
+    is_fs_mount_attempted = true;
+    is_fs_mounted = LittleFS.begin();
+  }
+  return is_fs_mounted;
+}
+}  // namespace
+
+EnergyAccumulator::EnergyAccumulator(const utils::UUID& id) {
+  const String id_string = id.toString();
+  id_hash_ = hash(reinterpret_cast<const uint8_t*>(id_string.c_str()),
+                  id_string.length());
+  path_ = F("/energy_");
+  path_ += String(id_hash_, HEX);
+
+  rtc_slot_ = claimRtcSlot();
+  if (rtc_slot_ < 0) {
+    return;
+  }
+  claimed_rtc_slots_.set(rtc_slot_);
+  restore();
+}
+
+EnergyAccumulator::~EnergyAccumulator() {
+  if (!isValid()) {
+    return;
+  }
+  if (energy_wh_ != committed_energy_wh_) {
+    writeFlash(createRecord());
+  }
+  claimed_rtc_slots_.reset(rtc_slot_);
+}
+
+bool EnergyAccumulator::isValid() const { return rtc_slot_ >= 0; }
+
+void EnergyAccumulator::update(const uint8_t* frame) {
+  // Not calibrated. The power coefficient is not valid
+  if (!isValid() || frame[0] == 0xAA) {
+    return;
+  }
+
+  const uint16_t pulses = uint16_t(frame[21]) << 8 | frame[22];
+  if (!has_last_pulses_) {
+    last_pulses_ = pulses;
+    has_last_pulses_ = true;
+    return;
+  }
+  // The counter wraps around at 16 bits
+  const uint16_t delta = pulses - last_pulses_;
+  last_pulses_ = pulses;
+  if (delta == 0) {
+    return;
+  }
+
+  // Each pulse is the power coefficient in µJ
+  const uint32_t power_coef =
+      uint32_t(frame[14]) << 16 | uint32_t(frame[15]) << 8 | frame[16];
+  energy_wh_ += delta * (power_coef / 3.6e9);
+  checkpoint();
+}
+
+double EnergyAccumulator::getEnergyWh() const { return energy_wh_; }
+
+void EnergyAccumulator::restore() {
+  // Use the larger of both, as the RTC memory is more recent but does not
+  // survive power loss
+  Record record;
+  if (readFlash(record)) {
+    energy_wh_ = record.energy_wh;
+  }
+  if (readRtc(record)) {
+    energy_wh_ = std::max(energy_wh_, record.energy_wh);
+  }
+  committed_energy_wh_ = energy_wh_;
+  last_commit_ms_ = millis();
+}
+
+void EnergyAccumulator::checkpoint() {
+  const Record record = createRecord();
+  writeRtc(record);
+
+  if (energy_wh_ - committed_energy_wh_ >= commit_threshold_wh_ &&
+      millis() - last_commit_ms_ >= min_commit_interval_ms_) {
+    writeFlash(record);
+    committed_energy_wh_ = energy_wh_;
+    last_commit_ms_ = millis();
+  }
+}
+
+EnergyAccumulator::Record EnergyAccumulator::createRecord() const {
+  Record record;
+  memset(&record, 0, sizeof(record));
+  record.magic = record_magic_;
+  record.id_hash = id_hash_;
+  record.energy_wh = energy_wh_;
+  record.checksum = hash(reinterpret_cast<const uint8_t*>(&record),
+                         offsetof(Record, checksum));
+  return record;
+}
+
+bool EnergyAccumulator::isValidRecord(const Record& record) const {
+  return isIntactRecord(record) && record.id_hash == id_hash_ &&
+         record.energy_wh >= 0;
+}
+
+bool EnergyAccumulator::isIntactRecord(const Record& record) {
+  return record.magic == record_magic_ &&
+         record.checksum == hash(reinterpret_cast<const uint8_t*>(&record),
+                                 offsetof(Record, checksum));
+}
+
+uint32_t EnergyAccumulator::hash(const uint8_t* data, size_t length) {
+  // FNV-1a
+  uint32_t hash = 2166136261;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ data[i]) * 16777619;
+  }
+  return hash;
+}
+
+int EnergyAccumulator::claimRtcSlot() const {
+  // Prefer the slot of the last checkpoint, then one without a checkpoint and
+  // only then the stale checkpoint of another peripheral
+  int free_slot = -1;
+  int stale_slot = -1;
+  for (int slot = 0; slot < static_cast<int>(rtc_slot_count_); slot++) {
+    if (claimed_rtc_slots_.test(slot)) {
+      continue;
+    }
+    Record record;
+    if (!readRtc(slot, record) || !isIntactRecord(record)) {
+      free_slot = free_slot < 0 ? slot : free_slot;
+    } else if (isValidRecord(record)) {
+      return slot;
+    } else {
+      stale_slot = stale_slot < 0 ? slot : stale_slot;
+    }
+  }
+  return free_slot >= 0 ? free_slot : stale_slot;
+}
+
+bool EnergyAccumulator::readRtc(int slot, Record& record) {
+  static_assert(sizeof(Record) <= rtc_slot_size,
+                "Record does not fit RTC slot");
+#ifdef ESP32
+  static_assert(sizeof(rtc_records) / rtc_slot_size == rtc_slot_count_,
+                "An RTC slot per accumulator");
+  memcpy(&record, rtc_records[slot], sizeof(record));
+  return true;
+#else
+  return ESP.rtcUserMemoryRead(
+      rtc_block_offset + slot * rtc_slot_size / sizeof(uint32_t),
+      reinterpret_cast<uint32_t*>(&record), sizeof(record));
+#endif
+}
+
+bool EnergyAccumulator::readRtc(Record& record) {
+  return readRtc(rtc_slot_, record) && isValidRecord(record);
+}
+
+void EnergyAccumulator::writeRtc(const Record& record) {
+#ifdef ESP32
+  memcpy(rtc_records[rtc_slot_], &record, sizeof(record));
+#else
+  ESP.rtcUserMemoryWrite(
+      rtc_block_offset + rtc_slot_ * rtc_slot_size / sizeof(uint32_t),
+      reinterpret_cast<uint32_t*>(const_cast<Record*>(&record)),
+      sizeof(record));
+#endif
+}
+
+bool EnergyAccumulator::readFlash(Record& record) {
+  if (!mountFs()) {
+    return false;
+  }
+  fs::File file = LittleFS.open(path_, "r");
+  if (!file) {
+    return false;
+  }
+  const size_t size =
+      file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record));
+  file.close();
+  return size == sizeof(record) && isValidRecord(record);
+}
+
+void EnergyAccumulator::writeFlash(const Record& record) {
+  if (!mountFs()) {
+    return;
+  }
+  fs::File file = LittleFS.open(path_, "w");
+  if (!file) {
+    return;
+  }
+  file.write(reinterpret_cast<const uint8_t*>(&record), sizeof(record));
+  file.close();
+}
+
+constexpr double EnergyAccumulator::commit_threshold_wh_;
+constexpr uint32_t EnergyAccumulator::min_commit_interval_ms_;
+constexpr uint32_t EnergyAccumulator::record_magic_;
+constexpr size_t EnergyAccumulator::rtc_slot_count_;
+std::bitset<EnergyAccumulator::rtc_slot_count_>
+    EnergyAccumulator::claimed_rtc_slots_;
+
+const __FlashStringHelper* EnergyAccumulator::rtc_slot_error_ =
+    FPSTR("Too many energy meters");
+
+}  // namespace cse7766
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
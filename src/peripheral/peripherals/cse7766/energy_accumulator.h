@@ -0,0 +1,127 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <bitset>
+
+#include "utils/uuid.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace cse7766 {
+
+/**
+ * Accumulates the active energy measured by a CSE7766 / CSE6677
+ *
+ * The chip counts a PF pulse for each fixed quantum of active energy, which
+ * is the power coefficient in µJ. The 16-bit pulse counter of every frame is
+ * used, so no energy is lost between frames and bursty loads are captured.
+ *
+ * The total is checkpointed to RTC memory on every update, which survives
+ * resets, and to flash to survive power loss. Flash commits are only made
+ * once enough energy has accumulated and the minimum commit interval has
+ * passed to limit flash wear.
+ *
+ * Each accumulator claims its own RTC slot, preferring the one holding its
+ * last checkpoint. If all slots are claimed, the accumulator is invalid.
+ */
+class EnergyAccumulator {
+ public:
+  /**
+   * Claims an RTC slot and restores the last checkpoint of the peripheral
+   *
+   * \param id The ID of the peripheral, used to find its checkpoint
+   */
+  EnergyAccumulator(const utils::UUID& id);
+
+  /**
+   * Commits the energy not yet stored in flash and releases the RTC slot
+   */
+  ~EnergyAccumulator();
+
+  /**
+   * Checks if an RTC slot could be claimed
+   *
+   * \return True if it is valid
+   */
+  bool isValid() const;
+
+  /**
+   * Adds the energy of the pulses counted since the last frame
+   *
+   * \param frame A valid 24-byte frame
+   */
+  void update(const uint8_t* frame);
+
+  /**
+   * Gets the total energy
+   *
+   * \return The accumulated energy in Wh
+   */
+  double getEnergyWh() const;
+
+  /// Error if more accumulators are created than there are RTC slots
+  static const __FlashStringHelper* rtc_slot_error_;
+
+ private:
+  /// Checkpoint of the accumulated energy
+  struct Record {
+    uint32_t magic;
+    uint32_t id_hash;
+    double energy_wh;
+    uint32_t checksum;
+  };
+
+  void restore();
+  void checkpoint();
+  Record createRecord() const;
+  bool isValidRecord(const Record& record) const;
+  static bool isIntactRecord(const Record& record);
+  static uint32_t hash(const uint8_t* data, size_t length);
+
+  /**
+   * Claims the slot of the last checkpoint, else a free or stale one
+   *
+   * \return The claimed slot or -1 if all are claimed
+   */
+  int claimRtcSlot() const;
+  static bool readRtc(int slot, Record& record);
+  bool readRtc(Record& record);
+  void writeRtc(const Record& record);
+  bool readFlash(Record& record);
+  void writeFlash(const Record& record);
+
+  /// Hash of the peripheral ID to identify its checkpoints
+  uint32_t id_hash_;
+  /// The claimed RTC slot or -1 if none was free
+  int rtc_slot_ = -1;
+  /// Flash file of the checkpoint
+  String path_;
+
+  double energy_wh_ = 0;
+  /// Energy at the last flash commit
+  double committed_energy_wh_ = 0;
+  /// Time of the last flash commit (millis)
+  uint32_t last_commit_ms_ = 0;
+
+  /// Pulse counter of the last frame
+  uint16_t last_pulses_ = 0;
+  bool has_last_pulses_ = false;
+
+  /// Minimum energy change before committing to flash
+  static constexpr double commit_threshold_wh_ = 10;
+  /// Minimum time between commits to flash
+  static constexpr uint32_t min_commit_interval_ms_ = 15 * 60 * 1000;
+  static constexpr uint32_t record_magic_ = 0x454E5247;
+
+  /// Number of accumulators that can checkpoint to RTC memory
+  static constexpr size_t rtc_slot_count_ = 4;
+  /// RTC slots claimed by accumulators
+  static std::bitset<rtc_slot_count_> claimed_rtc_slots_;
+};
+
+}  // namespace cse7766
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -0,0 +1,197 @@
+#ifndef MINIMAL_BUILD
+#include "dallas_temperature.h"
+
+#include "peripheral/peripheral_factory.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace dallas_temperature {
+
+DallasTemperature::DallasTemperature(const JsonObjectConst& parameters) {
+  const int pin = toPin(parameters[pin_key_]);
+  if (pin < 0) {
+    setInvalid(pin_key_error_);
+    return;
+  }
+
+  // 9 to 12 bits, which take 94 to 750 ms to convert
+  const int resolution = parameters[resolution_key_] | default_resolution_;
+  if (resolution < 9 || resolution > 12) {
+    setInvalid(resolution_key_error_);
+    return;
+  }
+  resolution_ = resolution;
+
+  JsonArrayConst probes = parameters[probes_key_];
+  if (probes.isNull() || probes.size() == 0) {
+    setInvalid(probes_key_error_);
+    return;
+  }
+
+  // Enumerates the probes on the bus and detects parasite power
+  one_wire_.begin(pin);
+  driver_.setOneWire(&one_wire_);
+  driver_.begin();
+  // Return after sending Convert T instead of waiting for it to complete
+  driver_.setWaitForConversion(false);
+
+  probes_.reserve(probes.size());
+  for (JsonVariantConst probe : probes) {
+    Probe entry{.address = {},
+                .data_point_type = utils::UUID(probe[data_point_type_key_]),
+                .temperature_c = NAN};
+    if (!parseAddress(probe[address_key_].as<const char*>(), entry.address) ||
+        !entry.data_point_type.isValid()) {
+      setInvalid(probes_key_error_);
+      return;
+    }
+
+    // Only writes the scratchpad and EEPROM if the resolution differs
+    if (!driver_.isConnected(entry.address) ||
+        !driver_.setResolution(entry.address, resolution_)) {
+      setInvalid(probeError(probe_missing_error_, entry));
+      return;
+    }
+    probes_.push_back(entry);
+  }
+  next_probe_ = probes_.size();
+}
+
+const String& DallasTemperature::getType() const { return type(); }
+
+const String& DallasTemperature::type() {
+  static const String name{"DallasTemperature"};
+  return name;
+}
+
+capabilities::GetValues* DallasTemperature::asGetValues() { return this; }
+
+capabilities::StartMeasurement* DallasTemperature::asStartMeasurement() {
+  return this;
+}
+
+capabilities::StartMeasurement::Result DallasTemperature::startMeasurement(
+    const JsonVariantConst& parameters) {
+  // Broadcast Convert T to all probes with a skip ROM command
+  driver_.requestTemperatures();
+  for (Probe& probe : probes_) {
+    probe.temperature_c = NAN;
+  }
+  next_probe_ = 0;
+  is_measuring_ = true;
+
+  const std::chrono::milliseconds conversion_time(
+      driver_.millisToWaitForConversion(resolution_));
+  ready_at_ = std::chrono::steady_clock::now() + conversion_time;
+  return {.wait = conversion_time};
+}
+
+capabilities::StartMeasurement::Result DallasTemperature::handleMeasurement() {
+  if (!is_measuring_) {
+    return {.wait = {}, .error = ErrorResult(type(), not_started_error_)};
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now < ready_at_) {
+    return {.wait = ready_at_ - now};
+  }
+  if (next_probe_ >= probes_.size()) {
+    return {.wait = {}};
+  }
+
+  // Read one scratchpad per call, which takes about 2 ms of bit banging
+  Probe& probe = probes_[next_probe_];
+  probe.temperature_c = driver_.getTempC(probe.address);
+  if (probe.temperature_c == DEVICE_DISCONNECTED_C) {
+    is_measuring_ = false;
+    return {.wait = {},
+            .error = ErrorResult(type(), probeError(read_error_, probe))};
+  }
+  next_probe_++;
+  if (next_probe_ >= probes_.size()) {
+    return {.wait = {}};
+  }
+  return {.wait = std::chrono::milliseconds(1)};
+}
+
+capabilities::GetValues::Result DallasTemperature::getValues() {
+  // Use the values of the last measurement and invalidate them after
+  // returning them
+  if (!is_measuring_ || next_probe_ < probes_.size()) {
+    return {.values = {}, .error = ErrorResult(type(), get_values_error_)};
+  }
+  is_measuring_ = false;
+
+  capabilities::GetValues::Result result;
+  result.values.reserve(probes_.size());
+  for (const Probe& probe : probes_) {
+    result.values.push_back(utils::ValueUnit{
+        .value = probe.temperature_c,
+        .data_point_type = probe.data_point_type});
+  }
+  return result;
+}
+
+bool DallasTemperature::parseAddress(const char* hex, DeviceAddress& address) {
+  if (!hex || strlen(hex) != sizeof(DeviceAddress) * 2) {
+    return false;
+  }
+  for (size_t i = 0; i < sizeof(DeviceAddress); i++) {
+    const char byte[] = {hex[i * 2], hex[i * 2 + 1], '\0'};
+    if (!isxdigit(byte[0]) || !isxdigit(byte[1])) {
+      return false;
+    }
+    address[i] = strtoul(byte, nullptr, 16);
+  }
+  // The last byte is the CRC of the family code and serial number
+  return OneWire::crc8(address, sizeof(DeviceAddress) - 1) ==
+         address[sizeof(DeviceAddress) - 1];
+}
+
+String DallasTemperature::probeError(const __FlashStringHelper* error,
+                                     const Probe& probe) {
+  String message(error);
+  message += F(": ");
+  for (uint8_t byte : probe.address) {
+    if (byte < 0x10) {
+      message += '0';
+    }
+    message += String(byte, HEX);
+  }
+  return message;
+}
+
+std::shared_ptr<Peripheral> DallasTemperature::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<DallasTemperature>(parameters);
+}
+
+constexpr uint8_t DallasTemperature::default_resolution_;
+
+const __FlashStringHelper* DallasTemperature::pin_key_ = FPSTR("pin");
+const __FlashStringHelper* DallasTemperature::pin_key_error_ =
+    FPSTR("Missing property: pin (unsigned int)");
+const __FlashStringHelper* DallasTemperature::resolution_key_ =
+    FPSTR("resolution");
+const __FlashStringHelper* DallasTemperature::resolution_key_error_ =
+    FPSTR("Invalid resolution (9 - 12 bits)");
+const __FlashStringHelper* DallasTemperature::probes_key_ = FPSTR("probes");
+const __FlashStringHelper* DallasTemperature::probes_key_error_ = FPSTR(
+    "Missing property: probes (array of address (hex) and data_point_type)");
+const __FlashStringHelper* DallasTemperature::address_key_ = FPSTR("address");
+const __FlashStringHelper* DallasTemperature::data_point_type_key_ =
+    FPSTR("data_point_type");
+const __FlashStringHelper* DallasTemperature::probe_missing_error_ =
+    FPSTR("Probe not found");
+const __FlashStringHelper* DallasTemperature::read_error_ =
+    FPSTR("Failed to read probe");
+const __FlashStringHelper* DallasTemperature::not_started_error_ =
+    FPSTR("Not started");
+
+}  // namespace dallas_temperature
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <DallasTemperature.h>
+#include <OneWire.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "managers/service_getters.h"
+#include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/start_measurement.h"
+#include "peripheral/peripheral.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace dallas_temperature {
+
+/**
+ * Peripheral for DS18B20 and compatible temperature probes on a 1-Wire bus
+ *
+ * A measurement sends a single Convert T command to all probes on the bus, so
+ * that they convert in parallel. Once the resolution dependent conversion
+ * time passed, the scratchpads are read one probe per call to not block the
+ * scheduler. Ten probes thereby take one conversion time instead of ten.
+ */
+class DallasTemperature : public Peripheral,
+                          public capabilities::GetValues,
+                          public capabilities::StartMeasurement {
+ public:
+  DallasTemperature(const JsonObjectConst& parameters);
+  virtual ~DallasTemperature() = default;
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
+
+  /**
+   * Starts the conversion of all probes on the bus
+   *
+   * \param parameters Unused
+   * \return The conversion time of the configured resolution
+   */
+  capabilities::StartMeasurement::Result startMeasurement(
+      const JsonVariantConst& parameters) final;
+
+  /**
+   * Reads the scratchpad of the next probe once the conversion completed
+   *
+   * \return The time to wait, if an error occured or if all probes were read
+   */
+  capabilities::StartMeasurement::Result handleMeasurement() final;
+
+  /**
+   * Returns the temperatures of the last measurement
+   *
+   * Invalidates the values after returning them. Repeat startMeasurement for
+   * new values.
+   *
+   * \return The temperatures in °C in the order of the probes
+   */
+  capabilities::GetValues::Result getValues() final;
+
+ private:
+  struct Probe {
+    DeviceAddress address;
+    utils::UUID data_point_type;
+    float temperature_c;
+  };
+
+  /**
+   * Parses a 1-Wire ROM address
+   *
+   * \param hex The address as 16 hex characters, e.g. 28FF641E8B160326
+   * \param address The parsed address
+   * \return True if the address is valid
+   */
+  static bool parseAddress(const char* hex, DeviceAddress& address);
+
+  /**
+   * Generates an error for a probe that did not respond
+   *
+   * \param error The error's description
+   * \param probe The probe that failed
+   * \return The error message including the probe's address
+   */
+  static String probeError(const __FlashStringHelper* error,
+                           const Probe& probe);
+
+  OneWire one_wire_;
+  ::DallasTemperature driver_;
+  std::vector<Probe> probes_;
+  uint8_t resolution_;
+
+  /// When the conversion of all probes is expected to be done
+  std::chrono::steady_clock::time_point ready_at_;
+  /// Index of the next probe to read. Equals the probe count when done
+  size_t next_probe_ = 0;
+  bool is_measuring_ = false;
+
+  static constexpr uint8_t default_resolution_ = 12;
+
+  static const __FlashStringHelper* pin_key_;
+  static const __FlashStringHelper* pin_key_error_;
+  static const __FlashStringHelper* resolution_key_;
+  static const __FlashStringHelper* resolution_key_error_;
+  static const __FlashStringHelper* probes_key_;
+  static const __FlashStringHelper* probes_key_error_;
+  static const __FlashStringHelper* address_key_;
+  static const __FlashStringHelper* data_point_type_key_;
+  static const __FlashStringHelper* probe_missing_error_;
+  static const __FlashStringHelper* read_error_;
+  static const __FlashStringHelper* not_started_error_;
+};
+
+}  // namespace dallas_temperature
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -1,12 +1,19 @@
 #include "digital_in.h"
 
+#include <algorithm>
+
 #include "peripheral/peripheral_factory.h"
+#include "utils/error_store.h"
+#include "utils/esp_timer_sync.h"
 
 namespace inamata {
 namespace peripheral {
 namespace peripherals {
 namespace digital_in {
 
+constexpr size_t DigitalIn::edge_buffer_size;
+constexpr size_t DigitalIn::max_edge_waiters;
+
 DigitalIn::DigitalIn(const JsonObjectConst& parameters) {
   // Get the pin # for the GPIO output and validate data. Invalidate on error
   int pin = toPin(parameters[pin_key_]);
@@ -43,6 +50,64 @@ DigitalIn::DigitalIn(const JsonObjectConst& parameters) {
     setInvalid(input_type_key_error_);
     return;
   }
+
+  // Optionally capture the edges by interrupt instead of polling the pin
+  edge_capture_ = parameters[edge_capture_key_] | false;
+  if (!edge_capture_) {
+    return;
+  }
+  JsonVariantConst debounce_us = parameters[debounce_us_key_];
+  if (!debounce_us.isNull() && !debounce_us.is<uint32_t>()) {
+    setInvalid(debounce_us_key_error_);
+    return;
+  }
+  debounce_us_ = debounce_us | 0;
+  JsonVariantConst edge_count_data_point_type =
+      parameters[edge_count_data_point_type_key_];
+  if (!edge_count_data_point_type.isNull()) {
+    edge_count_data_point_type_ = utils::UUID(edge_count_data_point_type);
+    if (!edge_count_data_point_type_.isValid()) {
+      setInvalid(ErrorStore::genMissingProperty(
+          edge_count_data_point_type_key_, ErrorStore::KeyType::kUUID));
+      return;
+    }
+  }
+
+#ifdef ESP32
+  for (auto& edge_waiter : edge_waiters_) {
+    edge_waiter.store(nullptr);
+  }
+  const esp_timer_create_args_t timer_args = {
+      .callback = onSettleTimer,
+      .arg = this,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "digital_in",
+      .skip_unhandled_events = false,
+  };
+  if (esp_timer_create(&timer_args, &settle_timer_) != ESP_OK) {
+    settle_timer_ = nullptr;
+    setInvalid(settle_timer_error_);
+    return;
+  }
+#endif
+  state_ = digitalRead(pin_);
+  attachInterruptArg(pin_, onEdge, this, CHANGE);
+}
+
+DigitalIn::~DigitalIn() {
+  if (edge_capture_) {
+    detachInterrupt(pin_);
+  }
+#ifdef ESP32
+  if (settle_timer_) {
+    // A running callback may arm the timer again, so stop it once more after
+    // waiting for the callback
+    esp_timer_stop(settle_timer_);
+    utils::waitForTimerCallbacks();
+    esp_timer_stop(settle_timer_);
+    esp_timer_delete(settle_timer_);
+  }
+#endif
 }
 
 const String& DigitalIn::getType() const { return type(); }
@@ -52,23 +117,189 @@ const String& DigitalIn::type() {
   return name;
 }
 
+capabilities::GetValues* DigitalIn::asGetValues() { return this; }
+
 capabilities::GetValues::Result DigitalIn::getValues() {
-  return {.values = {
-              utils::ValueUnit{.value = static_cast<float>(digitalRead(pin_)),
-                               .data_point_type = data_point_type_}}};
+  capabilities::GetValues::Result result = {
+      .values = {utils::ValueUnit{.value = static_cast<float>(getState()),
+                                  .data_point_type = data_point_type_}}};
+  if (edge_count_data_point_type_.isValid()) {
+    result.values.push_back(
+        utils::ValueUnit{.value = static_cast<float>(getEdgeCount()),
+                         .data_point_type = edge_count_data_point_type_});
+  }
+  return result;
+}
+
+const utils::UUID& DigitalIn::getDataPointType() const {
+  return data_point_type_;
+}
+
+bool DigitalIn::isEdgeCapture() const { return edge_capture_; }
+
+uint32_t DigitalIn::getEdgeCount() {
+  settle();
+  return edge_count_.load(std::memory_order_acquire);
+}
+
+uint32_t DigitalIn::getLastEdgeTime() const { return last_edge_us_; }
+
+bool DigitalIn::getState() {
+  if (!edge_capture_) {
+    return digitalRead(pin_);
+  }
+  settle();
+  return state_;
+}
+
+uint32_t DigitalIn::readEdges(uint32_t& index, std::vector<Edge>& edges) {
+  // Skip the edges that have already been overwritten
+  uint32_t count = getEdgeCount();
+  uint32_t skipped = 0;
+  if (count - index > edge_buffer_size) {
+    skipped = count - index - edge_buffer_size;
+    index = count - edge_buffer_size;
+  }
+
+  const size_t first = edges.size();
+  const uint32_t first_index = index;
+  for (; index != count; index++) {
+    edges.push_back(edges_[index % edge_buffer_size]);
+  }
+
+  // Drop the copied edges that the interrupt overwrote in the meantime
+  count = getEdgeCount();
+  if (count - first_index > edge_buffer_size) {
+    const uint32_t overwritten =
+        std::min<uint32_t>(count - first_index - edge_buffer_size,
+                           edges.size() - first);
+    edges.erase(edges.begin() + first, edges.begin() + first + overwritten);
+    skipped += overwritten;
+  }
+  return skipped;
+}
+
+#ifdef ESP32
+bool DigitalIn::addEdgeWaiter(StatusRequest* signal) {
+  for (auto& edge_waiter : edge_waiters_) {
+    StatusRequest* expected = nullptr;
+    if (edge_waiter.compare_exchange_strong(expected, signal)) {
+      return true;
+    }
+  }
+  return false;
 }
 
+void DigitalIn::removeEdgeWaiter(StatusRequest* signal) {
+  for (auto& edge_waiter : edge_waiters_) {
+    StatusRequest* expected = signal;
+    edge_waiter.compare_exchange_strong(expected, nullptr);
+  }
+  // The interrupt runs on the same core, so it is not using the signal after
+  // it was unregistered. The settle timer's callback runs on the other core
+  // and may still hold it
+  utils::waitForTimerCallbacks();
+}
+#endif
+
+void IRAM_ATTR DigitalIn::onEdge(void* arg) {
+  DigitalIn& digital_in = *static_cast<DigitalIn*>(arg);
+  bool is_recorded = false;
+#ifdef ESP32
+  portENTER_CRITICAL_ISR(&digital_in.edge_lock_);
+#endif
+  const uint32_t now = micros();
+  const bool state = digitalRead(digital_in.pin_);
+
+  // Ignore bounces after an edge, but sample the pin again once the debounce
+  // time ended, as the ignored edge may have been the last one of a pulse
+  const uint32_t count = digital_in.edge_count_.load(std::memory_order_relaxed);
+  const uint32_t since_edge_us = now - digital_in.last_edge_us_;
+  if (count && since_edge_us < digital_in.debounce_us_) {
+    if (!digital_in.is_settling_) {
+      digital_in.is_settling_ = true;
+#ifdef ESP32
+      esp_timer_start_once(digital_in.settle_timer_,
+                           digital_in.debounce_us_ - since_edge_us);
+#endif
+    }
+  } else if (state != digital_in.state_) {
+    digital_in.recordEdge(now, state);
+    is_recorded = true;
+  }
+#ifdef ESP32
+  portEXIT_CRITICAL_ISR(&digital_in.edge_lock_);
+  if (is_recorded) {
+    digital_in.wakeEdgeWaiters();
+  }
+#endif
+}
+
+void IRAM_ATTR DigitalIn::recordEdge(uint32_t time_us, bool state) {
+  const uint32_t count = edge_count_.load(std::memory_order_relaxed);
+  edges_[count % edge_buffer_size] = {.time_us = time_us, .state = state};
+  state_ = state;
+  last_edge_us_ = time_us;
+  edge_count_.store(count + 1, std::memory_order_release);
+}
+
+void DigitalIn::settle() {
+  if (!is_settling_) {
+    return;
+  }
+
+  bool is_recorded = false;
+#ifdef ESP32
+  portENTER_CRITICAL(&edge_lock_);
+#else
+  noInterrupts();
+#endif
+  const uint32_t now = micros();
+  const uint32_t since_edge_us = now - last_edge_us_;
+  if (is_settling_ && since_edge_us >= debounce_us_) {
+    is_settling_ = false;
+    const bool state = digitalRead(pin_);
+    if (state != state_) {
+      recordEdge(now, state);
+      is_recorded = true;
+    }
+  } else if (is_settling_) {
+#ifdef ESP32
+    // An edge was recorded after the timer was started. Fails without harm
+    // if the timer is still running
+    esp_timer_start_once(settle_timer_, debounce_us_ - since_edge_us);
+#endif
+  }
+#ifdef ESP32
+  portEXIT_CRITICAL(&edge_lock_);
+  if (is_recorded) {
+    wakeEdgeWaiters();
+  }
+#else
+  interrupts();
+#endif
+}
+
+#ifdef ESP32
+void DigitalIn::onSettleTimer(void* arg) {
+  static_cast<DigitalIn*>(arg)->settle();
+}
+
+void IRAM_ATTR DigitalIn::wakeEdgeWaiters() {
+  for (auto& edge_waiter : edge_waiters_) {
+    StatusRequest* signal = edge_waiter.load(std::memory_order_relaxed);
+    if (signal) {
+      signal->signalComplete();
+    }
+  }
+}
+#endif
+
 std::shared_ptr<Peripheral> DigitalIn::factory(
     const ServiceGetters& services, const JsonObjectConst& parameters) {
   return std::make_shared<DigitalIn>(parameters);
 }
 
-bool DigitalIn::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool DigitalIn::capability_get_values_ =
-    capabilities::GetValues::registerType(type());
-
 const __FlashStringHelper* DigitalIn::pin_key_ = FPSTR("pin");
 const __FlashStringHelper* DigitalIn::pin_key_error_ =
     FPSTR("Missing property: pin (unsigned int)");
@@ -80,6 +311,15 @@ const __FlashStringHelper* DigitalIn::input_type_floating = FPSTR("floating");
 const __FlashStringHelper* DigitalIn::input_type_pullup = FPSTR("pullup");
 const __FlashStringHelper* DigitalIn::input_type_pulldown = FPSTR("pulldown");
 
+const __FlashStringHelper* DigitalIn::edge_capture_key_ = FPSTR("edge_capture");
+const __FlashStringHelper* DigitalIn::debounce_us_key_ = FPSTR("debounce_us");
+const __FlashStringHelper* DigitalIn::debounce_us_key_error_ =
+    FPSTR("Wrong property: debounce_us (uint32_t)");
+const __FlashStringHelper* DigitalIn::settle_timer_error_ =
+    FPSTR("Failed to create the debounce timer");
+const __FlashStringHelper* DigitalIn::edge_count_data_point_type_key_ =
+    FPSTR("edge_count_data_point_type");
+
 }  // namespace digital_in
 }  // namespace peripherals
 }  // namespace peripheral
@@ -1,40 +1,203 @@
 #pragma once
 
 #include <ArduinoJson.h>
+#include <TaskSchedulerDeclarations.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
 
 #include "managers/service_getters.h"
 #include "peripheral/capabilities/get_values.h"
 #include "peripheral/peripheral.h"
 
+#ifdef ESP32
+#include <esp_timer.h>
+#endif
+
 namespace inamata {
 namespace peripheral {
 namespace peripherals {
 namespace digital_in {
 
 /**
- * Peripheral to control a GPIO output
+ * Peripheral to read a GPIO input
+ *
+ * In the edge capture mode, a GPIO interrupt records each debounced edge with
+ * its time into a ring buffer, so that short pulses are not missed between
+ * polls. Readers keep their own position in the buffer. On the ESP32, tasks
+ * can register a status request that the interrupt completes on each edge.
  */
 class DigitalIn : public Peripheral, public capabilities::GetValues {
  public:
+  /// A change of the input's state
+  struct Edge {
+    /// Time of the edge (micros())
+    uint32_t time_us;
+    /// The state after the edge
+    bool state;
+  };
+
   DigitalIn(const JsonObjectConst& parameters);
-  virtual ~DigitalIn() = default;
+  virtual ~DigitalIn();
 
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameter);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
 
   /**
    * Get the GPIO state
    *
+   * In the edge capture mode, the debounced state and optionally the number
+   * of edges are returned.
+   *
    * \return The value 1 represents the high state, 0 its low state
    */
   capabilities::GetValues::Result getValues() final;
 
+  /**
+   * Gets the data point type of the input's state
+   *
+   * \return The data point type
+   */
+  const utils::UUID& getDataPointType() const;
+
+  /**
+   * Checks if edges are captured by the interrupt
+   *
+   * \return True in the edge capture mode
+   */
+  bool isEdgeCapture() const;
+
+  /**
+   * Gets the number of captured edges, which is also the index of the next
+   *
+   * \return The number of edges since the peripheral was created
+   */
+  uint32_t getEdgeCount();
+
+  /**
+   * Gets the time of the last captured edge
+   *
+   * \return The time in micros() or 0 if none was captured
+   */
+  uint32_t getLastEdgeTime() const;
+
+  /**
+   * Gets the state of the input
+   *
+   * \return The debounced state in the edge capture mode, else the pin state
+   */
+  bool getState();
+
+  /**
+   * Copies the edges captured since the given index
+   *
+   * Edges that were overwritten before they could be read are skipped.
+   *
+   * \param index The index of the next edge to read. Advanced past the edges
+   * \param edges Receives the edges in the order they occured
+   * \return The number of skipped edges
+   */
+  uint32_t readEdges(uint32_t& index, std::vector<Edge>& edges);
+
+#ifdef ESP32
+  /**
+   * Registers a status request to be completed on each edge
+   *
+   * \param signal The status request. Has to be set waiting by the task
+   * \return False if too many are registered
+   */
+  bool addEdgeWaiter(StatusRequest* signal);
+
+  /**
+   * Unregisters a status request
+   *
+   * Waits for a running settle timer callback, after which the status request
+   * can be deleted.
+   *
+   * \param signal The status request to no longer complete
+   */
+  void removeEdgeWaiter(StatusRequest* signal);
+#endif
+
+  /// Number of edges that are kept until they are overwritten
+  static constexpr size_t edge_buffer_size = 32;
+  /// Maximum number of status requests completed on an edge
+  static constexpr size_t max_edge_waiters = 4;
+
  private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameter);
-  static bool registered_;
-  static bool capability_get_values_;
+  /**
+   * Records a debounced edge. Runs in the interrupt context
+   *
+   * \param arg The peripheral that captures the edges
+   */
+  static void IRAM_ATTR onEdge(void* arg);
+
+  /**
+   * Adds an edge to the ring buffer. The edges have to be locked
+   *
+   * \param time_us Time of the edge (micros())
+   * \param state The state after the edge
+   */
+  void IRAM_ATTR recordEdge(uint32_t time_us, bool state);
+
+  /**
+   * Records the level the pin settled at after ignored edges
+   *
+   * Edges within the debounce time are ignored, including the one ending a
+   * pulse shorter than it. Once the debounce time ended, the pin is sampled
+   * again and its level is recorded if it differs from the state.
+   */
+  void settle();
+
+#ifdef ESP32
+  /**
+   * Settles the pin once the debounce time ended. Runs in the esp_timer task
+   *
+   * \param arg The peripheral that captures the edges
+   */
+  static void onSettleTimer(void* arg);
+
+  /**
+   * Completes the registered status requests
+   */
+  void IRAM_ATTR wakeEdgeWaiters();
+#endif
+
+  bool edge_capture_ = false;
+  /// Time after an edge in which further edges are ignored
+  uint32_t debounce_us_ = 0;
+
+  /// Ring buffer of edges. Written by the interrupt only. A plain array, so
+  /// that no accessor has to be placed in IRAM
+  Edge edges_[edge_buffer_size];
+  std::atomic<uint32_t> edge_count_{0};
+  volatile uint32_t last_edge_us_ = 0;
+  volatile bool state_ = false;
+  /// Whether edges were ignored and the pin has to be sampled again
+  volatile bool is_settling_ = false;
+#ifdef ESP32
+  std::array<std::atomic<StatusRequest*>, max_edge_waiters> edge_waiters_;
+  /// Samples the pin once the debounce time after an ignored edge ended
+  esp_timer_handle_t settle_timer_ = nullptr;
+  /// Guards the edges against the interrupt and the settle timer
+  portMUX_TYPE edge_lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+  /// Data point type for the number of edges, if reported
+  utils::UUID edge_count_data_point_type_{nullptr};
+
+  static const __FlashStringHelper* edge_capture_key_;
+  static const __FlashStringHelper* debounce_us_key_;
+  static const __FlashStringHelper* debounce_us_key_error_;
+  static const __FlashStringHelper* settle_timer_error_;
+  static const __FlashStringHelper* edge_count_data_point_type_key_;
 
   /// The pin to be used as a GPIO output
   unsigned int pin_;
@@ -66,6 +66,8 @@ const String& DigitalOut::type() {
   return name;
 }
 
+capabilities::SetValue* DigitalOut::asSetValue() { return this; }
+
 void DigitalOut::setValue(utils::ValueUnit value_unit) {
   if (value_unit.data_point_type != data_point_type_) {
     web_socket_->sendError(type(), value_unit.sourceUnitError(data_point_type_));
@@ -90,12 +92,6 @@ std::shared_ptr<Peripheral> DigitalOut::factory(
   return std::make_shared<DigitalOut>(services, parameters);
 }
 
-bool DigitalOut::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool DigitalOut::capability_set_value_ =
-    capabilities::SetValue::registerType(type());
-
 const __FlashStringHelper* DigitalOut::pin_key_ = FPSTR("pin");
 const __FlashStringHelper* DigitalOut::pin_key_error_ =
     FPSTR("Missing property: pin (unsigned int)");
@@ -22,6 +22,11 @@ class DigitalOut : public Peripheral, public capabilities::SetValue {
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameter);
+
+  // Capabilities supported by the peripheral
+  capabilities::SetValue* asSetValue() final;
 
   /**
    * Turns the GPIO on or off
@@ -31,11 +36,6 @@ class DigitalOut : public Peripheral, public capabilities::SetValue {
   void setValue(utils::ValueUnit value_unit) final;
 
  private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameter);
-  static bool registered_;
-  static bool capability_set_value_;
-
   /// Interface to send data to the server
   std::shared_ptr<WebSocket> web_socket_;
 
@@ -0,0 +1,160 @@
+#ifndef MINIMAL_BUILD
+#include "ezo_group.h"
+
+#include <algorithm>
+
+#include "managers/services.h"
+#include "peripheral/peripheral_factory.h"
+#include "peripheral/peripherals/as_ec_meter/as_ec_meter.h"
+#include "peripheral/peripherals/as_ph_meter/as_ph_meter.h"
+#include "peripheral/peripherals/as_rtd_meter/as_rtd_meter.h"
+#include "utils/error_store.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace ezo_group {
+
+EzoGroup::EzoGroup(const JsonObjectConst& parameters) {
+  JsonArrayConst ezo_boards = parameters[ezo_boards_key_];
+  if (ezo_boards.isNull() || ezo_boards.size() == 0) {
+    setInvalid(ezo_boards_key_error_);
+    return;
+  }
+
+  boards_.reserve(ezo_boards.size());
+  for (JsonVariantConst ezo_board : ezo_boards) {
+    utils::UUID uuid(ezo_board);
+    if (!uuid.isValid()) {
+      setInvalid(ezo_boards_key_error_);
+      return;
+    }
+
+    // Since the UUIDs are specified externally, check the types
+    std::shared_ptr<Peripheral> peripheral =
+        Services::getPeripheralController().getPeripheral(uuid);
+    if (!peripheral || !isEzoBoard(peripheral->getType()) ||
+        !peripheral->isValid()) {
+      setInvalid(ErrorStore::genNotAValid(uuid, F("EZO board")));
+      return;
+    }
+    // A board measured twice at once would mix up its replies
+    const bool is_duplicate =
+        std::any_of(boards_.begin(), boards_.end(),
+                    [&peripheral](const Board& board) {
+                      return board.peripheral == peripheral;
+                    });
+    if (is_duplicate) {
+      setInvalid(ezo_boards_duplicate_error_);
+      return;
+    }
+    boards_.push_back(
+        Board{.peripheral = peripheral,
+              .start_measurement = peripheral->asStartMeasurement(),
+              .get_values = peripheral->asGetValues(),
+              .ready_at = {},
+              .is_done = true});
+  }
+}
+
+const String& EzoGroup::getType() const { return type(); }
+
+const String& EzoGroup::type() {
+  static const String name{"EzoGroup"};
+  return name;
+}
+
+capabilities::GetValues* EzoGroup::asGetValues() { return this; }
+
+capabilities::StartMeasurement* EzoGroup::asStartMeasurement() { return this; }
+
+capabilities::StartMeasurement::Result EzoGroup::startMeasurement(
+    const JsonVariantConst& parameters) {
+  // Send the read commands back-to-back, so that all boards convert at once
+  const auto now = std::chrono::steady_clock::now();
+  for (Board& board : boards_) {
+    auto result = board.start_measurement->startMeasurement(parameters);
+    if (result.error.isError()) {
+      stopMeasurement();
+      return result;
+    }
+    board.ready_at = now + result.wait;
+    board.is_done = false;
+  }
+  return handleMeasurement();
+}
+
+capabilities::StartMeasurement::Result EzoGroup::handleMeasurement() {
+  // Poll the boards that should be ready. Unstable ones start their next
+  // reading without waiting for the others
+  const auto now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point next_ready_at =
+      std::chrono::steady_clock::time_point::max();
+  for (Board& board : boards_) {
+    if (board.is_done) {
+      continue;
+    }
+    if (board.ready_at <= now) {
+      auto result = board.start_measurement->handleMeasurement();
+      if (result.error.isError()) {
+        stopMeasurement();
+        return result;
+      }
+      if (result.wait.count() == 0) {
+        board.is_done = true;
+        continue;
+      }
+      board.ready_at = now + result.wait;
+    }
+    next_ready_at = std::min(next_ready_at, board.ready_at);
+  }
+
+  if (next_ready_at == std::chrono::steady_clock::time_point::max()) {
+    return {.wait = {}};
+  }
+  return {.wait = next_ready_at - now};
+}
+
+capabilities::GetValues::Result EzoGroup::getValues() {
+  capabilities::GetValues::Result result;
+  for (Board& board : boards_) {
+    auto board_result = board.get_values->getValues();
+    if (board_result.error.isError()) {
+      return board_result;
+    }
+    result.values.insert(result.values.end(), board_result.values.begin(),
+                         board_result.values.end());
+  }
+  return result;
+}
+
+void EzoGroup::stopMeasurement() {
+  // Boards that already started finish their reading on their own
+  for (Board& board : boards_) {
+    board.is_done = true;
+  }
+}
+
+bool EzoGroup::isEzoBoard(const String& type) {
+  return type == as_ec_meter::AsEcMeterI2C::type() ||
+         type == as_ph_meter::AsPhMeterI2C::type() ||
+         type == as_rtd_meter::AsRtdMeterI2C::type();
+}
+
+std::shared_ptr<Peripheral> EzoGroup::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<EzoGroup>(parameters);
+}
+
+const __FlashStringHelper* EzoGroup::ezo_boards_key_ = FPSTR("ezo_boards");
+const __FlashStringHelper* EzoGroup::ezo_boards_key_error_ =
+    FPSTR("Missing property: ezo_boards (uuid array)");
+const __FlashStringHelper* EzoGroup::ezo_boards_duplicate_error_ =
+    FPSTR("ezo_boards contains a board more than once");
+
+}  // namespace ezo_group
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
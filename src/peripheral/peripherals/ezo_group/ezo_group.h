@@ -0,0 +1,105 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "managers/service_getters.h"
+#include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/start_measurement.h"
+#include "peripheral/peripheral.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace ezo_group {
+
+/**
+ * Measures several Atlas Scientific EZO boards in parallel
+ *
+ * Starts the readings of all boards at once, so that their conversions
+ * overlap. Each board is then polled as soon as its reading is expected to be
+ * ready and repeats its reading until stable, independently of the others. A
+ * measurement thereby takes about one conversion time instead of one per
+ * board.
+ *
+ * The boards should not be measured individually while the group measures.
+ */
+class EzoGroup : public Peripheral,
+                 public capabilities::GetValues,
+                 public capabilities::StartMeasurement {
+ public:
+  EzoGroup(const JsonObjectConst& parameters);
+  virtual ~EzoGroup() = default;
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
+
+  /**
+   * Starts the readings of all boards
+   *
+   * \param parameters Passed to each board. Optionally accepts temperature_c
+   *     for the temperature compensation of EC and pH readings
+   * \return The time until the first reading is ready
+   */
+  capabilities::StartMeasurement::Result startMeasurement(
+      const JsonVariantConst& parameters) final;
+
+  /**
+   * Polls the boards whose readings are expected to be ready
+   *
+   * \return The time until the next pending reading is ready, if an error
+   *     occured or if all readings are stable
+   */
+  capabilities::StartMeasurement::Result handleMeasurement() final;
+
+  /**
+   * Gets the stable readings of all boards
+   *
+   * \return The values of all boards in the order of the boards
+   */
+  capabilities::GetValues::Result getValues() final;
+
+ private:
+  struct Board {
+    std::shared_ptr<Peripheral> peripheral;
+    capabilities::StartMeasurement* start_measurement;
+    capabilities::GetValues* get_values;
+    /// When the board's reading is expected to be ready
+    std::chrono::steady_clock::time_point ready_at;
+    bool is_done;
+  };
+
+  /**
+   * Checks if the peripheral is one of the EZO boards
+   *
+   * \param type The peripheral's type
+   * \return True if it can be added to the group
+   */
+  static bool isEzoBoard(const String& type);
+
+  /**
+   * Stops polling the boards, so that a failed measurement is not continued
+   */
+  void stopMeasurement();
+
+  std::vector<Board> boards_;
+
+  static const __FlashStringHelper* ezo_boards_key_;
+  static const __FlashStringHelper* ezo_boards_key_error_;
+  static const __FlashStringHelper* ezo_boards_duplicate_error_;
+};
+
+}  // namespace ezo_group
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
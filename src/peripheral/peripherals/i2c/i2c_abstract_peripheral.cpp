@@ -1,6 +1,8 @@
+#ifdef ESP32
 #include "i2c_abstract_peripheral.h"
 
 #include "managers/services.h"
+#include "peripheral/peripherals/i2c/i2c_mux.h"
 
 namespace inamata {
 namespace peripheral {
@@ -8,6 +10,12 @@ namespace peripherals {
 namespace i2c {
 
 I2CAbstractPeripheral::I2CAbstractPeripheral(const JsonObjectConst& parameter) {
+  // Devices behind a multiplexer are accessed via the multiplexer's adapter
+  if (!parameter[i2c_mux_key_].isNull()) {
+    setMux(parameter);
+    return;
+  }
+
   utils::UUID i2c_adapter_uuid(parameter[i2c_adapter_key_]);
   if (!i2c_adapter_uuid.isValid()) {
     setInvalid(i2c_adapter_key_error_);
@@ -18,21 +26,37 @@ I2CAbstractPeripheral::I2CAbstractPeripheral(const JsonObjectConst& parameter) {
       Services::getPeripheralController().getPeripheral(i2c_adapter_uuid);
 
   // Since the UUID is specified externally, check the type
-  if (peripheral->getType() == util::I2CAdapter::type() &&
+  if (peripheral && peripheral->getType() == util::I2CAdapter::type() &&
       peripheral->isValid()) {
     i2c_adapter_ = std::static_pointer_cast<util::I2CAdapter>(peripheral);
   } else {
-    setInvalid(invalidI2CAdapterError(i2c_adapter_uuid, peripheral->getType()));
+    setInvalid(
+        invalidI2CAdapterError(i2c_adapter_uuid, util::I2CAdapter::type()));
     return;
   }
 }
 
+I2CAbstractPeripheral::~I2CAbstractPeripheral() {
+  // Prevent callbacks of queued transactions from using this peripheral
+  if (i2c_adapter_) {
+    i2c_adapter_->getBus().cancel(this);
+  }
+}
+
 TwoWire* I2CAbstractPeripheral::getWire() { return i2c_adapter_->getWire(); }
 
+I2CBus::Lock I2CAbstractPeripheral::lockBus(uint8_t i2c_address) {
+  return I2CBus::Lock(i2c_adapter_->getBus(), i2c_address, route_);
+}
+
+bool I2CAbstractPeripheral::queueTransaction(I2CTransaction transaction) {
+  transaction.owner = this;
+  transaction.route = route_;
+  return i2c_adapter_->getBus().queue(std::move(transaction));
+}
+
 bool I2CAbstractPeripheral::isDeviceConnected(uint16_t i2c_address) {
-  getWire()->beginTransmission(i2c_address);
-  byte error = Wire.endTransmission();
-  return error == 0;
+  return i2c_adapter_->getBus().isDevicePresent(i2c_address, route_);
 }
 
 String I2CAbstractPeripheral::missingI2CDeviceError(int i2c_address) {
@@ -41,6 +65,34 @@ String I2CAbstractPeripheral::missingI2CDeviceError(int i2c_address) {
   return error;
 }
 
+void I2CAbstractPeripheral::setMux(const JsonObjectConst& parameter) {
+  utils::UUID i2c_mux_uuid(parameter[i2c_mux_key_]);
+  if (!i2c_mux_uuid.isValid()) {
+    setInvalid(i2c_mux_key_error_);
+    return;
+  }
+
+  std::shared_ptr<Peripheral> peripheral =
+      Services::getPeripheralController().getPeripheral(i2c_mux_uuid);
+  if (!peripheral || peripheral->getType() != I2CMux::type() ||
+      !peripheral->isValid()) {
+    setInvalid(invalidI2CAdapterError(i2c_mux_uuid, I2CMux::type()));
+    return;
+  }
+
+  JsonVariantConst mux_channel = parameter[mux_channel_key_];
+  if (!mux_channel.is<int>() || mux_channel.as<int>() < 0 ||
+      mux_channel.as<int>() >= I2CMux::channel_count) {
+    setInvalid(mux_channel_key_error_);
+    return;
+  }
+
+  i2c_mux_ = std::static_pointer_cast<I2CMux>(peripheral);
+  i2c_adapter_ = i2c_mux_->getAdapter();
+  route_.mux_address = i2c_mux_->getAddress();
+  route_.channel = mux_channel.as<int>();
+}
+
 String I2CAbstractPeripheral::invalidI2CAdapterError(const utils::UUID& uuid,
                                                      const String& type) {
   String error = uuid.toString();
@@ -57,8 +109,18 @@ const __FlashStringHelper* I2CAbstractPeripheral::i2c_adapter_key_ =
     FPSTR("i2c_adapter");
 const __FlashStringHelper* I2CAbstractPeripheral::i2c_adapter_key_error_ =
     FPSTR("Missing property: i2c_adapter (uuid)");
+const __FlashStringHelper* I2CAbstractPeripheral::i2c_mux_key_ =
+    FPSTR("i2c_mux");
+const __FlashStringHelper* I2CAbstractPeripheral::i2c_mux_key_error_ =
+    FPSTR("Missing property: i2c_mux (uuid)");
+const __FlashStringHelper* I2CAbstractPeripheral::mux_channel_key_ =
+    FPSTR("mux_channel");
+const __FlashStringHelper* I2CAbstractPeripheral::mux_channel_key_error_ =
+    FPSTR("Missing property: mux_channel (0 - 7)");
 
 }  // namespace i2c_adapter
 }  // namespace peripherals
 }  // namespace peripheral
 }  // namespace inamata
+
+#endif
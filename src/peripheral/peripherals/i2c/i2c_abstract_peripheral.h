@@ -10,18 +10,62 @@ namespace peripheral {
 namespace peripherals {
 namespace i2c {
 
+class I2CMux;
+
 /**
  * Interface for sensors to access peripherals over the I2C bus
+ *
+ * Peripherals behind a multiplexer reference it and its channel instead of the
+ * adapter. Their transactions and locks then select the channel first.
  */
 class I2CAbstractPeripheral : public Peripheral {
  public:
   I2CAbstractPeripheral(const JsonObjectConst& parameters);
-  virtual ~I2CAbstractPeripheral() = default;
+  virtual ~I2CAbstractPeripheral();
 
   static const String& type();
 
  protected:
+  /**
+   * Gets the I2C interface for drivers that access the bus directly
+   *
+   * Hold a lock from lockBus() while using it.
+   *
+   * \return The adapter's I2C interface
+   */
   TwoWire* getWire();
+
+  /**
+   * Gets exclusive access to the bus for drivers that access it directly
+   *
+   * Serializes the access with queued transactions and accounts the time to
+   * the device.
+   *
+   * \param i2c_address The address of the device being accessed
+   * \return The lock which is released when going out of scope
+   */
+  I2CBus::Lock lockBus(uint8_t i2c_address);
+
+  /**
+   * Queues a transaction on the adapter's bus without blocking
+   *
+   * The callback is run by the scheduler once the transaction completed. It
+   * is not run if this peripheral is deleted in the meantime.
+   *
+   * \param transaction The transaction to execute
+   * \return False if the bus queue is full
+   */
+  bool queueTransaction(I2CTransaction transaction);
+
+  /**
+   * Checks if the device is connected to the bus
+   *
+   * Uses the bus' health cache and only probes the device if it has not
+   * recently completed a transaction successfully.
+   *
+   * \param i2c_address The address of the device
+   * \return True if the device is connected
+   */
   bool isDeviceConnected(uint16_t i2c_address);
 
   static String missingI2CDeviceError(int i2c_address);
@@ -30,13 +74,27 @@ class I2CAbstractPeripheral : public Peripheral {
   static const __FlashStringHelper* i2c_address_key_error_;
 
  private:
+  /**
+   * Uses the adapter of the multiplexer and routes via its channel
+   *
+   * \param parameter The peripheral's parameters with the multiplexer
+   */
+  void setMux(const JsonObjectConst& parameter);
+
   static String invalidI2CAdapterError(const utils::UUID& uuid,
                                        const String& type);
 
   static const __FlashStringHelper* i2c_adapter_key_;
   static const __FlashStringHelper* i2c_adapter_key_error_;
+  static const __FlashStringHelper* i2c_mux_key_;
+  static const __FlashStringHelper* i2c_mux_key_error_;
+  static const __FlashStringHelper* mux_channel_key_;
+  static const __FlashStringHelper* mux_channel_key_error_;
 
   std::shared_ptr<peripherals::util::I2CAdapter> i2c_adapter_;
+  /// Keeps the multiplexer registered while this peripheral uses it
+  std::shared_ptr<I2CMux> i2c_mux_;
+  I2CRoute route_;
 };
 
 }  // namespace i2c_adapter
@@ -2,6 +2,7 @@
 
 #include "i2c_adapter.h"
 
+#include "managers/services.h"
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -34,6 +35,16 @@ I2CAdapter::I2CAdapter(const ServiceGetters& services,
     return;
   }
 
+  // The clock of all devices or, with auto-tuning, the highest one to try
+  const uint32_t frequency = parameter[frequency_key_] | default_frequency_;
+  const bool auto_tune = parameter[auto_tune_key_] | false;
+  const uint32_t min_frequency =
+      auto_tune ? i2c::I2CBus::tune_clocks_hz[0] : 1;
+  if (frequency < min_frequency || frequency > max_frequency_) {
+    setInvalid(frequency_error_);
+    return;
+  }
+
   if (!wire_taken) {
     taken_variable = &wire_taken;
     wire_ = &Wire;
@@ -47,10 +58,18 @@ I2CAdapter::I2CAdapter(const ServiceGetters& services,
   }
 
   *taken_variable = true;
-  wire_->begin(data_pin, clock_pin, 0);
+  bus_.reset(
+      new i2c::I2CBus(*wire_, Services::getScheduler(), frequency, auto_tune));
+  wire_->begin(data_pin, clock_pin, bus_->getStartClock());
+  if (!bus_->isValid()) {
+    setInvalid(bus_error_);
+    return;
+  }
 }
 
 I2CAdapter::~I2CAdapter() {
+  // Stop the bus' worker before releasing the wire
+  bus_.reset();
   if (taken_variable) {
     *taken_variable = false;
   }
@@ -65,13 +84,22 @@ const String& I2CAdapter::type() {
 
 TwoWire* I2CAdapter::getWire() { return wire_; }
 
+i2c::I2CBus& I2CAdapter::getBus() { return *bus_; }
+
 std::shared_ptr<Peripheral> I2CAdapter::factory(
     const ServiceGetters& services, const JsonObjectConst& parameter) {
   return std::make_shared<I2CAdapter>(services, parameter);
 }
 
-bool I2CAdapter::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
+constexpr uint32_t I2CAdapter::default_frequency_;
+constexpr uint32_t I2CAdapter::max_frequency_;
+
+const __FlashStringHelper* I2CAdapter::frequency_key_ = FPSTR("frequency");
+const __FlashStringHelper* I2CAdapter::auto_tune_key_ = FPSTR("auto_tune");
+const __FlashStringHelper* I2CAdapter::frequency_error_ =
+    FPSTR("Invalid frequency: up to 1 MHz, at least 100 kHz for auto_tune");
+const __FlashStringHelper* I2CAdapter::bus_error_ =
+    FPSTR("Failed to start I2C bus worker");
 
 }  // namespace util
 }  // namespace peripherals
@@ -2,8 +2,11 @@
 
 #include <Wire.h>
 
+#include <memory>
+
 #include "managers/service_getters.h"
 #include "peripheral/peripheral.h"
+#include "peripheral/peripherals/i2c/i2c_bus.h"
 
 namespace inamata {
 namespace peripheral {
@@ -12,6 +15,10 @@ namespace util {
 
 /**
  * The driver for an I2C interface that supports both hardware I2C controllers
+ *
+ * Each adapter owns a bus scheduler that lets peripherals queue transactions
+ * instead of blocking the main loop. The clock is either fixed or auto-tuned
+ * per device.
  */
 class I2CAdapter : public Peripheral {
  public:
@@ -20,22 +27,37 @@ class I2CAdapter : public Peripheral {
 
   const String& getType() const final;
   static const String& type();
-
-  TwoWire* getWire();
-
- private:
   static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
                                              const JsonObjectConst&);
 
-  static bool registered_;
+  TwoWire* getWire();
+
+  /**
+   * Gets the scheduler for asynchronous transactions on this adapter's bus
+   *
+   * \return The bus of the adapter
+   */
+  i2c::I2CBus& getBus();
 
+ private:
   static bool wire_taken;
   static bool wire1_taken;
 
   std::shared_ptr<WebSocket> web_socket_;
 
-  bool* taken_variable;
-  TwoWire* wire_;
+  bool* taken_variable = nullptr;
+  TwoWire* wire_ = nullptr;
+  std::unique_ptr<i2c::I2CBus> bus_;
+
+  /// Default clock (standard mode)
+  static constexpr uint32_t default_frequency_ = 100000;
+  /// Highest clock supported by the controller (fast mode plus)
+  static constexpr uint32_t max_frequency_ = 1000000;
+
+  static const __FlashStringHelper* frequency_key_;
+  static const __FlashStringHelper* auto_tune_key_;
+  static const __FlashStringHelper* frequency_error_;
+  static const __FlashStringHelper* bus_error_;
 };
 
 }  // namespace util
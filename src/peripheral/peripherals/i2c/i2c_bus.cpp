@@ -0,0 +1,503 @@
+#ifdef ESP32
+
+#include "i2c_bus.h"
+
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace i2c {
+
+constexpr std::chrono::seconds I2CBus::presence_timeout;
+constexpr uint8_t I2CBus::max_reordered;
+constexpr uint16_t I2CBus::unknown_channels;
+constexpr uint32_t I2CBus::tune_clocks_hz[];
+constexpr uint8_t I2CBus::tune_window;
+constexpr uint8_t I2CBus::max_window_errors;
+
+I2CBus::Lock::Lock(I2CBus& bus, uint8_t address, const I2CRoute& route)
+    : bus_(bus.isValid() ? &bus : nullptr), address_(address), route_(route) {
+  if (bus_) {
+    xSemaphoreTakeRecursive(bus_->bus_mutex_, portMAX_DELAY);
+  }
+  start_us_ = esp_timer_get_time();
+  if (!bus_) {
+    return;
+  }
+  bus_->applyClock(address_, route_);
+  if (!bus_->select(route_)) {
+    outcome_ = Outcome::kFailure;
+  }
+}
+
+I2CBus::Lock::Lock(Lock&& other)
+    : bus_(other.bus_),
+      address_(other.address_),
+      route_(other.route_),
+      start_us_(other.start_us_),
+      outcome_(other.outcome_) {
+  other.bus_ = nullptr;
+}
+
+I2CBus::Lock::~Lock() {
+  if (!bus_) {
+    return;
+  }
+  const std::chrono::microseconds bus_time(esp_timer_get_time() - start_us_);
+  xSemaphoreGiveRecursive(bus_->bus_mutex_);
+  bus_->account(address_, route_, bus_time, outcome_);
+}
+
+void I2CBus::Lock::setSuccess(bool success) {
+  outcome_ = success ? Outcome::kSuccess : Outcome::kFailure;
+}
+
+I2CBus::I2CBus(TwoWire& wire, Scheduler& scheduler, uint32_t clock_hz,
+               bool auto_tune)
+    : Task(std::chrono::milliseconds(1).count(), TASK_FOREVER, &scheduler,
+           false),
+      wire_(wire),
+      port_(&wire == &Wire1 ? I2C_NUM_1 : I2C_NUM_0),
+      clock_hz_(clock_hz),
+      auto_tune_(auto_tune) {
+  queue_mutex_ = xSemaphoreCreateMutex();
+  bus_mutex_ = xSemaphoreCreateRecursiveMutex();
+  worker_stopped_ = xSemaphoreCreateBinary();
+  if (!queue_mutex_ || !bus_mutex_ || !worker_stopped_) {
+    return;
+  }
+  if (xTaskCreate(runWorker, "i2c_bus", 3072, this, 1, &worker_) != pdPASS) {
+    worker_ = nullptr;
+  }
+}
+
+I2CBus::~I2CBus() {
+  if (worker_) {
+    // Let the worker finish its current transaction and exit by itself, as
+    // deleting it could leave the bus mutex taken
+    stop_worker_ = true;
+    xTaskNotifyGive(worker_);
+    xSemaphoreTake(worker_stopped_, portMAX_DELAY);
+  }
+  if (worker_stopped_) {
+    vSemaphoreDelete(worker_stopped_);
+  }
+  if (bus_mutex_) {
+    vSemaphoreDelete(bus_mutex_);
+  }
+  if (queue_mutex_) {
+    vSemaphoreDelete(queue_mutex_);
+  }
+}
+
+bool I2CBus::isValid() const { return worker_ != nullptr; }
+
+bool I2CBus::queue(I2CTransaction transaction) {
+  if (!isValid() ||
+      transaction.write_length > I2CTransaction::max_data_length ||
+      transaction.read_length > I2CTransaction::max_data_length ||
+      transaction.register_count > I2CTransaction::max_data_length ||
+      (transaction.register_count &&
+       (transaction.write_length || transaction.read_length))) {
+    return false;
+  }
+
+  xSemaphoreTake(queue_mutex_, portMAX_DELAY);
+  const bool has_space = pending_.size() < max_queue_length;
+  if (has_space) {
+    pending_.push_back(std::move(transaction));
+  }
+  xSemaphoreGive(queue_mutex_);
+  if (!has_space) {
+    return false;
+  }
+
+  xTaskNotifyGive(worker_);
+  enableIfNot();
+  return true;
+}
+
+void I2CBus::cancel(const void* owner) {
+  if (!isValid()) {
+    return;
+  }
+
+  const auto is_owner = [owner](const I2CTransaction& transaction) {
+    return transaction.owner == owner;
+  };
+  xSemaphoreTake(queue_mutex_, portMAX_DELAY);
+  pending_.erase(std::remove_if(pending_.begin(), pending_.end(), is_owner),
+                 pending_.end());
+  completed_.erase(
+      std::remove_if(completed_.begin(), completed_.end(), is_owner),
+      completed_.end());
+  if (in_flight_owner_ == owner) {
+    in_flight_cancelled_ = true;
+  }
+  xSemaphoreGive(queue_mutex_);
+}
+
+bool I2CBus::addMux(uint8_t mux_address) {
+  if (!isValid()) {
+    return false;
+  }
+
+  xSemaphoreTakeRecursive(bus_mutex_, portMAX_DELAY);
+  // A second multiplexer would remove the first one's registration
+  const bool registered =
+      std::any_of(muxes_.begin(), muxes_.end(), [mux_address](const Mux& mux) {
+        return mux.address == mux_address;
+      });
+  if (!registered) {
+    muxes_.push_back(
+        Mux{.address = mux_address, .channels = unknown_channels});
+  }
+  xSemaphoreGiveRecursive(bus_mutex_);
+  return !registered;
+}
+
+void I2CBus::removeMux(uint8_t mux_address) {
+  if (!isValid()) {
+    return;
+  }
+
+  // Close the channels so that its devices don't conflict with others
+  xSemaphoreTakeRecursive(bus_mutex_, portMAX_DELAY);
+  wire_.beginTransmission(mux_address);
+  wire_.write(0);
+  wire_.endTransmission();
+  muxes_.erase(std::remove_if(muxes_.begin(), muxes_.end(),
+                              [mux_address](const Mux& mux) {
+                                return mux.address == mux_address;
+                              }),
+               muxes_.end());
+  xSemaphoreGiveRecursive(bus_mutex_);
+}
+
+uint32_t I2CBus::getMuxSwitchCount() const { return mux_switch_count_; }
+
+bool I2CBus::isDevicePresent(uint8_t address, const I2CRoute& route) {
+  if (!isValid()) {
+    return false;
+  }
+
+  xSemaphoreTake(queue_mutex_, portMAX_DELAY);
+  auto stats = std::find_if(device_stats_.begin(), device_stats_.end(),
+                            [address, &route](const DeviceStats& stats) {
+                              return stats.address == address &&
+                                     stats.route == route;
+                            });
+  const bool is_recent =
+      stats != device_stats_.end() && stats->consecutive_errors == 0 &&
+      stats->last_success_us != 0 &&
+      esp_timer_get_time() - stats->last_success_us <
+          std::chrono::microseconds(presence_timeout).count();
+  xSemaphoreGive(queue_mutex_);
+  if (is_recent) {
+    return true;
+  }
+
+  // Probe with an empty write. The result updates the device's health
+  Lock lock(*this, address, route);
+  wire_.beginTransmission(address);
+  const bool is_present = wire_.endTransmission() == 0;
+  lock.setSuccess(is_present);
+  return is_present;
+}
+
+std::vector<I2CBus::DeviceStats> I2CBus::getDeviceStats() const {
+  if (!isValid()) {
+    return {};
+  }
+
+  xSemaphoreTake(queue_mutex_, portMAX_DELAY);
+  std::vector<DeviceStats> device_stats = device_stats_;
+  xSemaphoreGive(queue_mutex_);
+  return device_stats;
+}
+
+uint32_t I2CBus::getStartClock() const {
+  return auto_tune_ ? tune_clocks_hz[0] : clock_hz_;
+}
+
+bool I2CBus::Callback() {
+  // Take all completed transactions at once to not hold the lock while the
+  // callbacks run. Callbacks may queue follow-up transactions
+  xSemaphoreTake(queue_mutex_, portMAX_DELAY);
+  std::deque<I2CTransaction> completed;
+  completed.swap(completed_);
+  const bool is_idle = pending_.empty() && !in_flight_owner_;
+  xSemaphoreGive(queue_mutex_);
+
+  for (const I2CTransaction& transaction : completed) {
+    if (transaction.callback) {
+      transaction.callback(transaction);
+    }
+  }
+
+  // Sleep until the next transaction is queued
+  if (is_idle && completed.empty()) {
+    disable();
+  }
+  return !completed.empty();
+}
+
+void I2CBus::runWorker(void* arg) {
+  I2CBus* bus = static_cast<I2CBus*>(arg);
+  I2CRoute selected;
+  while (!bus->stop_worker_) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    while (!bus->stop_worker_) {
+      xSemaphoreTake(bus->queue_mutex_, portMAX_DELAY);
+      if (bus->pending_.empty()) {
+        xSemaphoreGive(bus->queue_mutex_);
+        break;
+      }
+      const auto next = bus->pending_.begin() + bus->pickPending(selected);
+      I2CTransaction transaction = std::move(*next);
+      bus->pending_.erase(next);
+      bus->in_flight_owner_ = transaction.owner;
+      bus->in_flight_cancelled_ = false;
+      xSemaphoreGive(bus->queue_mutex_);
+
+      xSemaphoreTakeRecursive(bus->bus_mutex_, portMAX_DELAY);
+      bus->applyClock(transaction.address, transaction.route);
+      if (bus->select(transaction.route)) {
+        bus->execute(transaction);
+      } else {
+        transaction.error = I2CTransaction::mux_error;
+      }
+      xSemaphoreGiveRecursive(bus->bus_mutex_);
+      selected = transaction.route;
+      bus->account(transaction.address, transaction.route,
+                   transaction.bus_time,
+                   transaction.error ? Outcome::kFailure : Outcome::kSuccess,
+                   transaction.error);
+
+      xSemaphoreTake(bus->queue_mutex_, portMAX_DELAY);
+      if (!bus->in_flight_cancelled_) {
+        bus->completed_.push_back(std::move(transaction));
+      }
+      bus->in_flight_owner_ = nullptr;
+      xSemaphoreGive(bus->queue_mutex_);
+    }
+  }
+
+  xSemaphoreGive(bus->worker_stopped_);
+  vTaskDelete(nullptr);
+}
+
+void I2CBus::execute(I2CTransaction& transaction) {
+  const int64_t start_us = esp_timer_get_time();
+
+  // Write the data or probe the device. Keep the bus for a repeated start if
+  // data is to be read
+  transaction.error = 0;
+  if (transaction.register_count) {
+    executeRegisterReads(transaction);
+  } else if (transaction.write_length || !transaction.read_length) {
+    wire_.beginTransmission(transaction.address);
+    wire_.write(transaction.data, transaction.write_length);
+    transaction.error = wire_.endTransmission(transaction.read_length == 0);
+  }
+
+  if (!transaction.error && transaction.read_length &&
+      !transaction.register_count) {
+    const size_t received =
+        wire_.requestFrom(static_cast<uint16_t>(transaction.address),
+                          static_cast<size_t>(transaction.read_length), true);
+    for (size_t i = 0; i < received && i < transaction.read_length; i++) {
+      transaction.data[i] = wire_.read();
+    }
+    if (received != transaction.read_length) {
+      transaction.error = I2CTransaction::read_error;
+    }
+  }
+
+  transaction.bus_time =
+      std::chrono::microseconds(esp_timer_get_time() - start_us);
+}
+
+void I2CBus::executeRegisterReads(I2CTransaction& transaction) {
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  if (!cmd) {
+    transaction.error = I2CTransaction::read_error;
+    return;
+  }
+
+  // Select each register and read it, only stopping after the last one
+  const uint8_t write_address = transaction.address << 1 | I2C_MASTER_WRITE;
+  const uint8_t read_address = transaction.address << 1 | I2C_MASTER_READ;
+  uint8_t values[I2CTransaction::max_data_length];
+  for (uint8_t i = 0; i < transaction.register_count; i++) {
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, write_address, true);
+    i2c_master_write_byte(cmd, transaction.data[i], true);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, read_address, true);
+    i2c_master_read_byte(cmd, &values[i], I2C_MASTER_NACK);
+  }
+  i2c_master_stop(cmd);
+  const esp_err_t error =
+      i2c_master_cmd_begin(port_, cmd, pdMS_TO_TICKS(wire_.getTimeOut()));
+  i2c_cmd_link_delete(cmd);
+
+  // The IDF driver does not tell address and data NACKs apart
+  if (error == ESP_OK) {
+    std::copy(values, values + transaction.register_count, transaction.data);
+  } else if (error == ESP_FAIL) {
+    transaction.error = I2CTransaction::address_nack_error;
+  } else if (error == ESP_ERR_TIMEOUT) {
+    transaction.error = I2CTransaction::timeout_error;
+  } else {
+    transaction.error = I2CTransaction::read_error;
+  }
+}
+
+bool I2CBus::select(const I2CRoute& route) {
+  for (Mux& mux : muxes_) {
+    // Close the channels of other multiplexers, as their devices may have the
+    // same addresses
+    const uint16_t channels =
+        mux.address == route.mux_address ? 1 << route.channel : 0;
+    if (mux.channels == channels) {
+      continue;
+    }
+    wire_.beginTransmission(mux.address);
+    wire_.write(static_cast<uint8_t>(channels));
+    mux_switch_count_++;
+    if (wire_.endTransmission() != 0) {
+      mux.channels = unknown_channels;
+      return false;
+    }
+    mux.channels = channels;
+  }
+  return true;
+}
+
+size_t I2CBus::pickPending(const I2CRoute& selected) {
+  // Prefer the selected channel, but bound how often older transactions on
+  // other channels are skipped
+  if (reordered_count_ < max_reordered) {
+    for (size_t i = 0; i < pending_.size(); i++) {
+      if (pending_[i].route == selected) {
+        reordered_count_ = i ? reordered_count_ + 1 : 0;
+        return i;
+      }
+    }
+  }
+  reordered_count_ = 0;
+  return 0;
+}
+
+void I2CBus::applyClock(uint8_t address, const I2CRoute& route) {
+  uint32_t clock_hz = getStartClock();
+  if (auto_tune_) {
+    xSemaphoreTake(queue_mutex_, portMAX_DELAY);
+    auto stats = std::find_if(device_stats_.begin(), device_stats_.end(),
+                              [address, &route](const DeviceStats& stats) {
+                                return stats.address == address &&
+                                       stats.route == route;
+                              });
+    if (stats != device_stats_.end()) {
+      clock_hz = stats->clock_hz;
+    }
+    xSemaphoreGive(queue_mutex_);
+  }
+
+  if (clock_hz != current_clock_hz_) {
+    wire_.setClock(clock_hz);
+    current_clock_hz_ = clock_hz;
+  }
+}
+
+void I2CBus::account(uint8_t address, const I2CRoute& route,
+                     std::chrono::microseconds bus_time, Outcome outcome,
+                     uint8_t error) {
+  xSemaphoreTake(queue_mutex_, portMAX_DELAY);
+  auto stats = std::find_if(device_stats_.begin(), device_stats_.end(),
+                            [address, &route](const DeviceStats& stats) {
+                              return stats.address == address &&
+                                     stats.route == route;
+                            });
+  if (stats == device_stats_.end()) {
+    device_stats_.push_back(DeviceStats{.address = address,
+                                        .route = route,
+                                        .transactions = 0,
+                                        .errors = 0,
+                                        .nacks = 0,
+                                        .timeouts = 0,
+                                        .consecutive_errors = 0,
+                                        .last_success_us = 0,
+                                        .bus_time = {},
+                                        .clock_hz = getStartClock(),
+                                        .max_clock_hz = clock_hz_,
+                                        .window_transactions = 0,
+                                        .window_errors = 0});
+    stats = device_stats_.end() - 1;
+  }
+
+  // Only tune devices that responded before, as absent devices would
+  // otherwise be slowed down
+  if (auto_tune_ && stats->last_success_us &&
+      outcome != Outcome::kUnknown) {
+    stats->window_transactions++;
+    if (outcome == Outcome::kFailure) {
+      stats->window_errors++;
+    }
+    if (stats->window_transactions >= tune_window) {
+      tune(*stats);
+    }
+  }
+
+  stats->transactions++;
+  if (error == I2CTransaction::address_nack_error ||
+      error == I2CTransaction::data_nack_error) {
+    stats->nacks++;
+  } else if (error == I2CTransaction::timeout_error) {
+    stats->timeouts++;
+  }
+  if (outcome == Outcome::kFailure) {
+    stats->errors++;
+    if (stats->consecutive_errors < UINT16_MAX) {
+      stats->consecutive_errors++;
+    }
+  } else if (outcome == Outcome::kSuccess) {
+    stats->consecutive_errors = 0;
+    stats->last_success_us = esp_timer_get_time();
+  }
+  stats->bus_time += bus_time;
+  xSemaphoreGive(queue_mutex_);
+}
+
+void I2CBus::tune(DeviceStats& stats) {
+  const uint32_t* const begin = std::begin(tune_clocks_hz);
+  const uint32_t* const end = std::end(tune_clocks_hz);
+  const uint32_t* current = std::find(begin, end, stats.clock_hz);
+
+  if (stats.window_errors > max_window_errors) {
+    // Step down and don't try the failing clock again
+    if (current != begin && current != end) {
+      stats.max_clock_hz = *(current - 1);
+      stats.clock_hz = stats.max_clock_hz;
+    }
+  } else if (stats.window_errors == 0 && current != end &&
+             current + 1 != end && *(current + 1) <= stats.max_clock_hz) {
+    stats.clock_hz = *(current + 1);
+  }
+
+  stats.window_transactions = 0;
+  stats.window_errors = 0;
+}
+
+}  // namespace i2c
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+#include <Wire.h>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#ifdef ESP32
+#include <driver/i2c.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace i2c {
+
+/**
+ * The path to a device behind an optional I2C multiplexer (TCA9548A)
+ */
+struct I2CRoute {
+  /// Address of the multiplexer or 0 if the device is directly on the bus
+  uint8_t mux_address = 0;
+  /// Channel of the multiplexer the device is connected to
+  uint8_t channel = 0;
+
+  bool operator==(const I2CRoute& other) const {
+    return mux_address == other.mux_address && channel == other.channel;
+  }
+  bool operator!=(const I2CRoute& other) const { return !(*this == other); }
+};
+
+/**
+ * A single write and / or read transaction with a device on the I2C bus
+ *
+ * The write bytes are sent first. If a read length is set, the bytes are then
+ * read with a repeated start and replace the written bytes in the data buffer.
+ *
+ * Alternatively, several registers can be read one byte each in a single
+ * sequence, with repeated starts instead of stops in between.
+ */
+struct I2CTransaction {
+  /// Maximum number of bytes written or read by a single transaction
+  static constexpr size_t max_data_length = 32;
+
+  /// Error code if the device did not acknowledge its address
+  static constexpr uint8_t address_nack_error = 2;
+  /// Error code if the device did not acknowledge the written data
+  static constexpr uint8_t data_nack_error = 3;
+  /// Error code if fewer bytes than requested were read
+  static constexpr uint8_t read_error = 4;
+  /// Error code if the bus timed out, e.g. due to clock stretching
+  static constexpr uint8_t timeout_error = 5;
+  /// Error code if the multiplexer channel could not be selected
+  static constexpr uint8_t mux_error = 6;
+
+  /// The 7-bit address of the device
+  uint8_t address = 0;
+  /// The multiplexer channel the device is connected to, if any
+  I2CRoute route;
+  /// The bytes to write, replaced by the read bytes
+  uint8_t data[max_data_length];
+  /// Number of bytes in data to write
+  uint8_t write_length = 0;
+  /// Number of bytes to read into data after writing
+  uint8_t read_length = 0;
+  /// Number of registers in data to read one byte each in a single sequence.
+  /// Their values replace the registers. For devices that only keep values
+  /// spread over several registers consistent without a stop in between.
+  /// Excludes write_length and read_length
+  uint8_t register_count = 0;
+  /// Called from the scheduler once the transaction completed
+  std::function<void(const I2CTransaction&)> callback;
+
+  /// TwoWire error code (0 on success, 2 address NACK, 3 data NACK, 4 other,
+  /// 5 timeout, 6 mux error)
+  uint8_t error = 0;
+  /// Time the transaction occupied the bus
+  std::chrono::microseconds bus_time{0};
+  /// The peripheral that queued the transaction. Used to cancel callbacks
+  const void* owner = nullptr;
+};
+
+/**
+ * Schedules transactions on an I2C bus without blocking the main loop
+ *
+ * Transactions are queued by peripherals and executed by a FreeRTOS worker
+ * task. Completed transactions are handed back to the scheduler, where their
+ * callbacks are run. All pending completions are handled in one scheduler pass
+ * so that several devices on a bus are serviced at once.
+ *
+ * Drivers that access the TwoWire instance directly have to hold a Lock while
+ * doing so, which serializes them with the worker and also accounts their bus
+ * time.
+ *
+ * Devices behind registered multiplexers are reached by selecting their
+ * channel first. The selected channel of each multiplexer is cached, so that
+ * it is only switched when needed, and pending transactions on the selected
+ * channel are executed first to reduce the number of switches.
+ *
+ * The clock is set per device. With auto-tuning, each device starts at the
+ * lowest standard clock and is stepped up while its transactions succeed. It
+ * is stepped down, and not raised past that clock again, if too many of its
+ * transactions fail, e.g. due to long cables.
+ */
+class I2CBus : public Task {
+ public:
+  /// Bus usage and health of a single device
+  struct DeviceStats {
+    uint8_t address;
+    I2CRoute route;
+    uint32_t transactions;
+    uint32_t errors;
+    /// Failed transactions due to a missing acknowledge
+    uint32_t nacks;
+    /// Failed transactions due to a bus timeout
+    uint32_t timeouts;
+    /// Failed transactions since the last successful one
+    uint16_t consecutive_errors;
+    /// Time of the last successful transaction (esp_timer) or 0 if none
+    int64_t last_success_us;
+    std::chrono::microseconds bus_time;
+    /// Clock used to access the device
+    uint32_t clock_hz;
+    /// Highest clock the device may be raised to by auto-tuning
+    uint32_t max_clock_hz;
+    /// Transactions and errors in the current auto-tuning window
+    uint8_t window_transactions;
+    uint8_t window_errors;
+  };
+
+  /// Whether a transaction showed the device to be present
+  enum class Outcome { kUnknown, kSuccess, kFailure };
+
+  /**
+   * Exclusive access to the bus while in scope
+   *
+   * Selects the device's multiplexer channel. The time it was held is
+   * accounted to the device's bus time. Drivers that know whether the device
+   * responded should set the outcome so that it is used for the device's
+   * health.
+   */
+  class Lock {
+   public:
+    Lock(I2CBus& bus, uint8_t address, const I2CRoute& route = I2CRoute());
+    Lock(Lock&& other);
+    ~Lock();
+
+    /**
+     * Records whether the device responded while the lock was held
+     *
+     * \param success True if the device responded as expected
+     */
+    void setSuccess(bool success);
+
+   private:
+    I2CBus* bus_;
+    uint8_t address_;
+    I2CRoute route_;
+    int64_t start_us_;
+    Outcome outcome_ = Outcome::kUnknown;
+  };
+
+  /**
+   * Starts the worker task and registers the completion handler
+   *
+   * \param wire The initialized I2C interface to use
+   * \param scheduler The scheduler to run the callbacks from
+   * \param clock_hz The clock of all devices or the highest to auto-tune to
+   * \param auto_tune Whether to tune the clock per device by its error rate
+   */
+  I2CBus(TwoWire& wire, Scheduler& scheduler, uint32_t clock_hz,
+         bool auto_tune);
+  virtual ~I2CBus();
+
+  /**
+   * Check if the worker task and its resources were created
+   *
+   * \return True if transactions can be queued
+   */
+  bool isValid() const;
+
+  /**
+   * Add a transaction to the end of the queue
+   *
+   * \param transaction The transaction to execute
+   * \return False if the queue is full or the transaction is malformed
+   */
+  bool queue(I2CTransaction transaction);
+
+  /**
+   * Drop all queued and completed transactions of a peripheral
+   *
+   * Has to be called when a peripheral is destroyed, so that no callbacks are
+   * run on a deleted peripheral. An in-flight transaction is finished, but its
+   * callback is not run.
+   *
+   * \param owner The peripheral that queued the transactions
+   */
+  void cancel(const void* owner);
+
+  /**
+   * Registers a multiplexer so that its channels can be selected
+   *
+   * \param mux_address The address of the multiplexer
+   * \return False if the bus is invalid or the address is already registered
+   */
+  bool addMux(uint8_t mux_address);
+
+  /**
+   * Unregisters a multiplexer after closing its channels
+   *
+   * \param mux_address The address of the multiplexer
+   */
+  void removeMux(uint8_t mux_address);
+
+  /**
+   * Gets the number of multiplexer channel switches
+   *
+   * \return The number of writes to multiplexers
+   */
+  uint32_t getMuxSwitchCount() const;
+
+  /**
+   * Checks if a device is present, preferably without using the bus
+   *
+   * Presence is inferred from the device's recent successful transactions.
+   * The device is only probed with an empty write if its last transaction
+   * failed, it has not been seen yet or not within the presence timeout.
+   *
+   * \param address The address of the device
+   * \param route The multiplexer channel the device is connected to
+   * \return True if the device is present
+   */
+  bool isDevicePresent(uint8_t address, const I2CRoute& route = I2CRoute());
+
+  /**
+   * Gets the accumulated bus usage per device
+   *
+   * \return The usage of each device that used the bus
+   */
+  std::vector<DeviceStats> getDeviceStats() const;
+
+  /**
+   * Gets the clock that devices start with
+   *
+   * \return The initial clock in Hz
+   */
+  uint32_t getStartClock() const;
+
+  /**
+   * Runs the callbacks of all completed transactions
+   *
+   * \return True if a transaction was completed
+   */
+  bool Callback() final;
+
+  /// Maximum number of transactions waiting to be executed
+  static constexpr size_t max_queue_length = 16;
+
+  /// Time after a successful transaction until a device is probed again
+  static constexpr std::chrono::seconds presence_timeout{60};
+
+  /// Maximum number of transactions on the selected channel that may be run
+  /// before older ones on other channels
+  static constexpr uint8_t max_reordered = 8;
+
+  /// Standard clocks that auto-tuning steps between (standard, fast and fast
+  /// mode plus)
+  static constexpr uint32_t tune_clocks_hz[] = {100000, 400000, 1000000};
+  /// Number of a device's transactions after which its clock is tuned
+  static constexpr uint8_t tune_window = 32;
+  /// Failed transactions per window that are tolerated without stepping down
+  static constexpr uint8_t max_window_errors = 1;
+
+ private:
+  /// Multiplexer and its selected channels
+  struct Mux {
+    uint8_t address;
+    /// Bit mask of the open channels or unknown_channels
+    uint16_t channels;
+  };
+  static constexpr uint16_t unknown_channels = 0x100;
+
+  static void runWorker(void* arg);
+  void execute(I2CTransaction& transaction);
+  /// Reads the transaction's registers with repeated starts. The Arduino
+  /// interface ends each read with a stop, so the IDF driver is used
+  void executeRegisterReads(I2CTransaction& transaction);
+  /// Selects the route's channel and closes those of other multiplexers. Has
+  /// to be called while holding the bus mutex
+  bool select(const I2CRoute& route);
+  /// Picks the next pending transaction, preferring the selected channel.
+  /// Has to be called while holding the queue mutex
+  size_t pickPending(const I2CRoute& selected);
+  /// Sets the clock of a device if it differs from the current one. Has to be
+  /// called while holding the bus mutex
+  void applyClock(uint8_t address, const I2CRoute& route);
+  void account(uint8_t address, const I2CRoute& route,
+               std::chrono::microseconds bus_time, Outcome outcome,
+               uint8_t error = 0);
+  /// Steps the device's clock up or down by its errors in the last window
+  void tune(DeviceStats& stats);
+
+  TwoWire& wire_;
+#ifdef ESP32
+  /// The IDF port of the interface
+  const i2c_port_t port_;
+#endif
+
+  std::deque<I2CTransaction> pending_;
+  std::deque<I2CTransaction> completed_;
+  /// Owner of the transaction being executed by the worker
+  const void* in_flight_owner_ = nullptr;
+  /// Whether the in-flight transaction's callback was cancelled
+  bool in_flight_cancelled_ = false;
+  std::vector<DeviceStats> device_stats_;
+  /// Guarded by the bus mutex
+  std::vector<Mux> muxes_;
+  uint32_t mux_switch_count_ = 0;
+  /// Transactions run before older ones in a row
+  uint8_t reordered_count_ = 0;
+
+  /// Clock of all devices or the highest clock to auto-tune to
+  const uint32_t clock_hz_;
+  const bool auto_tune_;
+  /// Clock the interface is currently set to. Guarded by the bus mutex
+  uint32_t current_clock_hz_ = 0;
+
+#ifdef ESP32
+  /// Guards the queues, in-flight state and stats
+  SemaphoreHandle_t queue_mutex_ = nullptr;
+  /// Serializes bus access between the worker and direct drivers
+  SemaphoreHandle_t bus_mutex_ = nullptr;
+  /// Given by the worker once it exited
+  SemaphoreHandle_t worker_stopped_ = nullptr;
+  TaskHandle_t worker_ = nullptr;
+#endif
+  volatile bool stop_worker_ = false;
+};
+
+}  // namespace i2c
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
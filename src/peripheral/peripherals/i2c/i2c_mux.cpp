@@ -0,0 +1,90 @@
+#ifdef ESP32
+
+#include "i2c_mux.h"
+
+#include "managers/services.h"
+#include "peripheral/peripheral_factory.h"
+#include "utils/error_store.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace i2c {
+
+I2CMux::I2CMux(const ServiceGetters& services,
+               const JsonObjectConst& parameters) {
+  utils::UUID i2c_adapter_uuid(parameters[i2c_adapter_key_]);
+  if (!i2c_adapter_uuid.isValid()) {
+    setInvalid(i2c_adapter_key_error_);
+    return;
+  }
+
+  // Since the UUID is specified externally, check the type
+  std::shared_ptr<Peripheral> peripheral =
+      Services::getPeripheralController().getPeripheral(i2c_adapter_uuid);
+  if (!peripheral || peripheral->getType() != util::I2CAdapter::type() ||
+      !peripheral->isValid()) {
+    setInvalid(
+        ErrorStore::genNotAValid(i2c_adapter_uuid, util::I2CAdapter::type()));
+    return;
+  }
+  i2c_adapter_ = std::static_pointer_cast<util::I2CAdapter>(peripheral);
+
+  // The TCA9548A's address pins select one of 0x70 - 0x77
+  const int address = parameters[i2c_address_key_] | default_address_;
+  if (address < default_address_ || address > default_address_ + 7) {
+    setInvalid(i2c_address_error_);
+    return;
+  }
+  // Only set the address once registered, as the destructor unregisters it
+  if (!i2c_adapter_->getBus().addMux(address)) {
+    setInvalid(i2c_address_taken_error_);
+    return;
+  }
+  address_ = address;
+}
+
+I2CMux::~I2CMux() {
+  // Peripherals behind the multiplexer hold a reference to it, so all have
+  // been removed
+  if (address_) {
+    i2c_adapter_->getBus().removeMux(address_);
+  }
+}
+
+const String& I2CMux::getType() const { return type(); }
+
+const String& I2CMux::type() {
+  static const String name{"I2CMux"};
+  return name;
+}
+
+const std::shared_ptr<util::I2CAdapter>& I2CMux::getAdapter() const {
+  return i2c_adapter_;
+}
+
+uint8_t I2CMux::getAddress() const { return address_; }
+
+std::shared_ptr<Peripheral> I2CMux::factory(const ServiceGetters& services,
+                                            const JsonObjectConst& parameters) {
+  return std::make_shared<I2CMux>(services, parameters);
+}
+
+constexpr uint8_t I2CMux::channel_count;
+constexpr uint8_t I2CMux::default_address_;
+
+const __FlashStringHelper* I2CMux::i2c_adapter_key_ = FPSTR("i2c_adapter");
+const __FlashStringHelper* I2CMux::i2c_adapter_key_error_ =
+    FPSTR("Missing property: i2c_adapter (uuid)");
+const __FlashStringHelper* I2CMux::i2c_address_key_ = FPSTR("i2c_address");
+const __FlashStringHelper* I2CMux::i2c_address_error_ =
+    FPSTR("Invalid i2c_address: 0x70 - 0x77");
+const __FlashStringHelper* I2CMux::i2c_address_taken_error_ =
+    FPSTR("i2c_address is used by another I2CMux");
+
+}  // namespace i2c
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+
+#include "managers/service_getters.h"
+#include "peripheral/peripheral.h"
+#include "peripheral/peripherals/i2c/i2c_adapter.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace i2c {
+
+/**
+ * A TCA9548A I2C multiplexer on an I2C adapter's bus
+ *
+ * Registers the multiplexer with the adapter's bus, which then selects the
+ * channel of a device before accessing it. Peripherals behind the multiplexer
+ * reference it instead of the adapter.
+ */
+class I2CMux : public Peripheral {
+ public:
+  I2CMux(const ServiceGetters& services, const JsonObjectConst& parameters);
+  virtual ~I2CMux();
+
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst&);
+
+  /**
+   * Gets the adapter of the bus the multiplexer is connected to
+   *
+   * \return The I2C adapter
+   */
+  const std::shared_ptr<util::I2CAdapter>& getAdapter() const;
+
+  /**
+   * Gets the address of the multiplexer on the bus
+   *
+   * \return The 7-bit I2C address
+   */
+  uint8_t getAddress() const;
+
+  /// Number of channels of the multiplexer
+  static constexpr uint8_t channel_count = 8;
+
+ private:
+  std::shared_ptr<util::I2CAdapter> i2c_adapter_;
+  uint8_t address_ = 0;
+
+  /// Default address with all address pins pulled low
+  static constexpr uint8_t default_address_ = 0x70;
+
+  static const __FlashStringHelper* i2c_adapter_key_;
+  static const __FlashStringHelper* i2c_adapter_key_error_;
+  static const __FlashStringHelper* i2c_address_key_;
+  static const __FlashStringHelper* i2c_address_error_;
+  static const __FlashStringHelper* i2c_address_taken_error_;
+};
+
+}  // namespace i2c
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -1,3 +1,4 @@
+#ifdef ESP32
 #include "i2c_light_sensor.h"
 
 namespace inamata {
@@ -6,9 +7,124 @@ namespace peripherals {
 namespace light_sensor {
 
 I2CLightSensor::I2CLightSensor(const JsonObjectConst& parameter)
-    : I2CAbstractPeripheral(parameter) {}
+    : I2CAbstractPeripheral(parameter) {
+  // If the base class constructor failed, abort the constructor
+  if (!isValid()) {
+    return;
+  }
+
+  lux_data_point_type_ = utils::UUID(parameter[lux_data_point_type_key_]);
+  if (!lux_data_point_type_.isValid()) {
+    setInvalid(lux_data_point_type_key_error_);
+    return;
+  }
+
+  JsonVariantConst i2c_address = parameter[i2c_address_key_];
+  if (!i2c_address.is<uint8_t>()) {
+    setInvalid(i2c_address_key_error_);
+    return;
+  }
+  i2c_address_ = i2c_address;
+
+  if (!isDeviceConnected(i2c_address_)) {
+    setInvalid(missingI2CDeviceError(i2c_address_));
+    return;
+  }
+}
+
+capabilities::GetValues* I2CLightSensor::asGetValues() { return this; }
+
+capabilities::StartMeasurement* I2CLightSensor::asStartMeasurement() {
+  return this;
+}
+
+capabilities::StartMeasurement::Result I2CLightSensor::startMeasurement(
+    const JsonVariantConst& parameters) {
+  // The sensor converts continuously. Wait for a conversion that completes
+  // after this request instead of triggering one
+  const std::chrono::milliseconds integration_time = getIntegrationTime();
+  ready_at_ = std::chrono::steady_clock::now() + integration_time;
+  lux_ = NAN;
+  measurement_state_ = MeasurementState::kIntegrating;
+  return {.wait = integration_time};
+}
+
+capabilities::StartMeasurement::Result I2CLightSensor::handleMeasurement() {
+  if (measurement_state_ == MeasurementState::kIntegrating) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now < ready_at_) {
+      return {.wait = ready_at_ - now};
+    }
+    if (!readLux()) {
+      measurement_state_ = MeasurementState::kIdle;
+      return {.wait = {}, .error = ErrorResult(getType(), queue_error_)};
+    }
+    measurement_state_ = MeasurementState::kReading;
+    return {.wait = transaction_wait_};
+  } else if (measurement_state_ == MeasurementState::kReading) {
+    return {.wait = transaction_wait_};
+  } else if (measurement_state_ == MeasurementState::kDone) {
+    return {.wait = {}};
+  } else if (measurement_state_ == MeasurementState::kFailed) {
+    measurement_state_ = MeasurementState::kIdle;
+    return {.wait = {}, .error = ErrorResult(getType(), error_)};
+  } else {
+    return {.wait = {}, .error = ErrorResult(getType(), not_started_error_)};
+  }
+}
+
+capabilities::GetValues::Result I2CLightSensor::getValues() {
+  // Use the value of the last measurement and invalidate it after returning
+  // it
+  if (measurement_state_ != MeasurementState::kDone) {
+    return {.values = {}, .error = ErrorResult(getType(), get_values_error_)};
+  }
+  measurement_state_ = MeasurementState::kIdle;
+
+  capabilities::GetValues::Result result;
+  result.values.push_back(utils::ValueUnit{
+      .value = lux_, .data_point_type = lux_data_point_type_});
+  return result;
+}
+
+bool I2CLightSensor::queueWrite(const uint8_t* data, uint8_t length) {
+  i2c::I2CTransaction transaction;
+  transaction.address = i2c_address_;
+  memcpy(transaction.data, data, length);
+  transaction.write_length = length;
+  return queueTransaction(std::move(transaction));
+}
+
+void I2CLightSensor::handleLux(float lux) {
+  if (measurement_state_ == MeasurementState::kReading) {
+    lux_ = lux;
+    measurement_state_ = MeasurementState::kDone;
+  }
+}
+
+void I2CLightSensor::handleError(const __FlashStringHelper* error) {
+  if (measurement_state_ == MeasurementState::kReading) {
+    error_ = error;
+    measurement_state_ = MeasurementState::kFailed;
+  }
+}
+
+const std::chrono::milliseconds I2CLightSensor::transaction_wait_{1};
+
+const __FlashStringHelper* I2CLightSensor::lux_data_point_type_key_ =
+    FPSTR("lux_data_point_type");
+const __FlashStringHelper* I2CLightSensor::lux_data_point_type_key_error_ =
+    FPSTR("Missing property: lux_data_point_type (UUID)");
+const __FlashStringHelper* I2CLightSensor::transaction_error_ =
+    FPSTR("I2C transaction failed");
+const __FlashStringHelper* I2CLightSensor::queue_error_ =
+    FPSTR("I2C queue full");
+const __FlashStringHelper* I2CLightSensor::not_started_error_ =
+    FPSTR("Not started");
 
 }  // namespace light_sensor
 }  // namespace peripherals
 }  // namespace peripheral
 }  // namespace inamata
+
+#endif
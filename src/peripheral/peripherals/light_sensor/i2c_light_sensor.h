@@ -1,5 +1,11 @@
 #pragma once
 
+#include <ArduinoJson.h>
+
+#include <chrono>
+
+#include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/start_measurement.h"
 #include "peripheral/peripherals/i2c/i2c_abstract_peripheral.h"
 
 namespace inamata {
@@ -7,10 +13,124 @@ namespace peripheral {
 namespace peripherals {
 namespace light_sensor {
 
-class I2CLightSensor : public peripherals::i2c::I2CAbstractPeripheral {
+/**
+ * Base class for ambient light sensors that measure continuously
+ *
+ * A measurement waits for the sensor's current integration time, so that the
+ * result register holds a conversion that completed after the request, and
+ * then reads it with queued bus transactions. The sensors adapt their range on
+ * their own or in the derived class after each reading.
+ */
+class I2CLightSensor : public peripherals::i2c::I2CAbstractPeripheral,
+                       public capabilities::GetValues,
+                       public capabilities::StartMeasurement {
  public:
   I2CLightSensor(const JsonObjectConst& parameter);
   virtual ~I2CLightSensor() = default;
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
+
+  /**
+   * Starts waiting for a conversion with the current range
+   *
+   * \param parameters Unused
+   * \return The sensor's current integration time
+   */
+  capabilities::StartMeasurement::Result startMeasurement(
+      const JsonVariantConst& parameters) final;
+
+  /**
+   * Reads the result once the integration time passed
+   *
+   * \return The time to wait, if an error occured or if the measurement
+   *     completed
+   */
+  capabilities::StartMeasurement::Result handleMeasurement() final;
+
+  /**
+   * Returns the illuminance of the last measurement
+   *
+   * Invalidates the value after returning it. Repeat startMeasurement for a
+   * new value.
+   *
+   * \return The illuminance in lux
+   */
+  capabilities::GetValues::Result getValues() final;
+
+ protected:
+  /**
+   * Gets the longest time a conversion with the current range can take
+   *
+   * \return The integration time
+   */
+  virtual std::chrono::milliseconds getIntegrationTime() const = 0;
+
+  /**
+   * Queues the transactions to read the result register
+   *
+   * Once read, handleLux() or handleError() has to be called.
+   *
+   * \return False if the transactions could not be queued
+   */
+  virtual bool readLux() = 0;
+
+  /**
+   * Queues a transaction to write bytes to the sensor
+   *
+   * Errors are reported by the next read.
+   *
+   * \param data The bytes to write
+   * \param length The number of bytes to write
+   * \return False if the bus queue is full
+   */
+  bool queueWrite(const uint8_t* data, uint8_t length);
+
+  /**
+   * Stores the result of a completed read
+   *
+   * \param lux The illuminance in lux
+   */
+  void handleLux(float lux);
+
+  /**
+   * Fails the current measurement
+   *
+   * \param error The reason of the failure
+   */
+  void handleError(const __FlashStringHelper* error);
+
+  /// The sensor's I2C address
+  uint8_t i2c_address_;
+
+  static const __FlashStringHelper* transaction_error_;
+
+ private:
+  /// Progress of a measurement through the integration and read
+  enum class MeasurementState {
+    kIdle,
+    kIntegrating,
+    kReading,
+    kDone,
+    kFailed,
+  };
+
+  utils::UUID lux_data_point_type_{nullptr};
+
+  MeasurementState measurement_state_ = MeasurementState::kIdle;
+  /// When a conversion completed after the request
+  std::chrono::steady_clock::time_point ready_at_;
+  float lux_ = NAN;
+  const __FlashStringHelper* error_ = nullptr;
+
+  /// Time between polls for a queued transaction to complete
+  static const std::chrono::milliseconds transaction_wait_;
+
+  static const __FlashStringHelper* lux_data_point_type_key_;
+  static const __FlashStringHelper* lux_data_point_type_key_error_;
+  static const __FlashStringHelper* queue_error_;
+  static const __FlashStringHelper* not_started_error_;
 };
 
 }  // namespace light_sensor
@@ -0,0 +1,92 @@
+#ifdef ESP32
+#include "max44009_sensor.h"
+
+#include "peripheral/peripheral_factory.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace max44009 {
+
+namespace {
+constexpr uint8_t configuration_reg = 0x02;
+constexpr uint8_t lux_high_byte_reg = 0x03;
+constexpr uint8_t lux_low_byte_reg = 0x04;
+/// Continuous conversions with automatic range selection
+constexpr uint8_t continuous_mode = 0x80;
+constexpr uint8_t time_code_mask = 0x07;
+constexpr uint8_t overrange_exponent = 0x0F;
+}  // namespace
+
+Max44009Sensor::Max44009Sensor(const JsonObjectConst& parameter)
+    : light_sensor::I2CLightSensor(parameter) {
+  // If the base class constructor failed, abort the constructor
+  if (!isValid()) {
+    return;
+  }
+
+  const uint8_t configuration[] = {configuration_reg, continuous_mode};
+  queueWrite(configuration, sizeof(configuration));
+}
+
+const String& Max44009Sensor::getType() const { return type(); }
+
+const String& Max44009Sensor::type() {
+  static const String name{"MAX44009"};
+  return name;
+}
+
+std::chrono::milliseconds Max44009Sensor::getIntegrationTime() const {
+  // Round up the 12.5 and 6.25 ms integration times
+  return std::chrono::milliseconds((800 + (1 << time_code_) - 1) >>
+                                   time_code_);
+}
+
+bool Max44009Sensor::readLux() {
+  // The lux bytes only belong to the same conversion if they are read with a
+  // repeated start in between, as a stop lets the sensor update them
+  i2c::I2CTransaction transaction;
+  transaction.address = i2c_address_;
+  transaction.data[0] = lux_high_byte_reg;
+  transaction.data[1] = lux_low_byte_reg;
+  transaction.data[2] = configuration_reg;
+  transaction.register_count = 3;
+  transaction.callback = [this](const i2c::I2CTransaction& transaction) {
+    handleRead(transaction);
+  };
+  return queueTransaction(std::move(transaction));
+}
+
+void Max44009Sensor::handleRead(const i2c::I2CTransaction& transaction) {
+  if (transaction.error) {
+    handleError(transaction_error_);
+    return;
+  }
+  const uint8_t lux_high_byte = transaction.data[0];
+  const uint8_t lux_low_byte = transaction.data[1];
+  // The automatic mode reports the selected integration time
+  time_code_ = transaction.data[2] & time_code_mask;
+
+  const uint8_t exponent = lux_high_byte >> 4;
+  if (exponent == overrange_exponent) {
+    handleError(overrange_error_);
+    return;
+  }
+  const uint8_t mantissa = (lux_high_byte & 0x0F) << 4 | (lux_low_byte & 0x0F);
+  handleLux((1UL << exponent) * mantissa * 0.045f);
+}
+
+std::shared_ptr<Peripheral> Max44009Sensor::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<Max44009Sensor>(parameters);
+}
+
+const __FlashStringHelper* Max44009Sensor::overrange_error_ =
+    FPSTR("Illuminance over range");
+
+}  // namespace max44009
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
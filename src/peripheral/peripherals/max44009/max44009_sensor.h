@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "managers/service_getters.h"
+#include "peripheral/peripherals/light_sensor/i2c_light_sensor.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace max44009 {
+
+/**
+ * Peripheral for the Maxim MAX44009 ambient light sensor
+ *
+ * Measures continuously in the automatic mode, in which the sensor selects
+ * the integration time and current division itself to cover 0.045 lx to
+ * 188,000 lx. The selected integration time is read back with each result,
+ * so that the next measurement only waits as long as needed.
+ */
+class Max44009Sensor : public light_sensor::I2CLightSensor {
+ public:
+  Max44009Sensor(const JsonObjectConst& parameter);
+  virtual ~Max44009Sensor() = default;
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+ private:
+  std::chrono::milliseconds getIntegrationTime() const final;
+  bool readLux() final;
+
+  /**
+   * Converts the lux bytes and the configuration read by readLux()
+   *
+   * \param transaction The completed register reads
+   */
+  void handleRead(const i2c::I2CTransaction& transaction);
+
+  /// The integration time selected by the sensor, 800 ms >> time_code_
+  uint8_t time_code_ = 0;
+
+  static const __FlashStringHelper* overrange_error_;
+};
+
+}  // namespace max44009
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -0,0 +1,364 @@
+#ifndef MINIMAL_BUILD
+#include "modbus_device.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "managers/services.h"
+#include "peripheral/peripheral_factory.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+ModbusDevice::ModbusDevice(const ServiceGetters& services,
+                           const JsonObjectConst& parameters) {
+  web_socket_ = services.getWebSocket();
+  if (web_socket_ == nullptr) {
+    setInvalid(ServiceGetters::web_socket_nullptr_error_);
+    return;
+  }
+
+  // Get the master of the bus the device is connected to
+  utils::UUID modbus_master_uuid(parameters[modbus_master_key_]);
+  if (!modbus_master_uuid.isValid()) {
+    setInvalid(ErrorStore::genMissingProperty(modbus_master_key_,
+                                              ErrorStore::KeyType::kUUID));
+    return;
+  }
+  std::shared_ptr<Peripheral> peripheral =
+      Services::getPeripheralController().getPeripheral(modbus_master_uuid);
+  if (!peripheral || peripheral->getType() != ModbusMaster::type() ||
+      !peripheral->isValid()) {
+    setInvalid(
+        ErrorStore::genNotAValid(modbus_master_uuid, ModbusMaster::type()));
+    return;
+  }
+  modbus_master_ = std::static_pointer_cast<ModbusMaster>(peripheral);
+
+  JsonVariantConst slave_id = parameters[slave_id_key_];
+  if (!slave_id.is<int>() || slave_id.as<int>() < 1 ||
+      slave_id.as<int>() > 247) {
+    setInvalid(slave_id_key_error_);
+    return;
+  }
+  slave_id_ = slave_id.as<int>();
+
+  JsonArrayConst registers = parameters[registers_key_];
+  if (registers.isNull() || registers.size() == 0) {
+    setInvalid(registers_key_error_);
+    return;
+  }
+  registers_.reserve(registers.size());
+  for (JsonObjectConst register_doc : registers) {
+    Register reg;
+    if (!parseRegister(register_doc, reg)) {
+      setInvalid(registers_key_error_);
+      return;
+    }
+    registers_.push_back(reg);
+  }
+
+  // Allowed number of unmapped registers read to merge two blocks. Only
+  // adjacent registers are merged by default, as reading unmapped addresses
+  // fails on some devices
+  const int max_gap = parameters[max_gap_key_] | 0;
+  if (max_gap < 0 || max_gap > ModbusTransaction::max_read_count) {
+    setInvalid(max_gap_key_error_);
+    return;
+  }
+  coalesceBlocks(max_gap);
+}
+
+ModbusDevice::~ModbusDevice() {
+  // Drop the callbacks of the queued transactions, which reference this
+  if (modbus_master_) {
+    modbus_master_->cancel(this);
+    modbus_master_->cancel(&blocks_);
+  }
+}
+
+const String& ModbusDevice::getType() const { return type(); }
+
+const String& ModbusDevice::type() {
+  static const String name{"ModbusDevice"};
+  return name;
+}
+
+std::shared_ptr<Peripheral> ModbusDevice::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<ModbusDevice>(services, parameters);
+}
+
+capabilities::GetValues* ModbusDevice::asGetValues() { return this; }
+
+capabilities::StartMeasurement* ModbusDevice::asStartMeasurement() {
+  return this;
+}
+
+capabilities::SetValue* ModbusDevice::asSetValue() { return this; }
+
+capabilities::StartMeasurement::Result ModbusDevice::startMeasurement(
+    const JsonVariantConst& parameters) {
+  // Drop the reads of a previous measurement that did not complete. Queued
+  // writes are kept
+  modbus_master_->cancel(&blocks_);
+  has_values_ = false;
+  measurement_error_ = ErrorResult();
+  pending_blocks_ = 0;
+
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    const Block& block = blocks_[i];
+    ModbusTransaction transaction;
+    transaction.slave_id = slave_id_;
+    transaction.function = block.table == Table::kHolding
+                               ? ModbusTransaction::read_holding_registers
+                               : ModbusTransaction::read_input_registers;
+    transaction.address = block.address;
+    transaction.count = block.count;
+    transaction.callback = [this, i](const ModbusTransaction& result) {
+      handleBlock(i, result);
+    };
+    transaction.owner = &blocks_;
+    if (!modbus_master_->queue(std::move(transaction))) {
+      modbus_master_->cancel(&blocks_);
+      pending_blocks_ = 0;
+      return capabilities::StartMeasurement::Result{
+          .error = ErrorResult(type(), F("Queue full"))};
+    }
+    pending_blocks_++;
+  }
+  return {.wait = block_wait_ * blocks_.size()};
+}
+
+capabilities::StartMeasurement::Result ModbusDevice::handleMeasurement() {
+  if (pending_blocks_) {
+    return {.wait = block_wait_ * pending_blocks_};
+  }
+  if (measurement_error_.isError()) {
+    return capabilities::StartMeasurement::Result{.error = measurement_error_};
+  }
+  return capabilities::StartMeasurement::Result();
+}
+
+capabilities::GetValues::Result ModbusDevice::getValues() {
+  if (!has_values_) {
+    return capabilities::GetValues::Result{
+        .error = ErrorResult(type(), F("No measurement"))};
+  }
+
+  capabilities::GetValues::Result result;
+  for (const Register& reg : registers_) {
+    const std::vector<uint16_t>& values = blocks_[reg.block].registers;
+    const uint16_t high = values[reg.offset];
+    const uint32_t word = getWidth(reg.format) == 2
+                              ? uint32_t(high) << 16 | values[reg.offset + 1]
+                              : high;
+    float value = 0;
+    switch (reg.format) {
+      case Format::kUInt16:
+      case Format::kUInt32:
+        value = word;
+        break;
+      case Format::kInt16:
+        value = static_cast<int16_t>(word);
+        break;
+      case Format::kInt32:
+        value = static_cast<int32_t>(word);
+        break;
+      case Format::kFloat32:
+        memcpy(&value, &word, sizeof(value));
+        break;
+    }
+    result.values.push_back(utils::ValueUnit{
+        .value = value * reg.scale, .data_point_type = reg.data_point_type});
+  }
+  return result;
+}
+
+void ModbusDevice::setValue(utils::ValueUnit value_unit) {
+  auto reg = std::find_if(registers_.begin(), registers_.end(),
+                          [&value_unit](const Register& reg) {
+                            return reg.table == Table::kHolding &&
+                                   reg.data_point_type ==
+                                       value_unit.data_point_type;
+                          });
+  if (reg == registers_.end()) {
+    web_socket_->sendError(type(), no_register_error_);
+    return;
+  }
+
+  // Convert to the raw register value, clamped to the format's range
+  const double raw = value_unit.value / reg->scale;
+  uint32_t word = 0;
+  switch (reg->format) {
+    case Format::kUInt16:
+      word = std::lround(std::fmin(std::fmax(raw, 0), UINT16_MAX));
+      break;
+    case Format::kInt16:
+      word = static_cast<uint16_t>(
+          std::lround(std::fmin(std::fmax(raw, INT16_MIN), INT16_MAX)));
+      break;
+    case Format::kUInt32:
+      word = std::llround(std::fmin(std::fmax(raw, 0), UINT32_MAX));
+      break;
+    case Format::kInt32:
+      word = static_cast<uint32_t>(
+          std::llround(std::fmin(std::fmax(raw, INT32_MIN), INT32_MAX)));
+      break;
+    case Format::kFloat32: {
+      const float value = raw;
+      memcpy(&word, &value, sizeof(word));
+      break;
+    }
+  }
+
+  ModbusTransaction transaction;
+  transaction.slave_id = slave_id_;
+  transaction.address = reg->address;
+  if (getWidth(reg->format) == 2) {
+    transaction.function = ModbusTransaction::write_multiple_registers;
+    transaction.registers = {static_cast<uint16_t>(word >> 16),
+                             static_cast<uint16_t>(word & 0xFFFF)};
+  } else {
+    transaction.function = ModbusTransaction::write_single_register;
+    transaction.registers = {static_cast<uint16_t>(word)};
+  }
+  transaction.callback = [this](const ModbusTransaction& result) {
+    if (result.error != ModbusTransaction::Error::kNone) {
+      web_socket_->sendError(type(), result.errorToString());
+    }
+  };
+  transaction.owner = this;
+  if (!modbus_master_->queue(std::move(transaction))) {
+    web_socket_->sendError(type(), F("Queue full"));
+  }
+}
+
+bool ModbusDevice::parseRegister(const JsonObjectConst& doc, Register& reg) {
+  JsonVariantConst address = doc[address_key_];
+  if (!address.is<int>() || address.as<int>() < 0 ||
+      address.as<int>() > UINT16_MAX) {
+    return false;
+  }
+  reg.address = address.as<int>();
+
+  // Holding registers by default
+  const char* table = doc[table_key_] | "holding";
+  if (strcmp(table, "holding") == 0) {
+    reg.table = Table::kHolding;
+  } else if (strcmp(table, "input") == 0) {
+    reg.table = Table::kInput;
+  } else {
+    return false;
+  }
+
+  // Unsigned 16-bit by default. 32-bit values are stored high word first
+  const char* format = doc[format_key_] | "uint16";
+  if (strcmp(format, "uint16") == 0) {
+    reg.format = Format::kUInt16;
+  } else if (strcmp(format, "int16") == 0) {
+    reg.format = Format::kInt16;
+  } else if (strcmp(format, "uint32") == 0) {
+    reg.format = Format::kUInt32;
+  } else if (strcmp(format, "int32") == 0) {
+    reg.format = Format::kInt32;
+  } else if (strcmp(format, "float32") == 0) {
+    reg.format = Format::kFloat32;
+  } else {
+    return false;
+  }
+  if (reg.address + getWidth(reg.format) - 1 > UINT16_MAX) {
+    return false;
+  }
+
+  reg.scale = doc[scale_key_] | 1.0f;
+  if (reg.scale == 0) {
+    return false;
+  }
+
+  reg.data_point_type = utils::UUID(doc[data_point_type_key_]);
+  return reg.data_point_type.isValid();
+}
+
+void ModbusDevice::coalesceBlocks(uint16_t max_gap) {
+  std::vector<ModbusProtocol::RegisterRange> ranges;
+  ranges.reserve(registers_.size());
+  for (const Register& reg : registers_) {
+    ranges.push_back(
+        ModbusProtocol::RegisterRange{.table = static_cast<uint8_t>(reg.table),
+                                      .address = reg.address,
+                                      .width = getWidth(reg.format),
+                                      .block = 0,
+                                      .offset = 0});
+  }
+
+  for (const ModbusProtocol::BlockRange& range :
+       ModbusProtocol::coalesceBlocks(ranges, max_gap)) {
+    blocks_.push_back(Block{.table = static_cast<Table>(range.table),
+                            .address = range.address,
+                            .count = range.count,
+                            .registers = {}});
+  }
+  for (size_t i = 0; i < registers_.size(); i++) {
+    registers_[i].block = ranges[i].block;
+    registers_[i].offset = ranges[i].offset;
+  }
+}
+
+void ModbusDevice::handleBlock(size_t block,
+                               const ModbusTransaction& transaction) {
+  if (pending_blocks_ == 0) {
+    return;
+  }
+  pending_blocks_--;
+  if (transaction.error != ModbusTransaction::Error::kNone) {
+    measurement_error_ = ErrorResult(type(), transaction.errorToString());
+  } else {
+    blocks_[block].registers = transaction.registers;
+  }
+  if (pending_blocks_ == 0 && !measurement_error_.isError()) {
+    has_values_ = true;
+  }
+}
+
+uint8_t ModbusDevice::getWidth(Format format) {
+  switch (format) {
+    case Format::kUInt32:
+    case Format::kInt32:
+    case Format::kFloat32:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+constexpr std::chrono::milliseconds ModbusDevice::block_wait_;
+
+const __FlashStringHelper* ModbusDevice::modbus_master_key_ =
+    FPSTR("modbus_master");
+const __FlashStringHelper* ModbusDevice::slave_id_key_ = FPSTR("slave_id");
+const __FlashStringHelper* ModbusDevice::slave_id_key_error_ =
+    FPSTR("Missing property: slave_id (1 - 247)");
+const __FlashStringHelper* ModbusDevice::max_gap_key_ = FPSTR("max_gap");
+const __FlashStringHelper* ModbusDevice::max_gap_key_error_ =
+    FPSTR("Invalid max_gap (0 - 125)");
+const __FlashStringHelper* ModbusDevice::registers_key_ = FPSTR("registers");
+const __FlashStringHelper* ModbusDevice::registers_key_error_ =
+    FPSTR("Invalid registers");
+const __FlashStringHelper* ModbusDevice::address_key_ = FPSTR("address");
+const __FlashStringHelper* ModbusDevice::table_key_ = FPSTR("table");
+const __FlashStringHelper* ModbusDevice::format_key_ = FPSTR("format");
+const __FlashStringHelper* ModbusDevice::scale_key_ = FPSTR("scale");
+const __FlashStringHelper* ModbusDevice::data_point_type_key_ =
+    FPSTR("data_point_type");
+const __FlashStringHelper* ModbusDevice::no_register_error_ =
+    FPSTR("No holding register for data point type");
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "managers/service_getters.h"
+#include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/set_value.h"
+#include "peripheral/capabilities/start_measurement.h"
+#include "peripheral/peripheral.h"
+#include "peripheral/peripherals/modbus/modbus_master.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+/**
+ * A Modbus RTU slave with a map of registers to data point types
+ *
+ * Registers in the same table that are adjacent, or within the allowed gap,
+ * are coalesced into block reads of up to 125 registers. A measurement queues
+ * all block reads at once, which the master executes back-to-back. Holding
+ * registers can be written via the SetValue interface.
+ */
+class ModbusDevice : public Peripheral,
+                     public capabilities::GetValues,
+                     public capabilities::StartMeasurement,
+                     public capabilities::SetValue {
+ public:
+  ModbusDevice(const ServiceGetters& services,
+               const JsonObjectConst& parameters);
+  virtual ~ModbusDevice();
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
+  capabilities::SetValue* asSetValue() final;
+
+  /**
+   * Queues the block reads of all registers
+   *
+   * \param parameters No parameters expected
+   * \return The expected time until all blocks were read
+   */
+  capabilities::StartMeasurement::Result startMeasurement(
+      const JsonVariantConst& parameters) final;
+
+  /**
+   * Checks if all block reads completed
+   *
+   * \return Ready once all blocks were read, else wait or an error
+   */
+  capabilities::StartMeasurement::Result handleMeasurement() final;
+
+  /**
+   * Decodes the registers of the last measurement
+   *
+   * \return The scaled register values or an error
+   */
+  capabilities::GetValues::Result getValues() final;
+
+  /**
+   * Writes the holding register mapped to the data point type
+   *
+   * \param value_unit The unscaled value and its data point type
+   */
+  void setValue(utils::ValueUnit value_unit) final;
+
+ private:
+  enum class Table { kHolding, kInput };
+  enum class Format { kUInt16, kInt16, kUInt32, kInt32, kFloat32 };
+
+  /// A mapped register and where its value is stored in the read blocks
+  struct Register {
+    Table table;
+    uint16_t address;
+    Format format;
+    float scale;
+    utils::UUID data_point_type;
+    uint16_t block;
+    uint16_t offset;
+  };
+
+  /// Consecutive registers of a table that are read with one request
+  struct Block {
+    Table table;
+    uint16_t address;
+    uint16_t count;
+    std::vector<uint16_t> registers;
+  };
+
+  bool parseRegister(const JsonObjectConst& doc, Register& reg);
+  void coalesceBlocks(uint16_t max_gap);
+  void handleBlock(size_t block, const ModbusTransaction& transaction);
+  static uint8_t getWidth(Format format);
+
+  std::shared_ptr<WebSocket> web_socket_;
+  std::shared_ptr<ModbusMaster> modbus_master_;
+  uint8_t slave_id_ = 0;
+
+  std::vector<Register> registers_;
+  /// Owner of the queued block reads. Writes are owned by the device, so that
+  /// a new measurement only cancels the reads of the previous one
+  std::vector<Block> blocks_;
+
+  /// Block reads of the current measurement that did not complete yet
+  size_t pending_blocks_ = 0;
+  /// Whether all blocks were read successfully
+  bool has_values_ = false;
+  ErrorResult measurement_error_;
+
+  /// Expected time for a block read
+  static constexpr std::chrono::milliseconds block_wait_{20};
+
+  static const __FlashStringHelper* modbus_master_key_;
+  static const __FlashStringHelper* slave_id_key_;
+  static const __FlashStringHelper* slave_id_key_error_;
+  static const __FlashStringHelper* max_gap_key_;
+  static const __FlashStringHelper* max_gap_key_error_;
+  static const __FlashStringHelper* registers_key_;
+  static const __FlashStringHelper* registers_key_error_;
+  static const __FlashStringHelper* address_key_;
+  static const __FlashStringHelper* table_key_;
+  static const __FlashStringHelper* format_key_;
+  static const __FlashStringHelper* scale_key_;
+  static const __FlashStringHelper* data_point_type_key_;
+  static const __FlashStringHelper* no_register_error_;
+};
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -0,0 +1,83 @@
+#ifndef MINIMAL_BUILD
+#include "modbus_master.h"
+
+#include "managers/services.h"
+#include "peripheral/peripheral_factory.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+ModbusMaster::ModbusMaster(const JsonObjectConst& parameters)
+    : UARTAbstractPeripheral(parameters) {
+  // If the base class constructor failed, abort the constructor
+  if (!isValid()) {
+    return;
+  }
+
+  // Optional driver enable pin of an RS485 transceiver
+  int de_pin = -1;
+  JsonVariantConst de_pin_doc = parameters[de_pin_key_];
+  if (!de_pin_doc.isNull()) {
+    de_pin = toPin(de_pin_doc);
+    if (de_pin < 0) {
+      setInvalid(de_pin_key_error_);
+      return;
+    }
+  }
+
+  std::chrono::milliseconds response_timeout = default_response_timeout_;
+  JsonVariantConst response_timeout_doc = parameters[response_timeout_key_];
+  if (!response_timeout_doc.isNull()) {
+    if (!response_timeout_doc.is<int>() ||
+        response_timeout_doc.as<int>() <= 0) {
+      setInvalid(response_timeout_key_error_);
+      return;
+    }
+    response_timeout =
+        std::chrono::milliseconds(response_timeout_doc.as<int>());
+  }
+
+  rtu_.reset(new ModbusRtu(*uart_adapter_, Services::getScheduler(), de_pin,
+                           response_timeout));
+}
+
+const String& ModbusMaster::getType() const { return type(); }
+
+const String& ModbusMaster::type() {
+  static const String name{"ModbusMaster"};
+  return name;
+}
+
+std::shared_ptr<Peripheral> ModbusMaster::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<ModbusMaster>(parameters);
+}
+
+bool ModbusMaster::queue(ModbusTransaction transaction) {
+  return rtu_ && rtu_->queue(std::move(transaction));
+}
+
+void ModbusMaster::cancel(const void* owner) {
+  if (rtu_) {
+    rtu_->cancel(owner);
+  }
+}
+
+constexpr std::chrono::milliseconds ModbusMaster::default_response_timeout_;
+
+const __FlashStringHelper* ModbusMaster::de_pin_key_ = FPSTR("de_pin");
+const __FlashStringHelper* ModbusMaster::de_pin_key_error_ =
+    FPSTR("Invalid de_pin");
+const __FlashStringHelper* ModbusMaster::response_timeout_key_ =
+    FPSTR("response_timeout_ms");
+const __FlashStringHelper* ModbusMaster::response_timeout_key_error_ =
+    FPSTR("Invalid response_timeout_ms");
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
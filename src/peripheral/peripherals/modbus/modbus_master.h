@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <memory>
+
+#include "managers/service_getters.h"
+#include "peripheral/peripherals/modbus/modbus_rtu.h"
+#include "peripheral/peripherals/uart/uart_abstract_peripheral.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+/**
+ * Modbus RTU master on a UART adapter
+ *
+ * Executes the transactions of the Modbus devices connected to the bus. An
+ * optional driver enable pin switches an RS485 transceiver to transmit.
+ */
+class ModbusMaster : public uart::UARTAbstractPeripheral {
+ public:
+  ModbusMaster(const JsonObjectConst& parameters);
+  virtual ~ModbusMaster() = default;
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  /**
+   * Add a transaction to the end of the queue
+   *
+   * \param transaction The transaction to execute
+   * \return False if the queue is full or the transaction is malformed
+   */
+  bool queue(ModbusTransaction transaction);
+
+  /**
+   * Drop all queued transactions of a peripheral
+   *
+   * \param owner The peripheral that queued the transactions
+   */
+  void cancel(const void* owner);
+
+ private:
+  std::unique_ptr<ModbusRtu> rtu_;
+
+  /// Default time to wait for a response
+  static constexpr std::chrono::milliseconds default_response_timeout_{500};
+
+  static const __FlashStringHelper* de_pin_key_;
+  static const __FlashStringHelper* de_pin_key_error_;
+  static const __FlashStringHelper* response_timeout_key_;
+  static const __FlashStringHelper* response_timeout_key_error_;
+};
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
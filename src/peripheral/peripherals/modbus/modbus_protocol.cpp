@@ -0,0 +1,208 @@
+#include "modbus_protocol.h"
+
+#include <algorithm>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+constexpr uint8_t ModbusRequest::read_holding_registers;
+constexpr uint8_t ModbusRequest::read_input_registers;
+constexpr uint8_t ModbusRequest::write_single_register;
+constexpr uint8_t ModbusRequest::write_multiple_registers;
+constexpr uint16_t ModbusRequest::max_read_count;
+constexpr uint16_t ModbusRequest::max_write_count;
+constexpr size_t ModbusProtocol::max_frame_size;
+
+bool ModbusProtocol::prepareRequest(ModbusRequest& request) {
+  if (request.slave_id < 1 || request.slave_id > 247) {
+    return false;
+  }
+  switch (request.function) {
+    case ModbusRequest::read_holding_registers:
+    case ModbusRequest::read_input_registers:
+      if (request.count < 1 || request.count > ModbusRequest::max_read_count) {
+        return false;
+      }
+      request.registers.clear();
+      return true;
+    case ModbusRequest::write_single_register:
+      if (request.registers.size() != 1) {
+        return false;
+      }
+      request.count = 1;
+      return true;
+    case ModbusRequest::write_multiple_registers:
+      if (request.registers.empty() ||
+          request.registers.size() > ModbusRequest::max_write_count) {
+        return false;
+      }
+      request.count = request.registers.size();
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t ModbusProtocol::encodeRequest(const ModbusRequest& request,
+                                     uint8_t* frame) {
+  size_t length = 0;
+  frame[length++] = request.slave_id;
+  frame[length++] = request.function;
+  frame[length++] = request.address >> 8;
+  frame[length++] = request.address & 0xFF;
+  if (request.function == ModbusRequest::write_single_register) {
+    frame[length++] = request.registers[0] >> 8;
+    frame[length++] = request.registers[0] & 0xFF;
+  } else {
+    frame[length++] = request.count >> 8;
+    frame[length++] = request.count & 0xFF;
+  }
+  if (request.function == ModbusRequest::write_multiple_registers) {
+    frame[length++] = request.count * 2;
+    for (const uint16_t value : request.registers) {
+      frame[length++] = value >> 8;
+      frame[length++] = value & 0xFF;
+    }
+  }
+  const uint16_t crc = crc16(frame, length);
+  frame[length++] = crc & 0xFF;
+  frame[length++] = crc >> 8;
+  return length;
+}
+
+size_t ModbusProtocol::getResponseLength(const uint8_t* frame,
+                                         size_t length) {
+  if (length < 2) {
+    return 0;
+  }
+  // Exception: ID, function, exception code and CRC
+  if (frame[1] & 0x80) {
+    return 5;
+  }
+  switch (frame[1]) {
+    case ModbusRequest::read_holding_registers:
+    case ModbusRequest::read_input_registers:
+      // ID, function, byte count, data and CRC
+      return length < 3 ? 0 : 5 + frame[2];
+    case ModbusRequest::write_single_register:
+    case ModbusRequest::write_multiple_registers:
+      // ID, function, address, value or count and CRC
+      return 8;
+    default:
+      // Unknown function. Wait for the timeout
+      return 0;
+  }
+}
+
+ModbusRequest::Error ModbusProtocol::parseResponse(const uint8_t* frame,
+                                                   size_t length,
+                                                   ModbusRequest& request) {
+  // The shortest frame is an exception
+  if (length < 5) {
+    return ModbusRequest::Error::kInvalidResponse;
+  }
+  const uint16_t crc = crc16(frame, length - 2);
+  if (frame[length - 2] != (crc & 0xFF) || frame[length - 1] != (crc >> 8)) {
+    return ModbusRequest::Error::kCrc;
+  }
+  if (frame[0] != request.slave_id ||
+      (frame[1] & 0x7F) != request.function) {
+    return ModbusRequest::Error::kInvalidResponse;
+  }
+  if (frame[1] & 0x80) {
+    request.exception_code = frame[2];
+    return ModbusRequest::Error::kException;
+  }
+
+  switch (request.function) {
+    case ModbusRequest::read_holding_registers:
+    case ModbusRequest::read_input_registers:
+      if (frame[2] != request.count * 2 || length != 5u + frame[2]) {
+        return ModbusRequest::Error::kInvalidResponse;
+      }
+      request.registers.resize(request.count);
+      for (uint16_t i = 0; i < request.count; i++) {
+        request.registers[i] = frame[3 + i * 2] << 8 | frame[4 + i * 2];
+      }
+      break;
+    case ModbusRequest::write_single_register:
+    case ModbusRequest::write_multiple_registers: {
+      if (length != 8) {
+        return ModbusRequest::Error::kInvalidResponse;
+      }
+      // Echoes the address and the value or the count
+      const uint16_t address = frame[2] << 8 | frame[3];
+      const uint16_t value = frame[4] << 8 | frame[5];
+      const uint16_t expected_value =
+          request.function == ModbusRequest::write_single_register
+              ? request.registers[0]
+              : request.count;
+      if (address != request.address || value != expected_value) {
+        return ModbusRequest::Error::kInvalidResponse;
+      }
+      break;
+    }
+  }
+  return ModbusRequest::Error::kNone;
+}
+
+uint16_t ModbusProtocol::crc16(const uint8_t* data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      if (crc & 0x0001) {
+        crc = (crc >> 1) ^ 0xA001;
+      } else {
+        crc >>= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+std::vector<ModbusProtocol::BlockRange> ModbusProtocol::coalesceBlocks(
+    std::vector<RegisterRange>& registers, uint16_t max_gap) {
+  // Visit the registers ordered by table and address
+  std::vector<size_t> order(registers.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&registers](size_t a, size_t b) {
+    const RegisterRange& first = registers[a];
+    const RegisterRange& second = registers[b];
+    return first.table != second.table ? first.table < second.table
+                                       : first.address < second.address;
+  });
+
+  std::vector<BlockRange> blocks;
+  for (const size_t index : order) {
+    RegisterRange& reg = registers[index];
+    const uint32_t end = reg.address + reg.width;
+    // Extend the last block if the register is close enough and it fits
+    if (!blocks.empty()) {
+      BlockRange& block = blocks.back();
+      const uint32_t block_end = block.address + block.count;
+      if (block.table == reg.table && reg.address <= block_end + max_gap &&
+          end - block.address <= ModbusRequest::max_read_count) {
+        block.count = std::max(block_end, end) - block.address;
+        reg.block = blocks.size() - 1;
+        reg.offset = reg.address - block.address;
+        continue;
+      }
+    }
+    blocks.push_back(BlockRange{.table = reg.table,
+                                .address = reg.address,
+                                .count = static_cast<uint16_t>(reg.width)});
+    reg.block = blocks.size() - 1;
+    reg.offset = 0;
+  }
+  return blocks;
+}
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
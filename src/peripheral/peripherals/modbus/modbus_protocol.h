@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+/**
+ * A single request to a Modbus slave and its response
+ *
+ * For reads, count registers are read into registers. For writes, the values
+ * in registers are written.
+ */
+struct ModbusRequest {
+  enum class Error { kNone, kTimeout, kCrc, kException, kInvalidResponse };
+
+  static constexpr uint8_t read_holding_registers = 0x03;
+  static constexpr uint8_t read_input_registers = 0x04;
+  static constexpr uint8_t write_single_register = 0x06;
+  static constexpr uint8_t write_multiple_registers = 0x10;
+
+  /// Maximum number of registers read by a single request
+  static constexpr uint16_t max_read_count = 125;
+  /// Maximum number of registers written by a single request
+  static constexpr uint16_t max_write_count = 123;
+
+  /// Address of the slave (1 - 247)
+  uint8_t slave_id = 0;
+  /// One of the supported function codes
+  uint8_t function = 0;
+  /// Address of the first register
+  uint16_t address = 0;
+  /// Number of registers to read
+  uint16_t count = 0;
+  /// The values to write, replaced by the read values
+  std::vector<uint16_t> registers;
+
+  Error error = Error::kNone;
+  /// Exception code sent by the slave if error is kException
+  uint8_t exception_code = 0;
+};
+
+/**
+ * Encodes and decodes Modbus RTU frames and plans block reads
+ *
+ * Free of hardware dependencies, so that it can be tested on the host.
+ */
+class ModbusProtocol {
+ public:
+  /// A mapped register of a slave
+  struct RegisterRange {
+    /// Registers of different tables are never read together
+    uint8_t table;
+    uint16_t address;
+    /// Number of consecutive registers holding the value
+    uint8_t width;
+    /// Index of the block the register is read with
+    uint16_t block;
+    /// Position of the register within its block
+    uint16_t offset;
+  };
+
+  /// Consecutive registers of a table that are read with one request
+  struct BlockRange {
+    uint8_t table;
+    uint16_t address;
+    uint16_t count;
+  };
+
+  /**
+   * Checks a request and sets the count of writes
+   *
+   * \param request The request to check
+   * \return False if the slave ID, function or number of registers is invalid
+   */
+  static bool prepareRequest(ModbusRequest& request);
+
+  /**
+   * Encodes a request into an RTU frame with its CRC
+   *
+   * \param request A prepared request
+   * \param frame Receives the frame, at least max_frame_size bytes
+   * \return The length of the frame
+   */
+  static size_t encodeRequest(const ModbusRequest& request, uint8_t* frame);
+
+  /**
+   * Gets the length of the response being received
+   *
+   * \param frame The bytes received so far
+   * \param length The number of received bytes
+   * \return The length or 0 if not enough bytes were received to know it
+   */
+  static size_t getResponseLength(const uint8_t* frame, size_t length);
+
+  /**
+   * Checks a complete response and reads its registers into the request
+   *
+   * \param frame The received response
+   * \param length The length given by getResponseLength()
+   * \param request The request the response belongs to
+   * \return The error of the response or kNone
+   */
+  static ModbusRequest::Error parseResponse(const uint8_t* frame,
+                                            size_t length,
+                                            ModbusRequest& request);
+
+  /**
+   * Calculates the Modbus CRC16 (polynomial 0xA001, initial value 0xFFFF)
+   *
+   * \param data The bytes to calculate the CRC for
+   * \param length The number of bytes
+   * \return The CRC, which is sent low byte first
+   */
+  static uint16_t crc16(const uint8_t* data, size_t length);
+
+  /**
+   * Coalesces registers of the same table into block reads
+   *
+   * Registers that are adjacent, or within the allowed gap, are read by the
+   * same block of up to max_read_count registers.
+   *
+   * \param registers The registers to read. Receive their block and offset
+   * \param max_gap Number of unmapped registers that may be read to merge
+   * \return The blocks ordered by table and address
+   */
+  static std::vector<BlockRange> coalesceBlocks(
+      std::vector<RegisterRange>& registers, uint16_t max_gap);
+
+  /// Maximum size of an RTU frame
+  static constexpr size_t max_frame_size = 256;
+};
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -0,0 +1,172 @@
+#ifndef MINIMAL_BUILD
+#include "modbus_rtu.h"
+
+#include <algorithm>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+constexpr size_t ModbusRtu::max_queue_length;
+
+String ModbusTransaction::errorToString() const {
+  switch (error) {
+    case Error::kNone:
+      return String();
+    case Error::kTimeout:
+      return F("Response timeout");
+    case Error::kCrc:
+      return F("CRC mismatch");
+    case Error::kException:
+      return String(F("Exception ")) + String(exception_code);
+    case Error::kInvalidResponse:
+    default:
+      return F("Invalid response");
+  }
+}
+
+ModbusRtu::ModbusRtu(uart::UARTAdapter& uart_adapter, Scheduler& scheduler,
+                     int de_pin, std::chrono::milliseconds response_timeout)
+    : Task(std::chrono::milliseconds(1).count(), TASK_FOREVER, &scheduler,
+           false),
+      uart_adapter_(uart_adapter),
+      de_pin_(de_pin),
+      response_timeout_(response_timeout) {
+  // An RTU character has 11 bits. Above 19200 baud a fixed gap is used
+  const int baud_rate = std::max(uart_adapter_.getBaudRate(), 1);
+  char_time_ = std::chrono::microseconds(11000000 / baud_rate);
+  frame_gap_ = std::chrono::microseconds(
+      baud_rate > 19200 ? 1750 : 38500000 / baud_rate);
+  // Prefer the UART's RS485 mode, which releases the bus without polling
+  if (de_pin_ >= 0 && !uart_adapter_.setDriverEnablePin(de_pin_)) {
+    switch_de_pin_ = true;
+    pinMode(de_pin_, OUTPUT);
+    digitalWrite(de_pin_, LOW);
+  }
+  silent_since_us_ = micros();
+}
+
+bool ModbusRtu::queue(ModbusTransaction transaction) {
+  if (pending_.size() >= max_queue_length ||
+      !ModbusProtocol::prepareRequest(transaction)) {
+    return false;
+  }
+
+  pending_.push_back(std::move(transaction));
+  enableIfNot();
+  return true;
+}
+
+void ModbusRtu::cancel(const void* owner) {
+  auto begin = pending_.begin();
+  // The outstanding request has to be finished to keep the bus in sync
+  if (is_waiting_ && begin != pending_.end()) {
+    if (begin->owner == owner) {
+      is_cancelled_ = true;
+    }
+    begin++;
+  }
+  pending_.erase(std::remove_if(begin, pending_.end(),
+                                [owner](const ModbusTransaction& transaction) {
+                                  return transaction.owner == owner;
+                                }),
+                 pending_.end());
+}
+
+bool ModbusRtu::Callback() {
+  if (is_waiting_) {
+    return receive();
+  }
+  if (pending_.empty()) {
+    disable();
+    return false;
+  }
+  // Keep the bus silent between frames so that slaves detect the frame end
+  if (micros() - silent_since_us_ >=
+      static_cast<uint32_t>(frame_gap_.count())) {
+    send();
+  }
+  return false;
+}
+
+void ModbusRtu::send() {
+  const size_t length =
+      ModbusProtocol::encodeRequest(pending_.front(), frame_);
+
+  // Drop stray bytes so that they are not mistaken for the response
+  uart_adapter_.clearReceived();
+  if (switch_de_pin_) {
+    digitalWrite(de_pin_, HIGH);
+  }
+  uart_adapter_.write(frame_, length);
+  frame_length_ = 0;
+  is_waiting_ = true;
+  is_cancelled_ = false;
+
+  // Release the bus only after the last byte left the transmitter. Polled by
+  // receive(), as waiting would block the scheduler for the whole request
+  if (switch_de_pin_) {
+    is_transmitting_ = true;
+    return;
+  }
+
+  // The timeout starts once the request was transmitted
+  const std::chrono::microseconds transmit_time =
+      char_time_ * static_cast<int>(length);
+  response_deadline_us_ =
+      micros() + transmit_time.count() + response_timeout_.count();
+}
+
+bool ModbusRtu::receive() {
+  if (is_transmitting_) {
+    if (!uart_adapter_.isTransmitted()) {
+      return false;
+    }
+    digitalWrite(de_pin_, LOW);
+    is_transmitting_ = false;
+    response_deadline_us_ = micros() + response_timeout_.count();
+  }
+
+  const int available = uart_adapter_.available();
+  if (available > 0) {
+    const size_t length =
+        std::min(ModbusProtocol::max_frame_size - frame_length_,
+                 static_cast<size_t>(available));
+    frame_length_ += uart_adapter_.readBytes(frame_ + frame_length_, length);
+  }
+
+  const size_t expected_length =
+      ModbusProtocol::getResponseLength(frame_, frame_length_);
+  if (expected_length && frame_length_ >= expected_length) {
+    frame_length_ = expected_length;
+    complete(ModbusProtocol::parseResponse(frame_, frame_length_,
+                                           pending_.front()));
+    return true;
+  }
+  if (static_cast<int32_t>(micros() - response_deadline_us_) >= 0) {
+    complete(ModbusTransaction::Error::kTimeout);
+    return true;
+  }
+  return false;
+}
+
+void ModbusRtu::complete(ModbusTransaction::Error error) {
+  ModbusTransaction transaction = std::move(pending_.front());
+  pending_.pop_front();
+  transaction.error = error;
+  is_waiting_ = false;
+  silent_since_us_ = micros();
+
+  // Run the callback last, as it may queue follow-up transactions
+  if (!is_cancelled_ && transaction.callback) {
+    transaction.callback(transaction);
+  }
+}
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
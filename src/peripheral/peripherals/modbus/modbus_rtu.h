@@ -0,0 +1,117 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "peripheral/peripherals/modbus/modbus_protocol.h"
+#include "peripheral/peripherals/uart/uart_adapter.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace modbus {
+
+/**
+ * A queued request to a Modbus slave and the handler of its response
+ */
+struct ModbusTransaction : public ModbusRequest {
+  /// Called from the scheduler once the transaction completed
+  std::function<void(const ModbusTransaction&)> callback;
+  /// The peripheral that queued the transaction. Used to cancel callbacks
+  const void* owner = nullptr;
+
+  /**
+   * Describes the error of the transaction
+   *
+   * \return The error or an empty string on success
+   */
+  String errorToString() const;
+};
+
+/**
+ * Executes queued Modbus RTU transactions on a UART adapter
+ *
+ * Only one request is outstanding at a time. As soon as a response was
+ * received or timed out, the next request is sent after the silent interval
+ * of 3.5 characters, independent of the slave it is addressed to. The task
+ * only runs while transactions are queued.
+ */
+class ModbusRtu : public Task {
+ public:
+  /**
+   * Prepares the transport
+   *
+   * \param uart_adapter The UART adapter of the bus
+   * \param scheduler The scheduler to run the state machine
+   * \param de_pin Driver enable pin of an RS485 transceiver or -1 if none
+   * \param response_timeout Time to wait for a response
+   */
+  ModbusRtu(uart::UARTAdapter& uart_adapter, Scheduler& scheduler, int de_pin,
+            std::chrono::milliseconds response_timeout);
+  virtual ~ModbusRtu() = default;
+
+  /**
+   * Add a transaction to the end of the queue
+   *
+   * \param transaction The transaction to execute
+   * \return False if the queue is full or the transaction is malformed
+   */
+  bool queue(ModbusTransaction transaction);
+
+  /**
+   * Drop all queued transactions of a peripheral
+   *
+   * \param owner The peripheral that queued the transactions
+   */
+  void cancel(const void* owner);
+
+  /**
+   * Sends requests and receives their responses
+   *
+   * \return True if a transaction was completed
+   */
+  bool Callback() final;
+
+  /// Maximum number of transactions waiting to be executed
+  static constexpr size_t max_queue_length = 16;
+
+ private:
+  void send();
+  bool receive();
+  void complete(ModbusTransaction::Error error);
+
+  uart::UARTAdapter& uart_adapter_;
+  int de_pin_;
+  std::chrono::microseconds response_timeout_;
+  /// Time to send a single character (start, 8 data, parity / stop bits)
+  std::chrono::microseconds char_time_;
+  /// Silent interval required between frames
+  std::chrono::microseconds frame_gap_;
+
+  std::deque<ModbusTransaction> pending_;
+  /// Whether the front of the queue was sent and awaits its response
+  bool is_waiting_ = false;
+  /// Whether the owner of the outstanding request cancelled it
+  bool is_cancelled_ = false;
+  /// Whether the DE pin is switched by software instead of the UART
+  bool switch_de_pin_ = false;
+  /// Whether the request is still being sent with the DE pin switched by
+  /// software
+  bool is_transmitting_ = false;
+  uint8_t frame_[ModbusProtocol::max_frame_size];
+  size_t frame_length_ = 0;
+  /// Time until the response has to be received (micros)
+  uint32_t response_deadline_us_ = 0;
+  /// Time when the bus last became silent (micros)
+  uint32_t silent_since_us_ = 0;
+};
+
+}  // namespace modbus
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -1,6 +1,10 @@
 #ifndef MINIMAL_BUILD
 #include "neo_pixel.h"
 
+#ifdef ESP32
+#include <esp_timer.h>
+#endif
+
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -34,10 +38,63 @@ NeoPixel::NeoPixel(const JsonObjectConst& parameters) {
   }
 
   uint8_t pixel_type = color_encoding_int + NEO_KHZ800;
+  bytes_per_pixel_ = strlen(color_encoding_str.as<const char*>());
 
   driver_.setPin(led_pin);
   driver_.updateType(pixel_type);
   driver_.updateLength(led_count);
+  if (driver_.numPixels() != led_count.as<unsigned int>()) {
+    setInvalid(led_count_key_error_);
+    return;
+  }
+
+#ifdef ESP32
+  // Reserve a free RMT channel to send the frames without blocking
+  for (size_t i = 0; i < busy_channels_.size(); i++) {
+    if (!busy_channels_[i]) {
+      rmt_channel_ = i;
+      break;
+    }
+  }
+  if (rmt_channel_ < 0) {
+    setInvalid(rmt_taken_error_);
+    return;
+  }
+
+  rmt_config_t config = {};
+  config.rmt_mode = RMT_MODE_TX;
+  config.channel = static_cast<rmt_channel_t>(rmt_channel_);
+  config.gpio_num = static_cast<gpio_num_t>(led_pin.as<unsigned int>());
+  config.clk_div = rmt_clock_divider_;
+  config.mem_block_num = 1;
+  config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+  config.tx_config.idle_output_en = true;
+  if (rmt_config(&config) != ESP_OK) {
+    rmt_channel_ = -1;
+    setInvalid(rmt_error_);
+    return;
+  }
+  if (rmt_driver_install(config.channel, 0, 0) != ESP_OK) {
+    rmt_channel_ = -1;
+    setInvalid(rmt_error_);
+    return;
+  }
+  rmt_translator_init(config.channel, toRmtItems);
+  busy_channels_[rmt_channel_] = true;
+  tx_buffer_.reserve(bytes_per_pixel_ * driver_.numPixels());
+#endif
+}
+
+NeoPixel::~NeoPixel() {
+#ifdef ESP32
+  if (rmt_channel_ >= 0) {
+    // The driver reads from the TX buffer until the frame was sent
+    rmt_channel_t channel = static_cast<rmt_channel_t>(rmt_channel_);
+    rmt_wait_tx_done(channel, portMAX_DELAY);
+    rmt_driver_uninstall(channel);
+    busy_channels_[rmt_channel_] = false;
+  }
+#endif
 }
 
 const String& NeoPixel::getType() const { return type(); }
@@ -47,18 +104,79 @@ const String& NeoPixel::type() {
   return name;
 }
 
+capabilities::LedStrip* NeoPixel::asLedStrip() { return this; }
+
 void NeoPixel::turnOn(utils::Color color) {
+  driver_.fill(color.getWrgbInt());
+  showWhenIdle();
+}
+
+void NeoPixel::turnOff() {
+  driver_.clear();
+  showWhenIdle();
+}
+
+size_t NeoPixel::getPixelCount() const { return driver_.numPixels(); }
+
+void NeoPixel::setPixel(size_t index, utils::Color color) {
+  if (index < driver_.numPixels()) {
+    driver_.setPixelColor(index, color.getWrgbInt());
+  }
+}
+
+bool NeoPixel::show() {
+#ifdef ESP32
+  if (rmt_channel_ < 0 || isSending()) {
+    return false;
+  }
+
+  // Send a copy, so that the next frame can be drawn in the meantime
+  const uint8_t* pixels = driver_.getPixels();
+  tx_buffer_.assign(pixels, pixels + bytes_per_pixel_ * driver_.numPixels());
+  is_tx_done_ = false;
+  rmt_write_sample(static_cast<rmt_channel_t>(rmt_channel_),
+                   tx_buffer_.data(), tx_buffer_.size(), false);
+#else
   if (!is_driver_started_) {
     driver_.begin();
     is_driver_started_ = true;
   }
-  driver_.fill(color.getWrgbInt());
   driver_.show();
+#endif
+  return true;
 }
 
-void NeoPixel::turnOff() {
-  driver_.setBrightness(0);
-  driver_.show();
+bool NeoPixel::isSending() {
+#ifdef ESP32
+  if (!is_tx_done_) {
+    // The RMT may still read the buffer after the frame's nominal duration,
+    // for example when its refill interrupt was delayed
+    if (rmt_wait_tx_done(static_cast<rmt_channel_t>(rmt_channel_), 0) !=
+        ESP_OK) {
+      return true;
+    }
+    // Polled after the actual end, so the latch period is at least as long
+    is_tx_done_ = true;
+    tx_done_us_ = esp_timer_get_time();
+  }
+  return esp_timer_get_time() - tx_done_us_ < latch_time_us_;
+#else
+  return false;
+#endif
+}
+
+void NeoPixel::showWhenIdle() {
+#ifdef ESP32
+  // Only blocks when called while a frame is being sent
+  if (rmt_channel_ < 0) {
+    return;
+  }
+  rmt_wait_tx_done(static_cast<rmt_channel_t>(rmt_channel_), portMAX_DELAY);
+  while (isSending()) {
+    delayMicroseconds(latch_time_us_ / 10);
+  }
+#endif
+  show();
 }
 
 String NeoPixel::invalidColorEncodingError(const String& color_encoding) {
@@ -72,12 +190,6 @@ std::shared_ptr<Peripheral> NeoPixel::factory(
   return std::make_shared<NeoPixel>(parameter);
 }
 
-bool NeoPixel::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
-bool NeoPixel::capability_led_strip_ =
-    capabilities::LedStrip::registerType(type());
-
 const __FlashStringHelper* NeoPixel::color_encoding_key_ = FPSTR("color_encoding");
 const __FlashStringHelper* NeoPixel::color_encoding_key_error_ FPSTR(
     "Missing property: color_encoding (string)");
@@ -87,6 +199,12 @@ const __FlashStringHelper* NeoPixel::led_pin_key_error_ =
 const __FlashStringHelper* NeoPixel::led_count_key_ = FPSTR("led_count");
 const __FlashStringHelper* NeoPixel::led_count_key_error_ FPSTR(
     "Missing property: led_count (unsigned int)");
+#ifdef ESP32
+const __FlashStringHelper* NeoPixel::rmt_taken_error_ =
+    FPSTR("All RMT channels already taken");
+const __FlashStringHelper* NeoPixel::rmt_error_ =
+    FPSTR("Failed to configure the RMT channel");
+#endif
 
 uint8_t NeoPixel::getColorEncoding(String encoding_str) {
   // Check that it is a valid rgb_encoding
@@ -126,6 +244,35 @@ uint8_t NeoPixel::getColorEncoding(String encoding_str) {
   return neo_encoding;
 }
 
+#ifdef ESP32
+void IRAM_ATTR NeoPixel::toRmtItems(const void* src, rmt_item32_t* dest,
+                                    size_t src_size, size_t wanted_num,
+                                    size_t* translated_size,
+                                    size_t* item_num) {
+  // WS2812 timing in 25 ns ticks. 0: 400 ns high, 850 ns low and
+  // 1: 800 ns high, 450 ns low. Each item holds the high and the low period
+  constexpr uint32_t bit_0 = 16 | (1 << 15) | (34 << 16);
+  constexpr uint32_t bit_1 = 32 | (1 << 15) | (18 << 16);
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(src);
+  size_t size = 0;
+  size_t num = 0;
+  while (size < src_size && num + 8 <= wanted_num) {
+    for (int bit = 7; bit >= 0; bit--) {
+      dest[num].val = (bytes[size] >> bit) & 1 ? bit_1 : bit_0;
+      num++;
+    }
+    size++;
+  }
+  *translated_size = size;
+  *item_num = num;
+}
+
+std::bitset<SOC_RMT_TX_CANDIDATES_PER_GROUP> NeoPixel::busy_channels_;
+constexpr uint8_t NeoPixel::rmt_clock_divider_;
+constexpr uint32_t NeoPixel::latch_time_us_;
+#endif
+
 bool NeoPixel::cleanColorEncoding(String& color_encoding) {
   std::transform(color_encoding.begin(), color_encoding.end(),
                  color_encoding.begin(), ::tolower);
@@ -4,6 +4,13 @@
 #include <ArduinoJson.h>
 
 #include <memory>
+#include <vector>
+#ifdef ESP32
+#include <bitset>
+
+#include "driver/rmt.h"
+#include "soc/soc_caps.h"
+#endif
 
 #include "managers/service_getters.h"
 #include "peripheral/capabilities/led_strip.h"
@@ -17,15 +24,24 @@ namespace neo_pixel {
 
 /**
  * A peripheral to control NeoPixels
+ *
+ * Pixels are set in a frame buffer and sent with show(). On the ESP32, the
+ * frame is sent by an RMT channel from a second buffer, so show() returns
+ * immediately and the next frame can be drawn during the transmission.
  */
 class NeoPixel : public Peripheral, public capabilities::LedStrip {
  public:
   NeoPixel(const JsonObjectConst& parameters);
-  virtual ~NeoPixel() = default;
+  virtual ~NeoPixel();
 
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::LedStrip* asLedStrip() final;
 
   /**
    * Turns on all LEDs in a strip to a specific color
@@ -39,13 +55,29 @@ class NeoPixel : public Peripheral, public capabilities::LedStrip {
    */
   void turnOff() final;
 
+  size_t getPixelCount() const final;
+
+  void setPixel(size_t index, utils::Color color) final;
+
+  bool show() final;
+
  private:
-  static String invalidColorEncodingError(const String& color_encoding);
+  /**
+   * Checks whether the previous frame is still being sent
+   *
+   * Includes the low period after a frame with which the LEDs latch it.
+   * Does not block.
+   *
+   * \return True if no new frame can be sent yet
+   */
+  bool isSending();
 
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameters);
-  static bool registered_;
-  static bool capability_led_strip_;
+  /**
+   * Shows the frame buffer after waiting for the previous frame to be sent
+   */
+  void showWhenIdle();
+
+  static String invalidColorEncodingError(const String& color_encoding);
 
   static const uint8_t blue_offset_{0};
   static const uint8_t green_offset_{2};
@@ -58,12 +90,45 @@ class NeoPixel : public Peripheral, public capabilities::LedStrip {
   static const __FlashStringHelper* led_pin_key_error_;
   static const __FlashStringHelper* led_count_key_;
   static const __FlashStringHelper* led_count_key_error_;
+#ifdef ESP32
+  static const __FlashStringHelper* rmt_taken_error_;
+  static const __FlashStringHelper* rmt_error_;
+#endif
 
   uint8_t getColorEncoding(String color_encoding);
   bool cleanColorEncoding(String& color_encoding);
 
+  /// Encodes the colors and holds the frame buffer
   Adafruit_NeoPixel driver_;
   bool is_driver_started_ = false;
+  /// 3 for RGB and 4 for RGBW pixels
+  uint8_t bytes_per_pixel_ = 3;
+
+#ifdef ESP32
+  /**
+   * Translates the bytes of a frame to RMT items with the WS2812 bit timing
+   *
+   * Called from the RMT interrupt while the frame is being sent.
+   */
+  static void IRAM_ATTR toRmtItems(const void* src, rmt_item32_t* dest,
+                                   size_t src_size, size_t wanted_num,
+                                   size_t* translated_size, size_t* item_num);
+
+  /// RMT channels used by NeoPixels
+  static std::bitset<SOC_RMT_TX_CANDIDATES_PER_GROUP> busy_channels_;
+
+  /// RMT clock divider of the 80 MHz APB clock, giving 25 ns ticks
+  static constexpr uint8_t rmt_clock_divider_ = 2;
+  /// Low period after a frame with which the LEDs latch it in us
+  static constexpr uint32_t latch_time_us_ = 300;
+
+  int rmt_channel_ = -1;
+  /// Copy of the frame buffer that is read while being sent
+  std::vector<uint8_t> tx_buffer_;
+  /// Whether the RMT finished sending tx_buffer_ and when it was noticed
+  bool is_tx_done_ = true;
+  int64_t tx_done_us_ = 0;
+#endif
 };
 
 }  // namespace neo_pixel
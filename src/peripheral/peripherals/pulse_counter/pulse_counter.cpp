@@ -0,0 +1,224 @@
+#ifdef ESP32
+#include "pulse_counter.h"
+
+#include <esp_timer.h>
+
+#include "peripheral/peripheral_factory.h"
+#include "utils/error_store.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace pulse_counter {
+
+std::bitset<PCNT_UNIT_MAX> PulseCounter::busy_units_;
+
+PulseCounter::PulseCounter(const JsonObjectConst& parameters)
+    : accumulator_(counter_, counter_limit_, min_frequency_window_us_) {
+  const int pin = toPin(parameters[pin_key_]);
+  if (pin < 0) {
+    setInvalid(pin_key_error_);
+    return;
+  }
+
+  // Count rising edges by default, which is when S0 outputs close
+  pcnt_count_mode_t pos_mode = PCNT_COUNT_INC;
+  pcnt_count_mode_t neg_mode = PCNT_COUNT_DIS;
+  JsonVariantConst count_edges = parameters[count_edges_key_];
+  if (count_edges == count_edges_falling_) {
+    pos_mode = PCNT_COUNT_DIS;
+    neg_mode = PCNT_COUNT_INC;
+  } else if (count_edges == count_edges_both_) {
+    neg_mode = PCNT_COUNT_INC;
+  } else if (!count_edges.isNull() && count_edges != count_edges_rising_) {
+    setInvalid(count_edges_key_error_);
+    return;
+  }
+
+  const uint32_t filter_ns = parameters[filter_ns_key_] | default_filter_ns_;
+  if (filter_ns > max_filter_ns_) {
+    setInvalid(filter_ns_key_error_);
+    return;
+  }
+
+  count_data_point_type_ = utils::UUID(parameters[count_data_point_type_key_]);
+  if (!count_data_point_type_.isValid()) {
+    setInvalid(ErrorStore::genMissingProperty(count_data_point_type_key_,
+                                              ErrorStore::KeyType::kUUID));
+    return;
+  }
+  JsonVariantConst frequency_data_point_type =
+      parameters[frequency_data_point_type_key_];
+  if (!frequency_data_point_type.isNull()) {
+    frequency_data_point_type_ = utils::UUID(frequency_data_point_type);
+    if (!frequency_data_point_type_.isValid()) {
+      setInvalid(ErrorStore::genMissingProperty(frequency_data_point_type_key_,
+                                                ErrorStore::KeyType::kUUID));
+      return;
+    }
+  }
+  JsonVariantConst rate_data_point_type = parameters[rate_data_point_type_key_];
+  if (!rate_data_point_type.isNull()) {
+    rate_data_point_type_ = utils::UUID(rate_data_point_type);
+    if (!rate_data_point_type_.isValid()) {
+      setInvalid(ErrorStore::genMissingProperty(rate_data_point_type_key_,
+                                                ErrorStore::KeyType::kUUID));
+      return;
+    }
+  }
+  rate_factor_ = parameters[rate_factor_key_] | 1.0f;
+
+  // Reserve a free PCNT unit
+  for (size_t unit = 0; unit < busy_units_.size(); unit++) {
+    if (!busy_units_[unit]) {
+      busy_units_[unit] = true;
+      unit_ = unit;
+      break;
+    }
+  }
+  if (unit_ < 0) {
+    setInvalid(no_units_available_error_);
+    return;
+  }
+
+  // The counter is reset on reaching its upper limit, which raises the
+  // interrupt that accumulates the total
+  const pcnt_unit_t unit = static_cast<pcnt_unit_t>(unit_);
+  counter_.unit = unit;
+  pcnt_config_t config = {};
+  config.pulse_gpio_num = pin;
+  config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  config.lctrl_mode = PCNT_MODE_KEEP;
+  config.hctrl_mode = PCNT_MODE_KEEP;
+  config.pos_mode = pos_mode;
+  config.neg_mode = neg_mode;
+  config.counter_h_lim = counter_limit_;
+  config.counter_l_lim = 0;
+  config.unit = unit;
+  config.channel = PCNT_CHANNEL_0;
+  // The ISR service may already be installed by another pulse counter
+  const esp_err_t isr_error = pcnt_isr_service_install(0);
+  if (pcnt_unit_config(&config) != ESP_OK ||
+      (isr_error != ESP_OK && isr_error != ESP_ERR_INVALID_STATE)) {
+    setInvalid(pcnt_error_);
+    return;
+  }
+  pcnt_counter_pause(unit);
+  pcnt_counter_clear(unit);
+
+  // Filter lengths are given in APB clock cycles (80 MHz)
+  const uint16_t filter_cycles = filter_ns * 80 / 1000;
+  if (filter_cycles) {
+    pcnt_set_filter_value(unit, filter_cycles);
+    pcnt_filter_enable(unit);
+  } else {
+    pcnt_filter_disable(unit);
+  }
+
+  pcnt_event_enable(unit, PCNT_EVT_H_LIM);
+  if (pcnt_isr_handler_add(unit, onLimit, this) != ESP_OK) {
+    setInvalid(pcnt_error_);
+    return;
+  }
+  accumulator_.reset(esp_timer_get_time());
+  pcnt_counter_resume(unit);
+}
+
+PulseCounter::~PulseCounter() {
+  if (unit_ < 0) {
+    return;
+  }
+  const pcnt_unit_t unit = static_cast<pcnt_unit_t>(unit_);
+  pcnt_counter_pause(unit);
+  pcnt_event_disable(unit, PCNT_EVT_H_LIM);
+  pcnt_isr_handler_remove(unit);
+  busy_units_[unit_] = false;
+}
+
+const String& PulseCounter::getType() const { return type(); }
+
+const String& PulseCounter::type() {
+  static const String name{"PulseCounter"};
+  return name;
+}
+
+capabilities::GetValues* PulseCounter::asGetValues() { return this; }
+
+capabilities::GetValues::Result PulseCounter::getValues() {
+  const utils::PulseAccumulator::Reading reading =
+      accumulator_.read(esp_timer_get_time());
+
+  capabilities::GetValues::Result result = {
+      .values = {utils::ValueUnit{
+          .value = static_cast<float>(reading.total),
+          .data_point_type = count_data_point_type_}}};
+  if (frequency_data_point_type_.isValid()) {
+    result.values.push_back(utils::ValueUnit{
+        .value = reading.frequency_hz,
+        .data_point_type = frequency_data_point_type_});
+  }
+  if (rate_data_point_type_.isValid()) {
+    result.values.push_back(
+        utils::ValueUnit{.value = reading.frequency_hz * rate_factor_,
+                         .data_point_type = rate_data_point_type_});
+  }
+  return result;
+}
+
+uint64_t PulseCounter::getTotal() const { return accumulator_.getTotal(); }
+
+void IRAM_ATTR PulseCounter::onLimit(void* arg) {
+  PulseCounter& pulse_counter = *static_cast<PulseCounter*>(arg);
+  pulse_counter.accumulator_.addOverflow();
+}
+
+int16_t PulseCounter::PcntCounter::getCount() {
+  int16_t count = 0;
+  pcnt_get_counter_value(unit, &count);
+  return count;
+}
+
+std::shared_ptr<Peripheral> PulseCounter::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<PulseCounter>(parameters);
+}
+
+constexpr int16_t PulseCounter::counter_limit_;
+constexpr int64_t PulseCounter::min_frequency_window_us_;
+constexpr uint32_t PulseCounter::default_filter_ns_;
+constexpr uint32_t PulseCounter::max_filter_ns_;
+
+const __FlashStringHelper* PulseCounter::pin_key_ = FPSTR("pin");
+const __FlashStringHelper* PulseCounter::pin_key_error_ =
+    FPSTR("Missing property: pin (unsigned int)");
+const __FlashStringHelper* PulseCounter::count_edges_key_ =
+    FPSTR("count_edges");
+const __FlashStringHelper* PulseCounter::count_edges_key_error_ =
+    FPSTR("Wrong property: count_edges (rising, falling, both)");
+const __FlashStringHelper* PulseCounter::count_edges_rising_ =
+    FPSTR("rising");
+const __FlashStringHelper* PulseCounter::count_edges_falling_ =
+    FPSTR("falling");
+const __FlashStringHelper* PulseCounter::count_edges_both_ = FPSTR("both");
+const __FlashStringHelper* PulseCounter::filter_ns_key_ = FPSTR("filter_ns");
+const __FlashStringHelper* PulseCounter::filter_ns_key_error_ =
+    FPSTR("Wrong property: filter_ns (0 - 12787)");
+const __FlashStringHelper* PulseCounter::rate_factor_key_ =
+    FPSTR("rate_factor");
+const __FlashStringHelper* PulseCounter::count_data_point_type_key_ =
+    FPSTR("count_data_point_type");
+const __FlashStringHelper* PulseCounter::frequency_data_point_type_key_ =
+    FPSTR("frequency_data_point_type");
+const __FlashStringHelper* PulseCounter::rate_data_point_type_key_ =
+    FPSTR("rate_data_point_type");
+const __FlashStringHelper* PulseCounter::no_units_available_error_ =
+    FPSTR("No PCNT units available");
+const __FlashStringHelper* PulseCounter::pcnt_error_ =
+    FPSTR("Failed to configure PCNT unit");
+
+}  // namespace pulse_counter
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <driver/pcnt.h>
+
+#include <bitset>
+#include <memory>
+
+#include "managers/service_getters.h"
+#include "peripheral/capabilities/get_values.h"
+#include "peripheral/peripheral.h"
+#include "utils/pulse_accumulator.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace pulse_counter {
+
+/**
+ * Counts pulses, e.g. of flow or S0 energy meters, with the ESP32's PCNT unit
+ *
+ * The hardware counts the pulses without loading the CPU and filters glitches
+ * shorter than the filter time. Only when the 16-bit counter reaches its limit
+ * an interrupt adds it to the 64-bit total. The frequency is calculated from
+ * the pulses since the previous reading and the rate is the frequency scaled
+ * by a factor, e.g. to liters per minute or watts.
+ */
+class PulseCounter : public Peripheral, public capabilities::GetValues {
+ public:
+  PulseCounter(const JsonObjectConst& parameters);
+  virtual ~PulseCounter();
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+
+  /**
+   * Gets the total count and optionally the frequency and rate
+   *
+   * \return The values since the peripheral was created or the last reading
+   */
+  capabilities::GetValues::Result getValues() final;
+
+  /**
+   * Gets the number of pulses since the peripheral was created
+   *
+   * \return The total number of pulses
+   */
+  uint64_t getTotal() const;
+
+ private:
+  /// Reads the count of a PCNT unit
+  class PcntCounter : public utils::PulseAccumulator::Counter {
+   public:
+    int16_t getCount() final;
+
+    pcnt_unit_t unit = PCNT_UNIT_0;
+  };
+
+  /**
+   * Adds the counter's limit to the total. Runs in the interrupt context
+   *
+   * \param arg The pulse counter whose limit was reached
+   */
+  static void IRAM_ATTR onLimit(void* arg);
+
+  /// Marks which PCNT units are in use. The S3 has fewer than the ESP32
+  static std::bitset<PCNT_UNIT_MAX> busy_units_;
+
+  int unit_ = -1;
+  PcntCounter counter_;
+  /// Sums up the counter's overflows and calculates the frequency
+  utils::PulseAccumulator accumulator_;
+
+  float rate_factor_ = 1;
+
+  utils::UUID count_data_point_type_{nullptr};
+  utils::UUID frequency_data_point_type_{nullptr};
+  utils::UUID rate_data_point_type_{nullptr};
+
+  /// Value at which the counter is reset to zero
+  static constexpr int16_t counter_limit_ = 30000;
+  /// Readings closer together keep the previous frequency
+  static constexpr int64_t min_frequency_window_us_ = 100000;
+  /// Default length of glitches to filter
+  static constexpr uint32_t default_filter_ns_ = 1000;
+  /// Longest glitch the filter supports (1023 APB cycles at 80 MHz)
+  static constexpr uint32_t max_filter_ns_ = 12787;
+
+  static const __FlashStringHelper* pin_key_;
+  static const __FlashStringHelper* pin_key_error_;
+  static const __FlashStringHelper* count_edges_key_;
+  static const __FlashStringHelper* count_edges_key_error_;
+  static const __FlashStringHelper* count_edges_rising_;
+  static const __FlashStringHelper* count_edges_falling_;
+  static const __FlashStringHelper* count_edges_both_;
+  static const __FlashStringHelper* filter_ns_key_;
+  static const __FlashStringHelper* filter_ns_key_error_;
+  static const __FlashStringHelper* rate_factor_key_;
+  static const __FlashStringHelper* count_data_point_type_key_;
+  static const __FlashStringHelper* frequency_data_point_type_key_;
+  static const __FlashStringHelper* rate_data_point_type_key_;
+  static const __FlashStringHelper* no_units_available_error_;
+  static const __FlashStringHelper* pcnt_error_;
+};
+
+}  // namespace pulse_counter
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
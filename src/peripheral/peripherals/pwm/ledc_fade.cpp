@@ -0,0 +1,117 @@
+#ifdef ESP32
+#include "ledc_fade.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace pwm {
+
+constexpr std::chrono::milliseconds LedcFade::max_segment_duration;
+constexpr uint32_t LedcFade::min_curve_segments;
+
+bool LedcFade::fade_installed_ = false;
+
+LedcFade::LedcFade(uint8_t channel, Scheduler& scheduler)
+    : Task(TASK_IMMEDIATE, TASK_FOREVER, &scheduler, false),
+      // The Arduino core maps the channels 0-7 and 8-15 to the speed modes
+      mode_(static_cast<ledc_mode_t>(channel / 8)),
+      channel_(static_cast<ledc_channel_t>(channel % 8)) {}
+
+bool LedcFade::install() {
+  if (!fade_installed_) {
+    fade_installed_ = ledc_fade_func_install(0) == ESP_OK;
+  }
+  return fade_installed_;
+}
+
+void LedcFade::start(uint32_t target_duty, std::chrono::milliseconds duration,
+                     capabilities::RampValue::Curve curve) {
+  target_duty_ = target_duty;
+  duration_ = duration;
+  curve_ = curve;
+  has_pending_duty_ = false;
+
+  // Short segments keep the ramp responsive and follow the curve closely
+  segment_count_ = (duration.count() + max_segment_duration.count() - 1) /
+                   max_segment_duration.count();
+  if (curve != capabilities::RampValue::Curve::kLinear) {
+    segment_count_ = std::max(segment_count_, min_curve_segments);
+  }
+  segment_count_ =
+      std::min(segment_count_, static_cast<uint32_t>(duration.count()));
+  segment_index_ = 0;
+
+  if (segment_count_ == 0) {
+    setDuty(target_duty);
+    return;
+  }
+  // Otherwise continues from the end of the running segment
+  if (!is_fading_) {
+    start_duty_ = ledc_get_duty(mode_, channel_);
+    startSegment();
+  }
+}
+
+void LedcFade::setDuty(uint32_t duty) {
+  segment_count_ = 0;
+  segment_index_ = 0;
+  if (is_fading_) {
+    has_pending_duty_ = true;
+    pending_duty_ = duty;
+    return;
+  }
+  ledc_set_duty(mode_, channel_, duty);
+  ledc_update_duty(mode_, channel_);
+}
+
+bool LedcFade::isFading() const { return is_fading_; }
+
+bool LedcFade::Callback() {
+  is_fading_ = false;
+  if (has_pending_duty_) {
+    has_pending_duty_ = false;
+    setDuty(pending_duty_);
+  }
+
+  // A replacing ramp starts from the duty the last segment ended at
+  if (segment_index_ == 0 && segment_count_ > 0) {
+    start_duty_ = ledc_get_duty(mode_, channel_);
+  }
+  if (segment_index_ < segment_count_) {
+    startSegment();
+  } else {
+    disable();
+  }
+  return true;
+}
+
+void LedcFade::startSegment() {
+  // Time and duty at the end of the segment
+  const int64_t total_ms = duration_.count();
+  const int64_t start_ms = total_ms * segment_index_ / segment_count_;
+  segment_index_++;
+  const int64_t end_ms = total_ms * segment_index_ / segment_count_;
+  const float change = capabilities::RampValue::applyCurve(
+      curve_, static_cast<float>(end_ms) / total_ms);
+  const uint32_t duty = roundf(
+      start_duty_ + change * (static_cast<float>(target_duty_) - start_duty_));
+
+  const int segment_ms = end_ms - start_ms;
+  ledc_set_fade_with_time(mode_, channel_, duty, segment_ms);
+  ledc_fade_start(mode_, channel_, LEDC_FADE_NO_WAIT);
+  is_fading_ = true;
+
+  // Wake up when the hardware finished the segment
+  enableIfNot();
+  delay(segment_ms);
+}
+
+}  // namespace pwm
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+
+#include <chrono>
+
+#include "driver/ledc.h"
+#include "peripheral/capabilities/ramp_value.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace pwm {
+
+/**
+ * Ramps the duty cycle of an LEDC channel with the hardware fade engine
+ *
+ * The ramp is split into linear segments that the hardware fades through on
+ * its own. The task only wakes up at the end of each segment to start the
+ * next one, which also approximates non-linear curves.
+ *
+ * The driver blocks duty changes while a segment is fading. A new duty is
+ * therefore applied at the end of the running segment, which is limited to
+ * max_segment_duration.
+ */
+class LedcFade : public Task {
+ public:
+  /**
+   * Creates a fader for a channel set up with ledcSetup()
+   *
+   * \param channel The Arduino LEDC channel number
+   * \param scheduler The scheduler to run the segments
+   */
+  LedcFade(uint8_t channel, Scheduler& scheduler);
+  virtual ~LedcFade() = default;
+
+  /**
+   * Installs the fade interrupt of the LEDC driver once
+   *
+   * \return True if the fade engine can be used
+   */
+  static bool install();
+
+  /**
+   * Starts a ramp from the current to the target duty cycle
+   *
+   * Replaces a running ramp at the end of its current segment.
+   *
+   * \param target_duty The duty cycle at the end of the ramp
+   * \param duration The duration of the ramp
+   * \param curve The shape of the ramp
+   */
+  void start(uint32_t target_duty, std::chrono::milliseconds duration,
+             capabilities::RampValue::Curve curve);
+
+  /**
+   * Sets the duty cycle and ends a running ramp
+   *
+   * \param duty The new duty cycle
+   */
+  void setDuty(uint32_t duty);
+
+  /**
+   * Checks if the hardware is fading through a segment
+   *
+   * \return True while a segment is running
+   */
+  bool isFading() const;
+
+  bool Callback() final;
+
+  /// Longest segment, which limits the delay of a duty change during a ramp
+  static constexpr std::chrono::milliseconds max_segment_duration{250};
+  /// Minimum number of segments to approximate non-linear curves
+  static constexpr uint32_t min_curve_segments = 8;
+
+ private:
+  /**
+   * Starts fading through the next segment of the ramp
+   */
+  void startSegment();
+
+  static bool fade_installed_;
+
+  ledc_mode_t mode_;
+  ledc_channel_t channel_;
+
+  uint32_t start_duty_ = 0;
+  uint32_t target_duty_ = 0;
+  std::chrono::milliseconds duration_{0};
+  capabilities::RampValue::Curve curve_ =
+      capabilities::RampValue::Curve::kLinear;
+  uint32_t segment_count_ = 0;
+  uint32_t segment_index_ = 0;
+  bool is_fading_ = false;
+
+  /// Duty cycle to be set once the running segment ends
+  bool has_pending_duty_ = false;
+  uint32_t pending_duty_ = 0;
+};
+
+}  // namespace pwm
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -1,6 +1,7 @@
 #ifdef ESP32
 #include "pwm.h"
 
+#include "managers/services.h"
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -28,9 +29,16 @@ Pwm::Pwm(const ServiceGetters& services, const JsonObjectConst& parameters) {
     return;
   }
 
-  bool error = setup(pin);
-  if (error) {
-    setInvalid(no_channels_available_error_);
+  const uint32_t frequency = parameters[frequency_key_] | default_frequency_;
+  const int resolution = parameters[resolution_key_] | default_resolution_;
+  if (frequency == 0 || resolution < 1 || resolution > max_resolution_) {
+    setInvalid(frequency_resolution_error_);
+    return;
+  }
+
+  ErrorResult error = setup(pin, frequency, resolution);
+  if (error.isError()) {
+    setInvalid(error.detail_);
     return;
   }
 }
@@ -44,6 +52,10 @@ const String& Pwm::type() {
   return name;
 }
 
+capabilities::SetValue* Pwm::asSetValue() { return this; }
+
+capabilities::RampValue* Pwm::asRampValue() { return this; }
+
 void Pwm::setValue(utils::ValueUnit value_unit) {
   if (value_unit.data_point_type != data_point_type_) {
     web_socket_->sendError(type(),
@@ -60,14 +72,56 @@ void Pwm::setValue(utils::ValueUnit value_unit) {
   // - On an ESP32-WROOM-32, pin 32
   // - RIGOL DS1102
   // - 220 ohm and difuse red LED
-  value_unit.value = std::fmax(0, std::fmin(1, value_unit.value));
-  const uint32_t max_value = (1 << resolution_) - 1;
-  const uint32_t duty = roundf(value_unit.value * max_value);
-  ledcWrite(channel_, duty);
+  fade_->setDuty(toDuty(value_unit.value));
 }
 
-bool Pwm::setup(const uint8_t pin, const uint32_t frequency,
-                const uint8_t resolution) {
+ErrorResult Pwm::rampValue(const Ramp& ramp) {
+  utils::ValueUnit target = ramp.target;
+  if (target.data_point_type != data_point_type_) {
+    return ErrorResult(type(), target.sourceUnitError(data_point_type_));
+  }
+  if (!LedcFade::install()) {
+    return ErrorResult(type(), fade_error_);
+  }
+
+  fade_->start(toDuty(target.value), ramp.duration, ramp.curve);
+  return ErrorResult();
+}
+
+ErrorResult Pwm::update(const JsonObjectConst& parameters) {
+  const uint32_t frequency =
+      parameters[frequency_key_] | channel_frequencies_[channel_];
+  const int resolution = parameters[resolution_key_] | resolution_;
+  if (frequency == 0 || resolution < 1 || resolution > max_resolution_) {
+    return ErrorResult(type(), frequency_resolution_error_);
+  }
+  if (fade_->isFading()) {
+    return ErrorResult(type(), ramp_running_error_);
+  }
+
+  // Both channels of a timer run at the same frequency and resolution
+  const int sibling = channel_ ^ 1;
+  if (busy_channels_[sibling] &&
+      (channel_frequencies_[sibling] != frequency ||
+       channel_resolutions_[sibling] != resolution)) {
+    return ErrorResult(type(), shared_timer_error_);
+  }
+
+  // Keep the duty cycle as a fraction of the new resolution
+  const float value =
+      static_cast<float>(ledcRead(channel_)) / ((1 << resolution_) - 1);
+  if (ledcSetup(channel_, frequency, resolution) == 0) {
+    return ErrorResult(type(), frequency_resolution_error_);
+  }
+  resolution_ = resolution;
+  channel_frequencies_[channel_] = frequency;
+  channel_resolutions_[channel_] = resolution;
+  fade_->setDuty(toDuty(value));
+  return ErrorResult();
+}
+
+ErrorResult Pwm::setup(const uint8_t pin, const uint32_t frequency,
+                       const uint8_t resolution) {
   // If the PWM has already been setup, free it
   if (channel_ != -1 || pin_ != -1) {
     freeResources();
@@ -75,35 +129,55 @@ bool Pwm::setup(const uint8_t pin, const uint32_t frequency,
 
   // Checks if there are any free channels remaining
   if (busy_channels_.all()) {
-    return true;
+    return ErrorResult(type(), no_channels_available_error_);
   }
 
-  // Find the first free channel
+  // Prefer a free channel with a free timer. Otherwise share the timer with a
+  // channel with the same frequency and resolution
+  int channel = -1;
   for (int i = 0; i < busy_channels_.size(); i++) {
-    if (!busy_channels_.test(i)) {
-      channel_ = i;
+    if (busy_channels_.test(i)) {
+      continue;
+    }
+    const int sibling = i ^ 1;
+    if (!busy_channels_.test(sibling)) {
+      channel = i;
       break;
     }
+    if (channel < 0 && channel_frequencies_[sibling] == frequency &&
+        channel_resolutions_[sibling] == resolution) {
+      channel = i;
+    }
+  }
+  if (channel < 0) {
+    return ErrorResult(type(), shared_timer_error_);
+  }
+
+  // Setup the channel
+  if (ledcSetup(channel, frequency, resolution) == 0) {
+    return ErrorResult(type(), frequency_resolution_error_);
   }
 
   // Reserve the channel as well as saving the pin and resolution
-  busy_channels_[channel_] = true;
+  busy_channels_[channel] = true;
+  channel_frequencies_[channel] = frequency;
+  channel_resolutions_[channel] = resolution;
+  channel_ = channel;
   pin_ = pin;
   resolution_ = resolution;
 
-  // Setup the channel
-  ledcSetup(channel_, frequency, resolution);
-
   // Attach the pin to the configured channel
   ledcAttachPin(pin_, channel_);
+  fade_.reset(new LedcFade(channel_, Services::getScheduler()));
 
-  return false;
+  return ErrorResult();
 }
 
 void Pwm::freeResources() {
   if (channel_ >= 0 && channel_ < busy_channels_.size()) {
     busy_channels_[channel_] = false;
   }
+  fade_.reset();
   ledcDetachPin(pin_);
   pin_ = -1;
   channel_ = -1;
@@ -113,19 +187,38 @@ void Pwm::freeResources() {
 const __FlashStringHelper* Pwm::pin_key_ = FPSTR("pin");
 const __FlashStringHelper* Pwm::pin_key_error_ =
     FPSTR("Missing property: pin (unsigned int)");
+const __FlashStringHelper* Pwm::frequency_key_ = FPSTR("frequency");
+const __FlashStringHelper* Pwm::resolution_key_ = FPSTR("resolution");
+const __FlashStringHelper* Pwm::frequency_resolution_error_ =
+    FPSTR("Invalid frequency (Hz) or resolution (1-20 bits)");
 const __FlashStringHelper* Pwm::no_channels_available_error_ =
     FPSTR("No remaining PWM channels available");
+const __FlashStringHelper* Pwm::shared_timer_error_ =
+    FPSTR("PWM timer shared with a different frequency or resolution");
+const __FlashStringHelper* Pwm::fade_error_ =
+    FPSTR("Failed to install the LEDC fade engine");
+const __FlashStringHelper* Pwm::ramp_running_error_ =
+    FPSTR("Ramp still running");
 
 std::shared_ptr<Peripheral> Pwm::factory(const ServiceGetters& services,
                                          const JsonObjectConst& parameters) {
   return std::make_shared<Pwm>(services, parameters);
 }
 
-bool Pwm::registered_ = PeripheralFactory::registerFactory(type(), factory);
-
-bool Pwm::capability_set_value_ = capabilities::SetValue::registerType(type());
+uint32_t Pwm::toDuty(float value) const {
+  // Clamp the value as a percentage between 0 and 1
+  value = std::fmax(0, std::fmin(1, value));
+  const uint32_t max_value = (1 << resolution_) - 1;
+  return roundf(value * max_value);
+}
 
 std::bitset<16> Pwm::busy_channels_;
+std::array<uint32_t, 16> Pwm::channel_frequencies_;
+std::array<uint8_t, 16> Pwm::channel_resolutions_;
+
+constexpr uint32_t Pwm::default_frequency_;
+constexpr uint8_t Pwm::default_resolution_;
+constexpr uint8_t Pwm::max_resolution_;
 
 }  // namespace pwm
 }  // namespace peripherals
@@ -2,19 +2,31 @@
 
 #include <ArduinoJson.h>
 
+#include <array>
 #include <bitset>
 #include <memory>
 
 #include "managers/service_getters.h"
+#include "peripheral/capabilities/ramp_value.h"
 #include "peripheral/capabilities/set_value.h"
 #include "peripheral/peripheral.h"
+#include "peripheral/peripherals/pwm/ledc_fade.h"
 
 namespace inamata {
 namespace peripheral {
 namespace peripherals {
 namespace pwm {
 
-class Pwm : public Peripheral, public capabilities::SetValue {
+/**
+ * A PWM output on an LEDC channel
+ *
+ * Ramps to a value with the LEDC hardware fade engine. The frequency and
+ * resolution can be changed with an update while the output keeps its duty
+ * cycle.
+ */
+class Pwm : public Peripheral,
+            public capabilities::SetValue,
+            public capabilities::RampValue {
  public:
   Pwm(const ServiceGetters& services, const JsonObjectConst& parameters);
   virtual ~Pwm();
@@ -22,55 +34,100 @@ class Pwm : public Peripheral, public capabilities::SetValue {
   // Type registration in the peripheral factory
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::SetValue* asSetValue() final;
+  capabilities::RampValue* asRampValue() final;
 
   /**
    * Turn on the connected PWM signal to the specified value
    *
+   * Ends a running ramp, at the latest after LedcFade::max_segment_duration.
+   *
    * \param value A value between 0 and 1 sets the percentage brightness
    */
   void setValue(utils::ValueUnit value_unit);
 
+  /**
+   * Ramps the PWM signal to the target value with the hardware fade engine
+   *
+   * \param ramp The target between 0 and 1, the duration and the curve
+   * \return Whether the ramp was started
+   */
+  ErrorResult rampValue(const Ramp& ramp) final;
+
+  /**
+   * Changes the frequency and resolution while keeping the duty cycle
+   *
+   * \param parameters Optional frequency and resolution
+   * \return Contains the cause of the error, if the update failed
+   */
+  ErrorResult update(const JsonObjectConst& parameters) final;
+
  private:
   /**
    * Reserves and sets up a free PWM channel
    *
+   * Prefers channels whose timer is not shared with another PWM output, so
+   * that each output can have its own frequency.
+   *
    * \param pin Pin number with which the PWM signal is connected
    * \param frequency Frequency of the PWM signal
    * \param resolution Resolution of the duty cycle
-   * \return True if an error occured while setting up the channel
+   * \return Contains the cause of the error, if the setup failed
    */
-  bool setup(const uint8_t pin, const uint32_t frequency = 5000,
-             const uint8_t resolution = 8);
+  ErrorResult setup(const uint8_t pin, const uint32_t frequency,
+                    const uint8_t resolution);
 
   /**
    * Frees the configured PWM channel and pin
    */
   void freeResources();
 
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst& parameters);
-  static bool registered_;
-  static bool capability_set_value_;
+  /**
+   * Converts a value between 0 and 1 to the duty cycle
+   *
+   * \param value The value, which is clamped between 0 and 1
+   * \return The duty cycle at the current resolution
+   */
+  uint32_t toDuty(float value) const;
 
   /// Interface to send data to the server
   std::shared_ptr<WebSocket> web_socket_;
 
   /// Marks which PWM channels are currently in use
   static std::bitset<16> busy_channels_;
+  /// Frequency of the channels in use. Two channels share a timer
+  static std::array<uint32_t, 16> channel_frequencies_;
+  static std::array<uint8_t, 16> channel_resolutions_;
 
   utils::UUID data_point_type_{nullptr};
 
   int pin_ = -1;
   int channel_ = -1;
   int resolution_ = -1;
+  std::unique_ptr<LedcFade> fade_;
+
+  static constexpr uint32_t default_frequency_ = 5000;
+  static constexpr uint8_t default_resolution_ = 8;
+  /// Widest duty cycle resolution of all ESP32 variants' LEDC timers
+  static constexpr uint8_t max_resolution_ = 20;
 
   /// Name of the parameter to which the pin the PWM signal is connected
   static const __FlashStringHelper* pin_key_;
   static const __FlashStringHelper* pin_key_error_;
+  static const __FlashStringHelper* frequency_key_;
+  static const __FlashStringHelper* resolution_key_;
+  static const __FlashStringHelper* frequency_resolution_error_;
   static const __FlashStringHelper* no_channels_available_error_;
+  static const __FlashStringHelper* shared_timer_error_;
+  static const __FlashStringHelper* fade_error_;
+  static const __FlashStringHelper* ramp_running_error_;
 };
 
 }  // namespace pwm
 }  // namespace peripherals
 }  // namespace peripheral
-}  // namespace inamata
\ No newline at end of file
+}  // namespace inamata
@@ -0,0 +1,263 @@
+#ifdef ESP32
+#include "spectral_analyzer.h"
+
+#include "managers/services.h"
+#include "peripheral/peripheral_factory.h"
+#include "utils/esp_timer_sync.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spectral_analyzer {
+
+SpectralAnalyzer::SpectralAnalyzer(const JsonObjectConst& parameters)
+    : spectrum_(parameters[block_size_key_] | size_t(default_block_size_)),
+      raw_samples_(spectrum_.getBlockSize()) {
+  // Get the AnalogIn peripheral which provides the samples
+  utils::UUID analog_in_uuid(parameters[analog_in_key_]);
+  if (!analog_in_uuid.isValid()) {
+    setInvalid(ErrorStore::genMissingProperty(analog_in_key_,
+                                              ErrorStore::KeyType::kUUID));
+    return;
+  }
+  std::shared_ptr<Peripheral> peripheral =
+      Services::getPeripheralController().getPeripheral(analog_in_uuid);
+  if (peripheral && peripheral->getType() == analog_in::AnalogIn::type() &&
+      peripheral->isValid()) {
+    analog_in_ = std::static_pointer_cast<analog_in::AnalogIn>(peripheral);
+  } else {
+    setInvalid(
+        ErrorStore::genNotAValid(analog_in_uuid, analog_in::AnalogIn::type()));
+    return;
+  }
+
+  if (!spectrum_.getBlockSize()) {
+    setInvalid(block_size_key_error_);
+    return;
+  }
+
+  JsonVariantConst sample_rate_hz = parameters[sample_rate_hz_key_];
+  if (!sample_rate_hz.is<float>() || sample_rate_hz.as<float>() <= 0 ||
+      sample_rate_hz.as<float>() > max_sample_rate_hz_) {
+    setInvalid(sample_rate_hz_key_error_);
+    return;
+  }
+  sample_rate_hz_ = sample_rate_hz;
+
+  // Each feature is optional, but at least one has to be sent
+  rms_data_point_type_ = utils::UUID(parameters[rms_data_point_type_key_]);
+  crest_factor_data_point_type_ =
+      utils::UUID(parameters[crest_factor_data_point_type_key_]);
+  dominant_frequency_data_point_type_ =
+      utils::UUID(parameters[dominant_frequency_data_point_type_key_]);
+  if (!parseBands(parameters)) {
+    setInvalid(bands_key_error_);
+    return;
+  }
+  if (!rms_data_point_type_.isValid() &&
+      !crest_factor_data_point_type_.isValid() &&
+      !dominant_frequency_data_point_type_.isValid() && bands_.empty()) {
+    setInvalid(no_output_error_);
+    return;
+  }
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = captureSample,
+      .arg = this,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "spectral",
+      .skip_unhandled_events = false,
+  };
+  if (esp_timer_create(&timer_args, &timer_) != ESP_OK) {
+    timer_ = nullptr;
+    setInvalid(capture_error_);
+    return;
+  }
+}
+
+SpectralAnalyzer::~SpectralAnalyzer() {
+  if (timer_) {
+    stopCapture();
+    esp_timer_delete(timer_);
+  }
+}
+
+const String& SpectralAnalyzer::getType() const { return type(); }
+
+const String& SpectralAnalyzer::type() {
+  static const String name{"SpectralAnalyzer"};
+  return name;
+}
+
+capabilities::GetValues* SpectralAnalyzer::asGetValues() { return this; }
+
+capabilities::StartMeasurement* SpectralAnalyzer::asStartMeasurement() {
+  return this;
+}
+
+capabilities::StartMeasurement::Result SpectralAnalyzer::startMeasurement(
+    const JsonVariantConst& parameters) {
+  stopCapture();
+  features_ready_ = false;
+  sample_count_ = 0;
+
+  const uint64_t period_us = 1e6 / sample_rate_hz_;
+  if (esp_timer_start_periodic(timer_, period_us) != ESP_OK) {
+    return {.wait = {}, .error = ErrorResult(type(), capture_error_)};
+  }
+  capturing_ = true;
+
+  return {.wait = std::chrono::microseconds(period_us * raw_samples_.size())};
+}
+
+capabilities::StartMeasurement::Result SpectralAnalyzer::handleMeasurement() {
+  if (!capturing_) {
+    return {.wait = {}, .error = ErrorResult(type(), F("Not started"))};
+  }
+
+  // Wait for the remaining samples of the block
+  const size_t sample_count = sample_count_;
+  if (sample_count < raw_samples_.size()) {
+    const size_t remaining = raw_samples_.size() - sample_count;
+    return {.wait = std::chrono::microseconds(
+                static_cast<uint64_t>(1e6 * remaining / sample_rate_hz_))};
+  }
+  stopCapture();
+
+  float* samples = spectrum_.samples();
+  for (size_t i = 0; i < raw_samples_.size(); i++) {
+    samples[i] = analog_in_->toVoltage(raw_samples_[i]);
+  }
+  features_ = spectrum_.analyze(sample_rate_hz_);
+  band_energies_.clear();
+  for (const Band& band : bands_) {
+    band_energies_.push_back(spectrum_.bandEnergy(band.min_hz, band.max_hz));
+  }
+  features_ready_ = true;
+
+  return {.wait = {}};
+}
+
+capabilities::GetValues::Result SpectralAnalyzer::getValues() {
+  // Use the features of the last analyzed block and invalidate them after
+  // returning them
+  if (!features_ready_) {
+    return {.values = {}, .error = ErrorResult(type(), get_values_error_)};
+  }
+  features_ready_ = false;
+
+  std::vector<utils::ValueUnit> values;
+  if (rms_data_point_type_.isValid()) {
+    values.push_back(utils::ValueUnit{
+        .value = features_.rms, .data_point_type = rms_data_point_type_});
+  }
+  if (crest_factor_data_point_type_.isValid()) {
+    values.push_back(
+        utils::ValueUnit{.value = features_.crest_factor,
+                         .data_point_type = crest_factor_data_point_type_});
+  }
+  if (dominant_frequency_data_point_type_.isValid()) {
+    values.push_back(utils::ValueUnit{
+        .value = features_.dominant_frequency_hz,
+        .data_point_type = dominant_frequency_data_point_type_});
+  }
+  for (size_t i = 0; i < bands_.size(); i++) {
+    values.push_back(
+        utils::ValueUnit{.value = band_energies_[i],
+                         .data_point_type = bands_[i].data_point_type});
+  }
+
+  return {.values = values, .error = ErrorResult()};
+}
+
+bool SpectralAnalyzer::parseBands(const JsonObjectConst& parameters) {
+  JsonVariantConst bands = parameters[bands_key_];
+  if (bands.isNull()) {
+    return true;
+  }
+  if (!bands.is<JsonArrayConst>()) {
+    return false;
+  }
+  const float nyquist_hz = sample_rate_hz_ / 2;
+  for (JsonVariantConst band : bands.as<JsonArrayConst>()) {
+    JsonVariantConst min_hz = band[min_hz_key_];
+    JsonVariantConst max_hz = band[max_hz_key_];
+    utils::UUID data_point_type(band[data_point_type_key_]);
+    if (!min_hz.is<float>() || !max_hz.is<float>() ||
+        !data_point_type.isValid()) {
+      return false;
+    }
+    if (min_hz.as<float>() < 0 || max_hz.as<float>() <= min_hz.as<float>() ||
+        min_hz.as<float>() > nyquist_hz) {
+      return false;
+    }
+    bands_.push_back(Band{.min_hz = min_hz,
+                          .max_hz = max_hz,
+                          .data_point_type = data_point_type});
+  }
+  return true;
+}
+
+void SpectralAnalyzer::stopCapture() {
+  if (capturing_) {
+    esp_timer_stop(timer_);
+    // A sample may still be captured on the other core. Wait for it, so that
+    // it neither writes into the next block nor into a destroyed analyzer
+    utils::waitForTimerCallbacks();
+    capturing_ = false;
+  }
+}
+
+void SpectralAnalyzer::captureSample(void* arg) {
+  // Runs in the esp_timer task. Only touch the sample buffer and counter
+  SpectralAnalyzer* analyzer = static_cast<SpectralAnalyzer*>(arg);
+  const size_t index = analyzer->sample_count_;
+  if (index < analyzer->raw_samples_.size()) {
+    analyzer->raw_samples_[index] = analyzer->analog_in_->readRaw();
+    analyzer->sample_count_ = index + 1;
+  }
+}
+
+std::shared_ptr<Peripheral> SpectralAnalyzer::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<SpectralAnalyzer>(parameters);
+}
+
+const __FlashStringHelper* SpectralAnalyzer::analog_in_key_ =
+    FPSTR("analog_in");
+
+const float SpectralAnalyzer::max_sample_rate_hz_ = 10000;
+const __FlashStringHelper* SpectralAnalyzer::sample_rate_hz_key_ =
+    FPSTR("sample_rate_hz");
+const __FlashStringHelper* SpectralAnalyzer::sample_rate_hz_key_error_ =
+    FPSTR("Wrong property: sample_rate_hz (0 < float <= 10000)");
+
+const __FlashStringHelper* SpectralAnalyzer::block_size_key_ =
+    FPSTR("block_size");
+const __FlashStringHelper* SpectralAnalyzer::block_size_key_error_ =
+    FPSTR("Wrong property: block_size (power of 2, 16 - 1024)");
+
+const __FlashStringHelper* SpectralAnalyzer::rms_data_point_type_key_ =
+    FPSTR("rms_data_point_type");
+const __FlashStringHelper*
+    SpectralAnalyzer::crest_factor_data_point_type_key_ =
+        FPSTR("crest_factor_data_point_type");
+const __FlashStringHelper*
+    SpectralAnalyzer::dominant_frequency_data_point_type_key_ =
+        FPSTR("dominant_frequency_data_point_type");
+const __FlashStringHelper* SpectralAnalyzer::bands_key_ = FPSTR("bands");
+const __FlashStringHelper* SpectralAnalyzer::bands_key_error_ =
+    FPSTR("Wrong property: bands ([{min_hz, max_hz, data_point_type}])");
+const __FlashStringHelper* SpectralAnalyzer::min_hz_key_ = FPSTR("min_hz");
+const __FlashStringHelper* SpectralAnalyzer::max_hz_key_ = FPSTR("max_hz");
+const __FlashStringHelper* SpectralAnalyzer::no_output_error_ =
+    FPSTR("No data point type set");
+const __FlashStringHelper* SpectralAnalyzer::capture_error_ =
+    FPSTR("Failed to start capture timer");
+
+}  // namespace spectral_analyzer
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
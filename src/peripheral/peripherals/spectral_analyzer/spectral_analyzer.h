@@ -0,0 +1,132 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "managers/service_getters.h"
+#include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/start_measurement.h"
+#include "peripheral/peripheral.h"
+#include "peripheral/peripherals/analog_in/analog_in.h"
+#include "utils/spectrum.h"
+
+#ifdef ESP32
+#include <esp_timer.h>
+#endif
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spectral_analyzer {
+
+/**
+ * Captures sample blocks from an AnalogIn peripheral and reduces them to
+ * spectral features on the device
+ *
+ * Sampling is paced by a hardware backed timer so that the main loop keeps
+ * running while a block is captured. Once complete, the block is windowed,
+ * transformed and summarized as RMS, crest factor, dominant frequency and
+ * configurable band energies.
+ */
+class SpectralAnalyzer : public Peripheral,
+                         public capabilities::GetValues,
+                         public capabilities::StartMeasurement {
+ public:
+  SpectralAnalyzer(const JsonObjectConst& parameters);
+  virtual ~SpectralAnalyzer();
+
+  // Type registration in the peripheral factory
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst& parameters);
+
+  // Capabilities supported by the peripheral
+  capabilities::GetValues* asGetValues() final;
+  capabilities::StartMeasurement* asStartMeasurement() final;
+
+  /**
+   * Start capturing a new sample block
+   *
+   * \param parameters Unused
+   * \return The time until the block has been captured
+   */
+  capabilities::StartMeasurement::Result startMeasurement(
+      const JsonVariantConst& parameters) final;
+
+  /**
+   * Analyzes the block once it has been captured
+   *
+   * \return The remaining capture time or zero once the features are ready
+   */
+  capabilities::StartMeasurement::Result handleMeasurement() final;
+
+  /**
+   * Returns the features of the last analyzed block
+   *
+   * Invalidates the features after returning them. Repeat startMeasurement
+   * for new values.
+   *
+   * \return The configured features or an error if none are available
+   */
+  capabilities::GetValues::Result getValues() final;
+
+ private:
+  struct Band {
+    float min_hz;
+    float max_hz;
+    utils::UUID data_point_type;
+  };
+
+  bool parseBands(const JsonObjectConst& parameters);
+  void stopCapture();
+  static void captureSample(void* arg);
+
+  std::shared_ptr<analog_in::AnalogIn> analog_in_;
+  static const __FlashStringHelper* analog_in_key_;
+
+  float sample_rate_hz_;
+  static const float max_sample_rate_hz_;
+  static const __FlashStringHelper* sample_rate_hz_key_;
+  static const __FlashStringHelper* sample_rate_hz_key_error_;
+
+  static const size_t default_block_size_ = 256;
+  static const __FlashStringHelper* block_size_key_;
+  static const __FlashStringHelper* block_size_key_error_;
+
+  utils::Spectrum spectrum_;
+  /// Raw ADC values written by the capture timer
+  std::vector<uint16_t> raw_samples_;
+  std::atomic<size_t> sample_count_{0};
+#ifdef ESP32
+  esp_timer_handle_t timer_ = nullptr;
+#endif
+
+  utils::Spectrum::Features features_;
+  bool features_ready_ = false;
+  bool capturing_ = false;
+
+  utils::UUID rms_data_point_type_{nullptr};
+  static const __FlashStringHelper* rms_data_point_type_key_;
+  utils::UUID crest_factor_data_point_type_{nullptr};
+  static const __FlashStringHelper* crest_factor_data_point_type_key_;
+  utils::UUID dominant_frequency_data_point_type_{nullptr};
+  static const __FlashStringHelper* dominant_frequency_data_point_type_key_;
+  std::vector<Band> bands_;
+  std::vector<float> band_energies_;
+  static const __FlashStringHelper* bands_key_;
+  static const __FlashStringHelper* bands_key_error_;
+  static const __FlashStringHelper* min_hz_key_;
+  static const __FlashStringHelper* max_hz_key_;
+  /// Error if no feature has a data point type
+  static const __FlashStringHelper* no_output_error_;
+  static const __FlashStringHelper* capture_error_;
+};
+
+}  // namespace spectral_analyzer
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -0,0 +1,89 @@
+#ifdef ESP32
+#include "spi_abstract_peripheral.h"
+
+#include "managers/services.h"
+#include "utils/error_store.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spi {
+
+SPIAbstractPeripheral::SPIAbstractPeripheral(
+    const JsonObjectConst& parameters) {
+  utils::UUID spi_adapter_uuid(parameters[spi_adapter_key_]);
+  if (!spi_adapter_uuid.isValid()) {
+    setInvalid(spi_adapter_key_error_);
+    return;
+  }
+
+  // Since the UUID is specified externally, check the type
+  std::shared_ptr<Peripheral> peripheral =
+      Services::getPeripheralController().getPeripheral(spi_adapter_uuid);
+  if (!peripheral || peripheral->getType() != SPIAdapter::type() ||
+      !peripheral->isValid()) {
+    setInvalid(ErrorStore::genNotAValid(spi_adapter_uuid, SPIAdapter::type()));
+    return;
+  }
+  spi_adapter_ = std::static_pointer_cast<SPIAdapter>(peripheral);
+
+  const int cs_pin = toPin(parameters[cs_pin_key_]);
+  if (cs_pin < 0) {
+    setInvalid(cs_pin_key_error_);
+    return;
+  }
+  const int clock_hz = parameters[clock_hz_key_] | default_clock_hz_;
+  const int spi_mode = parameters[spi_mode_key_] | 0;
+  if (clock_hz <= 0 || spi_mode < 0 || spi_mode > 3) {
+    setInvalid(device_config_error_);
+    return;
+  }
+
+  device_ = spi_adapter_->getBus().addDevice(
+      SPIBus::DeviceConfig{.cs_pin = cs_pin,
+                           .clock_hz = clock_hz,
+                           .mode = static_cast<uint8_t>(spi_mode)});
+  if (!device_) {
+    setInvalid(device_config_error_);
+    return;
+  }
+}
+
+SPIAbstractPeripheral::~SPIAbstractPeripheral() {
+  // Waits for queued transactions and drops their callbacks
+  if (device_) {
+    spi_adapter_->getBus().removeDevice(device_);
+  }
+}
+
+bool SPIAbstractPeripheral::queueTransaction(SPITransaction transaction) {
+  return spi_adapter_->getBus().queue(device_, std::move(transaction));
+}
+
+bool SPIAbstractPeripheral::transfer(SPITransaction& transaction) {
+  return spi_adapter_->getBus().transfer(device_, transaction);
+}
+
+constexpr int SPIAbstractPeripheral::default_clock_hz_;
+
+const __FlashStringHelper* SPIAbstractPeripheral::spi_adapter_key_ =
+    FPSTR("spi_adapter");
+const __FlashStringHelper* SPIAbstractPeripheral::spi_adapter_key_error_ =
+    FPSTR("Missing property: spi_adapter (uuid)");
+const __FlashStringHelper* SPIAbstractPeripheral::cs_pin_key_ =
+    FPSTR("cs_pin");
+const __FlashStringHelper* SPIAbstractPeripheral::cs_pin_key_error_ =
+    FPSTR("Missing property: cs_pin (int)");
+const __FlashStringHelper* SPIAbstractPeripheral::clock_hz_key_ =
+    FPSTR("clock_hz");
+const __FlashStringHelper* SPIAbstractPeripheral::spi_mode_key_ =
+    FPSTR("spi_mode");
+const __FlashStringHelper* SPIAbstractPeripheral::device_config_error_ =
+    FPSTR("Invalid SPI device config");
+
+}  // namespace spi
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "peripheral/peripheral.h"
+#include "peripheral/peripherals/spi/spi_adapter.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spi {
+
+/**
+ * Interface for sensors to access peripherals over the SPI bus
+ *
+ * Registers the device with its chip select pin, clock and mode on the
+ * adapter's bus, so that several devices can share it at their full clock.
+ */
+class SPIAbstractPeripheral : public Peripheral {
+ public:
+  SPIAbstractPeripheral(const JsonObjectConst& parameters);
+  virtual ~SPIAbstractPeripheral();
+
+ protected:
+  /**
+   * Queues a DMA transaction with the device without blocking
+   *
+   * The callback is run by the scheduler once the transaction completed. It
+   * is not run if this peripheral is deleted in the meantime.
+   *
+   * \param transaction The transaction to execute
+   * \return False if the device's queue is full
+   */
+  bool queueTransaction(SPITransaction transaction);
+
+  /**
+   * Executes a transaction with the device and waits for it to complete
+   *
+   * Only to be used for short transfers when no transactions are queued,
+   * e.g. when initializing the device.
+   *
+   * \param transaction The transaction to execute, receives the result
+   * \return True on success
+   */
+  bool transfer(SPITransaction& transaction);
+
+ private:
+  std::shared_ptr<SPIAdapter> spi_adapter_;
+  SPIBus::DeviceHandle device_ = nullptr;
+
+  /// Default clock frequency of a device
+  static constexpr int default_clock_hz_ = 1000000;
+
+  static const __FlashStringHelper* spi_adapter_key_;
+  static const __FlashStringHelper* spi_adapter_key_error_;
+  static const __FlashStringHelper* cs_pin_key_;
+  static const __FlashStringHelper* cs_pin_key_error_;
+  static const __FlashStringHelper* clock_hz_key_;
+  static const __FlashStringHelper* spi_mode_key_;
+  static const __FlashStringHelper* device_config_error_;
+};
+
+}  // namespace spi
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -0,0 +1,113 @@
+#ifdef ESP32
+
+#include "spi_adapter.h"
+
+#include "managers/services.h"
+#include "peripheral/peripheral_factory.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spi {
+
+bool SPIAdapter::hspi_taken = false;
+bool SPIAdapter::vspi_taken = false;
+
+SPIAdapter::SPIAdapter(const ServiceGetters& services,
+                       const JsonObjectConst& parameters) {
+  // The clock pin is required. MOSI or MISO may be omitted for devices that
+  // only receive or only send
+  const int sclk_pin = toPin(parameters[sclk_key_]);
+  const int mosi_pin =
+      parameters[mosi_key_].isNull() ? -1 : toPin(parameters[mosi_key_]);
+  const int miso_pin =
+      parameters[miso_key_].isNull() ? -1 : toPin(parameters[miso_key_]);
+  if (sclk_pin < 0 || (mosi_pin < 0 && miso_pin < 0)) {
+    setInvalid(pins_error_);
+    return;
+  }
+
+  const int max_transfer_size =
+      parameters[max_transfer_size_key_] | default_max_transfer_size_;
+  if (max_transfer_size <= 0) {
+    setInvalid(max_transfer_size_error_);
+    return;
+  }
+
+  if (!hspi_taken) {
+    taken_variable_ = &hspi_taken;
+    host_ = SPI2_HOST;
+  } else if (!vspi_taken) {
+    taken_variable_ = &vspi_taken;
+    host_ = SPI3_HOST;
+  } else {
+    setInvalid(taken_error_);
+    return;
+  }
+
+  spi_bus_config_t bus_config = {};
+  bus_config.sclk_io_num = sclk_pin;
+  bus_config.mosi_io_num = mosi_pin;
+  bus_config.miso_io_num = miso_pin;
+  bus_config.quadwp_io_num = -1;
+  bus_config.quadhd_io_num = -1;
+  bus_config.max_transfer_sz = max_transfer_size;
+  if (spi_bus_initialize(static_cast<spi_host_device_t>(host_), &bus_config,
+                         SPI_DMA_CH_AUTO) != ESP_OK) {
+    taken_variable_ = nullptr;
+    host_ = -1;
+    setInvalid(bus_error_);
+    return;
+  }
+  *taken_variable_ = true;
+
+  bus_.reset(new SPIBus(host_, Services::getScheduler()));
+}
+
+SPIAdapter::~SPIAdapter() {
+  // Devices hold a reference to the adapter, so all have been removed
+  bus_.reset();
+  if (host_ >= 0) {
+    spi_bus_free(static_cast<spi_host_device_t>(host_));
+  }
+  if (taken_variable_) {
+    *taken_variable_ = false;
+  }
+}
+
+const String& SPIAdapter::getType() const { return type(); }
+
+const String& SPIAdapter::type() {
+  static const String name{"SPIAdapter"};
+  return name;
+}
+
+SPIBus& SPIAdapter::getBus() { return *bus_; }
+
+std::shared_ptr<Peripheral> SPIAdapter::factory(
+    const ServiceGetters& services, const JsonObjectConst& parameters) {
+  return std::make_shared<SPIAdapter>(services, parameters);
+}
+
+constexpr int SPIAdapter::default_max_transfer_size_;
+
+const __FlashStringHelper* SPIAdapter::sclk_key_ = FPSTR("sclk");
+const __FlashStringHelper* SPIAdapter::mosi_key_ = FPSTR("mosi");
+const __FlashStringHelper* SPIAdapter::miso_key_ = FPSTR("miso");
+const __FlashStringHelper* SPIAdapter::max_transfer_size_key_ =
+    FPSTR("max_transfer_size");
+const __FlashStringHelper* SPIAdapter::pins_error_ =
+    FPSTR("Invalid pins: sclk and mosi or miso required");
+const __FlashStringHelper* SPIAdapter::max_transfer_size_error_ =
+    FPSTR("Invalid max_transfer_size");
+const __FlashStringHelper* SPIAdapter::taken_error_ =
+    FPSTR("Both SPI hosts already taken");
+const __FlashStringHelper* SPIAdapter::bus_error_ =
+    FPSTR("Failed to initialize SPI bus");
+
+}  // namespace spi
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
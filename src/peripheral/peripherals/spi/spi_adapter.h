@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+
+#include "managers/service_getters.h"
+#include "peripheral/peripheral.h"
+#include "peripheral/peripherals/spi/spi_bus.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spi {
+
+/**
+ * The driver for an SPI interface that supports both general purpose SPI
+ * controllers (HSPI and VSPI)
+ *
+ * The bus is initialized with DMA. Each adapter owns a bus scheduler that
+ * lets peripherals queue transactions instead of blocking the main loop.
+ */
+class SPIAdapter : public Peripheral {
+ public:
+  SPIAdapter(const ServiceGetters& services, const JsonObjectConst& parameters);
+  virtual ~SPIAdapter();
+
+  const String& getType() const final;
+  static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst&);
+
+  /**
+   * Gets the scheduler for DMA transactions on this adapter's bus
+   *
+   * \return The bus of the adapter
+   */
+  SPIBus& getBus();
+
+ private:
+  static bool hspi_taken;
+  static bool vspi_taken;
+
+  bool* taken_variable_ = nullptr;
+  int host_ = -1;
+  std::unique_ptr<SPIBus> bus_;
+
+  /// Default maximum size of a single transfer in bytes
+  static constexpr int default_max_transfer_size_ = 4092;
+
+  static const __FlashStringHelper* sclk_key_;
+  static const __FlashStringHelper* mosi_key_;
+  static const __FlashStringHelper* miso_key_;
+  static const __FlashStringHelper* max_transfer_size_key_;
+  static const __FlashStringHelper* pins_error_;
+  static const __FlashStringHelper* max_transfer_size_error_;
+  static const __FlashStringHelper* taken_error_;
+  static const __FlashStringHelper* bus_error_;
+};
+
+}  // namespace spi
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
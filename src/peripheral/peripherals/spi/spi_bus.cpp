@@ -0,0 +1,147 @@
+#ifdef ESP32
+
+#include "spi_bus.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spi {
+
+constexpr int SPIBus::device_queue_size;
+
+SPIBus::SPIBus(int host, Scheduler& scheduler)
+    : Task(std::chrono::milliseconds(1).count(), TASK_FOREVER, &scheduler,
+           false),
+      host_(host) {}
+
+SPIBus::DeviceHandle SPIBus::addDevice(const DeviceConfig& config) {
+  spi_device_interface_config_t device_config = {};
+  device_config.mode = config.mode;
+  device_config.clock_speed_hz = config.clock_hz;
+  device_config.spics_io_num = config.cs_pin;
+  device_config.queue_size = device_queue_size;
+
+  DeviceHandle device = nullptr;
+  if (spi_bus_add_device(static_cast<spi_host_device_t>(host_),
+                         &device_config, &device) != ESP_OK) {
+    return nullptr;
+  }
+  return device;
+}
+
+void SPIBus::removeDevice(DeviceHandle device) {
+  // The driver returns the transactions of a device in order. Wait for all
+  // of them, as their buffers have to stay valid until then
+  for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+    if ((*it)->device != device) {
+      it++;
+      continue;
+    }
+    spi_transaction_t* result = nullptr;
+    spi_device_get_trans_result(device, &result, portMAX_DELAY);
+    it = in_flight_.erase(it);
+  }
+  spi_bus_remove_device(device);
+}
+
+bool SPIBus::queue(DeviceHandle device, SPITransaction transaction) {
+  if (!device) {
+    return false;
+  }
+
+  std::unique_ptr<InFlight> in_flight(new InFlight());
+  in_flight->device = device;
+  in_flight->transaction = std::move(transaction);
+  prepare(*in_flight);
+  if (spi_device_queue_trans(device, &in_flight->descriptor, 0) != ESP_OK) {
+    return false;
+  }
+
+  in_flight_.push_back(std::move(in_flight));
+  enableIfNot();
+  return true;
+}
+
+bool SPIBus::transfer(DeviceHandle device, SPITransaction& transaction) {
+  // The driver would return the result of a queued transaction instead
+  const bool has_queued = std::any_of(
+      in_flight_.begin(), in_flight_.end(),
+      [device](const std::unique_ptr<InFlight>& in_flight) {
+        return in_flight->device == device;
+      });
+  if (!device || has_queued) {
+    return false;
+  }
+
+  InFlight in_flight;
+  in_flight.device = device;
+  in_flight.transaction = std::move(transaction);
+  prepare(in_flight);
+  in_flight.transaction.error =
+      spi_device_transmit(device, &in_flight.descriptor);
+  transaction = std::move(in_flight.transaction);
+  return transaction.error == ESP_OK;
+}
+
+bool SPIBus::Callback() {
+  // Collect the completed transactions first, as callbacks may queue more.
+  // Only the oldest transaction of each device can have completed
+  std::vector<SPITransaction> completed;
+  std::vector<DeviceHandle> busy_devices;
+  for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+    const DeviceHandle device = (*it)->device;
+    if (std::find(busy_devices.begin(), busy_devices.end(), device) !=
+        busy_devices.end()) {
+      it++;
+      continue;
+    }
+    spi_transaction_t* result = nullptr;
+    if (spi_device_get_trans_result(device, &result, 0) != ESP_OK) {
+      busy_devices.push_back(device);
+      it++;
+      continue;
+    }
+    (*it)->transaction.error = ESP_OK;
+    completed.push_back(std::move((*it)->transaction));
+    it = in_flight_.erase(it);
+  }
+
+  for (const SPITransaction& transaction : completed) {
+    if (transaction.callback) {
+      transaction.callback(transaction);
+    }
+  }
+
+  // Sleep until the next transaction is queued
+  if (in_flight_.empty()) {
+    disable();
+  }
+  return !completed.empty();
+}
+
+void SPIBus::prepare(InFlight& in_flight) {
+  SPITransaction& transaction = in_flight.transaction;
+  // Full duplex. Pad the TX bytes with zeros to the number of clocked bytes
+  const size_t length = std::max(transaction.tx_data.size(),
+                                 transaction.rx_length);
+  transaction.tx_data.resize(length, 0);
+  transaction.rx_data.assign(transaction.rx_length, 0);
+
+  spi_transaction_t& descriptor = in_flight.descriptor;
+  memset(&descriptor, 0, sizeof(descriptor));
+  descriptor.length = length * 8;
+  descriptor.rxlength = transaction.rx_length * 8;
+  descriptor.tx_buffer = length ? transaction.tx_data.data() : nullptr;
+  descriptor.rx_buffer =
+      transaction.rx_length ? transaction.rx_data.data() : nullptr;
+}
+
+}  // namespace spi
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#ifdef ESP32
+#include <driver/spi_master.h>
+#endif
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace spi {
+
+/**
+ * A full-duplex transfer with a device on the SPI bus
+ *
+ * The TX bytes are clocked out while the same number of bytes is received.
+ * If rx_length is larger, zeros are sent for the remaining bytes.
+ */
+struct SPITransaction {
+  /// The bytes to send
+  std::vector<uint8_t> tx_data;
+  /// Number of bytes to receive into rx_data
+  size_t rx_length = 0;
+  /// The received bytes
+  std::vector<uint8_t> rx_data;
+  /// Called from the scheduler once the transaction completed
+  std::function<void(const SPITransaction&)> callback;
+
+  /// IDF error code (ESP_OK on success)
+  int error = 0;
+};
+
+/**
+ * Schedules DMA transactions on an SPI bus without blocking the main loop
+ *
+ * Transactions are handed to the IDF SPI master driver, which executes them
+ * with DMA and arbitrates between the devices, each with its own clock and
+ * mode. Completed transactions are collected by the scheduler, where their
+ * callbacks are run.
+ */
+class SPIBus : public Task {
+ public:
+  /// Configuration of a device on the bus
+  struct DeviceConfig {
+    /// Chip select pin
+    int cs_pin;
+    /// Clock frequency in Hz
+    int clock_hz;
+    /// SPI mode (0 - 3) for the clock polarity and phase
+    uint8_t mode;
+  };
+
+#ifdef ESP32
+  using DeviceHandle = spi_device_handle_t;
+#else
+  using DeviceHandle = void*;
+#endif
+
+  /**
+   * Registers the completion handler for an initialized bus
+   *
+   * \param host The SPI host the bus was initialized on
+   * \param scheduler The scheduler to run the callbacks from
+   */
+  SPIBus(int host, Scheduler& scheduler);
+  virtual ~SPIBus() = default;
+
+  /**
+   * Adds a device with its own chip select, clock and mode
+   *
+   * \param config The configuration of the device
+   * \return The handle of the device or nullptr on error
+   */
+  DeviceHandle addDevice(const DeviceConfig& config);
+
+  /**
+   * Removes a device after waiting for its queued transactions
+   *
+   * Their callbacks are not run.
+   *
+   * \param device The handle of the device
+   */
+  void removeDevice(DeviceHandle device);
+
+  /**
+   * Queues a transaction for DMA execution
+   *
+   * \param device The device to communicate with
+   * \param transaction The transaction to execute
+   * \return False if the device's queue is full or the transfer is too long
+   */
+  bool queue(DeviceHandle device, SPITransaction transaction);
+
+  /**
+   * Executes a transaction and waits for it to complete
+   *
+   * Only to be used for short transfers, e.g. when initializing a device.
+   *
+   * \param device The device to communicate with
+   * \param transaction The transaction to execute, receives the result
+   * \return True on success
+   */
+  bool transfer(DeviceHandle device, SPITransaction& transaction);
+
+  /**
+   * Runs the callbacks of all completed transactions
+   *
+   * \return True if a transaction was completed
+   */
+  bool Callback() final;
+
+  /// Number of transactions that can be queued per device
+  static constexpr int device_queue_size = 4;
+
+ private:
+  /// A queued transaction and its driver descriptor, which has to stay valid
+  /// until the driver returned it
+  struct InFlight {
+#ifdef ESP32
+    spi_transaction_t descriptor;
+#endif
+    DeviceHandle device;
+    SPITransaction transaction;
+  };
+
+  void prepare(InFlight& in_flight);
+
+  int host_;
+  std::list<std::unique_ptr<InFlight>> in_flight_;
+};
+
+}  // namespace spi
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
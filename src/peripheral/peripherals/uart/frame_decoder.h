@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace uart {
+
+/**
+ * Decodes fixed-size frames from a byte stream
+ *
+ * Received bytes are read in bulk into a ring buffer. A window of the frame
+ * size slides over the buffer until it starts with a valid header and passes
+ * the checksum, which keeps the decoder in sync even on corrupted bytes. The
+ * latest valid frame stays available until it is replaced by a newer one.
+ *
+ * The protocol has to provide:
+ * - `static constexpr size_t frame_size`
+ * - `static bool isHeader(uint8_t first, uint8_t second)`
+ * - `static bool isValid(const uint8_t* frame)`, which checks the checksum
+ *
+ * \tparam Protocol The frame format
+ * \tparam BufferSize Size of the ring buffer, a power of 2
+ */
+template <class Protocol, size_t BufferSize = 128>
+class FrameDecoder {
+ public:
+  static constexpr size_t frame_size = Protocol::frame_size;
+
+  static_assert((BufferSize & (BufferSize - 1)) == 0,
+                "BufferSize has to be a power of 2");
+  static_assert(BufferSize >= 2 * frame_size,
+                "BufferSize has to fit at least two frames");
+
+  /**
+   * Reads all available bytes from the source and decodes them
+   *
+   * Only reads as many bytes as are available, so it does not block.
+   *
+   * \param source A stream with available() and readBytes()
+   * \return The number of bytes read
+   */
+  template <class Source>
+  size_t drain(Source& source) {
+    size_t total = 0;
+    while (true) {
+      const int available = source.available();
+      if (available <= 0) {
+        break;
+      }
+      // Read into the contiguous free space up to the end of the ring
+      const size_t head_index = head_ & mask_;
+      const size_t free = BufferSize - size();
+      size_t length = std::min(free, BufferSize - head_index);
+      length = std::min(length, static_cast<size_t>(available));
+      const size_t read = source.readBytes(buffer_ + head_index, length);
+      head_ += read;
+      total += read;
+      parse();
+      if (read == 0) {
+        break;
+      }
+    }
+    return total;
+  }
+
+  /**
+   * Adds received bytes and decodes them
+   *
+   * \param data The received bytes
+   * \param length The number of received bytes
+   */
+  void push(const uint8_t* data, size_t length) {
+    while (length) {
+      const size_t head_index = head_ & mask_;
+      size_t chunk = std::min(BufferSize - size(), BufferSize - head_index);
+      chunk = std::min(chunk, length);
+      memcpy(buffer_ + head_index, data, chunk);
+      head_ += chunk;
+      data += chunk;
+      length -= chunk;
+      parse();
+    }
+  }
+
+  /**
+   * Check if a valid frame has been decoded
+   *
+   * \return True if getFrame() returns a valid frame
+   */
+  bool hasFrame() const { return frame_count_ > 0; }
+
+  /**
+   * Gets the latest valid frame
+   *
+   * \return The frame of frame_size bytes
+   */
+  const uint8_t* getFrame() const { return frame_; }
+
+  /**
+   * Gets the number of valid frames decoded so far
+   *
+   * \return The frame counter, which can be used to detect new frames
+   */
+  uint32_t getFrameCount() const { return frame_count_; }
+
+  /**
+   * Gets the number of bytes skipped while searching for valid frames
+   *
+   * \return The number of skipped bytes
+   */
+  uint32_t getInvalidByteCount() const { return invalid_byte_count_; }
+
+  /**
+   * Sets a function to be called with each valid frame
+   *
+   * Allows every frame to be processed, not only the latest one.
+   *
+   * \param callback Called with the frame of frame_size bytes
+   */
+  void setFrameCallback(std::function<void(const uint8_t*)> callback) {
+    frame_callback_ = std::move(callback);
+  }
+
+ private:
+  size_t size() const { return head_ - tail_; }
+  uint8_t at(size_t index) const { return buffer_[(tail_ + index) & mask_]; }
+
+  void parse() {
+    while (size() >= frame_size) {
+      // Slide by a byte until the window starts with a header
+      if (!Protocol::isHeader(at(0), at(1))) {
+        tail_++;
+        invalid_byte_count_++;
+        continue;
+      }
+
+      // Copy the candidate out of the ring, as it may wrap around
+      const size_t tail_index = tail_ & mask_;
+      const size_t first = std::min(frame_size, BufferSize - tail_index);
+      memcpy(candidate_, buffer_ + tail_index, first);
+      memcpy(candidate_ + first, buffer_, frame_size - first);
+
+      // A failed checksum may be a false header, so only skip one byte
+      if (!Protocol::isValid(candidate_)) {
+        tail_++;
+        invalid_byte_count_++;
+        continue;
+      }
+      memcpy(frame_, candidate_, frame_size);
+      frame_count_++;
+      tail_ += frame_size;
+      if (frame_callback_) {
+        frame_callback_(frame_);
+      }
+    }
+  }
+
+  static constexpr size_t mask_ = BufferSize - 1;
+
+  uint8_t buffer_[BufferSize];
+  /// Total bytes written to the ring. Wraps around with the unsigned type
+  size_t head_ = 0;
+  /// Total bytes consumed from the ring
+  size_t tail_ = 0;
+
+  uint8_t candidate_[frame_size];
+  uint8_t frame_[frame_size] = {};
+  uint32_t frame_count_ = 0;
+  uint32_t invalid_byte_count_ = 0;
+  std::function<void(const uint8_t*)> frame_callback_;
+};
+
+template <class Protocol, size_t BufferSize>
+constexpr size_t FrameDecoder<Protocol, BufferSize>::frame_size;
+
+template <class Protocol, size_t BufferSize>
+constexpr size_t FrameDecoder<Protocol, BufferSize>::mask_;
+
+}  // namespace uart
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+
+#include <chrono>
+
+#include "peripheral/peripherals/uart/frame_decoder.h"
+#include "peripheral/peripherals/uart/uart_adapter.h"
+
+namespace inamata {
+namespace peripheral {
+namespace peripherals {
+namespace uart {
+
+/**
+ * Drains a UART adapter into a frame decoder in the background
+ *
+ * Keeps the UART's receive buffer from overflowing and the latest frame up to
+ * date without a measurement having to be started. The adapter is only read
+ * once it received at least a frame's worth of bytes.
+ *
+ * \tparam Protocol The frame format
+ */
+template <class Protocol>
+class FrameReader : public Task {
+ public:
+  /**
+   * Starts draining the UART adapter
+   *
+   * \param uart_adapter The UART adapter to read from
+   * \param scheduler The scheduler to run the task
+   * \param interval Time between checks for received bytes. Has to be shorter
+   *     than it takes to fill the adapter's receive buffer
+   */
+  FrameReader(UARTAdapter& uart_adapter, Scheduler& scheduler,
+              std::chrono::milliseconds interval)
+      : Task(interval.count(), TASK_FOREVER, &scheduler, true),
+        uart_adapter_(uart_adapter) {
+    uart_adapter_.setReceiveThreshold(Protocol::frame_size);
+  }
+  virtual ~FrameReader() = default;
+
+  /**
+   * Reads the received bytes into the decoder
+   *
+   * \return True if bytes were read
+   */
+  bool Callback() final {
+    if (!uart_adapter_.isReceiveReady()) {
+      return false;
+    }
+    return decoder_.drain(uart_adapter_) > 0;
+  }
+
+  const FrameDecoder<Protocol>& getDecoder() const { return decoder_; }
+  FrameDecoder<Protocol>& getDecoder() { return decoder_; }
+
+ private:
+  UARTAdapter& uart_adapter_;
+  FrameDecoder<Protocol> decoder_;
+};
+
+}  // namespace uart
+}  // namespace peripherals
+}  // namespace peripheral
+}  // namespace inamata
@@ -1,5 +1,7 @@
 #include "uart_adapter.h"
 
+#include <algorithm>
+
 #include "peripheral/peripheral_factory.h"
 
 namespace inamata {
@@ -40,10 +42,12 @@ UARTAdapter::UARTAdapter(const ServiceGetters& services,
   if (!baud_rate.is<float>()) {
     setInvalid(ErrorStore::genMissingProperty(baud_rate_key_,
                                               ErrorStore::KeyType::kString));
+    return;
   }
+  baud_rate_ = baud_rate.as<int>();
 #ifdef ESP32
   setupESP32(rx_pin, tx_pin, config_chars.as<const char*>(),
-             baud_rate.as<int>());
+             baud_rate.as<int>(), parameters);
 #else
   setupESP8266(rx_pin, tx_pin, config_chars.as<const char*>(),
                baud_rate.as<float>());
@@ -51,6 +55,22 @@ UARTAdapter::UARTAdapter(const ServiceGetters& services,
 }
 
 UARTAdapter::~UARTAdapter() {
+#ifdef ESP32
+  if (event_task_) {
+    // Wake the event task with an invalid event so that it exits by itself
+    stop_event_task_ = true;
+    uart_event_t event = {};
+    event.type = UART_EVENT_MAX;
+    xQueueSend(event_queue_, &event, portMAX_DELAY);
+    xSemaphoreTake(event_task_stopped_, portMAX_DELAY);
+  }
+  if (event_task_stopped_) {
+    vSemaphoreDelete(event_task_stopped_);
+  }
+  if (port_ != UART_NUM_MAX && uart_is_driver_installed(port_)) {
+    uart_driver_delete(port_);
+  }
+#endif
   if (taken_variable_) {
     *taken_variable_ = false;
   }
@@ -77,17 +97,307 @@ HardwareSerial* UARTAdapter::getSerial() {
 #endif
 }
 
+int UARTAdapter::available() {
+#ifdef ESP32
+  size_t length = 0;
+  if (port_ == UART_NUM_MAX ||
+      uart_get_buffered_data_len(port_, &length) != ESP_OK) {
+    return 0;
+  }
+  return length;
+#else
+  HardwareSerial* serial = getSerial();
+  return serial ? serial->available() : 0;
+#endif
+}
+
+size_t UARTAdapter::readBytes(uint8_t* buffer, size_t length) {
+#ifdef ESP32
+  if (port_ == UART_NUM_MAX) {
+    return 0;
+  }
+  // Clear before checking the remaining bytes, so that bytes received in
+  // between are not missed
+  receive_ready_ = false;
+  const int read = uart_read_bytes(port_, buffer, length, 0);
+  if (available() >= static_cast<int>(receive_threshold_)) {
+    receive_ready_ = true;
+  }
+  return read > 0 ? read : 0;
+#else
+  HardwareSerial* serial = getSerial();
+  if (!serial) {
+    return 0;
+  }
+  const int available = serial->available();
+  if (available <= 0) {
+    return 0;
+  }
+  return serial->readBytes(buffer,
+                           std::min(length, static_cast<size_t>(available)));
+#endif
+}
+
+size_t UARTAdapter::write(const uint8_t* buffer, size_t length) {
+#ifdef ESP32
+  if (port_ == UART_NUM_MAX) {
+    return 0;
+  }
+  const int written =
+      uart_write_bytes(port_, reinterpret_cast<const char*>(buffer), length);
+  return written > 0 ? written : 0;
+#else
+  HardwareSerial* serial = getSerial();
+  return serial ? serial->write(buffer, length) : 0;
+#endif
+}
+
+bool UARTAdapter::isTransmitted() {
+#ifdef ESP32
+  return port_ == UART_NUM_MAX || uart_wait_tx_done(port_, 0) == ESP_OK;
+#else
+  HardwareSerial* serial = getSerial();
+  if (serial) {
+    serial->flush();
+  }
+  return true;
+#endif
+}
+
+bool UARTAdapter::setDriverEnablePin(int de_pin) {
+#ifdef ESP32
+  if (port_ == UART_NUM_MAX) {
+    return false;
+  }
+  return uart_set_pin(port_, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, de_pin,
+                      UART_PIN_NO_CHANGE) == ESP_OK &&
+         uart_set_mode(port_, UART_MODE_RS485_HALF_DUPLEX) == ESP_OK;
+#else
+  return false;
+#endif
+}
+
+void UARTAdapter::clearReceived() {
+#ifdef ESP32
+  if (port_ != UART_NUM_MAX) {
+    uart_flush_input(port_);
+  }
+  receive_ready_ = false;
+#else
+  HardwareSerial* serial = getSerial();
+  while (serial && serial->available() > 0) {
+    serial->read();
+  }
+#endif
+}
+
+int UARTAdapter::getBaudRate() const { return baud_rate_; }
+
+void UARTAdapter::setReceiveThreshold(size_t bytes) {
+  receive_threshold_ = std::max(bytes, static_cast<size_t>(1));
+}
+
+bool UARTAdapter::isReceiveReady() {
+#ifdef ESP32
+  return receive_ready_;
+#else
+  return available() >= static_cast<int>(receive_threshold_);
+#endif
+}
+
 std::shared_ptr<Peripheral> UARTAdapter::factory(
     const ServiceGetters& services, const JsonObjectConst& parameters) {
   return std::make_shared<UARTAdapter>(services, parameters);
 }
 
-bool UARTAdapter::registered_ =
-    PeripheralFactory::registerFactory(type(), factory);
-
 #ifdef ESP32
 void UARTAdapter::setupESP32(int rx_pin, int tx_pin, const char* config_chars,
-                             int baud_rate) {}
+                             int baud_rate, const JsonObjectConst& parameters) {
+  uart_config_t config = {};
+  config.baud_rate = baud_rate;
+  config.data_bits = UART_DATA_8_BITS;
+  config.parity = UART_PARITY_DISABLE;
+  config.stop_bits = UART_STOP_BITS_1;
+  config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+  config.source_clk = UART_SCLK_APB;
+  if (config_chars && strlen(config_chars) == 3) {
+    const char data_bits = config_chars[0];
+    switch (data_bits) {
+      case '5':
+        config.data_bits = UART_DATA_5_BITS;
+        break;
+      case '6':
+        config.data_bits = UART_DATA_6_BITS;
+        break;
+      case '7':
+        config.data_bits = UART_DATA_7_BITS;
+        break;
+      case '8':
+        config.data_bits = UART_DATA_8_BITS;
+        break;
+      default:
+        setInvalid(config_error_);
+        return;
+    }
+    const char parity = config_chars[1];
+    switch (parity) {
+      case 'N':
+        config.parity = UART_PARITY_DISABLE;
+        break;
+      case 'E':
+        config.parity = UART_PARITY_EVEN;
+        break;
+      case 'O':
+        config.parity = UART_PARITY_ODD;
+        break;
+      default:
+        setInvalid(config_error_);
+        return;
+    }
+    const char stop_bits = config_chars[2];
+    switch (stop_bits) {
+      case '1':
+        config.stop_bits = UART_STOP_BITS_1;
+        break;
+      case '2':
+        config.stop_bits = UART_STOP_BITS_2;
+        break;
+      default:
+        setInvalid(config_error_);
+        return;
+    }
+  }
+
+  // The ring buffer has to be larger than the hardware FIFO
+  const int rx_buffer_size =
+      parameters[rx_buffer_size_key_] | default_rx_buffer_size_;
+  const int rx_full_threshold =
+      parameters[rx_full_threshold_key_] | default_rx_full_threshold_;
+  const int rx_timeout = parameters[rx_timeout_key_] | default_rx_timeout_;
+  if (rx_buffer_size <= UART_FIFO_LEN || rx_full_threshold < 1 ||
+      rx_full_threshold >= UART_FIFO_LEN || rx_timeout < 0 ||
+      rx_timeout > 126) {
+    setInvalid(buffer_config_error_);
+    return;
+  }
+  JsonVariantConst pattern_char = parameters[pattern_char_key_];
+  const int pattern_count = parameters[pattern_count_key_] | 1;
+  if (!pattern_char.isNull() &&
+      (!pattern_char.is<int>() || pattern_char.as<int>() < 0 ||
+       pattern_char.as<int>() > 0xFF || pattern_count < 1 ||
+       pattern_count > 8)) {
+    setInvalid(buffer_config_error_);
+    return;
+  }
+
+  if (rx_pin < 0 && tx_pin < 0) {
+    setInvalid(invalid_pins_error_);
+    return;
+  }
+
+  // UART0 is used for logging. Pins are routed via the GPIO matrix
+  if (!serial2_taken) {
+    serial2_taken = true;
+    taken_variable_ = &serial2_taken;
+    port_ = UART_NUM_2;
+  } else if (!uart1_taken) {
+    uart1_taken = true;
+    taken_variable_ = &uart1_taken;
+    port_ = UART_NUM_1;
+  } else {
+    setInvalid(serial_taken_error_);
+    return;
+  }
+
+  esp_err_t error = uart_driver_install(port_, rx_buffer_size, 0,
+                                        event_queue_length_, &event_queue_, 0);
+  if (error != ESP_OK) {
+    port_ = UART_NUM_MAX;
+    setInvalid(driver_error_);
+    return;
+  }
+  error = uart_param_config(port_, &config);
+  if (error == ESP_OK) {
+    error = uart_set_pin(port_, tx_pin < 0 ? UART_PIN_NO_CHANGE : tx_pin,
+                         rx_pin < 0 ? UART_PIN_NO_CHANGE : rx_pin,
+                         UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+  }
+  if (error == ESP_OK) {
+    error = uart_set_rx_full_threshold(port_, rx_full_threshold);
+  }
+  if (error == ESP_OK) {
+    error = uart_set_rx_timeout(port_, rx_timeout);
+  }
+  if (error == ESP_OK && !pattern_char.isNull()) {
+    error = uart_enable_pattern_det_baud_intr(
+        port_, static_cast<char>(pattern_char.as<int>()), pattern_count, 9, 0,
+        0);
+    if (error == ESP_OK) {
+      error = uart_pattern_queue_reset(port_, pattern_queue_length_);
+    }
+  }
+  if (error != ESP_OK) {
+    setInvalid(driver_error_);
+    return;
+  }
+
+  event_task_stopped_ = xSemaphoreCreateBinary();
+  if (!event_task_stopped_ ||
+      xTaskCreate(runEventTask, "uart_events", 2048, this, 5, &event_task_) !=
+          pdPASS) {
+    event_task_ = nullptr;
+    setInvalid(driver_error_);
+    return;
+  }
+}
+
+void UARTAdapter::runEventTask(void* arg) {
+  UARTAdapter* adapter = static_cast<UARTAdapter*>(arg);
+  uart_event_t event;
+  while (!adapter->stop_event_task_) {
+    if (xQueueReceive(adapter->event_queue_, &event, portMAX_DELAY) ==
+            pdTRUE &&
+        !adapter->stop_event_task_) {
+      adapter->handleEvent(event);
+    }
+  }
+
+  xSemaphoreGive(adapter->event_task_stopped_);
+  vTaskDelete(nullptr);
+}
+
+void UARTAdapter::handleEvent(const uart_event_t& event) {
+  switch (event.type) {
+    case UART_DATA:
+      // Raised by the FIFO-full and idle interrupts. Only wake the consumers
+      // once enough bytes were buffered
+      if (available() >= static_cast<int>(receive_threshold_)) {
+        receive_ready_ = true;
+      }
+      break;
+    case UART_PATTERN_DET:
+      // A frame header was received. Consume its position to keep the
+      // pattern queue from filling up
+      uart_pattern_pop_pos(port_);
+      receive_ready_ = true;
+      break;
+    case UART_FIFO_OVF:
+    case UART_BUFFER_FULL:
+      // The consumers did not keep up. Drop the bytes to resynchronize
+      uart_flush_input(port_);
+      xQueueReset(event_queue_);
+      receive_ready_ = false;
+      break;
+    default:
+      break;
+  }
+}
+
+constexpr int UARTAdapter::default_rx_buffer_size_;
+constexpr int UARTAdapter::default_rx_full_threshold_;
+constexpr int UARTAdapter::default_rx_timeout_;
+constexpr int UARTAdapter::event_queue_length_;
+constexpr int UARTAdapter::pattern_queue_length_;
 #endif
 
 #ifdef ESP8266
@@ -184,6 +494,21 @@ const __FlashStringHelper* UARTAdapter::tx_key_ = FPSTR("tx");
 const __FlashStringHelper* UARTAdapter::baud_rate_key_ = FPSTR("baud_rate");
 const __FlashStringHelper* UARTAdapter::config_key_ = FPSTR("config");
 const __FlashStringHelper* UARTAdapter::config_error_ = FPSTR("Invalid config");
+#ifdef ESP32
+const __FlashStringHelper* UARTAdapter::rx_buffer_size_key_ =
+    FPSTR("rx_buffer_size");
+const __FlashStringHelper* UARTAdapter::rx_full_threshold_key_ =
+    FPSTR("rx_full_threshold");
+const __FlashStringHelper* UARTAdapter::rx_timeout_key_ = FPSTR("rx_timeout");
+const __FlashStringHelper* UARTAdapter::pattern_char_key_ =
+    FPSTR("pattern_char");
+const __FlashStringHelper* UARTAdapter::pattern_count_key_ =
+    FPSTR("pattern_count");
+const __FlashStringHelper* UARTAdapter::buffer_config_error_ =
+    FPSTR("Invalid buffer config");
+const __FlashStringHelper* UARTAdapter::driver_error_ =
+    FPSTR("UART driver error");
+#endif
 
 }  // namespace uart
 }  // namespace peripherals
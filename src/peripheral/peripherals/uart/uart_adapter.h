@@ -3,6 +3,16 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#ifdef ESP32
+#include <driver/uart.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#endif
+
 #include "managers/service_getters.h"
 #include "peripheral/peripheral.h"
 #include "peripheral/peripherals/uart/uart_adapter.h"
@@ -13,6 +23,14 @@ namespace peripheral {
 namespace peripherals {
 namespace uart {
 
+/**
+ * Configures a UART interface and buffers the received bytes
+ *
+ * On the ESP32 the IDF UART driver is used. Received bytes are moved from the
+ * RX FIFO into a ring buffer by the FIFO-full and idle interrupts, and an
+ * event task wakes consumers once enough bytes or a frame header pattern were
+ * received. On the ESP8266 the Arduino serial ports are used.
+ */
 class UARTAdapter : public Peripheral {
  public:
   UARTAdapter(const ServiceGetters& services,
@@ -21,6 +39,8 @@ class UARTAdapter : public Peripheral {
 
   const String& getType() const final;
   static const String& type();
+  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
+                                             const JsonObjectConst&);
 
   /**
    * Get the configured Serial object
@@ -29,12 +49,94 @@ class UARTAdapter : public Peripheral {
    */
   HardwareSerial* getSerial();
 
- private:
-  static std::shared_ptr<Peripheral> factory(const ServiceGetters& services,
-                                             const JsonObjectConst&);
+  /**
+   * Get the number of received bytes that can be read without blocking
+   *
+   * \return The number of buffered bytes
+   */
+  int available();
 
+  /**
+   * Reads received bytes without blocking
+   *
+   * \param buffer The buffer to read the bytes into
+   * \param length The maximum number of bytes to read
+   * \return The number of bytes read
+   */
+  size_t readBytes(uint8_t* buffer, size_t length);
+
+  /**
+   * Queues bytes to be sent
+   *
+   * \param buffer The bytes to send
+   * \param length The number of bytes to send
+   * \return The number of bytes queued
+   */
+  size_t write(const uint8_t* buffer, size_t length);
+
+  /**
+   * Checks if all queued bytes were sent without blocking
+   *
+   * On the ESP8266 it blocks until they were sent.
+   *
+   * \return True once the last byte left the transmitter
+   */
+  bool isTransmitted();
+
+  /**
+   * Lets the UART switch the driver enable pin of an RS485 transceiver
+   *
+   * The pin is used as RTS in half-duplex mode and is asserted by the UART
+   * while it transmits, so that the bus is released right after the last
+   * byte without waiting for it.
+   *
+   * \param de_pin The transceiver's driver enable pin
+   * \return False if not supported, the pin has to be switched by software
+   */
+  bool setDriverEnablePin(int de_pin);
+
+  /**
+   * Drops all received bytes that were not read yet
+   */
+  void clearReceived();
+
+  /**
+   * Get the configured baud rate
+   *
+   * \return The baud rate in bits per second
+   */
+  int getBaudRate() const;
+
+  /**
+   * Sets the number of received bytes required to wake consumers
+   *
+   * Consumers of frames should set this to the frame size.
+   *
+   * \param bytes The number of bytes, at least 1
+   */
+  void setReceiveThreshold(size_t bytes);
+
+  /**
+   * Check if enough bytes or a header pattern were received
+   *
+   * Cheap enough to be polled, as it does not access the UART.
+   *
+   * \return True if consumers should read the received bytes
+   */
+  bool isReceiveReady();
+
+ private:
 #ifdef ESP32
-  void setupESP32(int rx_pin, int tx_pin, const char* config, int baud_rate);
+  void setupESP32(int rx_pin, int tx_pin, const char* config, int baud_rate,
+                  const JsonObjectConst& parameters);
+
+  /**
+   * Waits for UART events and sets the receive ready flag
+   *
+   * \param arg The UART adapter
+   */
+  static void runEventTask(void* arg);
+  void handleEvent(const uart_event_t& event);
 #else
   void setupESP8266(int rx_pin, int tx_pin, const char* config, int baud_rate);
 #endif
@@ -48,8 +150,6 @@ class UARTAdapter : public Peripheral {
    */
   void setInvalidSerialTaken(const char serial_id);
 
-  static bool registered_;
-
   static bool uart0_taken;
   static bool uart1_taken;
 #ifdef ESP32
@@ -59,6 +159,30 @@ class UARTAdapter : public Peripheral {
   std::shared_ptr<WebSocket> web_socket_;
 
   bool* taken_variable_ = nullptr;
+  int baud_rate_ = 0;
+  /// Buffered bytes required to wake consumers
+  size_t receive_threshold_ = 1;
+#ifdef ESP32
+  uart_port_t port_ = UART_NUM_MAX;
+  QueueHandle_t event_queue_ = nullptr;
+  TaskHandle_t event_task_ = nullptr;
+  /// Given by the event task once it exited
+  SemaphoreHandle_t event_task_stopped_ = nullptr;
+  volatile bool stop_event_task_ = false;
+  /// Set by the event task, cleared once the bytes were read
+  std::atomic<bool> receive_ready_{false};
+
+  /// Default size of the RX ring buffer
+  static constexpr int default_rx_buffer_size_ = 512;
+  /// Default RX FIFO level that moves the bytes to the ring buffer
+  static constexpr int default_rx_full_threshold_ = 120;
+  /// Default idle time in symbols that moves the bytes to the ring buffer
+  static constexpr int default_rx_timeout_ = 10;
+  /// Number of UART events that can be queued
+  static constexpr int event_queue_length_ = 20;
+  /// Number of pattern positions that can be queued
+  static constexpr int pattern_queue_length_ = 16;
+#endif
   static const __FlashStringHelper* serial_taken_error_;
   static const __FlashStringHelper* invalid_pins_error_;
 
@@ -69,6 +193,15 @@ class UARTAdapter : public Peripheral {
   static const __FlashStringHelper* baud_rate_key_;
   static const __FlashStringHelper* config_key_;
   static const __FlashStringHelper* config_error_;
+#ifdef ESP32
+  static const __FlashStringHelper* rx_buffer_size_key_;
+  static const __FlashStringHelper* rx_full_threshold_key_;
+  static const __FlashStringHelper* rx_timeout_key_;
+  static const __FlashStringHelper* pattern_char_key_;
+  static const __FlashStringHelper* pattern_count_key_;
+  static const __FlashStringHelper* buffer_config_error_;
+  static const __FlashStringHelper* driver_error_;
+#endif
 };
 
 }  // namespace uart
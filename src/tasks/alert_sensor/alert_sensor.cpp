@@ -1,5 +1,6 @@
 #include "alert_sensor.h"
 
+#include "managers/services.h"
 #include "tasks/task_factory.h"
 
 namespace inamata {
@@ -65,9 +66,44 @@ AlertSensor::AlertSensor(const ServiceGetters& services,
     return;
   }
 
+  // Check the captured edges of digital inputs instead of polling their state
+  using peripheral::peripherals::digital_in::DigitalIn;
+  std::shared_ptr<peripheral::Peripheral> peripheral =
+      Services::getPeripheralController().getPeripheral(getPeripheralUUID());
+  if (peripheral && peripheral->getType() == DigitalIn::type()) {
+    auto digital_in = std::static_pointer_cast<DigitalIn>(peripheral);
+    if (digital_in->isEdgeCapture() &&
+        digital_in->getDataPointType() == data_point_type_) {
+      edge_input_ = digital_in;
+      edge_index_ = edge_input_->getEdgeCount();
+      last_value_ = edge_input_->getState();
+    }
+  }
+
+#ifdef ESP32
+  if (edge_input_) {
+    if (!edge_input_->addEdgeWaiter(&edge_signal_)) {
+      setInvalid(too_many_waiters_error_);
+      return;
+    }
+    if (!duration_ms.isNull()) {
+      duration_ = std::chrono::milliseconds(duration_ms.as<unsigned int>());
+    }
+    start_ = std::chrono::steady_clock::now();
+  }
+#endif
+
   enable();
 }
 
+AlertSensor::~AlertSensor() {
+#ifdef ESP32
+  if (edge_input_) {
+    edge_input_->removeEdgeWaiter(&edge_signal_);
+  }
+#endif
+}
+
 const String& AlertSensor::getType() const { return type(); }
 
 const String& AlertSensor::type() {
@@ -76,6 +112,10 @@ const String& AlertSensor::type() {
 }
 
 bool AlertSensor::TaskCallback() {
+  if (edge_input_) {
+    return handleEdges();
+  }
+
   auto result = getPeripheral()->getValues();
   if (result.error.isError()) {
     setInvalid(result.error.toString());
@@ -94,21 +134,7 @@ bool AlertSensor::TaskCallback() {
     return false;
   }
 
-  // Check the flank type if it should trigger
-  if (isRisingThreshold(trigger_value_unit->value)) {
-    if (trigger_type_ == TriggerType::kRising ||
-        trigger_type_ == TriggerType::kEither) {
-      sendAlert(TriggerType::kRising);
-    }
-  } else if (isFallingThreshold(trigger_value_unit->value)) {
-    if (trigger_type_ == TriggerType::kFalling ||
-        trigger_type_ == TriggerType::kEither) {
-      sendAlert(TriggerType::kFalling);
-    }
-  }
-
-  // Store the current value for the next iteration
-  last_value_ = trigger_value_unit->value;
+  checkValue(trigger_value_unit->value);
   return true;
 }
 
@@ -129,6 +155,53 @@ void AlertSensor::setTriggerType(const TriggerType type) {
 
 AlertSensor::TriggerType AlertSensor::getTriggerType() { return trigger_type_; }
 
+void AlertSensor::checkValue(float value) {
+  // Check the flank type if it should trigger
+  if (isRisingThreshold(value)) {
+    if (trigger_type_ == TriggerType::kRising ||
+        trigger_type_ == TriggerType::kEither) {
+      sendAlert(TriggerType::kRising);
+    }
+  } else if (isFallingThreshold(value)) {
+    if (trigger_type_ == TriggerType::kFalling ||
+        trigger_type_ == TriggerType::kEither) {
+      sendAlert(TriggerType::kFalling);
+    }
+  }
+
+  // Store the current value for the next iteration
+  last_value_ = value;
+}
+
+bool AlertSensor::handleEdges() {
+  // Check each edge, as a pulse may have come and gone since the last call
+  edges_.clear();
+  edge_input_->readEdges(edge_index_, edges_);
+  for (const auto& edge : edges_) {
+    checkValue(edge.state);
+  }
+
+#ifdef ESP32
+  if (duration_.count() &&
+      std::chrono::steady_clock::now() - start_ >= duration_) {
+    return false;
+  }
+  waitForEdge();
+#endif
+  return true;
+}
+
+#ifdef ESP32
+void AlertSensor::waitForEdge() {
+  edge_signal_.setWaiting();
+  // Edges captured since they were last read would otherwise wait for the next
+  if (edge_input_->getEdgeCount() != edge_index_) {
+    edge_signal_.signalComplete();
+  }
+  waitFor(&edge_signal_, getInterval(), TASK_FOREVER);
+}
+#endif
+
 bool AlertSensor::sendAlert(TriggerType trigger_type) {
   if (trigger_type == TriggerType::kRising ||
       trigger_type == TriggerType::kFalling) {
@@ -159,8 +232,6 @@ bool AlertSensor::isFallingThreshold(const float value) {
   return value < threshold_ && last_value_ > threshold_;
 }
 
-bool AlertSensor::registered_ = TaskFactory::registerTask(type(), factory);
-
 BaseTask* AlertSensor::factory(const ServiceGetters& services,
                                const JsonObjectConst& parameters,
                                Scheduler& scheduler) {
@@ -173,6 +244,9 @@ const std::map<AlertSensor::TriggerType, const __FlashStringHelper*>
         {TriggerType::kFalling, FPSTR("falling")},
         {TriggerType::kEither, FPSTR("either")}};
 
+const __FlashStringHelper* AlertSensor::too_many_waiters_error_ =
+    FPSTR("Too many tasks waiting for the digital input's edges");
+
 }  // namespace alert_sensor
 }  // namespace tasks
 }  // namespace inamata
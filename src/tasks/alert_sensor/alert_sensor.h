@@ -2,9 +2,12 @@
 
 #include <ArduinoJson.h>
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include "managers/service_getters.h"
+#include "peripheral/peripherals/digital_in/digital_in.h"
 #include "tasks/get_values_task/get_values_task.h"
 #include "utils/value_unit.h"
 
@@ -12,16 +15,26 @@ namespace inamata {
 namespace tasks {
 namespace alert_sensor {
 
+/**
+ * Sends an alert when a sensor value crosses a threshold
+ *
+ * Polls the sensor in an interval. For digital inputs that capture edges,
+ * every captured edge is checked instead, so that short pulses are not
+ * missed. On the ESP32, the task is woken by the edges instead of polling.
+ */
 class AlertSensor : public get_values_task::GetValuesTask {
  public:
   enum class TriggerType { kRising, kFalling, kEither };
 
   AlertSensor(const ServiceGetters& services, const JsonObjectConst& parameters,
               Scheduler& scheduler);
-  virtual ~AlertSensor() = default;
+  virtual ~AlertSensor();
 
   const String& getType() const final;
   static const String& type();
+  static BaseTask* factory(const ServiceGetters& services,
+                           const JsonObjectConst& parameters,
+                           Scheduler& scheduler);
 
   bool TaskCallback() final;
 
@@ -57,17 +70,35 @@ class AlertSensor : public get_values_task::GetValuesTask {
   const __FlashStringHelper* triggerType2String(TriggerType trigger_type);
 
  private:
+  /**
+   * Sends an alert if the value crossed the threshold in the trigger's
+   * direction and stores it for the next check
+   *
+   * \param value The latest sensor value
+   */
+  void checkValue(float value);
+
+  /**
+   * Checks the edges captured since the last call
+   *
+   * \return False once the duration has passed
+   */
+  bool handleEdges();
+
+#ifdef ESP32
+  /**
+   * Waits until the digital input captures the next edge
+   */
+  void waitForEdge();
+#endif
+
   bool sendAlert(TriggerType trigger_type);
   bool isRisingThreshold(const float value);
   bool isFallingThreshold(const float value);
 
-  static bool registered_;
-  static BaseTask* factory(const ServiceGetters& services,
-                           const JsonObjectConst& parameters,
-                           Scheduler& scheduler);
-
   static const std::map<TriggerType, const __FlashStringHelper*>
       trigger_type_strings_;
+  static const __FlashStringHelper* too_many_waiters_error_;
 
   /// Interface to send data to the server
   std::shared_ptr<WebSocket> web_socket_;
@@ -85,7 +116,20 @@ class AlertSensor : public get_values_task::GetValuesTask {
   float threshold_;
 
   /// Last measured sensor value
-  float last_value_;
+  float last_value_ = NAN;
+
+  /// The digital input if its edges are checked
+  std::shared_ptr<peripheral::peripherals::digital_in::DigitalIn> edge_input_;
+  /// Index of the next edge to read from the digital input
+  uint32_t edge_index_ = 0;
+  std::vector<peripheral::peripherals::digital_in::DigitalIn::Edge> edges_;
+#ifdef ESP32
+  /// Completed by the digital input on each edge
+  StatusRequest edge_signal_;
+  /// How long to check edges or zero for forever
+  std::chrono::milliseconds duration_{0};
+  std::chrono::steady_clock::time_point start_;
+#endif
 };
 
 }  // namespace alert_sensor
@@ -4,10 +4,14 @@ namespace inamata {
 namespace tasks {
 
 BaseTask::BaseTask(Scheduler& scheduler, utils::UUID task_id)
-    : Task(&scheduler), scheduler_(scheduler), task_id_(task_id) {}
+    : Task(&scheduler), scheduler_(scheduler), task_id_(task_id) {
+  setLtsPointer(this);
+}
 
 BaseTask::BaseTask(Scheduler& scheduler, const JsonObjectConst& parameters)
     : Task(&scheduler), scheduler_(scheduler) {
+  setLtsPointer(this);
+
   // Get and set the UUID to identify the task with the server
   task_id_ = utils::UUID(parameters[task_id_key_]);
   if (!task_id_.isValid()) {
@@ -74,10 +78,18 @@ const utils::UUID& BaseTask::getTaskID() const { return task_id_; }
 
 bool BaseTask::isSystemTask() const { return !task_id_.isValid(); }
 
-void BaseTask::setTaskRemovalCallback(std::function<void(Task&)> callback) {
+void BaseTask::setTaskRemovalCallback(
+    std::function<void(BaseTask&)> callback) {
   task_removal_callback_ = callback;
 }
 
+BaseTask* BaseTask::fromTask(Task* task) {
+  if (!task) {
+    return nullptr;
+  }
+  return static_cast<BaseTask*>(task->getLtsPointer());
+}
+
 void BaseTask::setInvalid() { is_valid_ = false; }
 
 void BaseTask::setInvalid(const String& error_message) {
@@ -100,7 +112,7 @@ const __FlashStringHelper* BaseTask::task_id_key_ = FPSTR("uuid");
 const __FlashStringHelper* BaseTask::task_id_key_error_ =
     FPSTR("Missing property: uuid (uuid)");
 
-std::function<void(Task&)> BaseTask::task_removal_callback_ = nullptr;
+std::function<void(BaseTask&)> BaseTask::task_removal_callback_ = nullptr;
 
 }  // namespace tasks
 }  // namespace inamata
@@ -129,7 +129,18 @@ class BaseTask : public Task {
    *
    * \param callback The function to call to add a task to the removal queue
    */
-  static void setTaskRemovalCallback(std::function<void(Task&)> callback);
+  static void setTaskRemovalCallback(std::function<void(BaseTask&)> callback);
+
+  /**
+   * Gets the base task from a task in the scheduler's chain
+   *
+   * Uses the scheduler's local task storage pointer which each base task sets
+   * to itself. This avoids requiring RTTI to identify base tasks.
+   *
+   * \param task The task to be checked
+   * \return The base task or a nullptr if the task is not a base task
+   */
+  static BaseTask* fromTask(Task* task);
 
   static const __FlashStringHelper* peripheral_key_;
   static const __FlashStringHelper* peripheral_key_error_;
@@ -166,7 +177,7 @@ class BaseTask : public Task {
   /// The task's identifier
   utils::UUID task_id_ = utils::UUID(nullptr);
   /// Add task to removal queue callback
-  static std::function<void(Task&)> task_removal_callback_;
+  static std::function<void(BaseTask&)> task_removal_callback_;
 };
 
 }  // namespace tasks
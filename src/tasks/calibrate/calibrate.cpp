@@ -1,5 +1,7 @@
 #include "calibrate.h"
 
+#include "utils/chrono_ceil.h"
+
 namespace inamata {
 namespace tasks {
 namespace calibrate {
@@ -19,19 +21,18 @@ Calibrate::Calibrate(const JsonObjectConst& parameters, Scheduler& scheduler)
   }
 
   // Search for the peripheral for the given name
-  auto peripheral =
-      Services::getPeripheralController().getPeripheral(peripheral_uuid);
-  if (!peripheral) {
+  const peripheral::PeripheralEntry* entry =
+      Services::getPeripheralController().findPeripheral(peripheral_uuid);
+  if (!entry) {
     setInvalid(peripheral_not_found_error_);
     return;
   }
 
   // Check that the peripheral supports the Calibrate interface capability
-  peripheral_ = std::dynamic_pointer_cast<peripheral::capabilities::Calibrate>(
-      peripheral);
+  peripheral_ = entry->share(entry->calibrate);
   if (!peripheral_) {
     setInvalid(peripheral::capabilities::Calibrate::invalidTypeError(
-        peripheral_uuid, peripheral));
+        peripheral_uuid, entry->peripheral));
     return;
   }
 
@@ -43,8 +44,7 @@ Calibrate::Calibrate(const JsonObjectConst& parameters, Scheduler& scheduler)
   }
 
   enableDelayed(
-      std::chrono::duration_cast<std::chrono::milliseconds>(result.wait)
-          .count());
+      utils::chrono_ceil<std::chrono::milliseconds>(result.wait).count());
 }
 
 const String& Calibrate::getType() const { return type(); }
@@ -62,8 +62,7 @@ bool Calibrate::TaskCallback() {
   } else if (result.wait.count() != 0) {
     // Delays execution of next callback for the specified milliseconds
     Calibrate::delay(
-        std::chrono::duration_cast<std::chrono::milliseconds>(result.wait)
-            .count());
+        utils::chrono_ceil<std::chrono::milliseconds>(result.wait).count());
     return true;
   } else {
     return false;
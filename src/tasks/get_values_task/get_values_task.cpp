@@ -23,21 +23,21 @@ GetValuesTask::GetValuesTask(const JsonObjectConst& parameters,
   }
 
   // Search for the peripheral for the given name
-  auto peripheral =
-      Services::getPeripheralController().getPeripheral(peripheral_uuid_);
-  if (!peripheral) {
+  const peripheral::PeripheralEntry* entry =
+      Services::getPeripheralController().findPeripheral(peripheral_uuid_);
+  if (!entry) {
     setInvalid(peripheralNotFoundError(peripheral_uuid_));
     return;
   }
 
   // Check that the peripheral supports the GetValues interface capability
-  peripheral_ = std::dynamic_pointer_cast<peripheral::capabilities::GetValues>(
-      peripheral);
+  peripheral_ = entry->share(entry->get_values);
   if (!peripheral_) {
     setInvalid(peripheral::capabilities::GetValues::invalidTypeError(
-        peripheral_uuid_, peripheral));
+        peripheral_uuid_, entry->peripheral));
     return;
   }
+  start_measurement_peripheral_ = entry->share(entry->start_measurement);
 }
 
 std::shared_ptr<peripheral::capabilities::GetValues>
@@ -45,6 +45,11 @@ GetValuesTask::getPeripheral() {
   return peripheral_;
 }
 
+std::shared_ptr<peripheral::capabilities::StartMeasurement>
+GetValuesTask::getStartMeasurementPeripheral() {
+  return start_measurement_peripheral_;
+}
+
 const utils::UUID& GetValuesTask::getPeripheralUUID() const {
   return peripheral_uuid_;
 }
@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "peripheral/capabilities/get_values.h"
+#include "peripheral/capabilities/start_measurement.h"
 #include "tasks/base_task.h"
 #include "utils/uuid.h"
 
@@ -22,6 +23,14 @@ class GetValuesTask : public BaseTask {
   virtual ~GetValuesTask() = default;
 
   std::shared_ptr<peripheral::capabilities::GetValues> getPeripheral();
+
+  /**
+   * The peripheral's StartMeasurement capability, resolved on construction
+   *
+   * \return The capability or a nullptr if it is not supported
+   */
+  std::shared_ptr<peripheral::capabilities::StartMeasurement>
+  getStartMeasurementPeripheral();
   const utils::UUID& getPeripheralUUID() const;
 
   /**
@@ -43,6 +52,8 @@ class GetValuesTask : public BaseTask {
 
  private:
   std::shared_ptr<peripheral::capabilities::GetValues> peripheral_;
+  std::shared_ptr<peripheral::capabilities::StartMeasurement>
+      start_measurement_peripheral_;
   utils::UUID peripheral_uuid_;
 };
 
@@ -0,0 +1,298 @@
+#ifdef ESP32
+#include "led_effect.h"
+
+#include "managers/services.h"
+#include "tasks/task_factory.h"
+
+namespace inamata {
+namespace tasks {
+namespace led_effect {
+
+LedEffect::LedEffect(const JsonObjectConst& parameters, Scheduler& scheduler)
+    : BaseTask(scheduler, parameters) {
+  if (!isValid()) {
+    return;
+  }
+
+  // Get the UUID to later find the pointer to the peripheral object
+  peripheral_uuid_ = utils::UUID(parameters[peripheral_key_]);
+  if (!peripheral_uuid_.isValid()) {
+    setInvalid(peripheral_key_error_);
+    return;
+  }
+
+  // Search for the peripheral for the given name
+  const peripheral::PeripheralEntry* entry =
+      Services::getPeripheralController().findPeripheral(peripheral_uuid_);
+  if (!entry) {
+    setInvalid(peripheralNotFoundError(peripheral_uuid_));
+    return;
+  }
+
+  // Check that the peripheral supports the LedStrip interface capability
+  peripheral_ = entry->share(entry->led_strip);
+  if (!peripheral_) {
+    setInvalid(peripheral::capabilities::LedStrip::invalidTypeError(
+        peripheral_uuid_, entry->peripheral));
+    return;
+  }
+
+  if (!parseEffect(parameters[effect_key_]) ||
+      !parseKeyframes(parameters[keyframes_key_]) ||
+      !parseSegments(parameters[segments_key_])) {
+    return;
+  }
+
+  // Loop over the keyframes by default
+  period_ms_ = parameters[period_ms_key_] | keyframes_.back().time_ms;
+  step_ms_ = parameters[step_ms_key_] | default_step_ms_;
+  chase_width_ = parameters[chase_width_key_] | 1;
+  duration_ms_ = parameters[duration_ms_key_] | 0;
+  const uint32_t frame_rate =
+      parameters[frame_rate_key_] | default_frame_rate_;
+  if (step_ms_ == 0 || chase_width_ == 0 || frame_rate == 0 ||
+      frame_rate > max_frame_rate_) {
+    setInvalid(timing_error_);
+    return;
+  }
+
+  // The effect is drawn from the time since the start, so late frames do not
+  // slow down the animation
+  Task::setInterval(1000 / frame_rate);
+  Task::setIterations(TASK_FOREVER);
+  palette_.resize(keyframes_.front().colors.size());
+  enable();
+}
+
+const String& LedEffect::getType() const { return type(); }
+
+const String& LedEffect::type() {
+  static const String name{"LedEffect"};
+  return name;
+}
+
+bool LedEffect::OnTaskEnable() {
+  start_ms_ = millis();
+  return true;
+}
+
+bool LedEffect::TaskCallback() {
+  const uint32_t elapsed_ms = millis() - start_ms_;
+  if (duration_ms_ && elapsed_ms >= duration_ms_) {
+    return false;
+  }
+
+  updatePalette(period_ms_ ? elapsed_ms % period_ms_ : elapsed_ms);
+  for (const Segment& segment : segments_) {
+    drawSegment(segment, elapsed_ms);
+  }
+
+  // Skips the frame if the previous one is still being sent
+  peripheral_->show();
+  return true;
+}
+
+BaseTask* LedEffect::factory(const ServiceGetters& services,
+                             const JsonObjectConst& parameters,
+                             Scheduler& scheduler) {
+  return new LedEffect(parameters, scheduler);
+}
+
+bool LedEffect::parseEffect(JsonVariantConst effect) {
+  if (effect == fade_) {
+    effect_ = Effect::kFade;
+  } else if (effect == gradient_) {
+    effect_ = Effect::kGradient;
+  } else if (effect == chase_) {
+    effect_ = Effect::kChase;
+  } else {
+    setInvalid(effect_key_error_);
+    return false;
+  }
+  return true;
+}
+
+bool LedEffect::parseKeyframes(JsonVariantConst keyframes) {
+  JsonArrayConst keyframes_array = keyframes.as<JsonArrayConst>();
+  if (keyframes_array.size() == 0) {
+    setInvalid(keyframes_key_error_);
+    return false;
+  }
+
+  // All keyframes require the same number of colors in ascending time
+  keyframes_.reserve(keyframes_array.size());
+  for (JsonVariantConst keyframe : keyframes_array) {
+    JsonVariantConst time_ms = keyframe[time_ms_key_];
+    JsonArrayConst colors = keyframe[colors_key_].as<JsonArrayConst>();
+    if (!time_ms.is<uint32_t>() || colors.size() == 0 ||
+        (!keyframes_.empty() &&
+         (time_ms.as<uint32_t>() < keyframes_.back().time_ms ||
+          colors.size() != keyframes_.back().colors.size()))) {
+      setInvalid(keyframes_key_error_);
+      return false;
+    }
+
+    keyframes_.push_back({time_ms.as<uint32_t>(), {}});
+    std::vector<utils::Color>& parsed = keyframes_.back().colors;
+    parsed.resize(colors.size());
+    for (size_t i = 0; i < colors.size(); i++) {
+      if (!parseColor(colors[i], parsed[i])) {
+        setInvalid(keyframes_key_error_);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool LedEffect::parseSegments(JsonVariantConst segments) {
+  // Without segments, the effect is drawn onto the whole strip
+  const size_t pixel_count = peripheral_->getPixelCount();
+  if (pixel_count == 0) {
+    setInvalid(no_pixels_error_);
+    return false;
+  }
+  if (segments.isNull()) {
+    segments_.push_back({0, pixel_count, false});
+    return true;
+  }
+
+  JsonArrayConst segments_array = segments.as<JsonArrayConst>();
+  if (segments_array.size() == 0) {
+    setInvalid(segments_key_error_);
+    return false;
+  }
+  segments_.reserve(segments_array.size());
+  for (JsonVariantConst segment : segments_array) {
+    JsonVariantConst start = segment[start_key_];
+    JsonVariantConst length = segment[length_key_];
+    if (!start.is<uint16_t>() || !length.is<uint16_t>() ||
+        length.as<size_t>() == 0 ||
+        start.as<size_t>() + length.as<size_t>() > pixel_count) {
+      setInvalid(segments_key_error_);
+      return false;
+    }
+    segments_.push_back({start.as<size_t>(), length.as<size_t>(),
+                         segment[reverse_key_] | false});
+  }
+  return true;
+}
+
+bool LedEffect::parseColor(JsonVariantConst color, utils::Color& result) {
+  JsonVariantConst red = color[red_key_];
+  JsonVariantConst green = color[green_key_];
+  JsonVariantConst blue = color[blue_key_];
+  JsonVariantConst white = color[white_key_];
+  if (!red.is<uint8_t>() || !green.is<uint8_t>() || !blue.is<uint8_t>() ||
+      !(white.is<uint8_t>() || white.isNull())) {
+    return false;
+  }
+  result = utils::Color::fromRgbw(red, green, blue, white | 0);
+  return true;
+}
+
+void LedEffect::updatePalette(uint32_t time_ms) {
+  // Hold the first and last colors outside of the keyframes
+  auto next = keyframes_.begin();
+  while (next != keyframes_.end() && next->time_ms <= time_ms) {
+    next++;
+  }
+  if (next == keyframes_.begin() || next == keyframes_.end()) {
+    const Keyframe& held =
+        next == keyframes_.end() ? keyframes_.back() : keyframes_.front();
+    palette_ = held.colors;
+    return;
+  }
+
+  const Keyframe& previous = *(next - 1);
+  const uint32_t weight = (time_ms - previous.time_ms) * 256 /
+                          (next->time_ms - previous.time_ms);
+  for (size_t i = 0; i < palette_.size(); i++) {
+    palette_[i] = mix(previous.colors[i], next->colors[i], weight);
+  }
+}
+
+void LedEffect::drawSegment(const Segment& segment, uint32_t time_ms) {
+  const size_t colors = palette_.size();
+  // The chase pattern moves by one pixel per step and wraps around
+  const size_t shift = time_ms / step_ms_ % segment.length;
+
+  for (size_t i = 0; i < segment.length; i++) {
+    utils::Color color;
+    switch (effect_) {
+      case Effect::kFade:
+        color = palette_.front();
+        break;
+      case Effect::kGradient: {
+        // Spread the palette evenly over the segment in 1/256 steps
+        const uint32_t position =
+            segment.length > 1 ? i * (colors - 1) * 256 / (segment.length - 1)
+                               : 0;
+        const size_t index = position / 256;
+        color = index + 1 < colors
+                    ? mix(palette_[index], palette_[index + 1], position % 256)
+                    : palette_.back();
+        break;
+      }
+      case Effect::kChase: {
+        const size_t position = (i + segment.length - shift) % segment.length;
+        color = palette_[position / chase_width_ % colors];
+        break;
+      }
+    }
+
+    const size_t offset = segment.reverse ? segment.length - 1 - i : i;
+    peripheral_->setPixel(segment.start + offset, color);
+  }
+}
+
+utils::Color LedEffect::mix(utils::Color a, utils::Color b, uint32_t weight) {
+  auto channel = [weight](uint8_t from, uint8_t to) -> uint8_t {
+    return (from * (256 - weight) + to * weight) / 256;
+  };
+  return utils::Color::fromRgbw(channel(a.getRed(), b.getRed()),
+                                channel(a.getGreen(), b.getGreen()),
+                                channel(a.getBlue(), b.getBlue()),
+                                channel(a.getWhite(), b.getWhite()));
+}
+
+constexpr uint32_t LedEffect::default_frame_rate_;
+constexpr uint32_t LedEffect::max_frame_rate_;
+constexpr uint32_t LedEffect::default_step_ms_;
+
+const __FlashStringHelper* LedEffect::effect_key_ = FPSTR("effect");
+const __FlashStringHelper* LedEffect::effect_key_error_ =
+    FPSTR("Missing property: effect (fade, gradient or chase)");
+const __FlashStringHelper* LedEffect::fade_ = FPSTR("fade");
+const __FlashStringHelper* LedEffect::gradient_ = FPSTR("gradient");
+const __FlashStringHelper* LedEffect::chase_ = FPSTR("chase");
+const __FlashStringHelper* LedEffect::keyframes_key_ = FPSTR("keyframes");
+const __FlashStringHelper* LedEffect::keyframes_key_error_ =
+    FPSTR("Invalid property: keyframes (array of time_ms and colors)");
+const __FlashStringHelper* LedEffect::time_ms_key_ = FPSTR("time_ms");
+const __FlashStringHelper* LedEffect::colors_key_ = FPSTR("colors");
+const __FlashStringHelper* LedEffect::red_key_ = FPSTR("red");
+const __FlashStringHelper* LedEffect::green_key_ = FPSTR("green");
+const __FlashStringHelper* LedEffect::blue_key_ = FPSTR("blue");
+const __FlashStringHelper* LedEffect::white_key_ = FPSTR("white");
+const __FlashStringHelper* LedEffect::segments_key_ = FPSTR("segments");
+const __FlashStringHelper* LedEffect::segments_key_error_ =
+    FPSTR("Invalid property: segments (array of start and length)");
+const __FlashStringHelper* LedEffect::no_pixels_error_ =
+    FPSTR("LED strip has no pixels");
+const __FlashStringHelper* LedEffect::start_key_ = FPSTR("start");
+const __FlashStringHelper* LedEffect::length_key_ = FPSTR("length");
+const __FlashStringHelper* LedEffect::reverse_key_ = FPSTR("reverse");
+const __FlashStringHelper* LedEffect::period_ms_key_ = FPSTR("period_ms");
+const __FlashStringHelper* LedEffect::step_ms_key_ = FPSTR("step_ms");
+const __FlashStringHelper* LedEffect::chase_width_key_ = FPSTR("chase_width");
+const __FlashStringHelper* LedEffect::frame_rate_key_ = FPSTR("frame_rate");
+const __FlashStringHelper* LedEffect::duration_ms_key_ = FPSTR("duration_ms");
+const __FlashStringHelper* LedEffect::timing_error_ =
+    FPSTR("Invalid step_ms, chase_width or frame_rate");
+
+}  // namespace led_effect
+}  // namespace tasks
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <memory>
+#include <vector>
+
+#include "managers/service_getters.h"
+#include "peripheral/capabilities/led_strip.h"
+#include "tasks/base_task.h"
+#include "utils/color.h"
+#include "utils/uuid.h"
+
+namespace inamata {
+namespace tasks {
+namespace led_effect {
+
+/**
+ * Plays an animation on a LED strip without further commands from the server
+ *
+ * The colors are given by keyframes between which is interpolated. The
+ * effect then draws them onto segments of the strip as a uniform fade, a
+ * gradient or a moving chase pattern. Frames are sent without blocking, so
+ * that the loop keeps running during the transmission.
+ */
+class LedEffect : public BaseTask {
+ public:
+  enum class Effect { kFade, kGradient, kChase };
+
+  LedEffect(const JsonObjectConst& parameters, Scheduler& scheduler);
+  virtual ~LedEffect() = default;
+
+  const String& getType() const final;
+  static const String& type();
+  static BaseTask* factory(const ServiceGetters& services,
+                           const JsonObjectConst& parameters,
+                           Scheduler& scheduler);
+
+  bool OnTaskEnable() final;
+
+  bool TaskCallback() final;
+
+ private:
+  /// The colors at a point in time of the animation
+  struct Keyframe {
+    uint32_t time_ms;
+    std::vector<utils::Color> colors;
+  };
+
+  /// A range of pixels onto which the effect is drawn
+  struct Segment {
+    size_t start;
+    size_t length;
+    bool reverse;
+  };
+
+  bool parseEffect(JsonVariantConst effect);
+  bool parseKeyframes(JsonVariantConst keyframes);
+  bool parseSegments(JsonVariantConst segments);
+
+  /**
+   * Parses a color object with red, green, blue and optionally white
+   *
+   * \param color The color object
+   * \param result Receives the parsed color
+   * \return True if the color is valid
+   */
+  static bool parseColor(JsonVariantConst color, utils::Color& result);
+
+  /**
+   * Interpolates the colors of the keyframes at a point in time
+   *
+   * \param time_ms Time since the start of the animation
+   */
+  void updatePalette(uint32_t time_ms);
+
+  /**
+   * Draws the palette onto a segment of the strip
+   *
+   * \param segment The segment to draw on
+   * \param time_ms Time since the start of the animation
+   */
+  void drawSegment(const Segment& segment, uint32_t time_ms);
+
+  /**
+   * Mixes two colors
+   *
+   * \param a The first color
+   * \param b The second color
+   * \param weight The weight of the second color from 0 to 256
+   * \return The mixed color
+   */
+  static utils::Color mix(utils::Color a, utils::Color b, uint32_t weight);
+
+  std::shared_ptr<peripheral::capabilities::LedStrip> peripheral_;
+  utils::UUID peripheral_uuid_;
+
+  Effect effect_ = Effect::kFade;
+  std::vector<Keyframe> keyframes_;
+  std::vector<Segment> segments_;
+  /// Colors of the current frame
+  std::vector<utils::Color> palette_;
+  /// Time after which the animation repeats. Zero to play it once
+  uint32_t period_ms_ = 0;
+  /// Time it takes the chase pattern to move by one pixel
+  uint32_t step_ms_ = default_step_ms_;
+  /// Number of pixels per color of the chase pattern
+  uint32_t chase_width_ = 1;
+  /// Optional run time after which the task ends. Zero to run forever
+  uint32_t duration_ms_ = 0;
+  uint32_t start_ms_ = 0;
+
+  static constexpr uint32_t default_frame_rate_ = 60;
+  static constexpr uint32_t max_frame_rate_ = 100;
+  static constexpr uint32_t default_step_ms_ = 50;
+
+  static const __FlashStringHelper* effect_key_;
+  static const __FlashStringHelper* effect_key_error_;
+  static const __FlashStringHelper* fade_;
+  static const __FlashStringHelper* gradient_;
+  static const __FlashStringHelper* chase_;
+  static const __FlashStringHelper* keyframes_key_;
+  static const __FlashStringHelper* keyframes_key_error_;
+  static const __FlashStringHelper* time_ms_key_;
+  static const __FlashStringHelper* colors_key_;
+  static const __FlashStringHelper* red_key_;
+  static const __FlashStringHelper* green_key_;
+  static const __FlashStringHelper* blue_key_;
+  static const __FlashStringHelper* white_key_;
+  static const __FlashStringHelper* segments_key_;
+  static const __FlashStringHelper* segments_key_error_;
+  static const __FlashStringHelper* no_pixels_error_;
+  static const __FlashStringHelper* start_key_;
+  static const __FlashStringHelper* length_key_;
+  static const __FlashStringHelper* reverse_key_;
+  static const __FlashStringHelper* period_ms_key_;
+  static const __FlashStringHelper* step_ms_key_;
+  static const __FlashStringHelper* chase_width_key_;
+  static const __FlashStringHelper* frame_rate_key_;
+  static const __FlashStringHelper* duration_ms_key_;
+  static const __FlashStringHelper* timing_error_;
+};
+
+}  // namespace led_effect
+}  // namespace tasks
+}  // namespace inamata
@@ -1,6 +1,7 @@
 #include "poll_sensor.h"
 
 #include "tasks/task_factory.h"
+#include "utils/chrono_ceil.h"
 
 namespace inamata {
 namespace tasks {
@@ -50,9 +51,7 @@ PollSensor::PollSensor(const ServiceGetters& services,
   // Check if the peripheral supports the startMeasurement capability. Start a
   // measurement if yes. Wait the returned amount of time to check the
   // measurement state. If doesn't support it, enable the task without delay.
-  start_measurement_peripheral_ =
-      std::dynamic_pointer_cast<peripheral::capabilities::StartMeasurement>(
-          getPeripheral());
+  start_measurement_peripheral_ = getStartMeasurementPeripheral();
   if (start_measurement_peripheral_) {
     auto result = start_measurement_peripheral_->startMeasurement(parameters);
     if (result.error.isError()) {
@@ -60,8 +59,7 @@ PollSensor::PollSensor(const ServiceGetters& services,
       return;
     }
     enableDelayed(
-        std::chrono::duration_cast<std::chrono::milliseconds>(result.wait)
-            .count());
+        utils::chrono_ceil<std::chrono::milliseconds>(result.wait).count());
   } else {
     enable();
   }
@@ -86,8 +84,7 @@ bool PollSensor::TaskCallback() {
     }
     if (result.wait.count() != 0) {
       Task::delay(
-          std::chrono::duration_cast<std::chrono::milliseconds>(result.wait)
-              .count());
+          utils::chrono_ceil<std::chrono::milliseconds>(result.wait).count());
       return true;
     }
   }
@@ -118,8 +115,6 @@ bool PollSensor::TaskCallback() {
   }
 }
 
-bool PollSensor::registered_ = TaskFactory::registerTask(type(), factory);
-
 BaseTask* PollSensor::factory(const ServiceGetters& services,
                               const JsonObjectConst& parameters,
                               Scheduler& scheduler) {
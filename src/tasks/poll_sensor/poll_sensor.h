@@ -33,15 +33,13 @@ class PollSensor : public get_values_task::GetValuesTask {
 
   const String& getType() const final;
   static const String& type();
-
-  bool TaskCallback() final;
-
- private:
-  static bool registered_;
   static BaseTask* factory(const ServiceGetters& services,
                            const JsonObjectConst& parameters,
                            Scheduler& scheduler);
 
+  bool TaskCallback() final;
+
+ private:
   std::shared_ptr<WebSocket> web_socket_;
 
   std::chrono::milliseconds interval_;
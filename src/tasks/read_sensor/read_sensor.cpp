@@ -1,6 +1,7 @@
 #include "read_sensor.h"
 
 #include "tasks/task_factory.h"
+#include "utils/chrono_ceil.h"
 
 namespace inamata {
 namespace tasks {
@@ -22,9 +23,7 @@ ReadSensor::ReadSensor(const ServiceGetters& services,
   // Check if the peripheral supports the startMeasurement capability. Start a
   // measurement if yes. Wait the returned amount of time to check the
   // measurement state. If doesn't support it, enable the task without delay.
-  start_measurement_peripheral_ =
-      std::dynamic_pointer_cast<peripheral::capabilities::StartMeasurement>(
-          getPeripheral());
+  start_measurement_peripheral_ = getStartMeasurementPeripheral();
   if (start_measurement_peripheral_) {
     // Repeatedly run task to call handleMeasurement
     Task::setIterations(-1);
@@ -35,8 +34,7 @@ ReadSensor::ReadSensor(const ServiceGetters& services,
       return;
     }
     enableDelayed(
-        std::chrono::duration_cast<std::chrono::milliseconds>(result.wait)
-            .count());
+        utils::chrono_ceil<std::chrono::milliseconds>(result.wait).count());
   } else {
     enable();
   }
@@ -61,8 +59,7 @@ bool ReadSensor::TaskCallback() {
     }
     if (result.wait.count() != 0) {
       Task::delay(
-          std::chrono::duration_cast<std::chrono::milliseconds>(result.wait)
-              .count());
+          utils::chrono_ceil<std::chrono::milliseconds>(result.wait).count());
       return true;
     }
   }
@@ -83,8 +80,6 @@ bool ReadSensor::TaskCallback() {
   return false;
 }
 
-bool ReadSensor::registered_ = TaskFactory::registerTask(type(), factory);
-
 BaseTask* ReadSensor::factory(const ServiceGetters& services,
                               const JsonObjectConst& parameters,
                               Scheduler& scheduler) {
@@ -37,6 +37,9 @@ class ReadSensor : public get_values_task::GetValuesTask {
 
   const String& getType() const final;
   static const String& type();
+  static BaseTask* factory(const ServiceGetters& services,
+                           const JsonObjectConst& parameters,
+                           Scheduler& scheduler);
 
   /**
    * Handles the measurement process and then reads the values.
@@ -50,10 +53,6 @@ class ReadSensor : public get_values_task::GetValuesTask {
   bool TaskCallback() final;
 
  private:
-  static bool registered_;
-  static BaseTask* factory(const ServiceGetters& services,
-                           const JsonObjectConst& parameters,
-                           Scheduler& scheduler);
   std::shared_ptr<peripheral::capabilities::StartMeasurement>
       start_measurement_peripheral_ = nullptr;
 
@@ -22,19 +22,18 @@ SetRgbLed::SetRgbLed(const JsonObjectConst& parameters, Scheduler& scheduler)
   }
 
   // Search for the peripheral for the given name
-  auto peripheral =
-      Services::getPeripheralController().getPeripheral(peripheral_uuid_);
-  if (!peripheral) {
+  const peripheral::PeripheralEntry* entry =
+      Services::getPeripheralController().findPeripheral(peripheral_uuid_);
+  if (!entry) {
     setInvalid(peripheralNotFoundError(peripheral_uuid_));
     return;
   }
 
-  // Check that the peripheral supports the GetValue interface capability
-  peripheral_ =
-      std::dynamic_pointer_cast<peripheral::capabilities::LedStrip>(peripheral);
+  // Check that the peripheral supports the LedStrip interface capability
+  peripheral_ = entry->share(entry->led_strip);
   if (!peripheral_) {
     setInvalid(peripheral::capabilities::LedStrip::invalidTypeError(
-        peripheral_uuid_, peripheral));
+        peripheral_uuid_, entry->peripheral));
     return;
   }
 
@@ -101,8 +100,6 @@ bool SetRgbLed::TaskCallback() {
   return false;
 }
 
-bool SetRgbLed::registered_ = TaskFactory::registerTask(type(), factory);
-
 BaseTask* SetRgbLed::factory(const ServiceGetters& services,
                              const JsonObjectConst& parameters,
                              Scheduler& scheduler) {
@@ -21,15 +21,13 @@ class SetRgbLed : public BaseTask {
 
   const String& getType() const final;
   static const String& type();
-
-  bool TaskCallback() final;
-
- private:
-  static bool registered_;
   static BaseTask* factory(const ServiceGetters& services,
                            const JsonObjectConst& parameters,
                            Scheduler& scheduler);
 
+  bool TaskCallback() final;
+
+ private:
   std::shared_ptr<peripheral::capabilities::LedStrip> peripheral_;
   utils::UUID peripheral_uuid_;
 
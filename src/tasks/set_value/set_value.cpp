@@ -22,19 +22,18 @@ SetValue::SetValue(const JsonObjectConst& parameters, Scheduler& scheduler)
   }
 
   // Search for the peripheral for the given name
-  auto peripheral =
-      Services::getPeripheralController().getPeripheral(peripheral_uuid);
-  if (!peripheral) {
+  const peripheral::PeripheralEntry* entry =
+      Services::getPeripheralController().findPeripheral(peripheral_uuid);
+  if (!entry) {
     setInvalid(peripheral_not_found_error_);
     return;
   }
 
   // Check that the peripheral supports the SetValue interface capability
-  peripheral_ =
-      std::dynamic_pointer_cast<peripheral::capabilities::SetValue>(peripheral);
+  peripheral_ = entry->share(entry->set_value);
   if (!peripheral_) {
     setInvalid(peripheral::capabilities::SetValue::invalidTypeError(
-        peripheral_uuid, peripheral));
+        peripheral_uuid, entry->peripheral));
     return;
   }
 
@@ -57,6 +56,32 @@ SetValue::SetValue(const JsonObjectConst& parameters, Scheduler& scheduler)
   value_unit_ =
       utils::ValueUnit{.value = value, .data_point_type = data_point_type};
 
+  // Optionally ramp to the value
+  using peripheral::capabilities::RampValue;
+  JsonVariantConst ramp_ms = parameters[RampValue::ramp_ms_key_];
+  if (!ramp_ms.isNull()) {
+    if (!ramp_ms.is<uint32_t>() ||
+        !RampValue::toCurve(parameters[RampValue::curve_key_], curve_)) {
+      setInvalid(RampValue::ramp_error_);
+      return;
+    }
+    ramp_duration_ = std::chrono::milliseconds(ramp_ms.as<uint32_t>());
+
+    // Without a hardware ramp, the task steps from the start value as the
+    // peripheral's current value is unknown
+    ramp_peripheral_ = entry->share(entry->ramp_value);
+    if (!ramp_peripheral_) {
+      JsonVariantConst start_value = parameters[start_value_key_];
+      if (!start_value.is<float>()) {
+        setInvalid(start_value_key_error_);
+        return;
+      }
+      start_value_ = start_value;
+      Task::setInterval(step_interval_.count());
+      Task::setIterations(TASK_FOREVER);
+    }
+  }
+
   enable();
 }
 
@@ -67,12 +92,41 @@ const String& SetValue::type() {
   return name;
 }
 
-bool SetValue::TaskCallback() {
-  peripheral_->setValue(value_unit_);
-  return false;
+bool SetValue::OnTaskEnable() {
+  ramp_start_ = std::chrono::steady_clock::now();
+  return true;
 }
 
-bool SetValue::registered_ = TaskFactory::registerTask(type(), factory);
+bool SetValue::TaskCallback() {
+  if (ramp_duration_.count() == 0) {
+    peripheral_->setValue(value_unit_);
+    return false;
+  }
+
+  if (ramp_peripheral_) {
+    ErrorResult error = ramp_peripheral_->rampValue(
+        peripheral::capabilities::RampValue::Ramp{.target = value_unit_,
+                                                  .duration = ramp_duration_,
+                                                  .curve = curve_});
+    if (error.isError()) {
+      setInvalid(error.detail_);
+    }
+    return false;
+  }
+
+  // Step through the ramp and end with the exact target value
+  const float progress =
+      std::chrono::duration<float>(std::chrono::steady_clock::now() -
+                                   ramp_start_) /
+      ramp_duration_;
+  utils::ValueUnit step = value_unit_;
+  step.value =
+      start_value_ +
+      peripheral::capabilities::RampValue::applyCurve(curve_, progress) *
+          (value_unit_.value - start_value_);
+  peripheral_->setValue(step);
+  return progress < 1;
+}
 
 BaseTask* SetValue::factory(const ServiceGetters& services,
                             const JsonObjectConst& parameters,
@@ -80,6 +134,12 @@ BaseTask* SetValue::factory(const ServiceGetters& services,
   return new SetValue(parameters, scheduler);
 }
 
+constexpr std::chrono::milliseconds SetValue::step_interval_;
+
+const __FlashStringHelper* SetValue::start_value_key_ = FPSTR("start_value");
+const __FlashStringHelper* SetValue::start_value_key_error_ =
+    FPSTR("Missing property: start_value (float) for a stepped ramp");
+
 }  // namespace set_value
 }  // namespace tasks
 }  // namespace inamata
\ No newline at end of file
@@ -2,9 +2,11 @@
 
 #include <ArduinoJson.h>
 
+#include <chrono>
 #include <memory>
 
 #include "managers/service_getters.h"
+#include "peripheral/capabilities/ramp_value.h"
 #include "peripheral/capabilities/set_value.h"
 #include "tasks/base_task.h"
 
@@ -12,6 +14,12 @@ namespace inamata {
 namespace tasks {
 namespace set_value {
 
+/**
+ * Sets the value of a peripheral or ramps it to the value over time
+ *
+ * Peripherals with the RampValue capability run the ramp on their own. For
+ * all others, the task steps through the ramp from the given start value.
+ */
 class SetValue : public BaseTask {
  public:
   SetValue(const JsonObjectConst& parameters, Scheduler& scheduler);
@@ -19,18 +27,33 @@ class SetValue : public BaseTask {
 
   const String& getType() const final;
   static const String& type();
-
-  bool TaskCallback() final;
-
- private:
-  static bool registered_;
   static BaseTask* factory(const ServiceGetters& services,
                            const JsonObjectConst& parameters,
                            Scheduler& scheduler);
 
+  bool OnTaskEnable() final;
+
+  bool TaskCallback() final;
+
+ private:
   std::shared_ptr<peripheral::capabilities::SetValue> peripheral_;
+  std::shared_ptr<peripheral::capabilities::RampValue> ramp_peripheral_;
 
   utils::ValueUnit value_unit_;
+
+  /// Ramp duration. Zero to set the value directly
+  std::chrono::milliseconds ramp_duration_{0};
+  peripheral::capabilities::RampValue::Curve curve_ =
+      peripheral::capabilities::RampValue::Curve::kLinear;
+  /// Start of a ramp stepped by the task
+  float start_value_ = 0;
+  std::chrono::steady_clock::time_point ramp_start_;
+
+  /// Interval of the steps of a ramp stepped by the task
+  static constexpr std::chrono::milliseconds step_interval_{20};
+
+  static const __FlashStringHelper* start_value_key_;
+  static const __FlashStringHelper* start_value_key_error_;
 };
 
 }  // namespace set_value
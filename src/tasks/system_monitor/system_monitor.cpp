@@ -1,5 +1,10 @@
 #include "system_monitor.h"
 
+#include "managers/services.h"
+#ifdef ESP32
+#include "peripheral/peripherals/i2c/i2c_adapter.h"
+#endif
+
 namespace inamata {
 namespace tasks {
 namespace system_monitor {
@@ -90,11 +95,54 @@ bool SystemMonitor::TaskCallback() {
   doc_out[F("productive_percent")] =
       100 - ((cpuIdle + cpuCycles) / cpuTotal * 100.0);
   doc_out[F("wifi_rssi")] = WiFi.RSSI();
+#ifdef ESP32
+  addI2CStats();
+#endif
 
   web_socket_->sendSystem(doc_out.as<JsonObject>());
   return true;
 }
 
+#ifdef ESP32
+void SystemMonitor::addI2CStats() {
+  using peripheral::peripherals::util::I2CAdapter;
+  peripheral::PeripheralController& peripheral_controller =
+      Services::getPeripheralController();
+
+  JsonArray adapters;
+  for (const utils::UUID& uuid : peripheral_controller.getPeripheralIDs()) {
+    std::shared_ptr<peripheral::Peripheral> peripheral =
+        peripheral_controller.getPeripheral(uuid);
+    if (!peripheral || peripheral->getType() != I2CAdapter::type() ||
+        !peripheral->isValid()) {
+      continue;
+    }
+    if (adapters.isNull()) {
+      adapters = doc_out.createNestedArray(F("i2c"));
+    }
+
+    I2CAdapter& adapter = static_cast<I2CAdapter&>(*peripheral);
+    JsonObject adapter_object = adapters.createNestedObject();
+    adapter_object[F("uuid")] = uuid.toString();
+    adapter_object[F("mux_switches")] = adapter.getBus().getMuxSwitchCount();
+    JsonArray devices = adapter_object.createNestedArray(F("devices"));
+    for (const auto& stats : adapter.getBus().getDeviceStats()) {
+      JsonObject device = devices.createNestedObject();
+      device[F("address")] = stats.address;
+      if (stats.route.mux_address) {
+        device[F("mux_address")] = stats.route.mux_address;
+        device[F("mux_channel")] = stats.route.channel;
+      }
+      device[F("clock_hz")] = stats.clock_hz;
+      device[F("transactions")] = stats.transactions;
+      device[F("errors")] = stats.errors;
+      device[F("nacks")] = stats.nacks;
+      device[F("timeouts")] = stats.timeouts;
+    }
+  }
+}
+#endif
+
 const std::chrono::seconds SystemMonitor::default_interval_{30};
 
 }  // namespace system_monitor
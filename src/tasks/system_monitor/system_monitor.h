@@ -13,7 +13,7 @@ namespace system_monitor {
 
 /**
  * Monitors the controller's state and informs the coordinator about it. Health
- * parameters include free memory and heap fragmentation.
+ * parameters include free memory, heap fragmentation and I2C bus errors.
  */
 class SystemMonitor : public BaseTask {
  public:
@@ -45,6 +45,13 @@ class SystemMonitor : public BaseTask {
    */
   bool TaskCallback() final;
 
+#ifdef ESP32
+  /**
+   * Adds the transaction and error counters of each I2C adapter's devices
+   */
+  void addI2CStats();
+#endif
+
   Scheduler& scheduler_;
   ServiceGetters services_;
   std::shared_ptr<WebSocket> web_socket_;
@@ -83,7 +83,7 @@ std::vector<utils::UUID> TaskController::getTaskIDs() {
 
   for (Task* task = scheduler_.getFirstTask(); task != NULL;
        task = task->getNextTask()) {
-    BaseTask* base_task = dynamic_cast<BaseTask*>(task);
+    BaseTask* base_task = BaseTask::fromTask(task);
     if (base_task) {
       task_ids.push_back(base_task->getTaskID());
     }
@@ -133,7 +133,7 @@ ErrorResult TaskController::stopTask(const JsonObjectConst& parameters) {
 //   JsonArray tasks_array = status_object.createNestedArray("tasks");
 
 //   for (Task* task = scheduler_.iFirst; task; task = task->iNext) {
-//     BaseTask* base_task = dynamic_cast<BaseTask*>(task);
+//     BaseTask* base_task = BaseTask::fromTask(task);
 //     if (base_task) {
 //       JsonObject task_object = tasks_array.createNestedObject();
 //       task_object["task"] = base_task->getTaskID().toString();
@@ -153,7 +153,7 @@ BaseTask* TaskController::findTask(const utils::UUID& uuid) {
   // Go through all tasks in the scheduler
   for (Task* task = scheduler_.iFirst; task; task = task->iNext) {
     // Check if it is a base task
-    BaseTask* base_task = dynamic_cast<BaseTask*>(task);
+    BaseTask* base_task = BaseTask::fromTask(task);
     // If the UUIDs match, return the task and end the search
     if (base_task && base_task->getTaskID() == uuid) {
       return base_task;
@@ -164,7 +164,7 @@ BaseTask* TaskController::findTask(const utils::UUID& uuid) {
 }
 
 const String& TaskController::getTaskType(Task* task) {
-  BaseTask* base_task = dynamic_cast<BaseTask*>(task);
+  BaseTask* base_task = BaseTask::fromTask(task);
   if (base_task) {
     return base_task->getType();
   } else {
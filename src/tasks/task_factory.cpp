@@ -1,10 +1,45 @@
 #include "task_factory.h"
 
 #include "invalid_task.h"
+#include "tasks/alert_sensor/alert_sensor.h"
+#include "tasks/poll_sensor/poll_sensor.h"
+#include "tasks/read_sensor/read_sensor.h"
+#include "tasks/set_value/set_value.h"
+#include "utils/sorted_table.h"
+#ifdef ESP32
+#include "tasks/led_effect/led_effect.h"
+#include "tasks/set_rgb_led/set_rgb_led.h"
+#endif
 
 namespace inamata {
 namespace tasks {
 
+namespace {
+
+/**
+ * All task factories that can be started by the server, sorted by their type
+ * name
+ *
+ * New tasks have to be added here. The order is checked at compile time.
+ */
+constexpr TaskFactory::Entry factories[] = {
+    {"AlertSensor", alert_sensor::AlertSensor::factory},
+#ifdef ESP32
+    {"LedEffect", led_effect::LedEffect::factory},
+#endif
+    {"PollSensor", poll_sensor::PollSensor::factory},
+    {"ReadSensor", read_sensor::ReadSensor::factory},
+#ifdef ESP32
+    {"SetRgbLed", set_rgb_led::SetRgbLed::factory},
+#endif
+    {"SetValue", set_value::SetValue::factory},
+};
+
+static_assert(utils::isSortedByName(factories),
+              "Task factories have to be sorted by name");
+
+}  // namespace
+
 TaskFactory::TaskFactory(Scheduler& scheduler) : scheduler_(scheduler) {}
 
 const String& TaskFactory::type() {
@@ -12,10 +47,6 @@ const String& TaskFactory::type() {
   return name;
 }
 
-bool TaskFactory::registerTask(const String& type, Factory factory) {
-  return getFactories().insert({type, factory}).second;
-}
-
 BaseTask* TaskFactory::startTask(const ServiceGetters& services,
                                  const JsonObjectConst& parameters) {
   JsonVariantConst type = parameters[type_key_];
@@ -24,10 +55,10 @@ BaseTask* TaskFactory::startTask(const ServiceGetters& services,
   }
 
   // Check if a factory for the type exists. Then try to start such a task
-  const auto& factory = getFactories().find(type);
-  if (factory != getFactories().end()) {
+  const Entry* entry = utils::findByName(factories, type.as<const char*>());
+  if (entry) {
     // Start a task via the respective task factory
-    return factory->second(services, parameters, scheduler_);
+    return entry->factory(services, parameters, scheduler_);
   } else {
     // Factory type not found, so return an invalid task
     return new InvalidTask(scheduler_,
@@ -37,17 +68,13 @@ BaseTask* TaskFactory::startTask(const ServiceGetters& services,
 
 const std::vector<String> TaskFactory::getFactoryNames() {
   std::vector<String> names;
-  for (const auto& factory : getFactories()) {
-    names.push_back(factory.first);
+  names.reserve(sizeof(factories) / sizeof(factories[0]));
+  for (const Entry& entry : factories) {
+    names.push_back(entry.name);
   }
   return names;
 }
 
-std::map<String, TaskFactory::Factory>& TaskFactory::getFactories() {
-  static std::map<String, Factory> factories;
-  return factories;
-}
-
 String TaskFactory::invalidFactoryTypeError(const String& type) {
   String error(F("Could not find the factory type: "));
   error += type;
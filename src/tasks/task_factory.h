@@ -3,7 +3,7 @@
 #include <ArduinoJson.h>
 #include <TaskSchedulerDeclarations.h>
 
-#include <map>
+#include <vector>
 
 #include "base_task.h"
 #include "managers/service_getters.h"
@@ -23,6 +23,12 @@ class TaskFactory {
                                 const JsonObjectConst& parameters,
                                 Scheduler& scheduler);
 
+  /// Entry in the constant table of task factories
+  struct Entry {
+    const char* name;
+    Factory factory;
+  };
+
   /**
    * Start a task factory that forwards 'add' commands to the subfactories
    *
@@ -36,15 +42,6 @@ class TaskFactory {
 
   static const String& type();
 
-  /**
-   * Register a task factory as a callback to start a task
-   *
-   * @param type Name of the task factory
-   * @param factory Callback to the task factory
-   * @return True on success --> no type by that name exists
-   */
-  static bool registerTask(const String& type, Factory factory);
-
   /**
    * Start a Task object from a JSON object by passing it to the subfactories
    *
@@ -62,9 +59,6 @@ class TaskFactory {
   const std::vector<String> getFactoryNames();
 
  private:
-  /// Get the callback map of the sub-factories to start new task objects
-  static std::map<String, Factory>& getFactories();
-
   static String invalidFactoryTypeError(const String& type);
 
   /// Refernce to the Scheduler
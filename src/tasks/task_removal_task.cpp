@@ -24,7 +24,7 @@ void TaskRemovalTask::setServices(ServiceGetters services) {
   services_ = services;
 }
 
-void TaskRemovalTask::add(Task& pt) {
+void TaskRemovalTask::add(BaseTask& pt) {
   tasks_.insert(&pt);
   setIterations(1);
   enableIfNot();
@@ -43,13 +43,12 @@ bool TaskRemovalTask::Callback() {
       task_results.createNestedArray(TaskController::stop_command_key_);
 
   for (auto it = tasks_.begin(); it != tasks_.end();) {
-    Task* task = *it;
-    BaseTask* base_task = dynamic_cast<BaseTask*>(task);
-    TRACEF("Deleting: %s\n", base_task->getType());
+    BaseTask* base_task = *it;
+    TRACEF("Deleting: %s\n", base_task->getType().c_str());
 
     // If it is not a system task, delete the task and free the memory
     // System tasks have a static memory lifetime and should not be deleted
-    if (base_task && !base_task->isSystemTask()) {
+    if (!base_task->isSystemTask()) {
       TaskController::addResultEntry(base_task->getTaskID(),
                                      base_task->getError(), stop_results);
       delete base_task;
@@ -31,7 +31,7 @@ class TaskRemovalTask : public Task {
    *
    * \param to_be_removed The task to be deleted and removed
    */
-  void add(Task& to_be_removed);
+  void add(BaseTask& to_be_removed);
 
  private:
   /**
@@ -45,7 +45,7 @@ class TaskRemovalTask : public Task {
   ServiceGetters services_;
 
   /// Queued tasks to be removed
-  std::set<Task*> tasks_;
+  std::set<BaseTask*> tasks_;
 };
 
 }  // namespace tasks
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <chrono>
+
+namespace inamata {
+namespace utils {
+
+/**
+ * Converts a duration to a coarser unit, rounding up
+ *
+ * Unlike duration_cast, which truncates, a wait is never shortened. Equal to
+ * std::chrono::ceil of C++17.
+ *
+ * \param d The duration to convert
+ * \return The smallest duration of the target unit that is not shorter
+ */
+template <class ToDuration, class Rep, class Period>
+constexpr inline ToDuration chrono_ceil(std::chrono::duration<Rep, Period> d) {
+  return std::chrono::duration_cast<ToDuration>(d) < d
+             ? std::chrono::duration_cast<ToDuration>(d) + ToDuration(1)
+             : std::chrono::duration_cast<ToDuration>(d);
+}
+
+}  // namespace utils
+}  // namespace inamata
@@ -0,0 +1,46 @@
+#ifdef ESP32
+#include "esp_timer_sync.h"
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+namespace inamata {
+namespace utils {
+
+namespace {
+void giveSemaphore(void* arg) {
+  xSemaphoreGive(static_cast<SemaphoreHandle_t>(arg));
+}
+}  // namespace
+
+bool waitForTimerCallbacks() {
+  SemaphoreHandle_t done = xSemaphoreCreateBinary();
+  if (!done) {
+    return false;
+  }
+  const esp_timer_create_args_t timer_args = {
+      .callback = giveSemaphore,
+      .arg = done,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "timer_sync",
+      .skip_unhandled_events = false,
+  };
+  esp_timer_handle_t timer = nullptr;
+  if (esp_timer_create(&timer_args, &timer) != ESP_OK) {
+    vSemaphoreDelete(done);
+    return false;
+  }
+  const bool is_started = esp_timer_start_once(timer, 0) == ESP_OK;
+  if (is_started) {
+    xSemaphoreTake(done, portMAX_DELAY);
+  }
+  esp_timer_delete(timer);
+  vSemaphoreDelete(done);
+  return is_started;
+}
+
+}  // namespace utils
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#ifdef ESP32
+
+namespace inamata {
+namespace utils {
+
+/**
+ * Waits until the esp_timer task finished the callback it is running
+ *
+ * The task runs the callbacks of all timers one after the other. Once a
+ * timer was stopped, a callback that already started may still be running
+ * on the other core. A callback queued after it has to wait for it, so that
+ * its object can be safely destroyed afterwards.
+ *
+ * \return False if the wait could not be queued
+ */
+bool waitForTimerCallbacks();
+
+}  // namespace utils
+}  // namespace inamata
+
+#endif
@@ -0,0 +1,44 @@
+#include "pulse_accumulator.h"
+
+#include <algorithm>
+
+namespace inamata {
+namespace utils {
+
+PulseAccumulator::PulseAccumulator(Counter& counter, int16_t limit,
+                                   int64_t min_window_us)
+    : counter_(counter), limit_(limit), min_window_us_(min_window_us) {}
+
+void PulseAccumulator::reset(int64_t now_us) {
+  overflows_ = 0;
+  last_total_ = 0;
+  last_time_us_ = now_us;
+  frequency_hz_ = 0;
+}
+
+uint64_t PulseAccumulator::getTotal() const {
+  // Retry if the counter overflowed while it was being read
+  uint32_t overflows;
+  int16_t count;
+  do {
+    overflows = overflows_.load();
+    count = counter_.getCount();
+  } while (overflows != overflows_.load());
+  return uint64_t(overflows) * limit_ + count;
+}
+
+PulseAccumulator::Reading PulseAccumulator::read(int64_t now_us) {
+  // The counter is reset shortly before the overflow is added to the total.
+  // Keep the previous total until then
+  const uint64_t total = std::max(getTotal(), last_total_);
+  const int64_t window_us = now_us - last_time_us_;
+  if (window_us >= min_window_us_) {
+    frequency_hz_ = (total - last_total_) * 1e6f / window_us;
+    last_total_ = total;
+    last_time_us_ = now_us;
+  }
+  return {.total = total, .frequency_hz = frequency_hz_};
+}
+
+}  // namespace utils
+}  // namespace inamata
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace inamata {
+namespace utils {
+
+/**
+ * Accumulates the pulses of a hardware counter with a limited range
+ *
+ * The hardware resets the counter on reaching its limit and reports it, so
+ * that the limit is added to the 64-bit total. The frequency is calculated
+ * from the pulses since the previous reading. Free of hardware dependencies,
+ * so that it can be checked on the host with a mocked counter.
+ */
+class PulseAccumulator {
+ public:
+  /// Access to the hardware counter
+  class Counter {
+   public:
+    virtual ~Counter() = default;
+
+    /**
+     * Reads the pulses since the counter was last reset
+     *
+     * \return The count between 0 and the limit
+     */
+    virtual int16_t getCount() = 0;
+  };
+
+  struct Reading {
+    /// Pulses since the accumulator was reset
+    uint64_t total;
+    /// Pulses per second over the window of the last reading
+    float frequency_hz;
+  };
+
+  /**
+   * Prepares the accumulator for a stopped counter
+   *
+   * \param counter The hardware counter
+   * \param limit The count at which the counter is reset
+   * \param min_window_us Readings closer together keep the frequency
+   */
+  PulseAccumulator(Counter& counter, int16_t limit, int64_t min_window_us);
+
+  /**
+   * Starts accumulating once the counter was cleared
+   *
+   * \param now_us The current time in microseconds
+   */
+  void reset(int64_t now_us);
+
+  /**
+   * Adds the limit to the total after the counter was reset
+   *
+   * Inline and lock-free, so that it can be called from interrupts.
+   */
+  void addOverflow() { overflows_.fetch_add(1); }
+
+  /**
+   * Gets the number of pulses since the accumulator was reset
+   *
+   * \return The total number of pulses
+   */
+  uint64_t getTotal() const;
+
+  /**
+   * Gets the total and updates the frequency since the previous reading
+   *
+   * \param now_us The current time in microseconds
+   * \return The total and the frequency
+   */
+  Reading read(int64_t now_us);
+
+ private:
+  Counter& counter_;
+  const int16_t limit_;
+  const int64_t min_window_us_;
+
+  /// Times the counter reached its limit and was reset
+  std::atomic<uint32_t> overflows_{0};
+
+  /// Total and time of the previous frequency update
+  uint64_t last_total_ = 0;
+  int64_t last_time_us_ = 0;
+  float frequency_hz_ = 0;
+};
+
+}  // namespace utils
+}  // namespace inamata
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+namespace inamata {
+namespace utils {
+
+/**
+ * Compares two C strings like strcmp, but usable in constant expressions
+ *
+ * \param a First null terminated string
+ * \param b Second null terminated string
+ * \return Negative if a sorts before b, 0 if equal, positive otherwise
+ */
+constexpr int compareNames(const char* a, const char* b) {
+  return *a != *b ? (static_cast<unsigned char>(*a) <
+                             static_cast<unsigned char>(*b)
+                         ? -1
+                         : 1)
+                  : (*a == '\0' ? 0 : compareNames(a + 1, b + 1));
+}
+
+/**
+ * Checks that a table is strictly sorted by the entries' name member
+ *
+ * Intended for static_assert so that unsorted or duplicate entries in
+ * constant tables fail the build.
+ *
+ * \param entries The table to check
+ * \param index The entry to compare with its predecessor
+ * \return True if each name sorts after the previous one
+ */
+template <class Entry, size_t N>
+constexpr bool isSortedByName(const Entry (&entries)[N], size_t index = 1) {
+  return index >= N ? true
+                    : compareNames(entries[index - 1].name,
+                                   entries[index].name) < 0 &&
+                          isSortedByName(entries, index + 1);
+}
+
+/**
+ * Binary search for an entry in a table sorted by name
+ *
+ * \param entries The table sorted by the entries' name member
+ * \param name The name to search for
+ * \return The matching entry or a nullptr if not found
+ */
+template <class Entry, size_t N>
+const Entry* findByName(const Entry (&entries)[N], const char* name) {
+  size_t low = 0;
+  size_t high = N;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    const int comparison = strcmp(entries[middle].name, name);
+    if (comparison == 0) {
+      return &entries[middle];
+    } else if (comparison < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace utils
+}  // namespace inamata
@@ -0,0 +1,180 @@
+#include "spectrum.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace inamata {
+namespace utils {
+
+Spectrum::Spectrum(size_t block_size)
+    : block_size_(isValidBlockSize(block_size) ? block_size : 0),
+      half_size_(block_size_ / 2),
+      samples_(block_size_),
+      twiddles_(block_size_),
+      bit_reverse_(half_size_),
+      power_(block_size_ ? half_size_ + 1 : 0) {
+  // Twiddle factors for the full block size. The half size complex FFT uses
+  // every second one, the real-valued split step uses all of them
+  for (size_t k = 0; k < half_size_; k++) {
+    const double angle = 2 * M_PI * k / block_size_;
+    twiddles_[2 * k] = cos(angle);
+    twiddles_[2 * k + 1] = -sin(angle);
+  }
+
+  size_t bits = 0;
+  while ((size_t(1) << bits) < half_size_) {
+    bits++;
+  }
+  for (size_t i = 0; i < half_size_; i++) {
+    size_t reversed = 0;
+    for (size_t bit = 0; bit < bits; bit++) {
+      if (i & (size_t(1) << bit)) {
+        reversed |= size_t(1) << (bits - 1 - bit);
+      }
+    }
+    bit_reverse_[i] = reversed;
+  }
+}
+
+bool Spectrum::isValidBlockSize(size_t block_size) {
+  return block_size >= min_block_size && block_size <= max_block_size &&
+         (block_size & (block_size - 1)) == 0;
+}
+
+size_t Spectrum::getBlockSize() const { return block_size_; }
+
+float* Spectrum::samples() { return samples_.data(); }
+
+Spectrum::Features Spectrum::analyze(float sample_rate_hz) {
+  Features features = {.rms = 0,
+                       .peak = 0,
+                       .crest_factor = 0,
+                       .dominant_frequency_hz = 0};
+  sample_rate_hz_ = sample_rate_hz;
+  if (!block_size_) {
+    return features;
+  }
+
+  float* x = samples_.data();
+  const float* w = twiddles_.data();
+
+  // Remove the DC offset, gather time-domain features and apply the Hann
+  // window. The window's cosine term is reused from the twiddle table, where
+  // cos(2*pi*(k + N/2)/N) = -cos(2*pi*k/N)
+  float sum = 0;
+  for (size_t i = 0; i < block_size_; i++) {
+    sum += x[i];
+  }
+  const float mean = sum / block_size_;
+  float sum_squared = 0;
+  for (size_t i = 0; i < block_size_; i++) {
+    const float value = x[i] - mean;
+    sum_squared += value * value;
+    features.peak = std::max(features.peak, fabsf(value));
+    const float window = i < half_size_
+                             ? 0.5f - 0.5f * w[2 * i]
+                             : 0.5f + 0.5f * w[2 * (i - half_size_)];
+    x[i] = value * window;
+  }
+  features.rms = sqrtf(sum_squared / block_size_);
+  if (features.rms > 0) {
+    features.crest_factor = features.peak / features.rms;
+  }
+
+  fft();
+
+  // Split the half size complex result into the spectrum of the real input.
+  // Scaled so that the one-sided bins sum up to the mean-square value. The
+  // Hann window's power sum is 3N/8
+  const float scale = 1.0f / (block_size_ * (3.0f * block_size_ / 8.0f));
+  power_[0] = (x[0] + x[1]) * (x[0] + x[1]) * scale;
+  power_[half_size_] = (x[0] - x[1]) * (x[0] - x[1]) * scale;
+  for (size_t k = 1; k < half_size_; k++) {
+    const float z_re = x[2 * k];
+    const float z_im = x[2 * k + 1];
+    const float m_re = x[2 * (half_size_ - k)];
+    const float m_im = -x[2 * (half_size_ - k) + 1];
+    const float even_re = 0.5f * (z_re + m_re);
+    const float even_im = 0.5f * (z_im + m_im);
+    const float odd_re = 0.5f * (z_im - m_im);
+    const float odd_im = -0.5f * (z_re - m_re);
+    const float w_re = w[2 * k];
+    const float w_im = w[2 * k + 1];
+    const float x_re = even_re + w_re * odd_re - w_im * odd_im;
+    const float x_im = even_im + w_re * odd_im + w_im * odd_re;
+    power_[k] = 2 * scale * (x_re * x_re + x_im * x_im);
+  }
+
+  // Strongest non-DC bin with parabolic interpolation over the magnitudes
+  size_t max_bin = 1;
+  for (size_t k = 2; k <= half_size_; k++) {
+    if (power_[k] > power_[max_bin]) {
+      max_bin = k;
+    }
+  }
+  float offset = 0;
+  if (max_bin < half_size_) {
+    const float a = sqrtf(power_[max_bin - 1]);
+    const float b = sqrtf(power_[max_bin]);
+    const float c = sqrtf(power_[max_bin + 1]);
+    const float denominator = a - 2 * b + c;
+    if (denominator != 0) {
+      offset = 0.5f * (a - c) / denominator;
+    }
+  }
+  features.dominant_frequency_hz =
+      (max_bin + offset) * sample_rate_hz / block_size_;
+
+  return features;
+}
+
+float Spectrum::bandEnergy(float min_hz, float max_hz) const {
+  if (!block_size_ || sample_rate_hz_ <= 0 || max_hz <= min_hz) {
+    return 0;
+  }
+  const float bin_width = sample_rate_hz_ / block_size_;
+  const long first = std::max(0L, long(ceilf(min_hz / bin_width)));
+  const long last =
+      std::min(long(half_size_), long(ceilf(max_hz / bin_width)) - 1);
+  float energy = 0;
+  for (long k = first; k <= last; k++) {
+    energy += power_[k];
+  }
+  return energy;
+}
+
+void Spectrum::fft() {
+  float* a = samples_.data();
+  const float* w = twiddles_.data();
+
+  for (size_t i = 0; i < half_size_; i++) {
+    const size_t j = bit_reverse_[i];
+    if (i < j) {
+      std::swap(a[2 * i], a[2 * j]);
+      std::swap(a[2 * i + 1], a[2 * j + 1]);
+    }
+  }
+
+  for (size_t length = 2; length <= half_size_; length <<= 1) {
+    const size_t half_length = length >> 1;
+    const size_t stride = block_size_ / length;
+    for (size_t j = 0; j < half_length; j++) {
+      const float w_re = w[2 * j * stride];
+      const float w_im = w[2 * j * stride + 1];
+      for (size_t i = j; i < half_size_; i += length) {
+        float* u = a + 2 * i;
+        float* v = a + 2 * (i + half_length);
+        const float t_re = v[0] * w_re - v[1] * w_im;
+        const float t_im = v[0] * w_im + v[1] * w_re;
+        v[0] = u[0] - t_re;
+        v[1] = u[1] - t_im;
+        u[0] += t_re;
+        u[1] += t_im;
+      }
+    }
+  }
+}
+
+}  // namespace utils
+}  // namespace inamata
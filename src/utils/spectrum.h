@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace inamata {
+namespace utils {
+
+/**
+ * Windowed FFT and spectral features for blocks of real-valued samples
+ *
+ * All tables (twiddle factors, Hann window, bit reversal) are generated once
+ * in the constructor so that analyzing a block only consists of single
+ * precision multiply-adds, which the ESP32's FPU executes natively. The real
+ * input is packed into a complex FFT of half the block size and split
+ * afterwards, halving the work compared to a naive complex transform.
+ */
+class Spectrum {
+ public:
+  struct Features {
+    /// RMS of the AC component (block mean removed)
+    float rms;
+    /// Largest absolute deviation from the block mean
+    float peak;
+    /// Ratio of peak to RMS (0 if the block is flat)
+    float crest_factor;
+    /// Frequency of the strongest bin, refined by parabolic interpolation
+    float dominant_frequency_hz;
+  };
+
+  /**
+   * Allocates the sample buffer and lookup tables
+   *
+   * \param block_size Number of samples per block. Has to be a power of two
+   *   between min_block_size and max_block_size
+   */
+  explicit Spectrum(size_t block_size);
+
+  /**
+   * Checks if the block size is supported
+   *
+   * \param block_size The number of samples per block
+   * \return True if it is a power of two within the supported range
+   */
+  static bool isValidBlockSize(size_t block_size);
+
+  size_t getBlockSize() const;
+
+  /**
+   * Buffer to be filled with block_size samples before calling analyze()
+   *
+   * The buffer is transformed in place, so it has to be refilled before each
+   * analysis.
+   *
+   * \return Pointer to the first sample
+   */
+  float* samples();
+
+  /**
+   * Computes the features and power spectrum of the current sample buffer
+   *
+   * \param sample_rate_hz The rate at which the samples were captured
+   * \return The time-domain and spectral features of the block
+   */
+  Features analyze(float sample_rate_hz);
+
+  /**
+   * Mean-square energy within a frequency band of the last analyzed block
+   *
+   * The sum of all bands from 0 Hz to the Nyquist frequency equals the
+   * squared RMS of the block.
+   *
+   * \param min_hz Lower bound of the band (inclusive)
+   * \param max_hz Upper bound of the band (exclusive)
+   * \return The energy in units squared
+   */
+  float bandEnergy(float min_hz, float max_hz) const;
+
+  static const size_t min_block_size = 16;
+  static const size_t max_block_size = 1024;
+
+ private:
+  /**
+   * In-place radix-2 decimation-in-time FFT over interleaved complex values
+   *
+   * Operates on half_size_ complex values stored in samples_.
+   */
+  void fft();
+
+  size_t block_size_;
+  size_t half_size_;
+  float sample_rate_hz_ = 0;
+
+  /// Interleaved sample buffer, reused as complex FFT input and output
+  std::vector<float> samples_;
+  /// Interleaved twiddle factors exp(-2*pi*i*k/block_size), k < half_size_
+  std::vector<float> twiddles_;
+  /// Bit reversed index for each of the half_size_ complex values
+  std::vector<uint16_t> bit_reverse_;
+  /// One-sided power spectrum with half_size_ + 1 bins
+  std::vector<float> power_;
+};
+
+}  // namespace utils
+}  // namespace inamata
@@ -0,0 +1,110 @@
+#include "waveform.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace inamata {
+namespace utils {
+namespace waveform {
+
+namespace {
+
+/**
+ * Converts a sample from -1 to 1 to a DAC code
+ */
+uint8_t toCode(float sample, float amplitude, float offset) {
+  const float value = (offset + sample * amplitude / 2) * 255;
+  return std::max(0.0f, std::min(255.0f, roundf(value)));
+}
+
+}  // namespace
+
+std::vector<uint8_t> generate(Shape shape, size_t length, float amplitude,
+                              float offset) {
+  std::vector<uint8_t> codes(length);
+  for (size_t i = 0; i < length; i++) {
+    const float phase = static_cast<float>(i) / length;
+    float sample = 0;
+    switch (shape) {
+      case Shape::kSine:
+        sample = sinf(2 * M_PI * phase);
+        break;
+      case Shape::kTriangle:
+        // Rises from the center to the peak, falls to the trough and back
+        sample = phase < 0.25f   ? 4 * phase
+                 : phase < 0.75f ? 2 - 4 * phase
+                                 : 4 * phase - 4;
+        break;
+      case Shape::kSquare:
+        sample = phase < 0.5f ? 1 : -1;
+        break;
+      case Shape::kSawtooth:
+        sample = 2 * phase - 1;
+        break;
+    }
+    codes[i] = toCode(sample, amplitude, offset);
+  }
+  return codes;
+}
+
+std::vector<uint8_t> scale(const std::vector<float>& table, float amplitude,
+                           float offset) {
+  std::vector<uint8_t> codes(table.size());
+  for (size_t i = 0; i < table.size(); i++) {
+    codes[i] = toCode(table[i], amplitude, offset);
+  }
+  return codes;
+}
+
+size_t tableLength(float frequency, const Limits& limits) {
+  size_t length = max_table_length;
+  while (length >= min_table_length &&
+         frequency * length > limits.max_sample_rate) {
+    length /= 2;
+  }
+  return length >= min_table_length ? length : 0;
+}
+
+bool layout(float frequency, size_t table_length, const Limits& limits,
+            Layout& layout) {
+  if (!(frequency > 0) || table_length < 2) {
+    return false;
+  }
+
+  const float table_rate = frequency * table_length;
+  uint32_t repeat = std::max(1.0f, ceilf(limits.min_sample_rate / table_rate));
+  for (; table_rate * repeat <= limits.max_sample_rate; repeat++) {
+    const size_t period = table_length * repeat;
+    if (period > limits.max_ring_frames) {
+      return false;
+    }
+
+    if (period <= limits.max_buffer_frames) {
+      // Fill each buffer with whole periods, so their order does not matter
+      layout.buffer_frames = limits.max_buffer_frames / period * period;
+      layout.buffer_count = 2;
+    } else {
+      // Split the period evenly. Retry with more repeats if the period only
+      // splits into tiny buffers
+      size_t count = (period + limits.max_buffer_frames - 1) /
+                     limits.max_buffer_frames;
+      while (period % count != 0) {
+        count++;
+      }
+      if (period / count < limits.min_buffer_frames) {
+        continue;
+      }
+      layout.buffer_frames = period / count;
+      layout.buffer_count = count;
+    }
+    layout.repeat = repeat;
+    layout.sample_rate = lroundf(table_rate * repeat);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace waveform
+}  // namespace utils
+}  // namespace inamata
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace inamata {
+namespace utils {
+
+/**
+ * Tables and DMA layouts for periodic DAC output
+ *
+ * Free of hardware dependencies, so that the tables and layouts can be
+ * checked on the host.
+ */
+namespace waveform {
+
+enum class Shape { kSine, kTriangle, kSquare, kSawtooth };
+
+/// Hardware limits of the DMA that plays the table
+struct Limits {
+  uint32_t min_sample_rate;
+  uint32_t max_sample_rate;
+  /// Largest number of frames in a single DMA buffer
+  size_t max_buffer_frames;
+  /// Smallest number of frames in a DMA buffer when splitting a period
+  size_t min_buffer_frames;
+  /// Largest number of frames in all DMA buffers together
+  size_t max_ring_frames;
+};
+
+/// How a table is played from a ring of DMA buffers
+struct Layout {
+  /// Frames per second
+  uint32_t sample_rate;
+  /// Number of consecutive frames per table entry
+  uint32_t repeat;
+  size_t buffer_frames;
+  size_t buffer_count;
+};
+
+/**
+ * Generates one period of a shape as 8-bit DAC codes
+ *
+ * \param shape The shape of the period. Sine and triangle start at the offset
+ * \param length The number of samples in the period, at least 2
+ * \param amplitude The peak to peak amplitude as a fraction of the full range
+ * \param offset The center as a fraction of the full range
+ * \return The DAC codes, clipped to the full range
+ */
+std::vector<uint8_t> generate(Shape shape, size_t length, float amplitude,
+                              float offset);
+
+/**
+ * Converts an arbitrary period with values from -1 to 1 to 8-bit DAC codes
+ *
+ * \param table The samples of the period
+ * \param amplitude The peak to peak amplitude as a fraction of the full range
+ * \param offset The center as a fraction of the full range
+ * \return The DAC codes, clipped to the full range
+ */
+std::vector<uint8_t> scale(const std::vector<float>& table, float amplitude,
+                           float offset);
+
+/**
+ * Chooses the number of samples per period for a generated shape
+ *
+ * \param frequency The frequency of the waveform in Hz
+ * \param limits The limits of the DMA
+ * \return A power of two up to max_table_length, or 0 if too fast
+ */
+size_t tableLength(float frequency, const Limits& limits);
+
+/**
+ * Lays out a table in a ring of DMA buffers that only contains whole periods
+ *
+ * The DMA can then repeat the ring without any further writes. Slow
+ * waveforms repeat each table entry to reach the minimum sample rate.
+ *
+ * \param frequency The frequency of the waveform in Hz
+ * \param table_length The number of samples per period
+ * \param limits The limits of the DMA
+ * \param layout Receives the layout
+ * \return False if the frequency can't be played with the table
+ */
+bool layout(float frequency, size_t table_length, const Limits& limits,
+            Layout& layout);
+
+/// Largest table length of generated shapes
+constexpr size_t max_table_length = 256;
+/// Smallest table length of generated shapes
+constexpr size_t min_table_length = 8;
+
+}  // namespace waveform
+}  // namespace utils
+}  // namespace inamata
@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "peripheral/peripherals/uart/frame_decoder.h"
+
+using inamata::peripheral::peripherals::uart::FrameDecoder;
+
+namespace {
+
+/**
+ * Frame format of the CSE7766
+ *
+ * 24 bytes with a 0x55 0x5A header and the sum of the bytes in between as the
+ * last byte.
+ */
+struct Protocol {
+  static constexpr size_t frame_size = 24;
+
+  static bool isHeader(uint8_t first, uint8_t second) {
+    return (first == 0x55 || first >= 0xF0 || first == 0xAA) &&
+           second == 0x5A;
+  }
+
+  static bool isValid(const uint8_t* frame) {
+    uint8_t checksum = 0;
+    for (size_t i = 2; i < frame_size - 1; i++) {
+      checksum += frame[i];
+    }
+    return checksum == frame[frame_size - 1];
+  }
+};
+
+constexpr size_t Protocol::frame_size;
+
+using Frame = std::vector<uint8_t>;
+
+/// A byte that can not form a header with its predecessor
+uint8_t randomByte(std::mt19937& random) {
+  const uint8_t byte = random();
+  return byte == 0x5A ? 0x5B : byte;
+}
+
+/// A valid frame whose bytes only form a header at its start
+Frame makeFrame(std::mt19937& random) {
+  Frame frame = {0x55, 0x5A};
+  uint8_t checksum = 0;
+  for (size_t i = 2; i < Protocol::frame_size - 1; i++) {
+    frame.push_back(randomByte(random));
+    checksum += frame.back();
+  }
+  if (checksum == 0x5A) {
+    frame[2]++;
+    checksum++;
+  }
+  frame.push_back(checksum);
+  return frame;
+}
+
+/**
+ * A recorded stream of valid frames, garbage, truncated frames and frames
+ * with failed checksums
+ */
+struct Recording {
+  std::vector<uint8_t> bytes;
+  std::vector<Frame> frames;
+  uint32_t invalid_bytes = 0;
+};
+
+Recording makeRecording(size_t frame_count, uint32_t seed) {
+  std::mt19937 random(seed);
+  Recording recording;
+  auto append = [&recording](const Frame& frame) {
+    recording.bytes.insert(recording.bytes.end(), frame.begin(), frame.end());
+  };
+  for (size_t i = 0; i < frame_count; i++) {
+    switch (random() % 8) {
+      case 0: {
+        // Garbage such as from a baud rate mismatch or a reset
+        const size_t length = 1 + random() % 40;
+        for (size_t j = 0; j < length; j++) {
+          recording.bytes.push_back(randomByte(random));
+        }
+        recording.invalid_bytes += length;
+        break;
+      }
+      case 1: {
+        // A flipped bit fails the checksum
+        Frame frame = makeFrame(random);
+        frame[2 + random() % 21] ^= 0x04;
+        append(frame);
+        recording.invalid_bytes += frame.size();
+        break;
+      }
+      case 2: {
+        // A frame cut off by a dropped byte. Together with the next
+        // frame's first byte, the 8-bit checksum still matches in 1 of 256
+        // cases, which the decoder can not detect
+        Frame frame;
+        do {
+          frame = makeFrame(random);
+          frame.erase(frame.begin() + 2 + random() % 21);
+          frame.push_back(0x55);
+        } while (Protocol::isValid(frame.data()));
+        frame.pop_back();
+        append(frame);
+        recording.invalid_bytes += frame.size();
+        break;
+      }
+      default:
+        break;
+    }
+    const Frame frame = makeFrame(random);
+    append(frame);
+    recording.frames.push_back(frame);
+  }
+  return recording;
+}
+
+/// A UART that returns at most chunk_size bytes per read
+struct Source {
+  Source(const std::vector<uint8_t>& bytes, size_t chunk_size)
+      : bytes(bytes), chunk_size(chunk_size) {}
+
+  const std::vector<uint8_t>& bytes;
+  const size_t chunk_size;
+  size_t position = 0;
+
+  int available() const {
+    return std::min(chunk_size, bytes.size() - position);
+  }
+
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    length = std::min({length, chunk_size, bytes.size() - position});
+    std::copy_n(bytes.begin() + position, length, buffer);
+    position += length;
+    return length;
+  }
+};
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_consecutive_frames() {
+  std::mt19937 random(1);
+  FrameDecoder<Protocol> decoder;
+  TEST_ASSERT_FALSE(decoder.hasFrame());
+  for (uint32_t i = 1; i <= 20; i++) {
+    const Frame frame = makeFrame(random);
+    decoder.push(frame.data(), frame.size());
+    TEST_ASSERT_EQUAL(i, decoder.getFrameCount());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame.data(), decoder.getFrame(),
+                                  frame.size());
+  }
+  TEST_ASSERT_TRUE(decoder.hasFrame());
+  TEST_ASSERT_EQUAL(0, decoder.getInvalidByteCount());
+}
+
+void test_resync_after_garbage() {
+  std::mt19937 random(2);
+  const Frame frame = makeFrame(random);
+  // Garbage ending in a header whose frame is cut off by the valid frame
+  std::vector<uint8_t> bytes = {0x00, 0xFF, 0x5B, 0x55, 0x5A, 0x01, 0x02};
+  const uint32_t garbage = bytes.size();
+  bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+  FrameDecoder<Protocol> decoder;
+  decoder.push(bytes.data(), bytes.size());
+  TEST_ASSERT_EQUAL(1, decoder.getFrameCount());
+  TEST_ASSERT_EQUAL(garbage, decoder.getInvalidByteCount());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(frame.data(), decoder.getFrame(),
+                                frame.size());
+}
+
+void test_split_frames() {
+  std::mt19937 random(3);
+  const Frame first = makeFrame(random);
+  const Frame second = makeFrame(random);
+  std::vector<uint8_t> bytes(first);
+  bytes.insert(bytes.end(), second.begin(), second.end());
+
+  // Split at every position, including within the header and checksum
+  for (size_t split = 1; split < bytes.size(); split++) {
+    FrameDecoder<Protocol> decoder;
+    decoder.push(bytes.data(), split);
+    TEST_ASSERT_EQUAL(split >= first.size() ? 1 : 0,
+                      decoder.getFrameCount());
+    decoder.push(bytes.data() + split, bytes.size() - split);
+    TEST_ASSERT_EQUAL(2, decoder.getFrameCount());
+    TEST_ASSERT_EQUAL(0, decoder.getInvalidByteCount());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(second.data(), decoder.getFrame(),
+                                  second.size());
+  }
+}
+
+void test_checksum_failure() {
+  std::mt19937 random(4);
+  const Frame valid = makeFrame(random);
+  Frame corrupted = makeFrame(random);
+  corrupted.back() ^= 0x01;
+
+  FrameDecoder<Protocol> decoder;
+  decoder.push(valid.data(), valid.size());
+  decoder.push(corrupted.data(), corrupted.size());
+  // The corrupted frame is dropped and the previous one stays available
+  TEST_ASSERT_EQUAL(1, decoder.getFrameCount());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(valid.data(), decoder.getFrame(),
+                                valid.size());
+
+  const Frame next = makeFrame(random);
+  decoder.push(next.data(), next.size());
+  TEST_ASSERT_EQUAL(2, decoder.getFrameCount());
+  TEST_ASSERT_EQUAL(corrupted.size(), decoder.getInvalidByteCount());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(next.data(), decoder.getFrame(),
+                                next.size());
+}
+
+void test_replay_recording() {
+  const Recording recording = makeRecording(500, 5);
+
+  // The result does not depend on how the bytes are chunked, including reads
+  // wrapping around the ring buffer
+  const size_t chunk_sizes[] = {1, 7, 23, 24, 25, 64, 128};
+  for (const size_t chunk_size : chunk_sizes) {
+    FrameDecoder<Protocol> decoder;
+    std::vector<Frame> frames;
+    decoder.setFrameCallback([&frames](const uint8_t* frame) {
+      frames.emplace_back(frame, frame + Protocol::frame_size);
+    });
+    Source source(recording.bytes, chunk_size);
+    size_t total = 0;
+    while (source.position < recording.bytes.size()) {
+      total += decoder.drain(source);
+    }
+    TEST_ASSERT_EQUAL(recording.bytes.size(), total);
+    TEST_ASSERT_EQUAL(recording.frames.size(), decoder.getFrameCount());
+    TEST_ASSERT_EQUAL(recording.invalid_bytes, decoder.getInvalidByteCount());
+    TEST_ASSERT_TRUE(frames == recording.frames);
+  }
+}
+
+void test_benchmark() {
+  const Recording recording = makeRecording(20000, 6);
+  const int repetitions = 20;
+  const size_t chunk_size = 64;
+
+  uint32_t frames = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++) {
+    FrameDecoder<Protocol> decoder;
+    for (size_t position = 0; position < recording.bytes.size();
+         position += chunk_size) {
+      decoder.push(recording.bytes.data() + position,
+                   std::min(chunk_size, recording.bytes.size() - position));
+    }
+    frames += decoder.getFrameCount();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  TEST_ASSERT_EQUAL(repetitions * recording.frames.size(), frames);
+
+  char message[96];
+  snprintf(message, sizeof(message), "decode: %.1f MB/s, %.0f frames/s",
+           repetitions * recording.bytes.size() / elapsed.count() / 1e6,
+           frames / elapsed.count());
+  TEST_MESSAGE(message);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_consecutive_frames);
+  RUN_TEST(test_resync_after_garbage);
+  RUN_TEST(test_split_frames);
+  RUN_TEST(test_checksum_failure);
+  RUN_TEST(test_replay_recording);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include <chrono>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <thread>
+#endif
+
+#include "peripheral/peripherals/modbus/modbus_protocol.h"
+
+using inamata::peripheral::peripherals::modbus::ModbusProtocol;
+using inamata::peripheral::peripherals::modbus::ModbusRequest;
+
+namespace {
+
+ModbusRequest readRequest(uint8_t slave_id, uint16_t address,
+                          uint16_t count) {
+  ModbusRequest request;
+  request.slave_id = slave_id;
+  request.function = ModbusRequest::read_holding_registers;
+  request.address = address;
+  request.count = count;
+  return request;
+}
+
+/// Appends the CRC to a frame, low byte first
+std::vector<uint8_t> withCrc(std::vector<uint8_t> frame) {
+  const uint16_t crc = ModbusProtocol::crc16(frame.data(), frame.size());
+  frame.push_back(crc & 0xFF);
+  frame.push_back(crc >> 8);
+  return frame;
+}
+
+ModbusRequest::Error parse(const std::vector<uint8_t>& frame,
+                           ModbusRequest& request) {
+  return ModbusProtocol::parseResponse(frame.data(), frame.size(), request);
+}
+
+ModbusProtocol::RegisterRange range(uint8_t table, uint16_t address,
+                                    uint8_t width) {
+  return ModbusProtocol::RegisterRange{.table = table,
+                                       .address = address,
+                                       .width = width,
+                                       .block = 0,
+                                       .offset = 0};
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_crc16_known_vectors() {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TEST_ASSERT_EQUAL_HEX16(0x4B37, ModbusProtocol::crc16(check, sizeof(check)));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, ModbusProtocol::crc16(check, 0));
+
+  // A frame followed by its CRC has a residue of zero
+  const uint8_t read[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0A, 0xC5, 0xCD};
+  TEST_ASSERT_EQUAL_HEX16(0xCDC5, ModbusProtocol::crc16(read, 6));
+  TEST_ASSERT_EQUAL_HEX16(0x0000, ModbusProtocol::crc16(read, sizeof(read)));
+}
+
+void test_prepare_request() {
+  ModbusRequest request = readRequest(1, 0, 1);
+  request.registers = {1, 2};
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  TEST_ASSERT_EQUAL(0, request.registers.size());
+
+  request = readRequest(0, 0, 1);
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+  request = readRequest(248, 0, 1);
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+  request = readRequest(1, 0, 0);
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+  request = readRequest(247, 0, ModbusRequest::max_read_count);
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  request = readRequest(1, 0, ModbusRequest::max_read_count + 1);
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+
+  request = readRequest(1, 0, 0);
+  request.function = ModbusRequest::write_single_register;
+  request.registers = {1, 2};
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+  request.registers = {1};
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  TEST_ASSERT_EQUAL(1, request.count);
+
+  request.function = ModbusRequest::write_multiple_registers;
+  request.registers.assign(ModbusRequest::max_write_count + 1, 0);
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+  request.registers.assign(ModbusRequest::max_write_count, 0);
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  TEST_ASSERT_EQUAL(ModbusRequest::max_write_count, request.count);
+  request.registers.clear();
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+
+  request.function = 0x2B;
+  request.registers = {1};
+  TEST_ASSERT_FALSE(ModbusProtocol::prepareRequest(request));
+}
+
+void test_encode_request() {
+  uint8_t frame[ModbusProtocol::max_frame_size];
+  const uint8_t read[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0A, 0xC5, 0xCD};
+  TEST_ASSERT_EQUAL(sizeof(read), ModbusProtocol::encodeRequest(
+                                      readRequest(1, 0, 10), frame));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(read, frame, sizeof(read));
+
+  ModbusRequest request = readRequest(1, 1, 0);
+  request.function = ModbusRequest::write_single_register;
+  request.registers = {3};
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  const uint8_t write_single[] = {0x01, 0x06, 0x00, 0x01,
+                                  0x00, 0x03, 0x98, 0x0B};
+  TEST_ASSERT_EQUAL(sizeof(write_single),
+                    ModbusProtocol::encodeRequest(request, frame));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(write_single, frame, sizeof(write_single));
+
+  request.slave_id = 0x11;
+  request.function = ModbusRequest::write_multiple_registers;
+  request.address = 0x0001;
+  request.registers = {0x000A, 0x0102};
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  const std::vector<uint8_t> write_multiple = withCrc(
+      {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04, 0x00, 0x0A, 0x01, 0x02});
+  TEST_ASSERT_EQUAL(write_multiple.size(),
+                    ModbusProtocol::encodeRequest(request, frame));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(write_multiple.data(), frame,
+                               write_multiple.size());
+}
+
+void test_response_length() {
+  const uint8_t read[] = {0x01, 0x03, 0x04};
+  TEST_ASSERT_EQUAL(0, ModbusProtocol::getResponseLength(read, 0));
+  TEST_ASSERT_EQUAL(0, ModbusProtocol::getResponseLength(read, 1));
+  TEST_ASSERT_EQUAL(0, ModbusProtocol::getResponseLength(read, 2));
+  TEST_ASSERT_EQUAL(9, ModbusProtocol::getResponseLength(read, 3));
+
+  const uint8_t exception[] = {0x01, 0x83};
+  TEST_ASSERT_EQUAL(5, ModbusProtocol::getResponseLength(exception, 2));
+  const uint8_t write[] = {0x01, 0x10};
+  TEST_ASSERT_EQUAL(8, ModbusProtocol::getResponseLength(write, 2));
+  const uint8_t unknown[] = {0x01, 0x2B};
+  TEST_ASSERT_EQUAL(0, ModbusProtocol::getResponseLength(unknown, 2));
+}
+
+void test_parse_read_response() {
+  ModbusRequest request = readRequest(1, 0, 2);
+  TEST_ASSERT_EQUAL(
+      ModbusRequest::Error::kNone,
+      parse(withCrc({0x01, 0x03, 0x04, 0x12, 0x34, 0xAB, 0xCD}), request));
+  TEST_ASSERT_EQUAL(2, request.registers.size());
+  TEST_ASSERT_EQUAL_HEX16(0x1234, request.registers[0]);
+  TEST_ASSERT_EQUAL_HEX16(0xABCD, request.registers[1]);
+
+  // Byte count not matching the requested registers
+  request = readRequest(1, 0, 2);
+  TEST_ASSERT_EQUAL(ModbusRequest::Error::kInvalidResponse,
+                    parse(withCrc({0x01, 0x03, 0x02, 0x12, 0x34}), request));
+  // Wrong slave or function
+  TEST_ASSERT_EQUAL(
+      ModbusRequest::Error::kInvalidResponse,
+      parse(withCrc({0x02, 0x03, 0x04, 0x12, 0x34, 0xAB, 0xCD}), request));
+  TEST_ASSERT_EQUAL(
+      ModbusRequest::Error::kInvalidResponse,
+      parse(withCrc({0x01, 0x04, 0x04, 0x12, 0x34, 0xAB, 0xCD}), request));
+
+  // A corrupted byte
+  std::vector<uint8_t> corrupted =
+      withCrc({0x01, 0x03, 0x04, 0x12, 0x34, 0xAB, 0xCD});
+  corrupted[4] ^= 0x01;
+  TEST_ASSERT_EQUAL(ModbusRequest::Error::kCrc, parse(corrupted, request));
+}
+
+void test_parse_exception_response() {
+  ModbusRequest request = readRequest(1, 0, 2);
+  const std::vector<uint8_t> exception = {0x01, 0x83, 0x02, 0xC0, 0xF1};
+  TEST_ASSERT_EQUAL(ModbusRequest::Error::kException,
+                    parse(exception, request));
+  TEST_ASSERT_EQUAL(2, request.exception_code);
+
+  // An exception to another function
+  request.function = ModbusRequest::read_input_registers;
+  TEST_ASSERT_EQUAL(ModbusRequest::Error::kInvalidResponse,
+                    parse(exception, request));
+}
+
+void test_parse_short_frames() {
+  ModbusRequest request = readRequest(1, 0, 1);
+  const std::vector<uint8_t> response =
+      withCrc({0x01, 0x03, 0x02, 0x00, 0x2A});
+  for (size_t length = 0; length < response.size(); length++) {
+    const std::vector<uint8_t> truncated(response.begin(),
+                                         response.begin() + length);
+    TEST_ASSERT_NOT_EQUAL(ModbusRequest::Error::kNone,
+                          parse(truncated, request));
+  }
+  // A frame with a valid CRC that ends before its registers
+  TEST_ASSERT_EQUAL(ModbusRequest::Error::kInvalidResponse,
+                    parse(withCrc({0x01, 0x03, 0x02, 0x00}), request));
+  TEST_ASSERT_EQUAL(ModbusRequest::Error::kNone, parse(response, request));
+  TEST_ASSERT_EQUAL(42, request.registers[0]);
+}
+
+void test_parse_write_response() {
+  ModbusRequest request = readRequest(1, 1, 0);
+  request.function = ModbusRequest::write_single_register;
+  request.registers = {3};
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  TEST_ASSERT_EQUAL(
+      ModbusRequest::Error::kNone,
+      parse({0x01, 0x06, 0x00, 0x01, 0x00, 0x03, 0x98, 0x0B}, request));
+  TEST_ASSERT_EQUAL(
+      ModbusRequest::Error::kInvalidResponse,
+      parse(withCrc({0x01, 0x06, 0x00, 0x01, 0x00, 0x04}), request));
+
+  request.function = ModbusRequest::write_multiple_registers;
+  request.registers = {1, 2};
+  TEST_ASSERT_TRUE(ModbusProtocol::prepareRequest(request));
+  TEST_ASSERT_EQUAL(
+      ModbusRequest::Error::kNone,
+      parse(withCrc({0x01, 0x10, 0x00, 0x01, 0x00, 0x02}), request));
+  TEST_ASSERT_EQUAL(
+      ModbusRequest::Error::kInvalidResponse,
+      parse(withCrc({0x01, 0x10, 0x00, 0x02, 0x00, 0x02}), request));
+}
+
+void test_coalesce_adjacent_and_gaps() {
+  // Unordered registers of two tables, one 32-bit
+  std::vector<ModbusProtocol::RegisterRange> registers = {
+      range(0, 12, 1), range(1, 10, 1), range(0, 10, 2), range(0, 14, 1)};
+  std::vector<ModbusProtocol::BlockRange> blocks =
+      ModbusProtocol::coalesceBlocks(registers, 0);
+  TEST_ASSERT_EQUAL(3, blocks.size());
+  TEST_ASSERT_EQUAL(0, blocks[0].table);
+  TEST_ASSERT_EQUAL(10, blocks[0].address);
+  TEST_ASSERT_EQUAL(3, blocks[0].count);
+  TEST_ASSERT_EQUAL(14, blocks[1].address);
+  TEST_ASSERT_EQUAL(1, blocks[1].count);
+  TEST_ASSERT_EQUAL(1, blocks[2].table);
+  TEST_ASSERT_EQUAL(0, registers[0].block);
+  TEST_ASSERT_EQUAL(2, registers[0].offset);
+  TEST_ASSERT_EQUAL(2, registers[1].block);
+  TEST_ASSERT_EQUAL(0, registers[2].offset);
+  TEST_ASSERT_EQUAL(1, registers[3].block);
+
+  // A gap of one unmapped register is read to merge the blocks
+  blocks = ModbusProtocol::coalesceBlocks(registers, 1);
+  TEST_ASSERT_EQUAL(2, blocks.size());
+  TEST_ASSERT_EQUAL(5, blocks[0].count);
+  TEST_ASSERT_EQUAL(0, registers[3].block);
+  TEST_ASSERT_EQUAL(4, registers[3].offset);
+
+  // Overlapping registers share their addresses
+  registers = {range(0, 20, 2), range(0, 21, 1)};
+  blocks = ModbusProtocol::coalesceBlocks(registers, 0);
+  TEST_ASSERT_EQUAL(1, blocks.size());
+  TEST_ASSERT_EQUAL(2, blocks[0].count);
+  TEST_ASSERT_EQUAL(1, registers[1].offset);
+}
+
+void test_coalesce_limits() {
+  const uint16_t max_count = ModbusRequest::max_read_count;
+
+  // The last register that still fits a block
+  std::vector<ModbusProtocol::RegisterRange> registers = {
+      range(0, 0, 1), range(0, max_count - 1, 1)};
+  std::vector<ModbusProtocol::BlockRange> blocks =
+      ModbusProtocol::coalesceBlocks(registers, max_count);
+  TEST_ASSERT_EQUAL(1, blocks.size());
+  TEST_ASSERT_EQUAL(max_count, blocks[0].count);
+
+  // One register more, or a 32-bit value crossing the limit, starts a block
+  registers = {range(0, 0, 1), range(0, max_count, 1)};
+  blocks = ModbusProtocol::coalesceBlocks(registers, max_count);
+  TEST_ASSERT_EQUAL(2, blocks.size());
+  TEST_ASSERT_EQUAL(max_count, blocks[1].address);
+  registers = {range(0, 0, 1), range(0, max_count - 1, 2)};
+  blocks = ModbusProtocol::coalesceBlocks(registers, max_count);
+  TEST_ASSERT_EQUAL(2, blocks.size());
+  TEST_ASSERT_EQUAL(2, blocks[1].count);
+
+  // The top of the address space
+  registers = {range(0, 0xFFFE, 2)};
+  blocks = ModbusProtocol::coalesceBlocks(registers, 0);
+  TEST_ASSERT_EQUAL(1, blocks.size());
+  TEST_ASSERT_EQUAL_HEX16(0xFFFE, blocks[0].address);
+  TEST_ASSERT_EQUAL(2, blocks[0].count);
+
+  registers.clear();
+  TEST_ASSERT_EQUAL(0, ModbusProtocol::coalesceBlocks(registers, 0).size());
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+
+/**
+ * Answers read requests on a pseudo-terminal like a Modbus slave
+ *
+ * Each register holds its own address. Returns once the terminal is closed.
+ */
+void runSimulatedSlave(int fd) {
+  std::vector<uint8_t> request;
+  uint8_t buffer[ModbusProtocol::max_frame_size];
+  while (true) {
+    const ssize_t received = read(fd, buffer, sizeof(buffer));
+    if (received <= 0) {
+      return;
+    }
+    request.insert(request.end(), buffer, buffer + received);
+    // Read requests have a fixed length
+    while (request.size() >= 8) {
+      std::vector<uint8_t> response;
+      if (ModbusProtocol::crc16(request.data(), 8) != 0) {
+        response = {request[0], uint8_t(request[1] | 0x80), 0x04};
+      } else {
+        const uint16_t address = request[2] << 8 | request[3];
+        const uint16_t count = request[4] << 8 | request[5];
+        response = {request[0], request[1], uint8_t(count * 2)};
+        for (uint16_t i = 0; i < count; i++) {
+          response.push_back((address + i) >> 8);
+          response.push_back((address + i) & 0xFF);
+        }
+      }
+      response = withCrc(response);
+      request.erase(request.begin(), request.begin() + 8);
+      if (write(fd, response.data(), response.size()) < 0) {
+        return;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void test_pty_slave_throughput() {
+  // The master uses the terminal like a serial port, without line discipline
+  const int slave_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  TEST_ASSERT_TRUE(slave_fd >= 0);
+  TEST_ASSERT_EQUAL(0, grantpt(slave_fd));
+  TEST_ASSERT_EQUAL(0, unlockpt(slave_fd));
+  const int port = open(ptsname(slave_fd), O_RDWR | O_NOCTTY);
+  TEST_ASSERT_TRUE(port >= 0);
+  termios settings;
+  tcgetattr(port, &settings);
+  cfmakeraw(&settings);
+  tcsetattr(port, TCSANOW, &settings);
+  std::thread slave(runSimulatedSlave, slave_fd);
+
+  // Read the first 10000 registers in blocks of the maximum size, which is
+  // what coalescing achieves for a dense register map
+  const uint16_t block_count = ModbusRequest::max_read_count;
+  const size_t requests = 400;
+  size_t registers = 0;
+  size_t errors = 0;
+  uint8_t frame[ModbusProtocol::max_frame_size];
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < requests; i++) {
+    ModbusRequest request =
+        readRequest(1, (i * block_count) % 10000, block_count);
+    const size_t length = ModbusProtocol::encodeRequest(request, frame);
+    TEST_ASSERT_EQUAL(length, write(port, frame, length));
+
+    size_t received = 0;
+    size_t expected = 0;
+    while (!expected || received < expected) {
+      const ssize_t result =
+          read(port, frame + received, sizeof(frame) - received);
+      TEST_ASSERT_TRUE(result > 0);
+      received += result;
+      expected = ModbusProtocol::getResponseLength(frame, received);
+    }
+    if (ModbusProtocol::parseResponse(frame, expected, request) !=
+            ModbusRequest::Error::kNone ||
+        request.registers.back() != request.address + block_count - 1) {
+      errors++;
+    }
+    registers += request.registers.size();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  close(port);
+  close(slave_fd);
+  slave.join();
+  TEST_ASSERT_EQUAL(0, errors);
+
+  char message[96];
+  snprintf(message, sizeof(message),
+           "pty: %.0f registers/s in blocks of %u (no baud rate limit)",
+           registers / elapsed.count(), block_count);
+  TEST_MESSAGE(message);
+}
+#endif
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc16_known_vectors);
+  RUN_TEST(test_prepare_request);
+  RUN_TEST(test_encode_request);
+  RUN_TEST(test_response_length);
+  RUN_TEST(test_parse_read_response);
+  RUN_TEST(test_parse_exception_response);
+  RUN_TEST(test_parse_short_frames);
+  RUN_TEST(test_parse_write_response);
+  RUN_TEST(test_coalesce_adjacent_and_gaps);
+  RUN_TEST(test_coalesce_limits);
+#if defined(__unix__) || defined(__APPLE__)
+  RUN_TEST(test_pty_slave_throughput);
+#endif
+  return UNITY_END();
+}
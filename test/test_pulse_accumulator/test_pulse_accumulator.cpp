@@ -0,0 +1,154 @@
+#include <unity.h>
+
+#include <functional>
+
+#include "utils/pulse_accumulator.h"
+
+using inamata::utils::PulseAccumulator;
+
+namespace {
+
+/// Counter of the PCNT peripheral's range with a hook to interleave events
+class MockCounter : public PulseAccumulator::Counter {
+ public:
+  int16_t getCount() final {
+    reads++;
+    if (on_read) {
+      // Only run once, as it may simulate a single interrupt
+      std::function<void()> callback = std::move(on_read);
+      on_read = nullptr;
+      callback();
+    }
+    return count;
+  }
+
+  int16_t count = 0;
+  int reads = 0;
+  std::function<void()> on_read;
+};
+
+constexpr int16_t limit = 32767;
+constexpr int64_t min_window_us = 1000000;
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_counts_without_overflow() {
+  MockCounter counter;
+  PulseAccumulator accumulator(counter, limit, min_window_us);
+  accumulator.reset(0);
+  TEST_ASSERT_EQUAL_UINT64(0, accumulator.getTotal());
+  counter.count = 1234;
+  TEST_ASSERT_EQUAL_UINT64(1234, accumulator.getTotal());
+}
+
+void test_wraparound_beyond_32_bits() {
+  MockCounter counter;
+  PulseAccumulator accumulator(counter, limit, min_window_us);
+  accumulator.reset(0);
+  const uint32_t overflows = 200000;
+  for (uint32_t i = 0; i < overflows; i++) {
+    accumulator.addOverflow();
+  }
+  counter.count = 17;
+  const uint64_t expected = uint64_t(overflows) * limit + 17;
+  TEST_ASSERT_TRUE(expected > UINT32_MAX);
+  TEST_ASSERT_EQUAL_UINT64(expected, accumulator.getTotal());
+  TEST_ASSERT_EQUAL_UINT64(expected, accumulator.read(1).total);
+}
+
+void test_overflow_during_read() {
+  // The counter wraps and its interrupt runs between reading the overflows
+  // and the count. The count is read again with the new overflows
+  MockCounter counter;
+  PulseAccumulator accumulator(counter, limit, min_window_us);
+  accumulator.reset(0);
+  counter.count = limit - 1;
+  counter.on_read = [&counter, &accumulator]() {
+    counter.count = 3;
+    accumulator.addOverflow();
+  };
+  TEST_ASSERT_EQUAL_UINT64(uint64_t(limit) + 3, accumulator.getTotal());
+  TEST_ASSERT_EQUAL(2, counter.reads);
+}
+
+void test_counter_reset_before_overflow_is_added() {
+  // The hardware clears the count before the interrupt adds the limit. The
+  // total must not go backwards in the meantime
+  MockCounter counter;
+  PulseAccumulator accumulator(counter, limit, min_window_us);
+  accumulator.reset(0);
+  counter.count = limit - 1;
+  TEST_ASSERT_EQUAL_UINT64(limit - 1, accumulator.read(min_window_us).total);
+  counter.count = 2;
+  TEST_ASSERT_EQUAL_UINT64(limit - 1,
+                           accumulator.read(2 * min_window_us).total);
+  accumulator.addOverflow();
+  TEST_ASSERT_EQUAL_UINT64(uint64_t(limit) + 2,
+                           accumulator.read(3 * min_window_us).total);
+}
+
+void test_frequency_window() {
+  MockCounter counter;
+  PulseAccumulator accumulator(counter, limit, min_window_us);
+  accumulator.reset(0);
+
+  // Readings within the minimum window keep the previous frequency
+  counter.count = 50;
+  PulseAccumulator::Reading reading = accumulator.read(min_window_us / 10);
+  TEST_ASSERT_EQUAL_UINT64(50, reading.total);
+  TEST_ASSERT_EQUAL_FLOAT(0, reading.frequency_hz);
+
+  // The frequency covers all pulses since the start of the window
+  counter.count = 500;
+  reading = accumulator.read(min_window_us);
+  TEST_ASSERT_EQUAL_FLOAT(500, reading.frequency_hz);
+
+  counter.count = 700;
+  reading = accumulator.read(min_window_us + min_window_us / 2);
+  TEST_ASSERT_EQUAL_UINT64(700, reading.total);
+  TEST_ASSERT_EQUAL_FLOAT(500, reading.frequency_hz);
+
+  reading = accumulator.read(3 * min_window_us);
+  TEST_ASSERT_EQUAL_FLOAT(100, reading.frequency_hz);
+
+  // Windows spanning an overflow
+  counter.count = 200;
+  accumulator.addOverflow();
+  reading = accumulator.read(5 * min_window_us);
+  TEST_ASSERT_EQUAL_FLOAT((limit + 200 - 700) / 2.0f, reading.frequency_hz);
+}
+
+void test_reset() {
+  MockCounter counter;
+  PulseAccumulator accumulator(counter, limit, min_window_us);
+  accumulator.reset(0);
+  accumulator.addOverflow();
+  counter.count = 10;
+  accumulator.read(min_window_us);
+
+  // The hardware counter is cleared before the accumulator is reset
+  counter.count = 0;
+  accumulator.reset(2 * min_window_us);
+  PulseAccumulator::Reading reading = accumulator.read(2 * min_window_us);
+  TEST_ASSERT_EQUAL_UINT64(0, reading.total);
+  TEST_ASSERT_EQUAL_FLOAT(0, reading.frequency_hz);
+  counter.count = 30;
+  reading = accumulator.read(3 * min_window_us);
+  TEST_ASSERT_EQUAL_UINT64(30, reading.total);
+  TEST_ASSERT_EQUAL_FLOAT(30, reading.frequency_hz);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_counts_without_overflow);
+  RUN_TEST(test_wraparound_beyond_32_bits);
+  RUN_TEST(test_overflow_during_read);
+  RUN_TEST(test_counter_reset_before_overflow_is_added);
+  RUN_TEST(test_frequency_window);
+  RUN_TEST(test_reset);
+  return UNITY_END();
+}
@@ -0,0 +1,159 @@
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "utils/spectrum.h"
+
+using inamata::utils::Spectrum;
+
+namespace {
+
+/**
+ * Fills the spectrum's buffer with an offset sine and optionally a second one
+ *
+ * \param spectrum The spectrum to fill
+ * \param sample_rate_hz The sampling rate
+ * \param frequency_hz The frequency of the first sine
+ * \param amplitude The amplitude of the first sine
+ * \param offset The DC offset, as from a biased ADC input
+ */
+void fillSine(Spectrum& spectrum, float sample_rate_hz, float frequency_hz,
+              float amplitude, float offset) {
+  float* samples = spectrum.samples();
+  for (size_t i = 0; i < spectrum.getBlockSize(); i++) {
+    samples[i] = offset + amplitude * sinf(2 * M_PI * frequency_hz * i /
+                                           sample_rate_hz);
+  }
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_block_sizes() {
+  TEST_ASSERT_FALSE(Spectrum::isValidBlockSize(8));
+  TEST_ASSERT_TRUE(Spectrum::isValidBlockSize(Spectrum::min_block_size));
+  TEST_ASSERT_TRUE(Spectrum::isValidBlockSize(Spectrum::max_block_size));
+  TEST_ASSERT_FALSE(Spectrum::isValidBlockSize(2 * Spectrum::max_block_size));
+  TEST_ASSERT_FALSE(Spectrum::isValidBlockSize(1000));
+
+  // An invalid size leaves an empty spectrum that analyzes to zeros
+  Spectrum spectrum(1000);
+  TEST_ASSERT_EQUAL(0, spectrum.getBlockSize());
+  const Spectrum::Features features = spectrum.analyze(1000);
+  TEST_ASSERT_EQUAL_FLOAT(0, features.rms);
+  TEST_ASSERT_EQUAL_FLOAT(0, spectrum.bandEnergy(0, 500));
+}
+
+void test_flat_block() {
+  Spectrum spectrum(64);
+  fillSine(spectrum, 1000, 0, 0, 2.5);
+  const Spectrum::Features features = spectrum.analyze(1000);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6, 0, features.rms);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6, 0, features.peak);
+  TEST_ASSERT_EQUAL_FLOAT(0, features.crest_factor);
+}
+
+void test_sine_time_features() {
+  // 16 samples per period, so that the samples hit the peaks
+  Spectrum spectrum(1024);
+  fillSine(spectrum, 1024, 64, 2, 1.5);
+  const Spectrum::Features features = spectrum.analyze(1024);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3, 2 / sqrtf(2), features.rms);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3, 2, features.peak);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3, sqrtf(2), features.crest_factor);
+}
+
+void test_dominant_frequency() {
+  // Off-bin frequencies are refined to a fraction of the bin width
+  const float sample_rate_hz = 1000;
+  for (size_t block_size = Spectrum::min_block_size;
+       block_size <= Spectrum::max_block_size; block_size <<= 1) {
+    Spectrum spectrum(block_size);
+    const float bin_width_hz = sample_rate_hz / block_size;
+    const float frequency_hz = 123.4f > 4 * bin_width_hz
+                                   ? 123.4f
+                                   : 4.3f * bin_width_hz;
+    fillSine(spectrum, sample_rate_hz, frequency_hz, 1, 0.5);
+    const Spectrum::Features features = spectrum.analyze(sample_rate_hz);
+    TEST_ASSERT_FLOAT_WITHIN(0.25f * bin_width_hz, frequency_hz,
+                             features.dominant_frequency_hz);
+  }
+}
+
+void test_band_energies_sum_to_mean_square() {
+  const float sample_rate_hz = 8000;
+  Spectrum spectrum(512);
+  float* samples = spectrum.samples();
+  for (size_t i = 0; i < spectrum.getBlockSize(); i++) {
+    const float t = i / sample_rate_hz;
+    samples[i] = 3 + sinf(2 * M_PI * 440 * t) +
+                 0.5f * sinf(2 * M_PI * 1234 * t) +
+                 0.25f * sinf(2 * M_PI * 3100 * t);
+  }
+  const Spectrum::Features features = spectrum.analyze(sample_rate_hz);
+  const float mean_square = features.rms * features.rms;
+
+  // The bands partition the spectrum up to and including the Nyquist bin
+  const float edges_hz[] = {0, 300, 1000, 2000, 4000 + sample_rate_hz / 512};
+  float sum = 0;
+  for (size_t i = 0; i + 1 < sizeof(edges_hz) / sizeof(edges_hz[0]); i++) {
+    sum += spectrum.bandEnergy(edges_hz[i], edges_hz[i + 1]);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-4, spectrum.bandEnergy(0, 2 * sample_rate_hz),
+                           sum);
+  TEST_ASSERT_FLOAT_WITHIN(0.05f * mean_square, mean_square, sum);
+
+  // Each tone's energy is half its squared amplitude
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.5f, spectrum.bandEnergy(300, 1000));
+  TEST_ASSERT_FLOAT_WITHIN(0.05f * 0.125f, 0.125f,
+                           spectrum.bandEnergy(1000, 2000));
+  TEST_ASSERT_FLOAT_WITHIN(0.05f * 0.03125f, 0.03125f,
+                           spectrum.bandEnergy(2000, 4000));
+  TEST_ASSERT_EQUAL_FLOAT(0, spectrum.bandEnergy(1000, 1000));
+}
+
+void test_benchmark() {
+  // Reports the throughput on the host. Each block is copied in again, as
+  // the analysis transforms the buffer in place
+  for (size_t block_size = Spectrum::min_block_size;
+       block_size <= Spectrum::max_block_size; block_size <<= 1) {
+    Spectrum spectrum(block_size);
+    fillSine(spectrum, 1000, 123.4f, 1, 0.5);
+    const std::vector<float> block(spectrum.samples(),
+                                   spectrum.samples() + block_size);
+    const size_t blocks = 2000000 / block_size;
+    float dominant_frequency_hz = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < blocks; i++) {
+      std::copy(block.begin(), block.end(), spectrum.samples());
+      dominant_frequency_hz += spectrum.analyze(1000).dominant_frequency_hz;
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    TEST_ASSERT_GREATER_THAN(0, dominant_frequency_hz);
+
+    char message[80];
+    snprintf(message, sizeof(message),
+             "%4zu samples: %9.0f blocks/s", block_size,
+             blocks / elapsed.count());
+    TEST_MESSAGE(message);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_block_sizes);
+  RUN_TEST(test_flat_block);
+  RUN_TEST(test_sine_time_features);
+  RUN_TEST(test_dominant_frequency);
+  RUN_TEST(test_band_energies_sum_to_mean_square);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
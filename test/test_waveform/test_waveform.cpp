@@ -0,0 +1,208 @@
+#include <math.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "utils/waveform.h"
+
+using inamata::utils::waveform::generate;
+using inamata::utils::waveform::layout;
+using inamata::utils::waveform::Layout;
+using inamata::utils::waveform::Limits;
+using inamata::utils::waveform::max_table_length;
+using inamata::utils::waveform::min_table_length;
+using inamata::utils::waveform::scale;
+using inamata::utils::waveform::Shape;
+using inamata::utils::waveform::tableLength;
+
+namespace {
+
+/// The limits of the ESP32's I2S DMA used by the DAC
+const Limits i2s_limits = {
+    .min_sample_rate = 5000,
+    .max_sample_rate = 1000000,
+    .max_buffer_frames = 1024,
+    .min_buffer_frames = 64,
+    .max_ring_frames = 8192,
+};
+
+/// Small limits to reach the period splitting cases with short tables
+const Limits small_limits = {
+    .min_sample_rate = 1,
+    .max_sample_rate = 1000000,
+    .max_buffer_frames = 100,
+    .min_buffer_frames = 40,
+    .max_ring_frames = 1000,
+};
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_generate_endpoints() {
+  // Full range centered at mid scale
+  const std::vector<uint8_t> square = generate(Shape::kSquare, 4, 1, 0.5f);
+  const uint8_t square_codes[] = {255, 255, 0, 0};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(square_codes, square.data(), 4);
+
+  const std::vector<uint8_t> triangle =
+      generate(Shape::kTriangle, 4, 1, 0.5f);
+  const uint8_t triangle_codes[] = {128, 255, 128, 0};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(triangle_codes, triangle.data(), 4);
+
+  const std::vector<uint8_t> sine = generate(Shape::kSine, 4, 1, 0.5f);
+  TEST_ASSERT_EQUAL(4, sine.size());
+  TEST_ASSERT_EQUAL_UINT8(128, sine[0]);
+  TEST_ASSERT_EQUAL_UINT8(255, sine[1]);
+  TEST_ASSERT_INT_WITHIN(1, 128, sine[2]);
+  TEST_ASSERT_EQUAL_UINT8(0, sine[3]);
+
+  // The sawtooth starts at the trough and ends a step below the peak
+  const std::vector<uint8_t> sawtooth =
+      generate(Shape::kSawtooth, max_table_length, 1, 0.5f);
+  TEST_ASSERT_EQUAL_UINT8(0, sawtooth.front());
+  TEST_ASSERT_EQUAL_UINT8(254, sawtooth.back());
+  for (size_t i = 1; i < sawtooth.size(); i++) {
+    TEST_ASSERT_TRUE(sawtooth[i] >= sawtooth[i - 1]);
+  }
+
+  TEST_ASSERT_EQUAL(0, generate(Shape::kSine, 0, 1, 0.5f).size());
+}
+
+void test_generate_clamping() {
+  // Twice the full range clips to the rails
+  const std::vector<uint8_t> triangle = generate(Shape::kTriangle, 8, 2, 0.5f);
+  const uint8_t triangle_codes[] = {128, 255, 255, 255, 128, 0, 0, 0};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(triangle_codes, triangle.data(), 8);
+
+  // An offset at the top rail clips the upper half
+  const std::vector<uint8_t> sine = generate(Shape::kSine, 4, 1, 1);
+  TEST_ASSERT_EQUAL_UINT8(255, sine[0]);
+  TEST_ASSERT_EQUAL_UINT8(255, sine[1]);
+  TEST_ASSERT_EQUAL_UINT8(128, sine[3]);
+
+  // Offsets beyond the range stay at the rails
+  for (const uint8_t code : generate(Shape::kSquare, 8, 0.5f, -1)) {
+    TEST_ASSERT_EQUAL_UINT8(0, code);
+  }
+  for (const uint8_t code : generate(Shape::kSawtooth, 8, 0.5f, 2)) {
+    TEST_ASSERT_EQUAL_UINT8(255, code);
+  }
+
+  const std::vector<uint8_t> scaled = scale({-2, -1, 0, 1, 2}, 1, 0.5f);
+  const uint8_t scaled_codes[] = {0, 0, 128, 255, 255};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(scaled_codes, scaled.data(), 5);
+}
+
+void test_table_length() {
+  TEST_ASSERT_EQUAL(max_table_length, tableLength(0.1f, i2s_limits));
+  TEST_ASSERT_EQUAL(max_table_length, tableLength(1000, i2s_limits));
+  // Exactly the maximum sample rate with the longest table
+  TEST_ASSERT_EQUAL(max_table_length, tableLength(3906.25f, i2s_limits));
+  TEST_ASSERT_EQUAL(max_table_length / 2, tableLength(3907, i2s_limits));
+  TEST_ASSERT_EQUAL(min_table_length, tableLength(125000, i2s_limits));
+  TEST_ASSERT_EQUAL(0, tableLength(125001, i2s_limits));
+}
+
+void test_layout_whole_periods() {
+  Layout result;
+  TEST_ASSERT_TRUE(layout(1000, 256, i2s_limits, result));
+  TEST_ASSERT_EQUAL(1, result.repeat);
+  TEST_ASSERT_EQUAL(256000, result.sample_rate);
+  TEST_ASSERT_EQUAL(1024, result.buffer_frames);
+  TEST_ASSERT_EQUAL(2, result.buffer_count);
+
+  // A period that does not divide the buffer leaves the remainder unused
+  TEST_ASSERT_TRUE(layout(1000, 300, i2s_limits, result));
+  TEST_ASSERT_EQUAL(900, result.buffer_frames);
+  TEST_ASSERT_EQUAL(2, result.buffer_count);
+}
+
+void test_layout_repeat() {
+  // 256 entries at 1 Hz are repeated 20 times to reach 5 kHz. The period of
+  // 5120 frames splits into 5 full buffers
+  Layout result;
+  TEST_ASSERT_TRUE(layout(1, 256, i2s_limits, result));
+  TEST_ASSERT_EQUAL(20, result.repeat);
+  TEST_ASSERT_EQUAL(5120, result.sample_rate);
+  TEST_ASSERT_EQUAL(1024, result.buffer_frames);
+  TEST_ASSERT_EQUAL(5, result.buffer_count);
+
+  // 33 repeats to reach 5 kHz do not fit the ring
+  TEST_ASSERT_FALSE(layout(0.6f, 256, i2s_limits, result));
+}
+
+void test_layout_split() {
+  // A period of 150 frames splits evenly into 2 buffers of 75
+  Layout result;
+  TEST_ASSERT_TRUE(layout(1000, 150, small_limits, result));
+  TEST_ASSERT_EQUAL(1, result.repeat);
+  TEST_ASSERT_EQUAL(75, result.buffer_frames);
+  TEST_ASSERT_EQUAL(2, result.buffer_count);
+
+  // 105 frames only split into 3 buffers of 35, below the minimum. Repeating
+  // each entry twice gives 210 frames in 3 buffers of 70
+  TEST_ASSERT_TRUE(layout(1000, 105, small_limits, result));
+  TEST_ASSERT_EQUAL(2, result.repeat);
+  TEST_ASSERT_EQUAL(210000, result.sample_rate);
+  TEST_ASSERT_EQUAL(70, result.buffer_frames);
+  TEST_ASSERT_EQUAL(3, result.buffer_count);
+
+  // A prime period only splits into single frames for any repeat, until the
+  // ring is full
+  TEST_ASSERT_FALSE(layout(1000, 101, small_limits, result));
+  // or the sample rate is too high
+  Limits slow_limits = small_limits;
+  slow_limits.max_sample_rate = 303000;
+  slow_limits.max_ring_frames = 100000;
+  TEST_ASSERT_FALSE(layout(1000, 101, slow_limits, result));
+}
+
+void test_layout_invalid() {
+  Layout result;
+  TEST_ASSERT_FALSE(layout(0, 256, i2s_limits, result));
+  TEST_ASSERT_FALSE(layout(-1, 256, i2s_limits, result));
+  TEST_ASSERT_FALSE(layout(NAN, 256, i2s_limits, result));
+  TEST_ASSERT_FALSE(layout(1000, 1, i2s_limits, result));
+  // Faster than the maximum sample rate allows
+  TEST_ASSERT_FALSE(layout(200000, 8, i2s_limits, result));
+}
+
+void test_layout_sweep() {
+  // From the lowest frequency, where 32 repeats of the longest table fill the
+  // ring, to the fastest, every frequency has a layout of whole periods
+  for (float frequency = 0.62f; frequency <= 125000; frequency *= 1.01f) {
+    const size_t length = tableLength(frequency, i2s_limits);
+    TEST_ASSERT_NOT_EQUAL(0, length);
+    Layout result;
+    TEST_ASSERT_TRUE(layout(frequency, length, i2s_limits, result));
+    const size_t period = length * result.repeat;
+    const size_t ring = result.buffer_frames * result.buffer_count;
+    TEST_ASSERT_EQUAL(0, ring % period);
+    TEST_ASSERT_TRUE(result.buffer_frames % period == 0 ||
+                     period % result.buffer_frames == 0);
+    TEST_ASSERT_LESS_OR_EQUAL(i2s_limits.max_buffer_frames,
+                              result.buffer_frames);
+    TEST_ASSERT_GREATER_OR_EQUAL(i2s_limits.min_buffer_frames,
+                                 result.buffer_frames);
+    TEST_ASSERT_LESS_OR_EQUAL(i2s_limits.max_ring_frames, ring);
+    TEST_ASSERT_GREATER_OR_EQUAL(i2s_limits.min_sample_rate,
+                                 result.sample_rate);
+    TEST_ASSERT_LESS_OR_EQUAL(i2s_limits.max_sample_rate, result.sample_rate);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_generate_endpoints);
+  RUN_TEST(test_generate_clamping);
+  RUN_TEST(test_table_length);
+  RUN_TEST(test_layout_whole_periods);
+  RUN_TEST(test_layout_repeat);
+  RUN_TEST(test_layout_split);
+  RUN_TEST(test_layout_invalid);
+  RUN_TEST(test_layout_sweep);
+  return UNITY_END();
+}